@@ -99,14 +99,23 @@ int fast_mp_invmod (mp_int * a, mp_int * b, mp_int * c)
 {
   mp_int  x, y, u, v, B, D;
   int     res, neg;
+  size_t  mark;
 
   /* 2. [modified] b must be odd   */
   if (mp_iseven (b) == 1) {
     return MP_VAL;
   }
 
-  /* init all our temps */
-  if ((res = mp_init_multi(&x, &y, &u, &v, &B, &D, NULL)) != MP_OKAY) {
+  /* init all our temps, D becomes the result and the rest are scratch */
+  mark = XSCRATCH_MARK();
+  XSCRATCH_RESERVE(sizeof(mp_digit) * 5 * (b->used + 4 * MP_PREC));
+  if ((res = mp_init_scratch_multi(b->used + 2, &x, &y, &u, &v, &B, NULL)) != MP_OKAY) {
+     XSCRATCH_RELEASE(mark);
+     return res;
+  }
+  if ((res = mp_init(&D)) != MP_OKAY) {
+     mp_clear_multi(&x, &y, &u, &v, &B, NULL);
+     XSCRATCH_RELEASE(mark);
      return res;
   }
 
@@ -213,6 +222,7 @@ top:
   res = MP_OKAY;
 
 LBL_ERR:mp_clear_multi (&x, &y, &u, &v, &B, &D, NULL);
+  XSCRATCH_RELEASE(mark);
   return res;
 }
 #endif
@@ -252,6 +262,82 @@ LBL_ERR:mp_clear_multi (&x, &y, &u, &v, &B, &D, NULL);
  *
  * Based on Algorithm 14.32 on pp.601 of HAC.
 */
+#ifdef MP_64BIT_FULL
+/* With full digits a column of W[] can not hold the sum of its products,
+ * so this is the product scanning form instead: each column of x + q*n is
+ * summed once, into a three digit accumulator, in the order the digits
+ * of q = x * -1/n mod b**n are found.  Column ix only needs q[0..ix].
+ */
+int fast_mp_montgomery_reduce (mp_int * x, mp_int * n, mp_digit rho)
+{
+  int     ix, iy, res, olduse, used;
+  mp_digit q[MP_WARRAY], c2, *tmpq, *tmpn;
+  mp_word _W;
+
+  /* get old used count */
+  olduse = x->used;
+  used   = n->used;
+
+  /* grow a as required */
+  if (x->alloc < used + 1) {
+    if ((res = mp_grow (x, used + 1)) != MP_OKAY) {
+      return res;
+    }
+  }
+
+  _W = 0;
+  c2 = 0;
+
+  /* the low columns, each one finds a digit of q and comes out zero */
+  for (ix = 0; ix < used; ix++) {
+    if (ix < x->used) {
+      MP_COMBA_ADD(_W, c2, (mp_word)x->dp[ix]);
+    }
+    tmpq = q;
+    tmpn = n->dp + ix;
+    for (iy = 0; iy < ix; iy++) {
+      MP_COMBA_ADD(_W, c2, ((mp_word)*tmpq++) * ((mp_word)*tmpn--));
+    }
+    q[ix] = ((mp_digit)_W) * rho;
+    MP_COMBA_ADD(_W, c2, ((mp_word)q[ix]) * ((mp_word)n->dp[0]));
+    MP_COMBA_NEXT(_W, c2);
+  }
+
+  /* the high columns are the result, A = A/b**n.  Digit ix of x has been
+   * read by the time digit ix - n is written over.
+   */
+  for (; ix < used + used; ix++) {
+    if (ix < x->used) {
+      MP_COMBA_ADD(_W, c2, (mp_word)x->dp[ix]);
+    }
+    tmpq = q + (ix - used + 1);
+    tmpn = n->dp + (used - 1);
+    for (iy = ix - used + 1; iy < used; iy++) {
+      MP_COMBA_ADD(_W, c2, ((mp_word)*tmpq++) * ((mp_word)*tmpn--));
+    }
+    x->dp[ix - used] = (mp_digit)_W;
+    MP_COMBA_NEXT(_W, c2);
+  }
+  x->dp[used] = (mp_digit)_W;
+
+  /* zero oldused digits, if the input a was larger than
+   * m->used+1 we'll have to clear the digits
+   */
+  for (ix = used + 1; ix < olduse; ix++) {
+    x->dp[ix] = 0;
+  }
+
+  /* set the max used and clamp */
+  x->used = used + 1;
+  mp_clamp (x);
+
+  /* if A >= m then A = A - m */
+  if (mp_cmp_mag (x, n) != MP_LT) {
+    return s_mp_sub (x, n, x);
+  }
+  return MP_OKAY;
+}
+#else
 int fast_mp_montgomery_reduce (mp_int * x, mp_int * n, mp_digit rho)
 {
   int     ix, res, olduse;
@@ -395,6 +481,7 @@ int fast_mp_montgomery_reduce (mp_int * x, mp_int * n, mp_digit rho)
   return MP_OKAY;
 }
 #endif
+#endif
 
 /* $Source: /cvs/libtom/libtommath/bn_fast_mp_montgomery_reduce.c,v $ */
 /* $Revision: 1.4 $ */
@@ -444,6 +531,20 @@ int fast_s_mp_mul_digs (mp_int * a, mp_int * b, mp_int * c, int digs)
   int     olduse, res, pa, ix, iz;
   mp_digit W[MP_WARRAY];
   register mp_word  _W;
+#ifdef MP_64BIT_FULL
+  register mp_digit c2 = 0;
+#endif
+
+#if defined(BN_S_MP_MUL_SIMD_C) && defined(MP_COMBA_SIMD)
+  /* the whole product with vector instructions? */
+  if (COMBA_MUL_METHOD == MP_COMBA_DETECT) {
+    COMBA_MUL_METHOD = mp_comba_best ();
+  }
+  if (COMBA_MUL_METHOD != MP_COMBA_SCALAR && digs >= a->used + b->used &&
+      MIN (a->used, b->used) >= SIMD_MUL_CUTOFF) {
+    return s_mp_mul_simd (a, b, c);
+  }
+#endif
 
   /* grow the destination as required */
   if (c->alloc < digs) {
@@ -476,6 +577,15 @@ int fast_s_mp_mul_digs (mp_int * a, mp_int * b, mp_int * c, int digs)
       iy = MIN(a->used-tx, ty+1);
 
       /* execute loop */
+#ifdef MP_64BIT_FULL
+      for (iz = 0; iz < iy; ++iz) {
+         MP_COMBA_ADD(_W, c2, ((mp_word)*tmpx++)*((mp_word)*tmpy--));
+      }
+
+      /* store term and make next carry */
+      W[ix] = (mp_digit)_W;
+      MP_COMBA_NEXT(_W, c2);
+#else
       for (iz = 0; iz < iy; ++iz) {
          _W += ((mp_word)*tmpx++)*((mp_word)*tmpy--);
 
@@ -486,6 +596,7 @@ int fast_s_mp_mul_digs (mp_int * a, mp_int * b, mp_int * c, int digs)
 
       /* make next carry */
       _W = _W >> ((mp_word)DIGIT_BIT);
+#endif
  }
 
   /* setup dest */
@@ -551,6 +662,9 @@ int fast_s_mp_mul_high_digs (mp_int * a, mp_int * b, mp_int * c, int digs)
   int     olduse, res, pa, ix, iz;
   mp_digit W[MP_WARRAY];
   mp_word  _W;
+#ifdef MP_64BIT_FULL
+  mp_digit c2 = 0;
+#endif
 
   /* grow the destination as required */
   pa = a->used + b->used;
@@ -581,6 +695,15 @@ int fast_s_mp_mul_high_digs (mp_int * a, mp_int * b, mp_int * c, int digs)
       iy = MIN(a->used-tx, ty+1);
 
       /* execute loop */
+#ifdef MP_64BIT_FULL
+      for (iz = 0; iz < iy; iz++) {
+         MP_COMBA_ADD(_W, c2, ((mp_word)*tmpx++)*((mp_word)*tmpy--));
+      }
+
+      /* store term and make next carry */
+      W[ix] = (mp_digit)_W;
+      MP_COMBA_NEXT(_W, c2);
+#else
       for (iz = 0; iz < iy; iz++) {
          _W += ((mp_word)*tmpx++)*((mp_word)*tmpy--);
       }
@@ -590,6 +713,7 @@ int fast_s_mp_mul_high_digs (mp_int * a, mp_int * b, mp_int * c, int digs)
 
       /* make next carry */
       _W = _W >> ((mp_word)DIGIT_BIT);
+#endif
   }
   
   /* setup dest */
@@ -658,6 +782,18 @@ int fast_s_mp_sqr (mp_int * a, mp_int * b)
   mp_digit   W[MP_WARRAY], *tmpx;
   mp_word   W1;
 
+#if defined(BN_S_MP_MUL_SIMD_C) && defined(MP_COMBA_SIMD)
+  /* with vector instructions?  they do not halve the work like below
+   * so only the 52 bit multiplier catches up, and from a larger size
+   */
+  if (COMBA_MUL_METHOD == MP_COMBA_DETECT) {
+    COMBA_MUL_METHOD = mp_comba_best ();
+  }
+  if (COMBA_MUL_METHOD == MP_COMBA_IFMA && a->used >= SIMD_SQR_CUTOFF) {
+    return s_mp_mul_simd (a, a, b);
+  }
+#endif
+
   /* grow the destination as required */
   pa = a->used + a->used;
   if (b->alloc < pa) {
@@ -672,6 +808,9 @@ int fast_s_mp_sqr (mp_int * a, mp_int * b)
       int      tx, ty, iy;
       mp_word  _W;
       mp_digit *tmpy;
+#ifdef MP_64BIT_FULL
+      mp_digit c2 = 0;
+#endif
 
       /* clear counter */
       _W = 0;
@@ -696,6 +835,28 @@ int fast_s_mp_sqr (mp_int * a, mp_int * b)
       iy = MIN(iy, (ty-tx+1)>>1);
 
       /* execute loop */
+#ifdef MP_64BIT_FULL
+      for (iz = 0; iz < iy; iz++) {
+         MP_COMBA_ADD(_W, c2, ((mp_word)*tmpx++)*((mp_word)*tmpy--));
+      }
+
+      /* double the inner product, the top bit of _W goes into c2 */
+      c2 = (c2 << 1) | (mp_digit)(_W >> ((mp_word)(2 * DIGIT_BIT - 1)));
+      _W = _W + _W;
+
+      /* add carry */
+      MP_COMBA_ADD(_W, c2, W1);
+
+      /* even columns have the square term in them */
+      if ((ix&1) == 0) {
+         MP_COMBA_ADD(_W, c2, ((mp_word)a->dp[ix>>1])*((mp_word)a->dp[ix>>1]));
+      }
+
+      /* store it and make next carry */
+      W[ix] = (mp_digit)_W;
+      MP_COMBA_NEXT(_W, c2);
+      W1 = _W;
+#else
       for (iz = 0; iz < iy; iz++) {
          _W += ((mp_word)*tmpx++)*((mp_word)*tmpy--);
       }
@@ -713,6 +874,7 @@ int fast_s_mp_sqr (mp_int * a, mp_int * b)
 
       /* make next carry */
       W1 = _W >> ((mp_word)DIGIT_BIT);
+#endif
   }
 
   /* setup dest */
@@ -962,9 +1124,6 @@ mp_add_d (mp_int * a, mp_digit b, mp_int * c)
   /* old number of used digits in c */
   oldused = c->used;
 
-  /* sign always positive */
-  c->sign = MP_ZPOS;
-
   /* source alias */
   tmpa    = a->dp;
 
@@ -976,6 +1135,17 @@ mp_add_d (mp_int * a, mp_digit b, mp_int * c)
      /* add digit, after this we're propagating
       * the carry.
       */
+#ifdef MP_64BIT_FULL
+     /* full digits, the carry is the wrap around */
+     *tmpc   = *tmpa++ + b;
+     mu      = (*tmpc++ < b);
+
+     /* now handle rest of the digits */
+     for (ix = 1; ix < a->used; ix++) {
+        *tmpc   = *tmpa++ + mu;
+        mu      = (*tmpc++ < mu);
+     }
+#else
      *tmpc   = *tmpa++ + b;
      mu      = *tmpc >> DIGIT_BIT;
      *tmpc++ &= MP_MASK;
@@ -986,6 +1156,7 @@ mp_add_d (mp_int * a, mp_digit b, mp_int * c)
         mu      = *tmpc >> DIGIT_BIT;
         *tmpc++ &= MP_MASK;
      }
+#endif
      /* set final carry */
      ix++;
      *tmpc++  = mu;
@@ -1009,6 +1180,9 @@ mp_add_d (mp_int * a, mp_digit b, mp_int * c)
      ix       = 1;
   }
 
+  /* sign always positive, only set now since c may be a */
+  c->sign = MP_ZPOS;
+
   /* now zero to oldused */
   while (ix++ < oldused) {
      *tmpc++ = 0;
@@ -1139,6 +1313,117 @@ mp_and (mp_int * a, mp_int * b, mp_int * c)
  --   End: vendor/libtommath-0.41/bn_mp_and.c
  ---------------------------------------------------------------------*/
 
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_chunk_mul.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_CHUNK_MUL_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* c = |a| * |b| by cutting a into pieces of size digits
+ *
+ * Meant for a much longer than b.  Every piece of a is multiplied by b
+ * with mp_mul, which picks the best method for two numbers of about the
+ * same size, and the partial products are added in at their digit.  The
+ * pieces are not copied, they are read in place from a.
+ */
+int mp_chunk_mul (mp_int * a, mp_int * b, mp_int * c, int size)
+{
+  mp_int   r, p, t;
+  mp_digit u, *tmpr, *tmpt;
+  int      res, ix, iy, n;
+#ifdef MP_64BIT_FULL
+  mp_word  w;
+#endif
+
+  if (size < 1) {
+    return MP_VAL;
+  }
+  if (mp_iszero (a) == MP_YES || mp_iszero (b) == MP_YES) {
+    mp_zero (c);
+    return MP_OKAY;
+  }
+
+  if ((res = mp_init_size (&r, a->used + b->used + 1)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_init_size (&t, size + b->used + 1)) != MP_OKAY) {
+    goto LBL_R;
+  }
+  r.used = a->used + b->used + 1;
+
+  /* p is a window on a, it is only ever read */
+  p.sign = MP_ZPOS;
+  for (ix = 0; ix < a->used; ix += size) {
+    n       = MIN (size, a->used - ix);
+    p.dp    = a->dp + ix;
+    p.used  = n;
+    p.alloc = n;
+    mp_clamp (&p);
+
+    if ((res = mp_mul (&p, b, &t)) != MP_OKAY) {
+      goto LBL_T;
+    }
+
+    /* r += t * 2**(ix*DIGIT_BIT) */
+    tmpr = r.dp + ix;
+    tmpt = t.dp;
+    u    = 0;
+#ifdef MP_64BIT_FULL
+    for (iy = 0; iy < t.used; iy++) {
+      w       = ((mp_word)*tmpr) + ((mp_word)*tmpt++) + ((mp_word)u);
+      *tmpr++ = (mp_digit)w;
+      u       = (mp_digit)(w >> ((mp_word)DIGIT_BIT));
+    }
+    while (u != 0) {
+      *tmpr += u;
+      u      = (*tmpr++ < u);
+    }
+#else
+    for (iy = 0; iy < t.used; iy++) {
+      *tmpr += *tmpt++ + u;
+      u      = *tmpr >> ((mp_digit)DIGIT_BIT);
+      *tmpr++ &= MP_MASK;
+    }
+    while (u != 0) {
+      *tmpr += u;
+      u      = *tmpr >> ((mp_digit)DIGIT_BIT);
+      *tmpr++ &= MP_MASK;
+    }
+#endif
+  }
+
+  mp_clamp (&r);
+  r.sign = MP_ZPOS;
+  mp_exch (&r, c);
+  res = MP_OKAY;
+
+LBL_T:mp_clear (&t);
+LBL_R:mp_clear (&r);
+  return res;
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_chunk_mul.c,v $ */
+/* $Revision: 1.1 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_chunk_mul.c
+ ---------------------------------------------------------------------*/
+
 /*----------------------------------------------------------------------
  -- Start: vendor/libtommath-0.41/bn_mp_clamp.c
  ---------------------------------------------------------------------*/
@@ -1741,6 +2026,7 @@ int mp_div (mp_int * a, mp_int * b, mp_int * c, mp_int * d)
 {
   mp_int  q, x, y, t1, t2;
   int     res, n, t, i, norm, neg;
+  size_t  mark;
 
   /* is divisor zero ? */
   if (mp_iszero (b) == 1) {
@@ -1760,16 +2046,27 @@ int mp_div (mp_int * a, mp_int * b, mp_int * c, mp_int * d)
     return res;
   }
 
+#ifdef BN_MP_DIV_BZ_C
+  /* long quotient and divisor?  use Burnikel-Ziegler */
+  if (b->used >= BZ_DIV_CUTOFF && a->used - b->used >= BZ_DIV_CUTOFF) {
+    return mp_div_bz (a, b, c, d);
+  }
+#endif
+
+  /* q and x become the results, the other temps are scratch */
+  mark = XSCRATCH_MARK ();
+  XSCRATCH_RESERVE (sizeof (mp_digit) * (a->used + b->used + 8 * MP_PREC));
+
   if ((res = mp_init_size (&q, a->used + 2)) != MP_OKAY) {
-    return res;
+    goto LBL_MARK;
   }
   q.used = a->used + 2;
 
-  if ((res = mp_init (&t1)) != MP_OKAY) {
+  if ((res = mp_init_scratch (&t1, a->used + 2)) != MP_OKAY) {
     goto LBL_Q;
   }
 
-  if ((res = mp_init (&t2)) != MP_OKAY) {
+  if ((res = mp_init_scratch (&t2, 3)) != MP_OKAY) {
     goto LBL_T1;
   }
 
@@ -1777,9 +2074,12 @@ int mp_div (mp_int * a, mp_int * b, mp_int * c, mp_int * d)
     goto LBL_T2;
   }
 
-  if ((res = mp_init_copy (&y, b)) != MP_OKAY) {
+  if ((res = mp_init_scratch (&y, b->used + 1)) != MP_OKAY) {
     goto LBL_X;
   }
+  if ((res = mp_copy (b, &y)) != MP_OKAY) {
+    goto LBL_Y;
+  }
 
   /* fix the sign */
   neg = (a->sign == b->sign) ? MP_ZPOS : MP_NEG;
@@ -1827,7 +2127,7 @@ int mp_div (mp_int * a, mp_int * b, mp_int * c, mp_int * d)
     /* step 3.1 if xi == yt then set q{i-t-1} to b-1, 
      * otherwise set q{i-t-1} to (xi*b + x{i-1})/yt */
     if (x.dp[i] == y.dp[t]) {
-      q.dp[i - t - 1] = ((((mp_digit)1) << DIGIT_BIT) - 1);
+      q.dp[i - t - 1] = MP_MASK;
     } else {
       mp_word tmp;
       tmp = ((mp_word) x.dp[i]) << ((mp_word) DIGIT_BIT);
@@ -1917,6 +2217,8 @@ LBL_X:mp_clear (&x);
 LBL_T2:mp_clear (&t2);
 LBL_T1:mp_clear (&t1);
 LBL_Q:mp_clear (&q);
+LBL_MARK:
+  XSCRATCH_RELEASE (mark);
   return res;
 }
 
@@ -2043,12 +2345,11 @@ int mp_div_2d (mp_int * a, int b, mp_int * c, mp_int * d)
     return res;
   }
 
-  if ((res = mp_init (&t)) != MP_OKAY) {
-    return res;
-  }
-
-  /* get the remainder */
+  /* get the remainder, the temporary is only needed for that */
   if (d != NULL) {
+    if ((res = mp_init (&t)) != MP_OKAY) {
+      return res;
+    }
     if ((res = mp_mod_2d (a, b, &t)) != MP_OKAY) {
       mp_clear (&t);
       return res;
@@ -2057,7 +2358,9 @@ int mp_div_2d (mp_int * a, int b, mp_int * c, mp_int * d)
 
   /* copy */
   if ((res = mp_copy (a, c)) != MP_OKAY) {
-    mp_clear (&t);
+    if (d != NULL) {
+      mp_clear (&t);
+    }
     return res;
   }
 
@@ -2097,8 +2400,8 @@ int mp_div_2d (mp_int * a, int b, mp_int * c, mp_int * d)
   mp_clamp (c);
   if (d != NULL) {
     mp_exch (&t, d);
+    mp_clear (&t);
   }
-  mp_clear (&t);
   return MP_OKAY;
 }
 #endif
@@ -2197,10 +2500,10 @@ mp_div_3 (mp_int * a, mp_int *c, mp_digit * d)
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_div_d.c
+ -- Start: vendor/libtommath-0.41/bn_mp_div_barrett.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_DIV_D_C
+#ifdef BN_MP_DIV_BARRETT_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -2216,113 +2519,172 @@ mp_div_3 (mp_int * a, mp_int *c, mp_digit * d)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-static int s_is_power_of_two(mp_digit b, int *p)
-{
-   int x;
-
-   /* fast return if no power of two */
-   if ((b==0) || (b & (b-1))) {
-      return 0;
-   }
-
-   for (x = 0; x < DIGIT_BIT; x++) {
-      if (b == (((mp_digit)1)<<x)) {
-         *p = x;
-         return 1;
-      }
-   }
-   return 0;
-}
-
-/* single digit division (based on routine from MPI) */
-int mp_div_d (mp_int * a, mp_digit b, mp_int * c, mp_digit * d)
+/* integer signed division, c*b + d == a, by Barrett reduction
+ *
+ * b has to be positive with the top bit of its top digit set and mu is
+ * mp_reciprocal(b), which is worth it when many numbers are divided by
+ * the same b.  a is worked through in blocks of n = b->used digits from
+ * the top.  Each block, below the remainder of the one before, is some
+ * x < b * 2**(DIGIT_BIT*n) and
+ *
+ *   q = ((x div 2**(DIGIT_BIT*(n-1))) * mu) div 2**(DIGIT_BIT*(n+1))
+ *
+ * is at most two short of x div b (HAC 14.42).  Only the columns of the
+ * product from n - 1 up are formed, which makes it at most three, and
+ * then x - q*b < 4b < 2**(DIGIT_BIT*(n+1)) only needs the low n + 1
+ * digits of q*b.  So a block costs two short products of about n
+ * digits.  The blocks are read from a and the quotient digits written
+ * into c in place.
+ */
+int mp_div_barrett(mp_int *a, mp_int *b, mp_int *mu, mp_int *c, mp_int *d)
 {
-  mp_int  q;
-  mp_word w;
-  mp_digit t;
-  int     res, ix;
+  mp_int    q, r, x, t;
+  mp_digit *tmpa, *tmpx;
+  int       res, n, k, ix, step, neg, sign;
+  size_t    mark;
 
-  /* cannot divide by zero */
-  if (b == 0) {
-     return MP_VAL;
+  if (b->sign == MP_NEG || b->used == 0 ||
+      (b->dp[b->used - 1] >> (DIGIT_BIT - 1)) == 0) {
+    return MP_VAL;
   }
 
-  /* quick outs */
-  if (b == 1 || mp_iszero(a) == 1) {
-     if (d != NULL) {
-        *d = 0;
-     }
-     if (c != NULL) {
-        return mp_copy(a, c);
-     }
-     return MP_OKAY;
+  /* if a < b then q=0, r = a */
+  if (mp_cmp_mag (a, b) == MP_LT) {
+    if (d != NULL) {
+      res = mp_copy (a, d);
+    } else {
+      res = MP_OKAY;
+    }
+    if (c != NULL) {
+      mp_zero (c);
+    }
+    return res;
   }
 
-  /* power of two ? */
-  if (s_is_power_of_two(b, &ix) == 1) {
-     if (d != NULL) {
-        *d = a->dp[0] & ((((mp_digit)1)<<ix) - 1);
-     }
-     if (c != NULL) {
-        return mp_div_2d(a, ix, c, NULL);
-     }
-     return MP_OKAY;
-  }
+  /* the signs before c or d, which may be a, are written */
+  neg  = a->sign;
+  sign = a->sign;
 
-#ifdef BN_MP_DIV_3_C
-  /* three? */
-  if (b == 3) {
-     return mp_div_3(a, c, d);
+  /* q and r become the results, the other temps are scratch */
+  mark = XSCRATCH_MARK();
+  XSCRATCH_RESERVE(sizeof(mp_digit) * 8 * (a->used + 2 * b->used + 8 * MP_PREC));
+  if ((res = mp_init_size(&q, a->used + 1)) != MP_OKAY) {
+    goto LBL_MARK;
   }
-#endif
-
-  /* no easy answer [c'est la vie].  Just division */
-  if ((res = mp_init_size(&q, a->used)) != MP_OKAY) {
-     return res;
+  if ((res = mp_init_size(&r, 2 * b->used + 2)) != MP_OKAY) {
+    goto LBL_Q;
   }
-  
-  q.used = a->used;
-  q.sign = a->sign;
-  w = 0;
-  for (ix = a->used - 1; ix >= 0; ix--) {
-     w = (w << ((mp_word)DIGIT_BIT)) | ((mp_word)a->dp[ix]);
-     
-     if (w >= b) {
-        t = (mp_digit)(w / b);
-        w -= ((mp_word)t) * ((mp_word)b);
-      } else {
-        t = 0;
-      }
-      q.dp[ix] = (mp_digit)t;
+  if ((res = mp_init_scratch_multi(2 * b->used + 4, &x, &t, NULL)) != MP_OKAY) {
+    goto LBL_R;
   }
-  
-  if (d != NULL) {
-     *d = (mp_digit)w;
+
+  /* the top block is what is left over a whole number of n digit ones */
+  n    = b->used;
+  k    = a->used;
+  step = k % n;
+  if (step == 0) {
+    step = n;
   }
-  
+  q.used = a->used;
+  while (k > 0) {
+    k -= step;
+
+    /* x = r * 2**(DIGIT_BIT*step) + the next step digits of |a| */
+    if ((res = mp_grow(&x, step + r.used)) != MP_OKAY) {
+      goto ERR;
+    }
+    tmpa = a->dp + k;
+    tmpx = x.dp;
+    for (ix = 0; ix < step; ix++) {
+      *tmpx++ = *tmpa++;
+    }
+    tmpa = r.dp;
+    for (ix = 0; ix < r.used; ix++) {
+      *tmpx++ = *tmpa++;
+    }
+    x.used = step + r.used;
+    x.sign = MP_ZPOS;
+    mp_clamp(&x);
+
+    /* t = the estimate of x div b, r = x - t * b */
+    if ((res = mp_copy(&x, &t)) != MP_OKAY) {
+      goto ERR;
+    }
+    mp_rshd(&t, n - 1);
+    if ((res = mp_mulhi(&t, mu, &t, n - 1)) != MP_OKAY) {
+      goto ERR;
+    }
+    mp_rshd(&t, n + 1);
+    if ((res = mp_mullo(&t, b, &r, n + 1)) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = mp_mod_2d(&x, DIGIT_BIT * (n + 1), &x)) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = mp_sub(&x, &r, &r)) != MP_OKAY) {
+      goto ERR;
+    }
+    if (r.sign == MP_NEG) {
+      mp_set(&x, 1);
+      if ((res = mp_lshd(&x, n + 1)) != MP_OKAY) {
+        goto ERR;
+      }
+      if ((res = mp_add(&r, &x, &r)) != MP_OKAY) {
+        goto ERR;
+      }
+    }
+    while (mp_cmp_mag(&r, b) != MP_LT) {
+      if ((res = mp_add_d(&t, 1, &t)) != MP_OKAY) {
+        goto ERR;
+      }
+      if ((res = s_mp_sub(&r, b, &r)) != MP_OKAY) {
+        goto ERR;
+      }
+    }
+
+    /* t < 2**(DIGIT_BIT*step) goes in at digit k of q */
+    tmpa = t.dp;
+    tmpx = q.dp + k;
+    for (ix = 0; ix < t.used; ix++) {
+      *tmpx++ = *tmpa++;
+    }
+    step = n;
+  }
+  mp_clamp(&q);
+
   if (c != NULL) {
-     mp_clamp(&q);
-     mp_exch(&q, c);
+    mp_exch(&q, c);
+    c->sign = (mp_iszero(c) == MP_YES) ? MP_ZPOS : neg;
+  }
+  if (d != NULL) {
+    mp_exch(&r, d);
+    d->sign = (mp_iszero(d) == MP_YES) ? MP_ZPOS : sign;
   }
+
+ERR:
+  mp_clear_multi(&x, &t, NULL);
+LBL_R:
+  mp_clear(&r);
+LBL_Q:
   mp_clear(&q);
-  
+LBL_MARK:
+  XSCRATCH_RELEASE(mark);
   return res;
 }
-
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_div_d.c,v $ */
-/* $Revision: 1.5 $ */
-/* $Date: 2007/01/09 04:44:32 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_div_barrett.c,v $ */
+/* $Revision: 1.1 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_div_d.c
+ --   End: vendor/libtommath-0.41/bn_mp_div_barrett.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_dr_is_modulus.c
+ -- Start: vendor/libtommath-0.41/bn_mp_div_bz.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_DR_IS_MODULUS_C
+#ifdef BN_MP_DIV_BZ_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -2338,41 +2700,294 @@ int mp_div_d (mp_int * a, mp_digit b, mp_int * c, mp_digit * d)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* determines if a number is a valid DR modulus */
-int mp_dr_is_modulus(mp_int *a)
+/* recursive division of Burnikel and Ziegler, as RecursiveDivRem in
+ * Brent and Zimmermann's "Modern Computer Arithmetic", sec. 1.4.3
+ *
+ * For a of n+m digits and b of n, m <= n and b normalized (top bit of
+ * its top digit set) with k = m/2 and b = b1 * x**k + b0, x = 2**DIGIT_BIT,
+ *
+ *   (q1, r1) = (a div x**2k) divrem b1
+ *   a'       = r1 * x**2k + (a mod x**2k) - q1 * b0 * x**k
+ *   while a' < 0:  q1 -= 1, a' += b * x**k
+ *   (q0, r0) = (a' div x**k) divrem b1
+ *   r        = r0 * x**k + (a' mod x**k) - q0 * b0
+ *   while r < 0:   q0 -= 1, r += b
+ *
+ * which is q = q1 * x**k + q0 and r.  Two half sized divisions and two
+ * half sized products, so the whole costs a few multiplications when
+ * mp_mul is subquadratic.  Quotients under BZ_DIV_CUTOFF digits go to the
+ * schoolbook mp_div.  The corrections run at most twice thanks to the
+ * normalization.
+ */
+static int s_mp_div_bz(mp_int *a, mp_int *b, mp_int *q, mp_int *r)
 {
-   int ix;
+  mp_int  ah, al, b0, b1, q1, t;
+  int     res, n, m, k;
+  size_t  mark;
 
-   /* must be at least two digits */
-   if (a->used < 2) {
-      return 0;
-   }
+  n = b->used;
+  m = a->used - n;
+  if (m < BZ_DIV_CUTOFF) {
+    return mp_div(a, b, q, r);
+  }
+  k = m / 2;
 
-   /* must be of the form b**k - a [a <= b] so all
-    * but the first digit must be equal to -1 (mod b).
-    */
-   for (ix = 1; ix < a->used; ix++) {
-       if (a->dp[ix] != MP_MASK) {
-          return 0;
-       }
-   }
-   return 1;
+  mark = XSCRATCH_MARK();
+  if ((res = mp_init_scratch_multi(a->used + 1, &ah, &al, &q1, &t, NULL)) != MP_OKAY) {
+    goto LBL_MARK;
+  }
+  if ((res = mp_init_scratch_multi(n + 1, &b0, &b1, NULL)) != MP_OKAY) {
+    goto LBL_A;
+  }
+
+  /* b = b1 * x**k + b0 */
+  if ((res = mp_mod_2d(b, DIGIT_BIT * k, &b0)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_copy(b, &b1)) != MP_OKAY) {
+    goto ERR;
+  }
+  mp_rshd(&b1, k);
+
+  /* (q1, ah) = (a div x**2k) divrem b1 */
+  if ((res = mp_copy(a, &ah)) != MP_OKAY) {
+    goto ERR;
+  }
+  mp_rshd(&ah, 2 * k);
+  if ((res = s_mp_div_bz(&ah, &b1, &q1, &ah)) != MP_OKAY) {
+    goto ERR;
+  }
+
+  /* ah = ah * x**2k + (a mod x**2k) - q1 * b0 * x**k */
+  if ((res = mp_mod_2d(a, DIGIT_BIT * 2 * k, &al)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_lshd(&ah, 2 * k)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_add(&ah, &al, &ah)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_mul(&q1, &b0, &t)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_lshd(&t, k)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_sub(&ah, &t, &ah)) != MP_OKAY) {
+    goto ERR;
+  }
+  if (ah.sign == MP_NEG) {
+    if ((res = mp_copy(b, &t)) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = mp_lshd(&t, k)) != MP_OKAY) {
+      goto ERR;
+    }
+    while (ah.sign == MP_NEG) {
+      if ((res = mp_sub_d(&q1, 1, &q1)) != MP_OKAY) {
+        goto ERR;
+      }
+      if ((res = mp_add(&ah, &t, &ah)) != MP_OKAY) {
+        goto ERR;
+      }
+    }
+  }
+
+  /* (q, r) = (ah div x**k) divrem b1 */
+  if ((res = mp_mod_2d(&ah, DIGIT_BIT * k, &al)) != MP_OKAY) {
+    goto ERR;
+  }
+  mp_rshd(&ah, k);
+  if ((res = s_mp_div_bz(&ah, &b1, q, r)) != MP_OKAY) {
+    goto ERR;
+  }
+
+  /* r = r * x**k + (ah mod x**k) - q * b0 */
+  if ((res = mp_lshd(r, k)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_add(r, &al, r)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_mul(q, &b0, &t)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_sub(r, &t, r)) != MP_OKAY) {
+    goto ERR;
+  }
+  while (r->sign == MP_NEG) {
+    if ((res = mp_sub_d(q, 1, q)) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = mp_add(r, b, r)) != MP_OKAY) {
+      goto ERR;
+    }
+  }
+
+  /* q = q1 * x**k + q */
+  if ((res = mp_lshd(&q1, k)) != MP_OKAY) {
+    goto ERR;
+  }
+  res = mp_add(&q1, q, q);
+
+ERR:
+  mp_clear_multi(&b0, &b1, NULL);
+LBL_A:
+  mp_clear_multi(&ah, &al, &q1, &t, NULL);
+LBL_MARK:
+  XSCRATCH_RELEASE(mark);
+  return res;
 }
 
+/* integer signed division, c*b + d == a, like mp_div but for big
+ * quotients and divisors.
+ *
+ * The divisor is normalized and a is divided in blocks of b->used
+ * digits from the top, each block with the remainder of the one before
+ * above it, so that s_mp_div_bz never sees a quotient longer than b.
+ */
+int mp_div_bz(mp_int *a, mp_int *b, mp_int *c, mp_int *d)
+{
+  mp_int  x, y, q, r, qb, t;
+  int     res, norm, n, k, step, neg, sign;
+  size_t  mark;
+
+  /* is divisor zero ? */
+  if (mp_iszero (b) == 1) {
+    return MP_VAL;
+  }
+
+  /* if a < b then q=0, r = a */
+  if (mp_cmp_mag (a, b) == MP_LT) {
+    if (d != NULL) {
+      res = mp_copy (a, d);
+    } else {
+      res = MP_OKAY;
+    }
+    if (c != NULL) {
+      mp_zero (c);
+    }
+    return res;
+  }
+
+  /* the signs before c or d, which may be a or b, are written */
+  neg  = (a->sign == b->sign) ? MP_ZPOS : MP_NEG;
+  sign = a->sign;
+
+  /* q and r become the results, the other temps are scratch */
+  mark = XSCRATCH_MARK();
+  XSCRATCH_RESERVE(sizeof(mp_digit) * 12 * (a->used + b->used + 8 * MP_PREC));
+  if ((res = mp_init_size(&q, a->used + 1)) != MP_OKAY) {
+    goto LBL_MARK;
+  }
+  if ((res = mp_init_size(&r, b->used + 1)) != MP_OKAY) {
+    goto LBL_Q;
+  }
+  if ((res = mp_init_scratch_multi(a->used + 2, &x, &t, NULL)) != MP_OKAY) {
+    goto LBL_R;
+  }
+  if ((res = mp_init_scratch_multi(b->used + 2, &y, &qb, NULL)) != MP_OKAY) {
+    goto LBL_X;
+  }
+
+  /* x = |a| and y = |b| shifted so the top bit of y is set */
+  norm = mp_count_bits(b) % DIGIT_BIT;
+  norm = (norm == 0) ? 0 : DIGIT_BIT - norm;
+  if ((res = mp_abs(a, &x)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_abs(b, &y)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_mul_2d(&x, norm, &x)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_mul_2d(&y, norm, &y)) != MP_OKAY) {
+    goto ERR;
+  }
+
+  /* the top block is what is left over a whole number of n digit ones */
+  n    = y.used;
+  k    = x.used - n;
+  step = k % n;
+  if (step == 0 && k > 0) {
+    step = n;
+  }
+  k -= step;
+  if ((res = mp_copy(&x, &t)) != MP_OKAY) {
+    goto ERR;
+  }
+  mp_rshd(&t, k);
+  if ((res = s_mp_div_bz(&t, &y, &q, &r)) != MP_OKAY) {
+    goto ERR;
+  }
+
+  /* then the next n digits of x under the remainder, and so on */
+  while (k > 0) {
+    k -= n;
+    if ((res = mp_copy(&x, &t)) != MP_OKAY) {
+      goto ERR;
+    }
+    mp_rshd(&t, k);
+    if ((res = mp_mod_2d(&t, DIGIT_BIT * n, &t)) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = mp_lshd(&r, n)) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = mp_add(&r, &t, &t)) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = s_mp_div_bz(&t, &y, &qb, &r)) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = mp_lshd(&q, n)) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = mp_add(&q, &qb, &q)) != MP_OKAY) {
+      goto ERR;
+    }
+  }
+
+  if (c != NULL) {
+    mp_exch(&q, c);
+    c->sign = (mp_iszero(c) == MP_YES) ? MP_ZPOS : neg;
+  }
+  if (d != NULL) {
+    if ((res = mp_div_2d(&r, norm, &r, NULL)) != MP_OKAY) {
+      goto ERR;
+    }
+    mp_exch(&r, d);
+    d->sign = (mp_iszero(d) == MP_YES) ? MP_ZPOS : sign;
+  }
+
+ERR:
+  mp_clear_multi(&y, &qb, NULL);
+LBL_X:
+  mp_clear_multi(&x, &t, NULL);
+LBL_R:
+  mp_clear(&r);
+LBL_Q:
+  mp_clear(&q);
+LBL_MARK:
+  XSCRATCH_RELEASE(mark);
+  return res;
+}
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_dr_is_modulus.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_div_bz.c,v $ */
+/* $Revision: 1.1 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_dr_is_modulus.c
+ --   End: vendor/libtommath-0.41/bn_mp_div_bz.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_dr_reduce.c
+ -- Start: vendor/libtommath-0.41/bn_mp_div_d.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_DR_REDUCE_C
+#ifdef BN_MP_DIV_D_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -2388,92 +3003,125 @@ int mp_dr_is_modulus(mp_int *a)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* reduce "x" in place modulo "n" using the Diminished Radix algorithm.
- *
- * Based on algorithm from the paper
- *
- * "Generating Efficient Primes for Discrete Log Cryptosystems"
- *                 Chae Hoon Lim, Pil Joong Lee,
- *          POSTECH Information Research Laboratories
- *
- * The modulus must be of a special format [see manual]
- *
- * Has been modified to use algorithm 7.10 from the LTM book instead
- *
- * Input x must be in the range 0 <= x <= (n-1)**2
- */
-int
-mp_dr_reduce (mp_int * x, mp_int * n, mp_digit k)
+static int s_is_power_of_two(mp_digit b, int *p)
 {
-  int      err, i, m;
-  mp_word  r;
-  mp_digit mu, *tmpx1, *tmpx2;
+   int x;
 
-  /* m = digits in modulus */
-  m = n->used;
+   /* fast return if no power of two */
+   if ((b==0) || (b & (b-1))) {
+      return 0;
+   }
 
-  /* ensure that "x" has at least 2m digits */
-  if (x->alloc < m + m) {
-    if ((err = mp_grow (x, m + m)) != MP_OKAY) {
-      return err;
-    }
-  }
+   for (x = 0; x < DIGIT_BIT; x++) {
+      if (b == (((mp_digit)1)<<x)) {
+         *p = x;
+         return 1;
+      }
+   }
+   return 0;
+}
 
-/* top of loop, this is where the code resumes if
- * another reduction pass is required.
- */
-top:
-  /* aliases for digits */
-  /* alias for lower half of x */
-  tmpx1 = x->dp;
-
-  /* alias for upper half of x, or x/B**m */
-  tmpx2 = x->dp + m;
+/* single digit division (based on routine from MPI) */
+int mp_div_d (mp_int * a, mp_digit b, mp_int * c, mp_digit * d)
+{
+  mp_int  q;
+  mp_word w;
+  mp_digit t;
+  int     res, ix;
 
-  /* set carry to zero */
-  mu = 0;
+  /* cannot divide by zero */
+  if (b == 0) {
+     return MP_VAL;
+  }
 
-  /* compute (x mod B**m) + k * [x/B**m] inline and inplace */
-  for (i = 0; i < m; i++) {
-      r         = ((mp_word)*tmpx2++) * ((mp_word)k) + *tmpx1 + mu;
-      *tmpx1++  = (mp_digit)(r & MP_MASK);
-      mu        = (mp_digit)(r >> ((mp_word)DIGIT_BIT));
+  /* quick outs */
+  if (b == 1 || mp_iszero(a) == 1) {
+     if (d != NULL) {
+        *d = 0;
+     }
+     if (c != NULL) {
+        return mp_copy(a, c);
+     }
+     return MP_OKAY;
   }
 
-  /* set final carry */
-  *tmpx1++ = mu;
+  /* power of two ? */
+  if (s_is_power_of_two(b, &ix) == 1) {
+     if (d != NULL) {
+        *d = a->dp[0] & ((((mp_digit)1)<<ix) - 1);
+     }
+     if (c != NULL) {
+        return mp_div_2d(a, ix, c, NULL);
+     }
+     return MP_OKAY;
+  }
 
-  /* zero words above m */
-  for (i = m + 1; i < x->used; i++) {
-      *tmpx1++ = 0;
+#ifdef BN_MP_DIV_3_C
+  /* three? */
+  if (b == 3) {
+     return mp_div_3(a, c, d);
   }
+#endif
 
-  /* clamp, sub and return */
-  mp_clamp (x);
+#ifdef BN_MP_DIV_D_INV_C
+  /* a few digits in, the inverse of b pays for working it out */
+  if (a->used > 8) {
+     mp_digit_inv inv;
 
-  /* if x >= n then subtract and reduce again
-   * Each successive "recursion" makes the input smaller and smaller.
-   */
-  if (mp_cmp_mag (x, n) != MP_LT) {
-    s_mp_sub(x, n, x);
-    goto top;
+     if ((res = mp_div_d_setup(b, &inv)) != MP_OKAY) {
+        return res;
+     }
+     return mp_div_d_inv(a, &inv, c, d);
   }
-  return MP_OKAY;
+#endif
+
+  /* no easy answer [c'est la vie].  Just division */
+  if ((res = mp_init_size(&q, a->used)) != MP_OKAY) {
+     return res;
+  }
+  
+  q.used = a->used;
+  q.sign = a->sign;
+  w = 0;
+  for (ix = a->used - 1; ix >= 0; ix--) {
+     w = (w << ((mp_word)DIGIT_BIT)) | ((mp_word)a->dp[ix]);
+     
+     if (w >= b) {
+        t = (mp_digit)(w / b);
+        w -= ((mp_word)t) * ((mp_word)b);
+      } else {
+        t = 0;
+      }
+      q.dp[ix] = (mp_digit)t;
+  }
+  
+  if (d != NULL) {
+     *d = (mp_digit)w;
+  }
+  
+  if (c != NULL) {
+     mp_clamp(&q);
+     mp_exch(&q, c);
+  }
+  mp_clear(&q);
+  
+  return res;
 }
+
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_dr_reduce.c,v $ */
-/* $Revision: 1.4 $ */
-/* $Date: 2006/12/28 01:25:13 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_div_d.c,v $ */
+/* $Revision: 1.5 $ */
+/* $Date: 2007/01/09 04:44:32 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_dr_reduce.c
+ --   End: vendor/libtommath-0.41/bn_mp_div_d.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_dr_setup.c
+ -- Start: vendor/libtommath-0.41/bn_mp_div_d_inv.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_DR_SETUP_C
+#ifdef BN_MP_DIV_D_INV_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -2489,30 +3137,103 @@ top:
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* determines the setup value */
-void mp_dr_setup(mp_int *a, mp_digit *d)
+/* single digit division by a precomputed inverse
+ *
+ * Each digit is the two digit division of Moller and Granlund.  The
+ * remainder so far is kept shifted like the divisor, so with the next
+ * digit it makes u1*R + u0, R = 2**DIGIT_BIT and u1 < norm, and
+ *
+ *   q = ((inv * u1 + u0) div R) + u1 + 1,  r = u0 - q * norm (mod R)
+ *
+ * is the quotient digit after at most two corrections, neither of
+ * which is likely.  That is two multiplications where mp_div_d had a
+ * double digit division.  c may be a, each quotient digit goes where
+ * the digit it came from was read.
+ */
+int mp_div_d_inv(mp_int *a, mp_digit_inv *inv, mp_int *c, mp_digit *d)
 {
-   /* the casts are required if DIGIT_BIT is one less than
-    * the number of bits in a mp_digit [e.g. DIGIT_BIT==31]
-    */
-   *d = (mp_digit)((((mp_word)1) << ((mp_word)DIGIT_BIT)) - 
-        ((mp_word)a->dp[0]));
+  mp_int  q;
+  mp_word p;
+  mp_digit r, u0, q1, x, m, norm, v, *qd;
+  int     res, ix, shift;
+
+  if (inv->norm == 0) {
+     return MP_VAL;
+  }
+
+  qd = NULL;
+  if (c == a) {
+     qd = a->dp;
+  } else if (c != NULL) {
+     if ((res = mp_init_size(&q, a->used)) != MP_OKAY) {
+        return res;
+     }
+     q.used = a->used;
+     q.sign = a->sign;
+     qd     = q.dp;
+  }
+
+  norm  = inv->norm;
+  v     = inv->inv;
+  shift = inv->shift;
+  r     = 0;
+  for (ix = a->used - 1; ix >= 0; ix--) {
+     /* u1 = r plus the top of the shifted digit, u0 the rest of it.  The
+      * shift is split in two as shift can be 0 and DIGIT_BIT the width
+      * of a mp_digit
+      */
+     x  = a->dp[ix];
+     u0 = (x << ((mp_digit)shift)) & MP_MASK;
+     x  = r | ((x >> 1) >> ((mp_digit)(DIGIT_BIT - 1 - shift)));
+
+     p  = ((mp_word)v) * ((mp_word)x) + ((mp_word)u0);
+     q1 = (((mp_digit)(p >> ((mp_word)DIGIT_BIT))) + x + 1) & MP_MASK;
+     r  = (u0 - q1 * norm) & MP_MASK;
+     /* the first correction is taken about as often as not, m is all
+      * ones when it is
+      */
+     m  = ((mp_digit)0) - ((mp_digit)(r > (((mp_digit)p) & MP_MASK)));
+     q1 = (q1 + m) & MP_MASK;
+     r  = (r + (norm & m)) & MP_MASK;
+     if (r >= norm) {
+        ++q1;
+        r -= norm;
+     }
+
+     if (qd != NULL) {
+        qd[ix] = q1;
+     }
+  }
+
+  if (d != NULL) {
+     *d = r >> ((mp_digit)shift);
+  }
+
+  if (c == a) {
+     mp_clamp(a);
+  } else if (c != NULL) {
+     mp_clamp(&q);
+     mp_exch(&q, c);
+     mp_clear(&q);
+  }
+
+  return MP_OKAY;
 }
 
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_dr_setup.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_div_d_inv.c,v $ */
+/* $Revision: 1.1 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_dr_setup.c
+ --   End: vendor/libtommath-0.41/bn_mp_div_d_inv.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_exch.c
+ -- Start: vendor/libtommath-0.41/bn_mp_div_d_setup.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_EXCH_C
+#ifdef BN_MP_DIV_D_SETUP_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -2528,32 +3249,51 @@ void mp_dr_setup(mp_int *a, mp_digit *d)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* swap the elements of two integers, for cases where you can't simply swap the 
- * mp_int pointers around
+/* precomputes the inverse of a single digit divisor (Moller and
+ * Granlund, "Improved division by invariant integers", 2011)
+ *
+ * b is shifted up until bit DIGIT_BIT-1 is set and, for R = 2**DIGIT_BIT,
+ * inv = floor((R**2 - 1)/norm) - R, which turns every later division
+ * by b into two multiplications.
  */
-void
-mp_exch (mp_int * a, mp_int * b)
+int mp_div_d_setup(mp_digit b, mp_digit_inv *inv)
 {
-  mp_int  t;
+  mp_digit norm;
 
-  t  = *a;
-  *a = *b;
-  *b = t;
+  /* cannot divide by zero */
+  if (b == 0) {
+     return MP_VAL;
+  }
+
+  norm = b;
+  inv->shift = 0;
+  while ((norm >> ((mp_digit)(DIGIT_BIT - 1))) == 0) {
+     norm <<= ((mp_digit)1);
+     ++(inv->shift);
+  }
+
+  /* (R**2 - 1 - norm*R) / norm, which is under R */
+  inv->b    = b;
+  inv->norm = norm;
+  inv->inv  = (mp_digit)(((((mp_word)(MP_MASK - norm)) << ((mp_word)DIGIT_BIT)) |
+                          ((mp_word)MP_MASK)) / ((mp_word)norm));
+  return MP_OKAY;
 }
+
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_exch.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_div_d_setup.c,v $ */
+/* $Revision: 1.1 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_exch.c
+ --   End: vendor/libtommath-0.41/bn_mp_div_d_setup.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_expt_d.c
+ -- Start: vendor/libtommath-0.41/bn_mp_divexact.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_EXPT_D_C
+#ifdef BN_MP_DIVEXACT_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -2569,55 +3309,143 @@ mp_exch (mp_int * a, mp_int * b)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* calculate c = a**b  using a square-multiply algorithm */
-int mp_expt_d (mp_int * a, mp_digit b, mp_int * c)
+/* c = a/b when b is known to divide a exactly.
+ *
+ * This is Jebelean's exact division done from the low end (a.k.a.
+ * Hensel division).  After the common powers of two are shifted out b
+ * is odd, so its lowest digit has an inverse modulo 2**DIGIT_BIT.  Each
+ * quotient digit is then simply the current low digit of the dividend
+ * times that inverse, with no trial quotients, no normalization and no
+ * correction steps.  Only the low (a->used - b->used + 1) digits of the
+ * dividend are ever touched since the quotient cannot be any longer.
+ *
+ * If b does not divide a the result is meaningless.
+ */
+int mp_divexact (mp_int * a, mp_int * b, mp_int * c)
 {
-  int     res, x;
-  mp_int  g;
+  mp_int   q, r, d;
+  mp_digit inv, qd, mu, *tmpr, *tmpd;
+  mp_word  w;
+  int      res, k, n, ix, iy, bits, neg;
 
-  if ((res = mp_init_copy (&g, a)) != MP_OKAY) {
+  /* b == 0 is an error */
+  if (mp_iszero (b) == 1) {
+    return MP_VAL;
+  }
+
+  neg = (a->sign == b->sign) ? MP_ZPOS : MP_NEG;
+
+  if (mp_iszero (a) == 1) {
+    mp_zero (c);
+    return MP_OKAY;
+  }
+
+  if ((res = mp_init_copy (&r, a)) != MP_OKAY) {
     return res;
   }
+  if ((res = mp_init_copy (&d, b)) != MP_OKAY) {
+    goto LBL_R;
+  }
+  r.sign = d.sign = MP_ZPOS;
 
-  /* set initial result */
-  mp_set (c, 1);
+  /* shift out the powers of two b has, a has at least as many */
+  k = mp_cnt_lsb (&d);
+  if (k > 0) {
+    if ((res = mp_div_2d (&d, k, &d, NULL)) != MP_OKAY) {
+      goto LBL_D;
+    }
+    if ((res = mp_div_2d (&r, k, &r, NULL)) != MP_OKAY) {
+      goto LBL_D;
+    }
+  }
 
-  for (x = 0; x < (int) DIGIT_BIT; x++) {
-    /* square */
-    if ((res = mp_sqr (c, c)) != MP_OKAY) {
-      mp_clear (&g);
-      return res;
+  /* quotient is zero (or a was not a multiple of b) */
+  if (r.used < d.used) {
+    mp_zero (c);
+    res = MP_OKAY;
+    goto LBL_D;
+  }
+
+  n = r.used - d.used + 1;
+  if ((res = mp_init_size (&q, n)) != MP_OKAY) {
+    goto LBL_D;
+  }
+
+  /* inv = 1/d mod 2**DIGIT_BIT by Newton iteration.  d is odd so
+   * d*d == 1 mod 8 and every step doubles the number of correct bits.
+   */
+  inv = d.dp[0];
+  for (bits = 3; bits < DIGIT_BIT; bits <<= 1) {
+    w   = ((mp_word)d.dp[0]) * ((mp_word)inv);
+    w   = ((mp_word)2) - (w & ((mp_word)MP_MASK));
+    inv = (mp_digit)((((mp_word)inv) * w) & ((mp_word)MP_MASK));
+  }
+
+  for (ix = 0; ix < n; ix++) {
+    /* the next quotient digit clears the low digit of the remainder */
+    qd = (mp_digit)((((mp_word)r.dp[ix]) * ((mp_word)inv)) & ((mp_word)MP_MASK));
+    q.dp[ix] = qd;
+
+    /* r -= qd * d * 2**(ix*DIGIT_BIT), only below digit n, the product
+     * and the borrow are folded into one running value mu
+     */
+    tmpr = r.dp + ix;
+    tmpd = d.dp;
+    mu   = 0;
+    for (iy = 0; (iy < d.used) && (ix + iy < n); iy++) {
+      w  = ((mp_word)qd) * ((mp_word)*tmpd++) + ((mp_word)mu);
+      mu = (mp_digit)(w >> ((mp_word)DIGIT_BIT));
+      w &= ((mp_word)MP_MASK);
+      if (((mp_word)*tmpr) < w) {
+        *tmpr = (mp_digit)((((mp_word)*tmpr) + (((mp_word)1) << ((mp_word)DIGIT_BIT))) - w);
+        ++mu;
+      } else {
+        *tmpr = (mp_digit)(((mp_word)*tmpr) - w);
+      }
+      ++tmpr;
     }
 
-    /* if the bit is set multiply */
-    if ((b & (mp_digit) (((mp_digit)1) << (DIGIT_BIT - 1))) != 0) {
-      if ((res = mp_mul (c, &g, c)) != MP_OKAY) {
-         mp_clear (&g);
-         return res;
+    /* ripple what is left up to digit n */
+    for (iy = ix + iy; (mu != 0) && (iy < n); iy++) {
+      if (*tmpr < mu) {
+        *tmpr = (mp_digit)((*tmpr + (MP_MASK - mu)) + 1);
+        mu    = 1;
+      } else {
+        *tmpr -= mu;
+        mu     = 0;
       }
+      ++tmpr;
     }
+  }
 
-    /* shift to next bit */
-    b <<= 1;
+  q.used = n;
+  q.sign = neg;
+  mp_clamp (&q);
+  if (q.used == 0) {
+    q.sign = MP_ZPOS;
   }
+  mp_exch (&q, c);
+  res = MP_OKAY;
 
-  mp_clear (&g);
-  return MP_OKAY;
+  mp_clear (&q);
+LBL_D:mp_clear (&d);
+LBL_R:mp_clear (&r);
+  return res;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_expt_d.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_divexact.c,v $ */
+/* $Revision: 1.1 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_expt_d.c
+ --   End: vendor/libtommath-0.41/bn_mp_divexact.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_exptmod.c
+ -- Start: vendor/libtommath-0.41/bn_mp_dr_is_modulus.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_EXPTMOD_C
+#ifdef BN_MP_DR_IS_MODULUS_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -2633,110 +3461,41 @@ int mp_expt_d (mp_int * a, mp_digit b, mp_int * c)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-
-/* this is a shell function that calls either the normal or Montgomery
- * exptmod functions.  Originally the call to the montgomery code was
- * embedded in the normal function but that wasted alot of stack space
- * for nothing (since 99% of the time the Montgomery code would be called)
- */
-int mp_exptmod (mp_int * G, mp_int * X, mp_int * P, mp_int * Y)
+/* determines if a number is a valid DR modulus */
+int mp_dr_is_modulus(mp_int *a)
 {
-  int dr;
-
-  /* modulus P must be positive */
-  if (P->sign == MP_NEG) {
-     return MP_VAL;
-  }
+   int ix;
 
-  /* if exponent X is negative we have to recurse */
-  if (X->sign == MP_NEG) {
-#ifdef BN_MP_INVMOD_C
-     mp_int tmpG, tmpX;
-     int err;
-
-     /* first compute 1/G mod P */
-     if ((err = mp_init(&tmpG)) != MP_OKAY) {
-        return err;
-     }
-     if ((err = mp_invmod(G, P, &tmpG)) != MP_OKAY) {
-        mp_clear(&tmpG);
-        return err;
-     }
-
-     /* now get |X| */
-     if ((err = mp_init(&tmpX)) != MP_OKAY) {
-        mp_clear(&tmpG);
-        return err;
-     }
-     if ((err = mp_abs(X, &tmpX)) != MP_OKAY) {
-        mp_clear_multi(&tmpG, &tmpX, NULL);
-        return err;
-     }
-
-     /* and now compute (1/G)**|X| instead of G**X [X < 0] */
-     err = mp_exptmod(&tmpG, &tmpX, P, Y);
-     mp_clear_multi(&tmpG, &tmpX, NULL);
-     return err;
-#else 
-     /* no invmod */
-     return MP_VAL;
-#endif
-  }
-
-/* modified diminished radix reduction */
-#if defined(BN_MP_REDUCE_IS_2K_L_C) && defined(BN_MP_REDUCE_2K_L_C) && defined(BN_S_MP_EXPTMOD_C)
-  if (mp_reduce_is_2k_l(P) == MP_YES) {
-     return s_mp_exptmod(G, X, P, Y, 1);
-  }
-#endif
-
-#ifdef BN_MP_DR_IS_MODULUS_C
-  /* is it a DR modulus? */
-  dr = mp_dr_is_modulus(P);
-#else
-  /* default to no */
-  dr = 0;
-#endif
+   /* must be at least two digits */
+   if (a->used < 2) {
+      return 0;
+   }
 
-#ifdef BN_MP_REDUCE_IS_2K_C
-  /* if not, is it a unrestricted DR modulus? */
-  if (dr == 0) {
-     dr = mp_reduce_is_2k(P) << 1;
-  }
-#endif
-    
-  /* if the modulus is odd or dr != 0 use the montgomery method */
-#ifdef BN_MP_EXPTMOD_FAST_C
-  if (mp_isodd (P) == 1 || dr !=  0) {
-    return mp_exptmod_fast (G, X, P, Y, dr);
-  } else {
-#endif
-#ifdef BN_S_MP_EXPTMOD_C
-    /* otherwise use the generic Barrett reduction technique */
-    return s_mp_exptmod (G, X, P, Y, 0);
-#else
-    /* no exptmod for evens */
-    return MP_VAL;
-#endif
-#ifdef BN_MP_EXPTMOD_FAST_C
-  }
-#endif
+   /* must be of the form b**k - a [a <= b] so all
+    * but the first digit must be equal to -1 (mod b).
+    */
+   for (ix = 1; ix < a->used; ix++) {
+       if (a->dp[ix] != MP_MASK) {
+          return 0;
+       }
+   }
+   return 1;
 }
 
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_exptmod.c,v $ */
-/* $Revision: 1.5 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_dr_is_modulus.c,v $ */
+/* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_exptmod.c
+ --   End: vendor/libtommath-0.41/bn_mp_dr_is_modulus.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_exptmod_fast.c
+ -- Start: vendor/libtommath-0.41/bn_mp_dr_reduce.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_EXPTMOD_FAST_C
+#ifdef BN_MP_DR_REDUCE_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -2752,319 +3511,92 @@ int mp_exptmod (mp_int * G, mp_int * X, mp_int * P, mp_int * Y)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* computes Y == G**X mod P, HAC pp.616, Algorithm 14.85
+/* reduce "x" in place modulo "n" using the Diminished Radix algorithm.
  *
- * Uses a left-to-right k-ary sliding window to compute the modular exponentiation.
- * The value of k changes based on the size of the exponent.
+ * Based on algorithm from the paper
  *
- * Uses Montgomery or Diminished Radix reduction [whichever appropriate]
+ * "Generating Efficient Primes for Discrete Log Cryptosystems"
+ *                 Chae Hoon Lim, Pil Joong Lee,
+ *          POSTECH Information Research Laboratories
+ *
+ * The modulus must be of a special format [see manual]
+ *
+ * Has been modified to use algorithm 7.10 from the LTM book instead
+ *
+ * Input x must be in the range 0 <= x <= (n-1)**2
  */
-
-#ifdef MP_LOW_MEM
-   #define TAB_SIZE 32
-#else
-   #define TAB_SIZE 256
-#endif
-
-int mp_exptmod_fast (mp_int * G, mp_int * X, mp_int * P, mp_int * Y, int redmode)
+int
+mp_dr_reduce (mp_int * x, mp_int * n, mp_digit k)
 {
-  mp_int  M[TAB_SIZE], res;
-  mp_digit buf, mp;
-  int     err, bitbuf, bitcpy, bitcnt, mode, digidx, x, y, winsize;
-
-  /* use a pointer to the reduction algorithm.  This allows us to use
-   * one of many reduction algorithms without modding the guts of
-   * the code with if statements everywhere.
-   */
-  int     (*redux)(mp_int*,mp_int*,mp_digit);
-
-  /* find window size */
-  x = mp_count_bits (X);
-  if (x <= 7) {
-    winsize = 2;
-  } else if (x <= 36) {
-    winsize = 3;
-  } else if (x <= 140) {
-    winsize = 4;
-  } else if (x <= 450) {
-    winsize = 5;
-  } else if (x <= 1303) {
-    winsize = 6;
-  } else if (x <= 3529) {
-    winsize = 7;
-  } else {
-    winsize = 8;
-  }
-
-#ifdef MP_LOW_MEM
-  if (winsize > 5) {
-     winsize = 5;
-  }
-#endif
+  int      err, i, m;
+  mp_word  r;
+  mp_digit mu, *tmpx1, *tmpx2;
 
-  /* init M array */
-  /* init first cell */
-  if ((err = mp_init(&M[1])) != MP_OKAY) {
-     return err;
-  }
+  /* m = digits in modulus */
+  m = n->used;
 
-  /* now init the second half of the array */
-  for (x = 1<<(winsize-1); x < (1 << winsize); x++) {
-    if ((err = mp_init(&M[x])) != MP_OKAY) {
-      for (y = 1<<(winsize-1); y < x; y++) {
-        mp_clear (&M[y]);
-      }
-      mp_clear(&M[1]);
+  /* ensure that "x" has at least 2m digits */
+  if (x->alloc < m + m) {
+    if ((err = mp_grow (x, m + m)) != MP_OKAY) {
       return err;
     }
   }
 
-  /* determine and setup reduction code */
-  if (redmode == 0) {
-#ifdef BN_MP_MONTGOMERY_SETUP_C     
-     /* now setup montgomery  */
-     if ((err = mp_montgomery_setup (P, &mp)) != MP_OKAY) {
-        goto LBL_M;
-     }
-#else
-     err = MP_VAL;
-     goto LBL_M;
-#endif
+/* top of loop, this is where the code resumes if
+ * another reduction pass is required.
+ */
+top:
+  /* aliases for digits */
+  /* alias for lower half of x */
+  tmpx1 = x->dp;
 
-     /* automatically pick the comba one if available (saves quite a few calls/ifs) */
-#ifdef BN_FAST_MP_MONTGOMERY_REDUCE_C
-     if (((P->used * 2 + 1) < MP_WARRAY) &&
-          P->used < (1 << ((CHAR_BIT * sizeof (mp_word)) - (2 * DIGIT_BIT)))) {
-        redux = fast_mp_montgomery_reduce;
-     } else 
-#endif
-     {
-#ifdef BN_MP_MONTGOMERY_REDUCE_C
-        /* use slower baseline Montgomery method */
-        redux = mp_montgomery_reduce;
-#else
-        err = MP_VAL;
-        goto LBL_M;
-#endif
-     }
-  } else if (redmode == 1) {
-#if defined(BN_MP_DR_SETUP_C) && defined(BN_MP_DR_REDUCE_C)
-     /* setup DR reduction for moduli of the form B**k - b */
-     mp_dr_setup(P, &mp);
-     redux = mp_dr_reduce;
-#else
-     err = MP_VAL;
-     goto LBL_M;
-#endif
-  } else {
-#if defined(BN_MP_REDUCE_2K_SETUP_C) && defined(BN_MP_REDUCE_2K_C)
-     /* setup DR reduction for moduli of the form 2**k - b */
-     if ((err = mp_reduce_2k_setup(P, &mp)) != MP_OKAY) {
-        goto LBL_M;
-     }
-     redux = mp_reduce_2k;
-#else
-     err = MP_VAL;
-     goto LBL_M;
-#endif
+  /* alias for upper half of x, or x/B**m */
+  tmpx2 = x->dp + m;
+
+  /* set carry to zero */
+  mu = 0;
+
+  /* compute (x mod B**m) + k * [x/B**m] inline and inplace */
+  for (i = 0; i < m; i++) {
+      r         = ((mp_word)*tmpx2++) * ((mp_word)k) + *tmpx1 + mu;
+      *tmpx1++  = (mp_digit)(r & MP_MASK);
+      mu        = (mp_digit)(r >> ((mp_word)DIGIT_BIT));
   }
 
-  /* setup result */
-  if ((err = mp_init (&res)) != MP_OKAY) {
-    goto LBL_M;
+  /* set final carry */
+  *tmpx1++ = mu;
+
+  /* zero words above m */
+  for (i = m + 1; i < x->used; i++) {
+      *tmpx1++ = 0;
   }
 
-  /* create M table
-   *
+  /* clamp, sub and return */
+  mp_clamp (x);
 
-   *
-   * The first half of the table is not computed though accept for M[0] and M[1]
+  /* if x >= n then subtract and reduce again
+   * Each successive "recursion" makes the input smaller and smaller.
    */
-
-  if (redmode == 0) {
-#ifdef BN_MP_MONTGOMERY_CALC_NORMALIZATION_C
-     /* now we need R mod m */
-     if ((err = mp_montgomery_calc_normalization (&res, P)) != MP_OKAY) {
-       goto LBL_RES;
-     }
-#else 
-     err = MP_VAL;
-     goto LBL_RES;
-#endif
-
-     /* now set M[1] to G * R mod m */
-     if ((err = mp_mulmod (G, &res, P, &M[1])) != MP_OKAY) {
-       goto LBL_RES;
-     }
-  } else {
-     mp_set(&res, 1);
-     if ((err = mp_mod(G, P, &M[1])) != MP_OKAY) {
-        goto LBL_RES;
-     }
-  }
-
-  /* compute the value at M[1<<(winsize-1)] by squaring M[1] (winsize-1) times */
-  if ((err = mp_copy (&M[1], &M[1 << (winsize - 1)])) != MP_OKAY) {
-    goto LBL_RES;
-  }
-
-  for (x = 0; x < (winsize - 1); x++) {
-    if ((err = mp_sqr (&M[1 << (winsize - 1)], &M[1 << (winsize - 1)])) != MP_OKAY) {
-      goto LBL_RES;
-    }
-    if ((err = redux (&M[1 << (winsize - 1)], P, mp)) != MP_OKAY) {
-      goto LBL_RES;
-    }
-  }
-
-  /* create upper table */
-  for (x = (1 << (winsize - 1)) + 1; x < (1 << winsize); x++) {
-    if ((err = mp_mul (&M[x - 1], &M[1], &M[x])) != MP_OKAY) {
-      goto LBL_RES;
-    }
-    if ((err = redux (&M[x], P, mp)) != MP_OKAY) {
-      goto LBL_RES;
-    }
-  }
-
-  /* set initial mode and bit cnt */
-  mode   = 0;
-  bitcnt = 1;
-  buf    = 0;
-  digidx = X->used - 1;
-  bitcpy = 0;
-  bitbuf = 0;
-
-  for (;;) {
-    /* grab next digit as required */
-    if (--bitcnt == 0) {
-      /* if digidx == -1 we are out of digits so break */
-      if (digidx == -1) {
-        break;
-      }
-      /* read next digit and reset bitcnt */
-      buf    = X->dp[digidx--];
-      bitcnt = (int)DIGIT_BIT;
-    }
-
-    /* grab the next msb from the exponent */
-    y     = (mp_digit)(buf >> (DIGIT_BIT - 1)) & 1;
-    buf <<= (mp_digit)1;
-
-    /* if the bit is zero and mode == 0 then we ignore it
-     * These represent the leading zero bits before the first 1 bit
-     * in the exponent.  Technically this opt is not required but it
-     * does lower the # of trivial squaring/reductions used
-     */
-    if (mode == 0 && y == 0) {
-      continue;
-    }
-
-    /* if the bit is zero and mode == 1 then we square */
-    if (mode == 1 && y == 0) {
-      if ((err = mp_sqr (&res, &res)) != MP_OKAY) {
-        goto LBL_RES;
-      }
-      if ((err = redux (&res, P, mp)) != MP_OKAY) {
-        goto LBL_RES;
-      }
-      continue;
-    }
-
-    /* else we add it to the window */
-    bitbuf |= (y << (winsize - ++bitcpy));
-    mode    = 2;
-
-    if (bitcpy == winsize) {
-      /* ok window is filled so square as required and multiply  */
-      /* square first */
-      for (x = 0; x < winsize; x++) {
-        if ((err = mp_sqr (&res, &res)) != MP_OKAY) {
-          goto LBL_RES;
-        }
-        if ((err = redux (&res, P, mp)) != MP_OKAY) {
-          goto LBL_RES;
-        }
-      }
-
-      /* then multiply */
-      if ((err = mp_mul (&res, &M[bitbuf], &res)) != MP_OKAY) {
-        goto LBL_RES;
-      }
-      if ((err = redux (&res, P, mp)) != MP_OKAY) {
-        goto LBL_RES;
-      }
-
-      /* empty window and reset */
-      bitcpy = 0;
-      bitbuf = 0;
-      mode   = 1;
-    }
-  }
-
-  /* if bits remain then square/multiply */
-  if (mode == 2 && bitcpy > 0) {
-    /* square then multiply if the bit is set */
-    for (x = 0; x < bitcpy; x++) {
-      if ((err = mp_sqr (&res, &res)) != MP_OKAY) {
-        goto LBL_RES;
-      }
-      if ((err = redux (&res, P, mp)) != MP_OKAY) {
-        goto LBL_RES;
-      }
-
-      /* get next bit of the window */
-      bitbuf <<= 1;
-      if ((bitbuf & (1 << winsize)) != 0) {
-        /* then multiply */
-        if ((err = mp_mul (&res, &M[1], &res)) != MP_OKAY) {
-          goto LBL_RES;
-        }
-        if ((err = redux (&res, P, mp)) != MP_OKAY) {
-          goto LBL_RES;
-        }
-      }
-    }
-  }
-
-  if (redmode == 0) {
-     /* fixup result if Montgomery reduction is used
-      * recall that any value in a Montgomery system is
-      * actually multiplied by R mod n.  So we have
-      * to reduce one more time to cancel out the factor
-      * of R.
-      */
-     if ((err = redux(&res, P, mp)) != MP_OKAY) {
-       goto LBL_RES;
-     }
-  }
-
-  /* swap res with Y */
-  mp_exch (&res, Y);
-  err = MP_OKAY;
-LBL_RES:mp_clear (&res);
-LBL_M:
-  mp_clear(&M[1]);
-  for (x = 1<<(winsize-1); x < (1 << winsize); x++) {
-    mp_clear (&M[x]);
+  if (mp_cmp_mag (x, n) != MP_LT) {
+    s_mp_sub(x, n, x);
+    goto top;
   }
-  return err;
+  return MP_OKAY;
 }
 #endif
 
-
-/* $Source: /cvs/libtom/libtommath/bn_mp_exptmod_fast.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_dr_reduce.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_exptmod_fast.c
+ --   End: vendor/libtommath-0.41/bn_mp_dr_reduce.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_exteuclid.c
+ -- Start: vendor/libtommath-0.41/bn_mp_dr_setup.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_EXTEUCLID_C
+#ifdef BN_MP_DR_SETUP_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -3080,80 +3612,30 @@ LBL_M:
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* Extended euclidean algorithm of (a, b) produces 
-   a*u1 + b*u2 = u3
- */
-int mp_exteuclid(mp_int *a, mp_int *b, mp_int *U1, mp_int *U2, mp_int *U3)
+/* determines the setup value */
+void mp_dr_setup(mp_int *a, mp_digit *d)
 {
-   mp_int u1,u2,u3,v1,v2,v3,t1,t2,t3,q,tmp;
-   int err;
-
-   if ((err = mp_init_multi(&u1, &u2, &u3, &v1, &v2, &v3, &t1, &t2, &t3, &q, &tmp, NULL)) != MP_OKAY) {
-      return err;
-   }
-
-   /* initialize, (u1,u2,u3) = (1,0,a) */
-   mp_set(&u1, 1);
-   if ((err = mp_copy(a, &u3)) != MP_OKAY)                                        { goto _ERR; }
-
-   /* initialize, (v1,v2,v3) = (0,1,b) */
-   mp_set(&v2, 1);
-   if ((err = mp_copy(b, &v3)) != MP_OKAY)                                        { goto _ERR; }
-
-   /* loop while v3 != 0 */
-   while (mp_iszero(&v3) == MP_NO) {
-       /* q = u3/v3 */
-       if ((err = mp_div(&u3, &v3, &q, NULL)) != MP_OKAY)                         { goto _ERR; }
-
-       /* (t1,t2,t3) = (u1,u2,u3) - (v1,v2,v3)q */
-       if ((err = mp_mul(&v1, &q, &tmp)) != MP_OKAY)                              { goto _ERR; }
-       if ((err = mp_sub(&u1, &tmp, &t1)) != MP_OKAY)                             { goto _ERR; }
-       if ((err = mp_mul(&v2, &q, &tmp)) != MP_OKAY)                              { goto _ERR; }
-       if ((err = mp_sub(&u2, &tmp, &t2)) != MP_OKAY)                             { goto _ERR; }
-       if ((err = mp_mul(&v3, &q, &tmp)) != MP_OKAY)                              { goto _ERR; }
-       if ((err = mp_sub(&u3, &tmp, &t3)) != MP_OKAY)                             { goto _ERR; }
-
-       /* (u1,u2,u3) = (v1,v2,v3) */
-       if ((err = mp_copy(&v1, &u1)) != MP_OKAY)                                  { goto _ERR; }
-       if ((err = mp_copy(&v2, &u2)) != MP_OKAY)                                  { goto _ERR; }
-       if ((err = mp_copy(&v3, &u3)) != MP_OKAY)                                  { goto _ERR; }
-
-       /* (v1,v2,v3) = (t1,t2,t3) */
-       if ((err = mp_copy(&t1, &v1)) != MP_OKAY)                                  { goto _ERR; }
-       if ((err = mp_copy(&t2, &v2)) != MP_OKAY)                                  { goto _ERR; }
-       if ((err = mp_copy(&t3, &v3)) != MP_OKAY)                                  { goto _ERR; }
-   }
-
-   /* make sure U3 >= 0 */
-   if (u3.sign == MP_NEG) {
-      mp_neg(&u1, &u1);
-      mp_neg(&u2, &u2);
-      mp_neg(&u3, &u3);
-   }
-
-   /* copy result out */
-   if (U1 != NULL) { mp_exch(U1, &u1); }
-   if (U2 != NULL) { mp_exch(U2, &u2); }
-   if (U3 != NULL) { mp_exch(U3, &u3); }
-
-   err = MP_OKAY;
-_ERR: mp_clear_multi(&u1, &u2, &u3, &v1, &v2, &v3, &t1, &t2, &t3, &q, &tmp, NULL);
-   return err;
+   /* the casts are required if DIGIT_BIT is one less than
+    * the number of bits in a mp_digit [e.g. DIGIT_BIT==31]
+    */
+   *d = (mp_digit)((((mp_word)1) << ((mp_word)DIGIT_BIT)) - 
+        ((mp_word)a->dp[0]));
 }
+
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_exteuclid.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_dr_setup.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_exteuclid.c
+ --   End: vendor/libtommath-0.41/bn_mp_dr_setup.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_fread.c
+ -- Start: vendor/libtommath-0.41/bn_mp_exch.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_FREAD_C
+#ifdef BN_MP_EXCH_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -3169,65 +3651,32 @@ _ERR: mp_clear_multi(&u1, &u2, &u3, &v1, &v2, &v3, &t1, &t2, &t3, &q, &tmp, NULL
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* read a bigint from a file stream in ASCII */
-int mp_fread(mp_int *a, int radix, FILE *stream)
-{
-   int err, ch, neg, y;
-   
-   /* clear a */
-   mp_zero(a);
-   
-   /* if first digit is - then set negative */
-   ch = fgetc(stream);
-   if (ch == '-') {
-      neg = MP_NEG;
-      ch = fgetc(stream);
-   } else {
-      neg = MP_ZPOS;
-   }
-   
-   for (;;) {
-      /* find y in the radix map */
-      for (y = 0; y < radix; y++) {
-          if (mp_s_rmap[y] == ch) {
-             break;
-          }
-      }
-      if (y == radix) {
-         break;
-      }
-      
-      /* shift up and add */
-      if ((err = mp_mul_d(a, radix, a)) != MP_OKAY) {
-         return err;
-      }
-      if ((err = mp_add_d(a, y, a)) != MP_OKAY) {
-         return err;
-      }
-      
-      ch = fgetc(stream);
-   }
-   if (mp_cmp_d(a, 0) != MP_EQ) {
-      a->sign = neg;
-   }
-   
-   return MP_OKAY;
-}
+/* swap the elements of two integers, for cases where you can't simply swap the 
+ * mp_int pointers around
+ */
+void
+mp_exch (mp_int * a, mp_int * b)
+{
+  mp_int  t;
 
+  t  = *a;
+  *a = *b;
+  *b = t;
+}
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_fread.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_exch.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_fread.c
+ --   End: vendor/libtommath-0.41/bn_mp_exch.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_fwrite.c
+ -- Start: vendor/libtommath-0.41/bn_mp_export.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_FWRITE_C
+#ifdef BN_MP_EXPORT_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -3243,50 +3692,83 @@ int mp_fread(mp_int *a, int radix, FILE *stream)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-int mp_fwrite(mp_int *a, int radix, FILE *stream)
+/* writes |op| out as words of size bytes [after GMP's mpz_export]
+ *
+ * The words go most significant first if order is 1 and least
+ * significant first if it is -1, and the bytes in each word are big
+ * endian for an endian of 1, little endian for -1 and however the
+ * machine has them for 0.  The top nails bits of every word are left
+ * zero.  *countp, if not NULL, gets the number of words written, which
+ * is none for a zero op.  The digits of op run through a mp_word bit
+ * buffer and leave it a byte at a time, in a single pass over both.
+ */
+int mp_export(void *rop, size_t *countp, int order, size_t size, int endian,
+              size_t nails, mp_int *op)
 {
-   char *buf;
-   int err, len, x;
-   
-   if ((err = mp_radix_size(a, radix, &len)) != MP_OKAY) {
-      return err;
-   }
+  unsigned char *out, *word;
+  mp_word  acc;
+  size_t   count, wbits, left, ix, iy;
+  int      have, n, iz;
 
-   buf = OPT_CAST(char) XMALLOC (len);
-   if (buf == NULL) {
-      return MP_MEM;
-   }
-   
-   if ((err = mp_toradix(a, buf, radix)) != MP_OKAY) {
-      XFREE (buf);
-      return err;
-   }
-   
-   for (x = 0; x < len; x++) {
-       if (fputc(buf[x], stream) == EOF) {
-          XFREE (buf);
-          return MP_VAL;
-       }
-   }
-   
-   XFREE (buf);
-   return MP_OKAY;
+  if (size == 0 || nails >= 8 * size || (order != 1 && order != -1) ||
+      endian < -1 || endian > 1) {
+    return MP_VAL;
+  }
+  if (endian == 0) {
+    /* see which end of a word the machine puts first */
+    union {
+      unsigned long l;
+      unsigned char c[sizeof(unsigned long)];
+    } u;
+    u.l    = 1;
+    endian = (u.c[0] == 1) ? -1 : 1;
+  }
+
+  wbits = 8 * size - nails;
+  count = ((size_t)mp_count_bits(op) + wbits - 1) / wbits;
+  out   = (unsigned char *)rop;
+
+  acc  = 0;
+  have = 0;
+  iz   = 0;
+  for (ix = 0; ix < count; ix++) {
+    /* the ix-th word from the bottom and its bytes from the bottom */
+    word = out + ((order == -1) ? ix : (count - 1 - ix)) * size;
+    left = wbits;
+    for (iy = 0; iy < size; iy++) {
+      n = (left < 8) ? (int)left : 8;
+      while (have < n && iz < op->used) {
+        acc  |= ((mp_word)op->dp[iz++]) << ((mp_word)have);
+        have += DIGIT_BIT;
+      }
+      word[(endian == -1) ? iy : (size - 1 - iy)] =
+         (unsigned char)(((mp_digit)acc) & ((((mp_digit)1) << n) - 1));
+      acc  >>= ((mp_word)n);
+      have  = (have > n) ? (have - n) : 0;
+      left -= (size_t)n;
+    }
+  }
+
+  if (countp != NULL) {
+    *countp = count;
+  }
+  return MP_OKAY;
 }
 
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_fwrite.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_export.c,v $ */
+/* $Revision: 1.1 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_fwrite.c
+ --   End: vendor/libtommath-0.41/bn_mp_export.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_gcd.c
+ -- Start: vendor/libtommath-0.41/bn_mp_expt_d.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_GCD_C
+#ifdef BN_MP_EXPT_D_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -3302,103 +3784,55 @@ int mp_fwrite(mp_int *a, int radix, FILE *stream)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* Greatest Common Divisor using the binary method */
-int mp_gcd (mp_int * a, mp_int * b, mp_int * c)
+/* calculate c = a**b  using a square-multiply algorithm */
+int mp_expt_d (mp_int * a, mp_digit b, mp_int * c)
 {
-  mp_int  u, v;
-  int     k, u_lsb, v_lsb, res;
-
-  /* either zero than gcd is the largest */
-  if (mp_iszero (a) == MP_YES) {
-    return mp_abs (b, c);
-  }
-  if (mp_iszero (b) == MP_YES) {
-    return mp_abs (a, c);
-  }
+  int     res, x;
+  mp_int  g;
 
-  /* get copies of a and b we can modify */
-  if ((res = mp_init_copy (&u, a)) != MP_OKAY) {
+  if ((res = mp_init_copy (&g, a)) != MP_OKAY) {
     return res;
   }
 
-  if ((res = mp_init_copy (&v, b)) != MP_OKAY) {
-    goto LBL_U;
-  }
-
-  /* must be positive for the remainder of the algorithm */
-  u.sign = v.sign = MP_ZPOS;
-
-  /* B1.  Find the common power of two for u and v */
-  u_lsb = mp_cnt_lsb(&u);
-  v_lsb = mp_cnt_lsb(&v);
-  k     = MIN(u_lsb, v_lsb);
-
-  if (k > 0) {
-     /* divide the power of two out */
-     if ((res = mp_div_2d(&u, k, &u, NULL)) != MP_OKAY) {
-        goto LBL_V;
-     }
+  /* set initial result */
+  mp_set (c, 1);
 
-     if ((res = mp_div_2d(&v, k, &v, NULL)) != MP_OKAY) {
-        goto LBL_V;
-     }
-  }
+  for (x = 0; x < (int) DIGIT_BIT; x++) {
+    /* square */
+    if ((res = mp_sqr (c, c)) != MP_OKAY) {
+      mp_clear (&g);
+      return res;
+    }
 
-  /* divide any remaining factors of two out */
-  if (u_lsb != k) {
-     if ((res = mp_div_2d(&u, u_lsb - k, &u, NULL)) != MP_OKAY) {
-        goto LBL_V;
-     }
-  }
+    /* if the bit is set multiply */
+    if ((b & (mp_digit) (((mp_digit)1) << (DIGIT_BIT - 1))) != 0) {
+      if ((res = mp_mul (c, &g, c)) != MP_OKAY) {
+         mp_clear (&g);
+         return res;
+      }
+    }
 
-  if (v_lsb != k) {
-     if ((res = mp_div_2d(&v, v_lsb - k, &v, NULL)) != MP_OKAY) {
-        goto LBL_V;
-     }
+    /* shift to next bit */
+    b <<= 1;
   }
 
-  while (mp_iszero(&v) == 0) {
-     /* make sure v is the largest */
-     if (mp_cmp_mag(&u, &v) == MP_GT) {
-        /* swap u and v to make sure v is >= u */
-        mp_exch(&u, &v);
-     }
-     
-     /* subtract smallest from largest */
-     if ((res = s_mp_sub(&v, &u, &v)) != MP_OKAY) {
-        goto LBL_V;
-     }
-     
-     /* Divide out all factors of two */
-     if ((res = mp_div_2d(&v, mp_cnt_lsb(&v), &v, NULL)) != MP_OKAY) {
-        goto LBL_V;
-     } 
-  } 
-
-  /* multiply by 2**k which we divided out at the beginning */
-  if ((res = mp_mul_2d (&u, k, c)) != MP_OKAY) {
-     goto LBL_V;
-  }
-  c->sign = MP_ZPOS;
-  res = MP_OKAY;
-LBL_V:mp_clear (&u);
-LBL_U:mp_clear (&v);
-  return res;
+  mp_clear (&g);
+  return MP_OKAY;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_gcd.c,v $ */
-/* $Revision: 1.5 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_expt_d.c,v $ */
+/* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_gcd.c
+ --   End: vendor/libtommath-0.41/bn_mp_expt_d.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_get_int.c
+ -- Start: vendor/libtommath-0.41/bn_mp_exptmod.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_GET_INT_C
+#ifdef BN_MP_EXPTMOD_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -3414,107 +3848,119 @@ LBL_U:mp_clear (&v);
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* get the lower 32-bits of an mp_int */
-unsigned long mp_get_int(mp_int * a) 
+
+/* this is a shell function that calls either the normal or Montgomery
+ * exptmod functions.  Originally the call to the montgomery code was
+ * embedded in the normal function but that wasted alot of stack space
+ * for nothing (since 99% of the time the Montgomery code would be called)
+ */
+int mp_exptmod (mp_int * G, mp_int * X, mp_int * P, mp_int * Y)
 {
-  int i;
-  unsigned long res;
+  int dr;
 
-  if (a->used == 0) {
-     return 0;
+  /* modulus P must be positive */
+  if (P->sign == MP_NEG) {
+     return MP_VAL;
   }
 
-  /* get number of digits of the lsb we have to read */
-  i = MIN(a->used,(int)((sizeof(unsigned long)*CHAR_BIT+DIGIT_BIT-1)/DIGIT_BIT))-1;
+  /* if exponent X is negative we have to recurse */
+  if (X->sign == MP_NEG) {
+#ifdef BN_MP_INVMOD_C
+     mp_int tmpG, tmpX;
+     int err;
 
-  /* get most significant digit of result */
-  res = DIGIT(a,i);
-   
-  while (--i >= 0) {
-    res = (res << DIGIT_BIT) | DIGIT(a,i);
-  }
+     /* first compute 1/G mod P */
+     if ((err = mp_init(&tmpG)) != MP_OKAY) {
+        return err;
+     }
+     if ((err = mp_invmod(G, P, &tmpG)) != MP_OKAY) {
+        mp_clear(&tmpG);
+        return err;
+     }
 
-  /* force result to 32-bits always so it is consistent on non 32-bit platforms */
-  return res & 0xFFFFFFFFUL;
-}
-#endif
+     /* now get |X| */
+     if ((err = mp_init(&tmpX)) != MP_OKAY) {
+        mp_clear(&tmpG);
+        return err;
+     }
+     if ((err = mp_abs(X, &tmpX)) != MP_OKAY) {
+        mp_clear_multi(&tmpG, &tmpX, NULL);
+        return err;
+     }
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_get_int.c,v $ */
-/* $Revision: 1.4 $ */
-/* $Date: 2006/12/28 01:25:13 $ */
-/*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_get_int.c
- ---------------------------------------------------------------------*/
-
-/*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_grow.c
- ---------------------------------------------------------------------*/
-#include <tommath.h>
-#ifdef BN_MP_GROW_C
-/* LibTomMath, multiple-precision integer library -- Tom St Denis
- *
- * LibTomMath is a library that provides multiple-precision
- * integer arithmetic as well as number theoretic functionality.
- *
- * The library was designed directly after the MPI library by
- * Michael Fromberger but has been written from scratch with
- * additional optimizations in place.
- *
- * The library is free for all purposes without any express
- * guarantee it works.
- *
- * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
- */
-
-/* grow as required */
-int mp_grow (mp_int * a, int size)
-{
-  int     i;
-  mp_digit *tmp;
+     /* and now compute (1/G)**|X| instead of G**X [X < 0] */
+     err = mp_exptmod(&tmpG, &tmpX, P, Y);
+     mp_clear_multi(&tmpG, &tmpX, NULL);
+     return err;
+#else 
+     /* no invmod */
+     return MP_VAL;
+#endif
+  }
 
-  /* if the alloc size is smaller alloc more ram */
-  if (a->alloc < size) {
-    /* ensure there are always at least MP_PREC digits extra on top */
-    size += (MP_PREC * 2) - (size % MP_PREC);
+/* modified diminished radix reduction */
+#if defined(BN_MP_REDUCE_IS_2K_L_C) && defined(BN_MP_REDUCE_2K_L_C) && defined(BN_S_MP_EXPTMOD_C)
+  if (mp_reduce_is_2k_l(P) == MP_YES) {
+     return s_mp_exptmod(G, X, P, Y, 1);
+  }
+#endif
 
-    /* reallocate the array a->dp
-     *
-     * We store the return in a temporary variable
-     * in case the operation failed we don't want
-     * to overwrite the dp member of a.
-     */
-    tmp = OPT_CAST(mp_digit) XREALLOC (a->dp, sizeof (mp_digit) * size);
-    if (tmp == NULL) {
-      /* reallocation failed but "a" is still valid [can be freed] */
-      return MP_MEM;
-    }
+#ifdef BN_MP_DR_IS_MODULUS_C
+  /* is it a DR modulus? */
+  dr = mp_dr_is_modulus(P);
+#else
+  /* default to no */
+  dr = 0;
+#endif
 
-    /* reallocation succeeded so set a->dp */
-    a->dp = tmp;
+#ifdef BN_MP_REDUCE_IS_2K_C
+  /* if not, is it a unrestricted DR modulus? */
+  if (dr == 0) {
+     dr = mp_reduce_is_2k(P) << 1;
+  }
+#endif
+    
+#if defined(BN_MP_MONTGOMERY_REDUCE_L_C) && defined(BN_S_MP_EXPTMOD_C)
+  /* odd and big enough for Karatsuba?  reduce with short products, they
+   * leave the digit at a time Montgomery behind from about there
+   */
+  if (mp_isodd (P) == 1 && dr == 0 && P->used >= KARATSUBA_MUL_CUTOFF) {
+     return s_mp_exptmod (G, X, P, Y, 2);
+  }
+#endif
 
-    /* zero excess digits */
-    i        = a->alloc;
-    a->alloc = size;
-    for (; i < a->alloc; i++) {
-      a->dp[i] = 0;
-    }
+  /* if the modulus is odd or dr != 0 use the montgomery method */
+#ifdef BN_MP_EXPTMOD_FAST_C
+  if (mp_isodd (P) == 1 || dr !=  0) {
+    return mp_exptmod_fast (G, X, P, Y, dr);
+  } else {
+#endif
+#ifdef BN_S_MP_EXPTMOD_C
+    /* otherwise use the generic Barrett reduction technique */
+    return s_mp_exptmod (G, X, P, Y, 0);
+#else
+    /* no exptmod for evens */
+    return MP_VAL;
+#endif
+#ifdef BN_MP_EXPTMOD_FAST_C
   }
-  return MP_OKAY;
+#endif
 }
+
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_grow.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_exptmod.c,v $ */
+/* $Revision: 1.5 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_grow.c
+ --   End: vendor/libtommath-0.41/bn_mp_exptmod.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_init.c
+ -- Start: vendor/libtommath-0.41/bn_mp_exptmod_fast.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_INIT_C
+#ifdef BN_MP_EXPTMOD_FAST_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -3530,149 +3976,2992 @@ int mp_grow (mp_int * a, int size)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* init a new mp_int */
-int mp_init (mp_int * a)
+/* computes Y == G**X mod P, HAC pp.616, Algorithm 14.85
+ *
+ * Uses a left-to-right k-ary sliding window to compute the modular exponentiation.
+ * The value of k changes based on the size of the exponent.
+ *
+ * Uses Montgomery or Diminished Radix reduction [whichever appropriate]
+ */
+
+#ifdef MP_LOW_MEM
+   #define TAB_SIZE 32
+#else
+   #define TAB_SIZE 256
+#endif
+
+int mp_exptmod_fast (mp_int * G, mp_int * X, mp_int * P, mp_int * Y, int redmode)
 {
-  int i;
+  mp_int  M[TAB_SIZE], res;
+  mp_digit buf, mp;
+  int     err, bitbuf, bitcpy, bitcnt, mode, digidx, x, y, winsize;
+  size_t  mark;
 
-  /* allocate memory required and clear it */
-  a->dp = OPT_CAST(mp_digit) XMALLOC (sizeof (mp_digit) * MP_PREC);
-  if (a->dp == NULL) {
-    return MP_MEM;
-  }
+  /* use a pointer to the reduction algorithm.  This allows us to use
+   * one of many reduction algorithms without modding the guts of
+   * the code with if statements everywhere.
+   */
+  int     (*redux)(mp_int*,mp_int*,mp_digit);
 
-  /* set the digits to zero */
-  for (i = 0; i < MP_PREC; i++) {
-      a->dp[i] = 0;
+  /* find window size */
+  x = mp_count_bits (X);
+  if (x <= 7) {
+    winsize = 2;
+  } else if (x <= 36) {
+    winsize = 3;
+  } else if (x <= 140) {
+    winsize = 4;
+  } else if (x <= 450) {
+    winsize = 5;
+  } else if (x <= 1303) {
+    winsize = 6;
+  } else if (x <= 3529) {
+    winsize = 7;
+  } else {
+    winsize = 8;
   }
 
-  /* set the used to zero, allocated digits to the default precision
-   * and sign to positive */
-  a->used  = 0;
-  a->alloc = MP_PREC;
-  a->sign  = MP_ZPOS;
-
-  return MP_OKAY;
-}
+#ifdef MP_LOW_MEM
+  if (winsize > 5) {
+     winsize = 5;
+  }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_init.c,v $ */
-/* $Revision: 1.4 $ */
-/* $Date: 2006/12/28 01:25:13 $ */
-/*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_init.c
- ---------------------------------------------------------------------*/
-
-/*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_init_copy.c
- ---------------------------------------------------------------------*/
-#include <tommath.h>
-#ifdef BN_MP_INIT_COPY_C
-/* LibTomMath, multiple-precision integer library -- Tom St Denis
- *
- * LibTomMath is a library that provides multiple-precision
- * integer arithmetic as well as number theoretic functionality.
- *
- * The library was designed directly after the MPI library by
- * Michael Fromberger but has been written from scratch with
- * additional optimizations in place.
- *
- * The library is free for all purposes without any express
- * guarantee it works.
- *
- * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
- */
+  /* the M array lives in scratch memory, reserved together with what
+   * the multiplications below will want, each cell holds a product
+   */
+  mark = XSCRATCH_MARK();
+  XSCRATCH_RESERVE(sizeof(mp_digit) * ((1 << (winsize - 1)) + 21) * (P->used * 2 + 3 * MP_PREC));
 
-/* creates "a" then copies b into it */
-int mp_init_copy (mp_int * a, mp_int * b)
-{
-  int     res;
+  /* init M array */
+  /* init first cell */
+  if ((err = mp_init_scratch(&M[1], P->used * 2 + 1)) != MP_OKAY) {
+     XSCRATCH_RELEASE(mark);
+     return err;
+  }
 
-  if ((res = mp_init (a)) != MP_OKAY) {
-    return res;
+  /* now init the second half of the array */
+  for (x = 1<<(winsize-1); x < (1 << winsize); x++) {
+    if ((err = mp_init_scratch(&M[x], P->used * 2 + 1)) != MP_OKAY) {
+      for (y = 1<<(winsize-1); y < x; y++) {
+        mp_clear (&M[y]);
+      }
+      mp_clear(&M[1]);
+      XSCRATCH_RELEASE(mark);
+      return err;
+    }
   }
-  return mp_copy (b, a);
-}
-#endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_init_copy.c,v $ */
-/* $Revision: 1.4 $ */
-/* $Date: 2006/12/28 01:25:13 $ */
-/*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_init_copy.c
- ---------------------------------------------------------------------*/
+  /* determine and setup reduction code */
+  if (redmode == 0) {
+#ifdef BN_MP_MONTGOMERY_SETUP_C     
+     /* now setup montgomery  */
+     if ((err = mp_montgomery_setup (P, &mp)) != MP_OKAY) {
+        goto LBL_M;
+     }
+#else
+     err = MP_VAL;
+     goto LBL_M;
+#endif
 
-/*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_init_multi.c
- ---------------------------------------------------------------------*/
-#include <tommath.h>
-#ifdef BN_MP_INIT_MULTI_C
-/* LibTomMath, multiple-precision integer library -- Tom St Denis
- *
- * LibTomMath is a library that provides multiple-precision
- * integer arithmetic as well as number theoretic functionality.
- *
- * The library was designed directly after the MPI library by
- * Michael Fromberger but has been written from scratch with
- * additional optimizations in place.
- *
- * The library is free for all purposes without any express
+     /* automatically pick the comba one if available (saves quite a few calls/ifs) */
+#ifdef BN_FAST_MP_MONTGOMERY_REDUCE_C
+     if (((P->used * 2 + 1) < MP_WARRAY) &&
+          P->used < MP_COMBA_MAX) {
+        redux = fast_mp_montgomery_reduce;
+     } else 
+#endif
+     {
+#ifdef BN_MP_MONTGOMERY_REDUCE_C
+        /* use slower baseline Montgomery method */
+        redux = mp_montgomery_reduce;
+#else
+        err = MP_VAL;
+        goto LBL_M;
+#endif
+     }
+  } else if (redmode == 1) {
+#if defined(BN_MP_DR_SETUP_C) && defined(BN_MP_DR_REDUCE_C)
+     /* setup DR reduction for moduli of the form B**k - b */
+     mp_dr_setup(P, &mp);
+     redux = mp_dr_reduce;
+#else
+     err = MP_VAL;
+     goto LBL_M;
+#endif
+  } else {
+#if defined(BN_MP_REDUCE_2K_SETUP_C) && defined(BN_MP_REDUCE_2K_C)
+     /* setup DR reduction for moduli of the form 2**k - b */
+     if ((err = mp_reduce_2k_setup(P, &mp)) != MP_OKAY) {
+        goto LBL_M;
+     }
+     redux = mp_reduce_2k;
+#else
+     err = MP_VAL;
+     goto LBL_M;
+#endif
+  }
+
+  /* setup result */
+  if ((err = mp_init (&res)) != MP_OKAY) {
+    goto LBL_M;
+  }
+
+  /* create M table
+   *
+
+   *
+   * The first half of the table is not computed though accept for M[0] and M[1]
+   */
+
+  if (redmode == 0) {
+#ifdef BN_MP_MONTGOMERY_CALC_NORMALIZATION_C
+     /* now we need R mod m */
+     if ((err = mp_montgomery_calc_normalization (&res, P)) != MP_OKAY) {
+       goto LBL_RES;
+     }
+#else 
+     err = MP_VAL;
+     goto LBL_RES;
+#endif
+
+     /* now set M[1] to G * R mod m */
+     if ((err = mp_mulmod (G, &res, P, &M[1])) != MP_OKAY) {
+       goto LBL_RES;
+     }
+  } else {
+     mp_set(&res, 1);
+     if ((err = mp_mod(G, P, &M[1])) != MP_OKAY) {
+        goto LBL_RES;
+     }
+  }
+
+  /* compute the value at M[1<<(winsize-1)] by squaring M[1] (winsize-1) times */
+  if ((err = mp_copy (&M[1], &M[1 << (winsize - 1)])) != MP_OKAY) {
+    goto LBL_RES;
+  }
+
+  for (x = 0; x < (winsize - 1); x++) {
+    if ((err = mp_sqr (&M[1 << (winsize - 1)], &M[1 << (winsize - 1)])) != MP_OKAY) {
+      goto LBL_RES;
+    }
+    if ((err = redux (&M[1 << (winsize - 1)], P, mp)) != MP_OKAY) {
+      goto LBL_RES;
+    }
+  }
+
+  /* create upper table */
+  for (x = (1 << (winsize - 1)) + 1; x < (1 << winsize); x++) {
+    if ((err = mp_mul (&M[x - 1], &M[1], &M[x])) != MP_OKAY) {
+      goto LBL_RES;
+    }
+    if ((err = redux (&M[x], P, mp)) != MP_OKAY) {
+      goto LBL_RES;
+    }
+  }
+
+  /* set initial mode and bit cnt */
+  mode   = 0;
+  bitcnt = 1;
+  buf    = 0;
+  digidx = X->used - 1;
+  bitcpy = 0;
+  bitbuf = 0;
+
+  for (;;) {
+    /* grab next digit as required */
+    if (--bitcnt == 0) {
+      /* if digidx == -1 we are out of digits so break */
+      if (digidx == -1) {
+        break;
+      }
+      /* read next digit and reset bitcnt */
+      buf    = X->dp[digidx--];
+      bitcnt = (int)DIGIT_BIT;
+    }
+
+    /* grab the next msb from the exponent */
+    y     = (mp_digit)(buf >> (DIGIT_BIT - 1)) & 1;
+    buf <<= (mp_digit)1;
+
+    /* if the bit is zero and mode == 0 then we ignore it
+     * These represent the leading zero bits before the first 1 bit
+     * in the exponent.  Technically this opt is not required but it
+     * does lower the # of trivial squaring/reductions used
+     */
+    if (mode == 0 && y == 0) {
+      continue;
+    }
+
+    /* if the bit is zero and mode == 1 then we square */
+    if (mode == 1 && y == 0) {
+      if ((err = mp_sqr (&res, &res)) != MP_OKAY) {
+        goto LBL_RES;
+      }
+      if ((err = redux (&res, P, mp)) != MP_OKAY) {
+        goto LBL_RES;
+      }
+      continue;
+    }
+
+    /* else we add it to the window */
+    bitbuf |= (y << (winsize - ++bitcpy));
+    mode    = 2;
+
+    if (bitcpy == winsize) {
+      /* ok window is filled so square as required and multiply  */
+      /* square first */
+      for (x = 0; x < winsize; x++) {
+        if ((err = mp_sqr (&res, &res)) != MP_OKAY) {
+          goto LBL_RES;
+        }
+        if ((err = redux (&res, P, mp)) != MP_OKAY) {
+          goto LBL_RES;
+        }
+      }
+
+      /* then multiply */
+      if ((err = mp_mul (&res, &M[bitbuf], &res)) != MP_OKAY) {
+        goto LBL_RES;
+      }
+      if ((err = redux (&res, P, mp)) != MP_OKAY) {
+        goto LBL_RES;
+      }
+
+      /* empty window and reset */
+      bitcpy = 0;
+      bitbuf = 0;
+      mode   = 1;
+    }
+  }
+
+  /* if bits remain then square/multiply */
+  if (mode == 2 && bitcpy > 0) {
+    /* square then multiply if the bit is set */
+    for (x = 0; x < bitcpy; x++) {
+      if ((err = mp_sqr (&res, &res)) != MP_OKAY) {
+        goto LBL_RES;
+      }
+      if ((err = redux (&res, P, mp)) != MP_OKAY) {
+        goto LBL_RES;
+      }
+
+      /* get next bit of the window */
+      bitbuf <<= 1;
+      if ((bitbuf & (1 << winsize)) != 0) {
+        /* then multiply */
+        if ((err = mp_mul (&res, &M[1], &res)) != MP_OKAY) {
+          goto LBL_RES;
+        }
+        if ((err = redux (&res, P, mp)) != MP_OKAY) {
+          goto LBL_RES;
+        }
+      }
+    }
+  }
+
+  if (redmode == 0) {
+     /* fixup result if Montgomery reduction is used
+      * recall that any value in a Montgomery system is
+      * actually multiplied by R mod n.  So we have
+      * to reduce one more time to cancel out the factor
+      * of R.
+      */
+     if ((err = redux(&res, P, mp)) != MP_OKAY) {
+       goto LBL_RES;
+     }
+  }
+
+  /* swap res with Y */
+  mp_exch (&res, Y);
+  err = MP_OKAY;
+LBL_RES:mp_clear (&res);
+LBL_M:
+  mp_clear(&M[1]);
+  for (x = 1<<(winsize-1); x < (1 << winsize); x++) {
+    mp_clear (&M[x]);
+  }
+  XSCRATCH_RELEASE(mark);
+  return err;
+}
+#endif
+
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_exptmod_fast.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_exptmod_fast.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_exteuclid.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_EXTEUCLID_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* Extended euclidean algorithm of (a, b) produces 
+   a*u1 + b*u2 = u3
+ */
+int mp_exteuclid(mp_int *a, mp_int *b, mp_int *U1, mp_int *U2, mp_int *U3)
+{
+   mp_int u1,u2,u3,v1,v2,v3,t1,t2,t3,q,tmp;
+   int err;
+
+   if ((err = mp_init_multi(&u1, &u2, &u3, &v1, &v2, &v3, &t1, &t2, &t3, &q, &tmp, NULL)) != MP_OKAY) {
+      return err;
+   }
+
+   /* initialize, (u1,u2,u3) = (1,0,a) */
+   mp_set(&u1, 1);
+   if ((err = mp_copy(a, &u3)) != MP_OKAY)                                        { goto _ERR; }
+
+   /* initialize, (v1,v2,v3) = (0,1,b) */
+   mp_set(&v2, 1);
+   if ((err = mp_copy(b, &v3)) != MP_OKAY)                                        { goto _ERR; }
+
+   /* loop while v3 != 0 */
+   while (mp_iszero(&v3) == MP_NO) {
+       /* q = u3/v3 */
+       if ((err = mp_div(&u3, &v3, &q, NULL)) != MP_OKAY)                         { goto _ERR; }
+
+       /* (t1,t2,t3) = (u1,u2,u3) - (v1,v2,v3)q */
+       if ((err = mp_mul(&v1, &q, &tmp)) != MP_OKAY)                              { goto _ERR; }
+       if ((err = mp_sub(&u1, &tmp, &t1)) != MP_OKAY)                             { goto _ERR; }
+       if ((err = mp_mul(&v2, &q, &tmp)) != MP_OKAY)                              { goto _ERR; }
+       if ((err = mp_sub(&u2, &tmp, &t2)) != MP_OKAY)                             { goto _ERR; }
+       if ((err = mp_mul(&v3, &q, &tmp)) != MP_OKAY)                              { goto _ERR; }
+       if ((err = mp_sub(&u3, &tmp, &t3)) != MP_OKAY)                             { goto _ERR; }
+
+       /* (u1,u2,u3) = (v1,v2,v3) */
+       if ((err = mp_copy(&v1, &u1)) != MP_OKAY)                                  { goto _ERR; }
+       if ((err = mp_copy(&v2, &u2)) != MP_OKAY)                                  { goto _ERR; }
+       if ((err = mp_copy(&v3, &u3)) != MP_OKAY)                                  { goto _ERR; }
+
+       /* (v1,v2,v3) = (t1,t2,t3) */
+       if ((err = mp_copy(&t1, &v1)) != MP_OKAY)                                  { goto _ERR; }
+       if ((err = mp_copy(&t2, &v2)) != MP_OKAY)                                  { goto _ERR; }
+       if ((err = mp_copy(&t3, &v3)) != MP_OKAY)                                  { goto _ERR; }
+   }
+
+   /* make sure U3 >= 0 */
+   if (u3.sign == MP_NEG) {
+      mp_neg(&u1, &u1);
+      mp_neg(&u2, &u2);
+      mp_neg(&u3, &u3);
+   }
+
+   /* copy result out */
+   if (U1 != NULL) { mp_exch(U1, &u1); }
+   if (U2 != NULL) { mp_exch(U2, &u2); }
+   if (U3 != NULL) { mp_exch(U3, &u3); }
+
+   err = MP_OKAY;
+_ERR: mp_clear_multi(&u1, &u2, &u3, &v1, &v2, &v3, &t1, &t2, &t3, &q, &tmp, NULL);
+   return err;
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_exteuclid.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_exteuclid.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_fread.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_FREAD_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* read a bigint from a file stream in ASCII */
+int mp_fread(mp_int *a, int radix, FILE *stream)
+{
+   int err, ch, neg, y;
+   
+   /* clear a */
+   mp_zero(a);
+   
+   /* if first digit is - then set negative */
+   ch = fgetc(stream);
+   if (ch == '-') {
+      neg = MP_NEG;
+      ch = fgetc(stream);
+   } else {
+      neg = MP_ZPOS;
+   }
+   
+   for (;;) {
+      /* find y in the radix map */
+      for (y = 0; y < radix; y++) {
+          if (mp_s_rmap[y] == ch) {
+             break;
+          }
+      }
+      if (y == radix) {
+         break;
+      }
+      
+      /* shift up and add */
+      if ((err = mp_mul_d(a, radix, a)) != MP_OKAY) {
+         return err;
+      }
+      if ((err = mp_add_d(a, y, a)) != MP_OKAY) {
+         return err;
+      }
+      
+      ch = fgetc(stream);
+   }
+   if (mp_cmp_d(a, 0) != MP_EQ) {
+      a->sign = neg;
+   }
+   
+   return MP_OKAY;
+}
+
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_fread.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_fread.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_fwrite.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_FWRITE_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+int mp_fwrite(mp_int *a, int radix, FILE *stream)
+{
+   char *buf;
+   int err, len, x;
+   
+   if ((err = mp_radix_size(a, radix, &len)) != MP_OKAY) {
+      return err;
+   }
+
+   buf = OPT_CAST(char) XMALLOC (len);
+   if (buf == NULL) {
+      return MP_MEM;
+   }
+   
+   if ((err = mp_toradix(a, buf, radix)) != MP_OKAY) {
+      XFREE (buf);
+      return err;
+   }
+   
+   for (x = 0; x < len; x++) {
+       if (fputc(buf[x], stream) == EOF) {
+          XFREE (buf);
+          return MP_VAL;
+       }
+   }
+   
+   XFREE (buf);
+   return MP_OKAY;
+}
+
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_fwrite.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_fwrite.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_gcd.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_GCD_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* Greatest Common Divisor using the binary method */
+int mp_gcd (mp_int * a, mp_int * b, mp_int * c)
+{
+  mp_int  u, v;
+  int     k, u_lsb, v_lsb, res;
+
+  /* either zero than gcd is the largest */
+  if (mp_iszero (a) == MP_YES) {
+    return mp_abs (b, c);
+  }
+  if (mp_iszero (b) == MP_YES) {
+    return mp_abs (a, c);
+  }
+
+  /* get copies of a and b we can modify */
+  if ((res = mp_init_copy (&u, a)) != MP_OKAY) {
+    return res;
+  }
+
+  if ((res = mp_init_copy (&v, b)) != MP_OKAY) {
+    goto LBL_U;
+  }
+
+  /* must be positive for the remainder of the algorithm */
+  u.sign = v.sign = MP_ZPOS;
+
+  /* B1.  Find the common power of two for u and v */
+  u_lsb = mp_cnt_lsb(&u);
+  v_lsb = mp_cnt_lsb(&v);
+  k     = MIN(u_lsb, v_lsb);
+
+  if (k > 0) {
+     /* divide the power of two out */
+     if ((res = mp_div_2d(&u, k, &u, NULL)) != MP_OKAY) {
+        goto LBL_V;
+     }
+
+     if ((res = mp_div_2d(&v, k, &v, NULL)) != MP_OKAY) {
+        goto LBL_V;
+     }
+  }
+
+  /* divide any remaining factors of two out */
+  if (u_lsb != k) {
+     if ((res = mp_div_2d(&u, u_lsb - k, &u, NULL)) != MP_OKAY) {
+        goto LBL_V;
+     }
+  }
+
+  if (v_lsb != k) {
+     if ((res = mp_div_2d(&v, v_lsb - k, &v, NULL)) != MP_OKAY) {
+        goto LBL_V;
+     }
+  }
+
+  while (mp_iszero(&v) == 0) {
+     /* make sure v is the largest */
+     if (mp_cmp_mag(&u, &v) == MP_GT) {
+        /* swap u and v to make sure v is >= u */
+        mp_exch(&u, &v);
+     }
+     
+     /* subtract smallest from largest */
+     if ((res = s_mp_sub(&v, &u, &v)) != MP_OKAY) {
+        goto LBL_V;
+     }
+     
+     /* Divide out all factors of two */
+     if ((res = mp_div_2d(&v, mp_cnt_lsb(&v), &v, NULL)) != MP_OKAY) {
+        goto LBL_V;
+     } 
+  } 
+
+  /* multiply by 2**k which we divided out at the beginning */
+  if ((res = mp_mul_2d (&u, k, c)) != MP_OKAY) {
+     goto LBL_V;
+  }
+  c->sign = MP_ZPOS;
+  res = MP_OKAY;
+LBL_V:mp_clear (&u);
+LBL_U:mp_clear (&v);
+  return res;
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_gcd.c,v $ */
+/* $Revision: 1.5 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_gcd.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_get_int.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_GET_INT_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* get the lower 32-bits of an mp_int */
+unsigned long mp_get_int(mp_int * a) 
+{
+  int i;
+  unsigned long res;
+
+  if (a->used == 0) {
+     return 0;
+  }
+
+  /* get number of digits of the lsb we have to read */
+  i = MIN(a->used,(int)((sizeof(unsigned long)*CHAR_BIT+DIGIT_BIT-1)/DIGIT_BIT))-1;
+
+  /* get most significant digit of result */
+  res = DIGIT(a,i);
+   
+  while (--i >= 0) {
+    /* DIGIT_BIT can be the width of a long, the loop is not run then */
+    res = ((res << 1) << (DIGIT_BIT - 1)) | DIGIT(a,i);
+  }
+
+  /* force result to 32-bits always so it is consistent on non 32-bit platforms */
+  return res & 0xFFFFFFFFUL;
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_get_int.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_get_int.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_grow.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_GROW_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* grow as required */
+int mp_grow (mp_int * a, int size)
+{
+  int     i;
+  mp_digit *tmp;
+
+  /* if the alloc size is smaller alloc more ram */
+  if (a->alloc < size) {
+    /* ensure there are always at least MP_PREC digits extra on top */
+    size += (MP_PREC * 2) - (size % MP_PREC);
+
+    /* reallocate the array a->dp
+     *
+     * We store the return in a temporary variable
+     * in case the operation failed we don't want
+     * to overwrite the dp member of a.
+     */
+    tmp = OPT_CAST(mp_digit) XREALLOC (a->dp, sizeof (mp_digit) * size);
+    if (tmp == NULL) {
+      /* reallocation failed but "a" is still valid [can be freed] */
+      return MP_MEM;
+    }
+
+    /* reallocation succeeded so set a->dp */
+    a->dp = tmp;
+
+    /* zero excess digits */
+    i        = a->alloc;
+    a->alloc = size;
+    for (; i < a->alloc; i++) {
+      a->dp[i] = 0;
+    }
+  }
+  return MP_OKAY;
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_grow.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_grow.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_import.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_IMPORT_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* reads rop from count words of size bytes, laid out as for mp_export */
+int mp_import(mp_int *rop, size_t count, int order, size_t size, int endian,
+              size_t nails, const void *op)
+{
+  const unsigned char *in, *word;
+  mp_word  acc;
+  size_t   wbits, left, ix, iy;
+  int      res, have, n, iz;
+
+  if (size == 0 || nails >= 8 * size || (order != 1 && order != -1) ||
+      endian < -1 || endian > 1) {
+    return MP_VAL;
+  }
+  if (endian == 0) {
+    /* see which end of a word the machine puts first */
+    union {
+      unsigned long l;
+      unsigned char c[sizeof(unsigned long)];
+    } u;
+    u.l    = 1;
+    endian = (u.c[0] == 1) ? -1 : 1;
+  }
+
+  wbits = 8 * size - nails;
+  mp_zero(rop);
+  if ((res = mp_grow(rop, (int)((count * wbits) / DIGIT_BIT) + 1)) != MP_OKAY) {
+    return res;
+  }
+  in = (const unsigned char *)op;
+
+  /* the bytes go into acc from the bottom of the lowest word on */
+  acc  = 0;
+  have = 0;
+  iz   = 0;
+  for (ix = 0; ix < count; ix++) {
+    word = in + ((order == -1) ? ix : (count - 1 - ix)) * size;
+    left = wbits;
+    for (iy = 0; iy < size; iy++) {
+      n = (left < 8) ? (int)left : 8;
+      acc  |= ((mp_word)(word[(endian == -1) ? iy : (size - 1 - iy)] &
+                         ((1u << n) - 1u))) << ((mp_word)have);
+      have += n;
+      left -= (size_t)n;
+      if (have >= DIGIT_BIT) {
+        rop->dp[iz++] = ((mp_digit)acc) & MP_MASK;
+        acc         >>= ((mp_word)DIGIT_BIT);
+        have         -= DIGIT_BIT;
+      }
+    }
+  }
+  if (have > 0) {
+    rop->dp[iz++] = (mp_digit)acc;
+  }
+
+  rop->used = iz;
+  mp_clamp(rop);
+  return MP_OKAY;
+}
+
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_import.c,v $ */
+/* $Revision: 1.1 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_import.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_init.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_INIT_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* init a new mp_int */
+int mp_init (mp_int * a)
+{
+  int i;
+
+  /* allocate memory required and clear it */
+  a->dp = OPT_CAST(mp_digit) XMALLOC (sizeof (mp_digit) * MP_PREC);
+  if (a->dp == NULL) {
+    return MP_MEM;
+  }
+
+  /* set the digits to zero */
+  for (i = 0; i < MP_PREC; i++) {
+      a->dp[i] = 0;
+  }
+
+  /* set the used to zero, allocated digits to the default precision
+   * and sign to positive */
+  a->used  = 0;
+  a->alloc = MP_PREC;
+  a->sign  = MP_ZPOS;
+
+  return MP_OKAY;
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_init.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_init.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_init_copy.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_INIT_COPY_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* creates "a" then copies b into it */
+int mp_init_copy (mp_int * a, mp_int * b)
+{
+  int     res;
+
+  if ((res = mp_init (a)) != MP_OKAY) {
+    return res;
+  }
+  return mp_copy (b, a);
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_init_copy.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_init_copy.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_init_multi.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_INIT_MULTI_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+#include <stdarg.h>
+
+int mp_init_multi(mp_int *mp, ...) 
+{
+    mp_err res = MP_OKAY;      /* Assume ok until proven otherwise */
+    int n = 0;                 /* Number of ok inits */
+    mp_int* cur_arg = mp;
+    va_list args;
+
+    va_start(args, mp);        /* init args to next argument from caller */
+    while (cur_arg != NULL) {
+        if (mp_init(cur_arg) != MP_OKAY) {
+            /* Oops - error! Back-track and mp_clear what we already
+               succeeded in init-ing, then return error.
+            */
+            va_list clean_args;
+            
+            /* end the current list */
+            va_end(args);
+            
+            /* now start cleaning up */            
+            cur_arg = mp;
+            va_start(clean_args, mp);
+            while (n--) {
+                mp_clear(cur_arg);
+                cur_arg = va_arg(clean_args, mp_int*);
+            }
+            va_end(clean_args);
+            res = MP_MEM;
+            break;
+        }
+        n++;
+        cur_arg = va_arg(args, mp_int*);
+    }
+    va_end(args);
+    return res;                /* Assumed ok, if error flagged above. */
+}
+
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_init_multi.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_init_multi.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_init_scratch.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_INIT_SCRATCH_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* init an mp_int for a given size from scratch memory.  Only for the
+ * temporaries of a routine that brackets itself with XSCRATCH_MARK and
+ * XSCRATCH_RELEASE, they are cleared as usual but must never be swapped
+ * into a result.
+ */
+int mp_init_scratch (mp_int * a, int size)
+{
+  int x;
+
+  /* pad size so there are always extra digits */
+  size += (MP_PREC * 2) - (size % MP_PREC);
+
+  /* alloc mem */
+  a->dp = OPT_CAST(mp_digit) XSCRATCH_ALLOC (sizeof (mp_digit) * size);
+  if (a->dp == NULL) {
+    return MP_MEM;
+  }
+
+  /* set the members */
+  a->used  = 0;
+  a->alloc = size;
+  a->sign  = MP_ZPOS;
+
+  /* zero the digits */
+  for (x = 0; x < size; x++) {
+      a->dp[x] = 0;
+  }
+
+  return MP_OKAY;
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_init_scratch.c,v $ */
+/* $Revision: 1.1 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_init_scratch.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_init_scratch_multi.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_INIT_SCRATCH_MULTI_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+#include <stdarg.h>
+
+/* mp_init_scratch for every mp_int of a NULL terminated list */
+int mp_init_scratch_multi(int size, mp_int *mp, ...) 
+{
+    mp_err res = MP_OKAY;      /* Assume ok until proven otherwise */
+    int n = 0;                 /* Number of ok inits */
+    mp_int* cur_arg = mp;
+    va_list args;
+
+    va_start(args, mp);        /* init args to next argument from caller */
+    while (cur_arg != NULL) {
+        if (mp_init_scratch(cur_arg, size) != MP_OKAY) {
+            /* back-track and clear what was already init-ed */
+            va_list clean_args;
+            
+            va_end(args);
+            
+            cur_arg = mp;
+            va_start(clean_args, mp);
+            while (n--) {
+                mp_clear(cur_arg);
+                cur_arg = va_arg(clean_args, mp_int*);
+            }
+            va_end(clean_args);
+            res = MP_MEM;
+            break;
+        }
+        n++;
+        cur_arg = va_arg(args, mp_int*);
+    }
+    va_end(args);
+    return res;                /* Assumed ok, if error flagged above. */
+}
+
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_init_scratch_multi.c,v $ */
+/* $Revision: 1.1 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_init_scratch_multi.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_init_set.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_INIT_SET_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* initialize and set a digit */
+int mp_init_set (mp_int * a, mp_digit b)
+{
+  int err;
+  if ((err = mp_init(a)) != MP_OKAY) {
+     return err;
+  }
+  mp_set(a, b);
+  return err;
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_init_set.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_init_set.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_init_set_int.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_INIT_SET_INT_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* initialize and set a digit */
+int mp_init_set_int (mp_int * a, unsigned long b)
+{
+  int err;
+  if ((err = mp_init(a)) != MP_OKAY) {
+     return err;
+  }
+  return mp_set_int(a, b);
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_init_set_int.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_init_set_int.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_init_size.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_INIT_SIZE_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* init an mp_init for a given size */
+int mp_init_size (mp_int * a, int size)
+{
+  int x;
+
+  /* pad size so there are always extra digits */
+  size += (MP_PREC * 2) - (size % MP_PREC);	
+  
+  /* alloc mem */
+  a->dp = OPT_CAST(mp_digit) XMALLOC (sizeof (mp_digit) * size);
+  if (a->dp == NULL) {
+    return MP_MEM;
+  }
+
+  /* set the members */
+  a->used  = 0;
+  a->alloc = size;
+  a->sign  = MP_ZPOS;
+
+  /* zero the digits */
+  for (x = 0; x < size; x++) {
+      a->dp[x] = 0;
+  }
+
+  return MP_OKAY;
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_init_size.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_init_size.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_invmod.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_INVMOD_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* hac 14.61, pp608 */
+int mp_invmod (mp_int * a, mp_int * b, mp_int * c)
+{
+  /* b cannot be negative */
+  if (b->sign == MP_NEG || mp_iszero(b) == 1) {
+    return MP_VAL;
+  }
+
+#ifdef BN_FAST_MP_INVMOD_C
+  /* if the modulus is odd we can use a faster routine instead */
+  if (mp_isodd (b) == 1) {
+    return fast_mp_invmod (a, b, c);
+  }
+#endif
+
+#ifdef BN_MP_INVMOD_SLOW_C
+  return mp_invmod_slow(a, b, c);
+#endif
+
+  return MP_VAL;
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_invmod.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_invmod.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_invmod_slow.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_INVMOD_SLOW_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* hac 14.61, pp608 */
+int mp_invmod_slow (mp_int * a, mp_int * b, mp_int * c)
+{
+  mp_int  x, y, u, v, A, B, C, D;
+  int     res;
+  size_t  mark;
+
+  /* b cannot be negative */
+  if (b->sign == MP_NEG || mp_iszero(b) == 1) {
+    return MP_VAL;
+  }
+
+  /* init temps, C becomes the result and the rest are scratch */
+  mark = XSCRATCH_MARK();
+  XSCRATCH_RESERVE(sizeof(mp_digit) * 7 * (b->used + 4 * MP_PREC));
+  if ((res = mp_init_scratch_multi(b->used + 2, &x, &y, &u, &v, 
+                                   &A, &B, &D, NULL)) != MP_OKAY) {
+     XSCRATCH_RELEASE(mark);
+     return res;
+  }
+  if ((res = mp_init(&C)) != MP_OKAY) {
+     mp_clear_multi(&x, &y, &u, &v, &A, &B, &D, NULL);
+     XSCRATCH_RELEASE(mark);
+     return res;
+  }
+
+  /* x = a, y = b */
+  if ((res = mp_mod(a, b, &x)) != MP_OKAY) {
+      goto LBL_ERR;
+  }
+  if ((res = mp_copy (b, &y)) != MP_OKAY) {
+    goto LBL_ERR;
+  }
+
+  /* 2. [modified] if x,y are both even then return an error! */
+  if (mp_iseven (&x) == 1 && mp_iseven (&y) == 1) {
+    res = MP_VAL;
+    goto LBL_ERR;
+  }
+
+  /* 3. u=x, v=y, A=1, B=0, C=0,D=1 */
+  if ((res = mp_copy (&x, &u)) != MP_OKAY) {
+    goto LBL_ERR;
+  }
+  if ((res = mp_copy (&y, &v)) != MP_OKAY) {
+    goto LBL_ERR;
+  }
+  mp_set (&A, 1);
+  mp_set (&D, 1);
+
+top:
+  /* 4.  while u is even do */
+  while (mp_iseven (&u) == 1) {
+    /* 4.1 u = u/2 */
+    if ((res = mp_div_2 (&u, &u)) != MP_OKAY) {
+      goto LBL_ERR;
+    }
+    /* 4.2 if A or B is odd then */
+    if (mp_isodd (&A) == 1 || mp_isodd (&B) == 1) {
+      /* A = (A+y)/2, B = (B-x)/2 */
+      if ((res = mp_add (&A, &y, &A)) != MP_OKAY) {
+         goto LBL_ERR;
+      }
+      if ((res = mp_sub (&B, &x, &B)) != MP_OKAY) {
+         goto LBL_ERR;
+      }
+    }
+    /* A = A/2, B = B/2 */
+    if ((res = mp_div_2 (&A, &A)) != MP_OKAY) {
+      goto LBL_ERR;
+    }
+    if ((res = mp_div_2 (&B, &B)) != MP_OKAY) {
+      goto LBL_ERR;
+    }
+  }
+
+  /* 5.  while v is even do */
+  while (mp_iseven (&v) == 1) {
+    /* 5.1 v = v/2 */
+    if ((res = mp_div_2 (&v, &v)) != MP_OKAY) {
+      goto LBL_ERR;
+    }
+    /* 5.2 if C or D is odd then */
+    if (mp_isodd (&C) == 1 || mp_isodd (&D) == 1) {
+      /* C = (C+y)/2, D = (D-x)/2 */
+      if ((res = mp_add (&C, &y, &C)) != MP_OKAY) {
+         goto LBL_ERR;
+      }
+      if ((res = mp_sub (&D, &x, &D)) != MP_OKAY) {
+         goto LBL_ERR;
+      }
+    }
+    /* C = C/2, D = D/2 */
+    if ((res = mp_div_2 (&C, &C)) != MP_OKAY) {
+      goto LBL_ERR;
+    }
+    if ((res = mp_div_2 (&D, &D)) != MP_OKAY) {
+      goto LBL_ERR;
+    }
+  }
+
+  /* 6.  if u >= v then */
+  if (mp_cmp (&u, &v) != MP_LT) {
+    /* u = u - v, A = A - C, B = B - D */
+    if ((res = mp_sub (&u, &v, &u)) != MP_OKAY) {
+      goto LBL_ERR;
+    }
+
+    if ((res = mp_sub (&A, &C, &A)) != MP_OKAY) {
+      goto LBL_ERR;
+    }
+
+    if ((res = mp_sub (&B, &D, &B)) != MP_OKAY) {
+      goto LBL_ERR;
+    }
+  } else {
+    /* v - v - u, C = C - A, D = D - B */
+    if ((res = mp_sub (&v, &u, &v)) != MP_OKAY) {
+      goto LBL_ERR;
+    }
+
+    if ((res = mp_sub (&C, &A, &C)) != MP_OKAY) {
+      goto LBL_ERR;
+    }
+
+    if ((res = mp_sub (&D, &B, &D)) != MP_OKAY) {
+      goto LBL_ERR;
+    }
+  }
+
+  /* if not zero goto step 4 */
+  if (mp_iszero (&u) == 0)
+    goto top;
+
+  /* now a = C, b = D, gcd == g*v */
+
+  /* if v != 1 then there is no inverse */
+  if (mp_cmp_d (&v, 1) != MP_EQ) {
+    res = MP_VAL;
+    goto LBL_ERR;
+  }
+
+  /* if its too low */
+  while (mp_cmp_d(&C, 0) == MP_LT) {
+      if ((res = mp_add(&C, b, &C)) != MP_OKAY) {
+         goto LBL_ERR;
+      }
+  }
+  
+  /* too big */
+  while (mp_cmp_mag(&C, b) != MP_LT) {
+      if ((res = mp_sub(&C, b, &C)) != MP_OKAY) {
+         goto LBL_ERR;
+      }
+  }
+  
+  /* C is now the inverse */
+  mp_exch (&C, c);
+  res = MP_OKAY;
+LBL_ERR:mp_clear_multi (&x, &y, &u, &v, &A, &B, &C, &D, NULL);
+  XSCRATCH_RELEASE(mark);
+  return res;
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_invmod_slow.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_invmod_slow.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_is_square.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_IS_SQUARE_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* Check if remainders are possible squares - fast exclude non-squares */
+static const char rem_128[128] = {
+ 0, 0, 1, 1, 0, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1,
+ 0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1,
+ 1, 0, 1, 1, 0, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1,
+ 1, 0, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1,
+ 0, 0, 1, 1, 0, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1,
+ 1, 0, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1,
+ 1, 0, 1, 1, 0, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1,
+ 1, 0, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1
+};
+
+static const char rem_105[105] = {
+ 0, 0, 1, 1, 0, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1,
+ 0, 0, 1, 1, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 1,
+ 0, 1, 1, 1, 1, 1, 0, 1, 1, 0, 1, 1, 1, 1, 1,
+ 1, 0, 1, 1, 0, 1, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+ 0, 1, 1, 1, 0, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1,
+ 1, 1, 1, 1, 0, 1, 0, 1, 1, 0, 0, 1, 1, 1, 1,
+ 1, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0, 1, 1, 1, 1
+};
+
+/* Store non-zero to ret if arg is square, and zero if not */
+int mp_is_square(mp_int *arg,int *ret) 
+{
+  int           res;
+  mp_digit      c;
+  mp_int        t;
+  unsigned long r;
+
+  /* Default to Non-square :) */
+  *ret = MP_NO; 
+
+  if (arg->sign == MP_NEG) {
+    return MP_VAL;
+  }
+
+  /* digits used?  (TSD) */
+  if (arg->used == 0) {
+     return MP_OKAY;
+  }
+
+  /* First check mod 128 (suppose that DIGIT_BIT is at least 7) */
+  if (rem_128[127 & DIGIT(arg,0)] == 1) {
+     return MP_OKAY;
+  }
+
+  /* Next check mod 105 (3*5*7) */
+  if ((res = mp_mod_d(arg,105,&c)) != MP_OKAY) {
+     return res;
+  }
+  if (rem_105[c] == 1) {
+     return MP_OKAY;
+  }
+
+
+  if ((res = mp_init_set_int(&t,11L*13L*17L*19L*23L*29L*31L)) != MP_OKAY) {
+     return res;
+  }
+  if ((res = mp_mod(arg,&t,&t)) != MP_OKAY) {
+     goto ERR;
+  }
+  r = mp_get_int(&t);
+  /* Check for other prime modules, note it's not an ERROR but we must
+   * free "t" so the easiest way is to goto ERR.  We know that res
+   * is already equal to MP_OKAY from the mp_mod call 
+   */ 
+  if ( (1L<<(r%11)) & 0x5C4L )             goto ERR;
+  if ( (1L<<(r%13)) & 0x9E4L )             goto ERR;
+  if ( (1L<<(r%17)) & 0x5CE8L )            goto ERR;
+  if ( (1L<<(r%19)) & 0x4F50CL )           goto ERR;
+  if ( (1L<<(r%23)) & 0x7ACCA0L )          goto ERR;
+  if ( (1L<<(r%29)) & 0xC2EDD0CL )         goto ERR;
+  if ( (1L<<(r%31)) & 0x6DE2B848L )        goto ERR;
+
+  /* Final check - is sqr(sqrt(arg)) == arg ? */
+  if ((res = mp_sqrt(arg,&t)) != MP_OKAY) {
+     goto ERR;
+  }
+  if ((res = mp_sqr(&t,&t)) != MP_OKAY) {
+     goto ERR;
+  }
+
+  *ret = (mp_cmp_mag(&t,arg) == MP_EQ) ? MP_YES : MP_NO;
+ERR:mp_clear(&t);
+  return res;
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_is_square.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_is_square.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_jacobi.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_JACOBI_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* computes the jacobi c = (a | n) (or Legendre if n is prime)
+ * HAC pp. 73 Algorithm 2.149
+ */
+int mp_jacobi (mp_int * a, mp_int * p, int *c)
+{
+  mp_int  a1, p1;
+  int     k, s, r, res;
+  mp_digit residue;
+
+  /* if p <= 0 return MP_VAL */
+  if (mp_cmp_d(p, 0) != MP_GT) {
+     return MP_VAL;
+  }
+
+  /* step 1.  if a == 0, return 0 */
+  if (mp_iszero (a) == 1) {
+    *c = 0;
+    return MP_OKAY;
+  }
+
+  /* step 2.  if a == 1, return 1 */
+  if (mp_cmp_d (a, 1) == MP_EQ) {
+    *c = 1;
+    return MP_OKAY;
+  }
+
+  /* default */
+  s = 0;
+
+  /* step 3.  write a = a1 * 2**k  */
+  if ((res = mp_init_copy (&a1, a)) != MP_OKAY) {
+    return res;
+  }
+
+  if ((res = mp_init (&p1)) != MP_OKAY) {
+    goto LBL_A1;
+  }
+
+  /* divide out larger power of two */
+  k = mp_cnt_lsb(&a1);
+  if ((res = mp_div_2d(&a1, k, &a1, NULL)) != MP_OKAY) {
+     goto LBL_P1;
+  }
+
+  /* step 4.  if e is even set s=1 */
+  if ((k & 1) == 0) {
+    s = 1;
+  } else {
+    /* else set s=1 if p = 1/7 (mod 8) or s=-1 if p = 3/5 (mod 8) */
+    residue = p->dp[0] & 7;
+
+    if (residue == 1 || residue == 7) {
+      s = 1;
+    } else if (residue == 3 || residue == 5) {
+      s = -1;
+    }
+  }
+
+  /* step 5.  if p == 3 (mod 4) *and* a1 == 3 (mod 4) then s = -s */
+  if ( ((p->dp[0] & 3) == 3) && ((a1.dp[0] & 3) == 3)) {
+    s = -s;
+  }
+
+  /* if a1 == 1 we're done */
+  if (mp_cmp_d (&a1, 1) == MP_EQ) {
+    *c = s;
+  } else {
+    /* n1 = n mod a1 */
+    if ((res = mp_mod (p, &a1, &p1)) != MP_OKAY) {
+      goto LBL_P1;
+    }
+    if ((res = mp_jacobi (&p1, &a1, &r)) != MP_OKAY) {
+      goto LBL_P1;
+    }
+    *c = s * r;
+  }
+
+  /* done */
+  res = MP_OKAY;
+LBL_P1:mp_clear (&p1);
+LBL_A1:mp_clear (&a1);
+  return res;
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_jacobi.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_jacobi.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_karatsuba_mul.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_KARATSUBA_MUL_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* c = |a| * |b| using Karatsuba Multiplication using 
+ * three half size multiplications
+ *
+ * Let B represent the radix [e.g. 2**DIGIT_BIT] and 
+ * let n represent half of the number of digits in 
+ * the min(a,b)
+ *
+ * a = a1 * B**n + a0
+ * b = b1 * B**n + b0
+ *
+ * Then, a * b => 
+   a1b1 * B**2n + ((a1 + a0)(b1 + b0) - (a0b0 + a1b1)) * B + a0b0
+ *
+ * Note that a1b1 and a0b0 are used twice and only need to be 
+ * computed once.  So in total three half size (half # of 
+ * digit) multiplications are performed, a0b0, a1b1 and 
+ * (a1+b1)(a0+b0)
+ *
+ * Note that a multiplication of half the digits requires
+ * 1/4th the number of single precision multiplications so in 
+ * total after one call 25% of the single precision multiplications 
+ * are saved.  Note also that the call to mp_mul can end up back 
+ * in this function if the a0, a1, b0, or b1 are above the threshold.  
+ * This is known as divide-and-conquer and leads to the famous 
+ * O(N**lg(3)) or O(N**1.584) work which is asymptopically lower than 
+ * the standard O(N**2) that the baseline/comba methods use.  
+ * Generally though the overhead of this method doesn't pay off 
+ * until a certain size (N ~ 80) is reached.
+ */
+int mp_karatsuba_mul (mp_int * a, mp_int * b, mp_int * c)
+{
+  mp_int  x0, x1, y0, y1, t1, x0y0, x1y1;
+  int     B, err;
+  size_t  mark;
+
+  /* default the return code to an error */
+  err = MP_MEM;
+
+  /* min # of digits */
+  B = MIN (a->used, b->used);
+
+  /* now divide in two */
+  B = B >> 1;
+
+  /* the temps come from scratch memory, enough for this call and the
+   * ones it recurses into is reserved up front
+   */
+  mark = XSCRATCH_MARK ();
+  XSCRATCH_RESERVE (sizeof (mp_digit) * 10 * (a->used + b->used + 8 * MP_PREC));
+
+  /* init copy all the temps */
+  if (mp_init_scratch (&x0, a->used + b->used) != MP_OKAY)
+    goto ERR;
+  if (mp_init_scratch (&x1, a->used - B) != MP_OKAY)
+    goto X0;
+  if (mp_init_scratch (&y0, B) != MP_OKAY)
+    goto X1;
+  if (mp_init_scratch (&y1, b->used - B) != MP_OKAY)
+    goto Y0;
+
+  /* init temps */
+  if (mp_init_scratch (&t1, a->used + b->used + 1) != MP_OKAY)
+    goto Y1;
+  if (mp_init_scratch (&x0y0, B * 2 + 1) != MP_OKAY)
+    goto T1;
+  if (mp_init_scratch (&x1y1, a->used + b->used) != MP_OKAY)
+    goto X0Y0;
+
+  /* now shift the digits */
+  x0.used = y0.used = B;
+  x1.used = a->used - B;
+  y1.used = b->used - B;
+
+  {
+    register int x;
+    register mp_digit *tmpa, *tmpb, *tmpx, *tmpy;
+
+    /* we copy the digits directly instead of using higher level functions
+     * since we also need to shift the digits
+     */
+    tmpa = a->dp;
+    tmpb = b->dp;
+
+    tmpx = x0.dp;
+    tmpy = y0.dp;
+    for (x = 0; x < B; x++) {
+      *tmpx++ = *tmpa++;
+      *tmpy++ = *tmpb++;
+    }
+
+    tmpx = x1.dp;
+    for (x = B; x < a->used; x++) {
+      *tmpx++ = *tmpa++;
+    }
+
+    tmpy = y1.dp;
+    for (x = B; x < b->used; x++) {
+      *tmpy++ = *tmpb++;
+    }
+  }
+
+  /* only need to clamp the lower words since by definition the 
+   * upper words x1/y1 must have a known number of digits
+   */
+  mp_clamp (&x0);
+  mp_clamp (&y0);
+
+  /* now calc the products x0y0 and x1y1 */
+  /* after this x0 is no longer required, free temp [x0==t2]! */
+  if (mp_mul (&x0, &y0, &x0y0) != MP_OKAY)  
+    goto X1Y1;          /* x0y0 = x0*y0 */
+  if (mp_mul (&x1, &y1, &x1y1) != MP_OKAY)
+    goto X1Y1;          /* x1y1 = x1*y1 */
+
+  /* now calc x1+x0 and y1+y0 */
+  if (s_mp_add (&x1, &x0, &t1) != MP_OKAY)
+    goto X1Y1;          /* t1 = x1 - x0 */
+  if (s_mp_add (&y1, &y0, &x0) != MP_OKAY)
+    goto X1Y1;          /* t2 = y1 - y0 */
+  if (mp_mul (&t1, &x0, &t1) != MP_OKAY)
+    goto X1Y1;          /* t1 = (x1 + x0) * (y1 + y0) */
+
+  /* add x0y0 */
+  if (mp_add (&x0y0, &x1y1, &x0) != MP_OKAY)
+    goto X1Y1;          /* t2 = x0y0 + x1y1 */
+  if (s_mp_sub (&t1, &x0, &t1) != MP_OKAY)
+    goto X1Y1;          /* t1 = (x1+x0)*(y1+y0) - (x1y1 + x0y0) */
+
+  /* shift by B */
+  if (mp_lshd (&t1, B) != MP_OKAY)
+    goto X1Y1;          /* t1 = (x0y0 + x1y1 - (x1-x0)*(y1-y0))<<B */
+  if (mp_lshd (&x1y1, B * 2) != MP_OKAY)
+    goto X1Y1;          /* x1y1 = x1y1 << 2*B */
+
+  if (mp_add (&x0y0, &t1, &t1) != MP_OKAY)
+    goto X1Y1;          /* t1 = x0y0 + t1 */
+  if (mp_add (&t1, &x1y1, c) != MP_OKAY)
+    goto X1Y1;          /* t1 = x0y0 + t1 + x1y1 */
+
+  /* Algorithm succeeded set the return code to MP_OKAY */
+  err = MP_OKAY;
+
+X1Y1:mp_clear (&x1y1);
+X0Y0:mp_clear (&x0y0);
+T1:mp_clear (&t1);
+Y1:mp_clear (&y1);
+Y0:mp_clear (&y0);
+X1:mp_clear (&x1);
+X0:mp_clear (&x0);
+ERR:
+  XSCRATCH_RELEASE (mark);
+  return err;
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_karatsuba_mul.c,v $ */
+/* $Revision: 1.6 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_karatsuba_mul.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_karatsuba_sqr.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_KARATSUBA_SQR_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* Karatsuba squaring, computes b = a*a using three 
+ * half size squarings
+ *
+ * See comments of karatsuba_mul for details.  It 
+ * is essentially the same algorithm but merely 
+ * tuned to perform recursive squarings.
+ */
+int mp_karatsuba_sqr (mp_int * a, mp_int * b)
+{
+  mp_int  x0, x1, t1, t2, x0x0, x1x1;
+  int     B, err;
+  size_t  mark;
+
+  err = MP_MEM;
+
+  /* min # of digits */
+  B = a->used;
+
+  /* now divide in two */
+  B = B >> 1;
+
+  /* the temps come from scratch memory, see mp_karatsuba_mul */
+  mark = XSCRATCH_MARK ();
+  XSCRATCH_RESERVE (sizeof (mp_digit) * 20 * (a->used + 4 * MP_PREC));
+
+  /* init copy all the temps */
+  if (mp_init_scratch (&x0, B) != MP_OKAY)
+    goto ERR;
+  if (mp_init_scratch (&x1, a->used - B) != MP_OKAY)
+    goto X0;
+
+  /* init temps */
+  if (mp_init_scratch (&t1, a->used * 2) != MP_OKAY)
+    goto X1;
+  if (mp_init_scratch (&t2, a->used * 2) != MP_OKAY)
+    goto T1;
+  if (mp_init_scratch (&x0x0, B * 2) != MP_OKAY)
+    goto T2;
+  if (mp_init_scratch (&x1x1, a->used * 2) != MP_OKAY)
+    goto X0X0;
+
+  {
+    register int x;
+    register mp_digit *dst, *src;
+
+    src = a->dp;
+
+    /* now shift the digits */
+    dst = x0.dp;
+    for (x = 0; x < B; x++) {
+      *dst++ = *src++;
+    }
+
+    dst = x1.dp;
+    for (x = B; x < a->used; x++) {
+      *dst++ = *src++;
+    }
+  }
+
+  x0.used = B;
+  x1.used = a->used - B;
+
+  mp_clamp (&x0);
+
+  /* now calc the products x0*x0 and x1*x1 */
+  if (mp_sqr (&x0, &x0x0) != MP_OKAY)
+    goto X1X1;           /* x0x0 = x0*x0 */
+  if (mp_sqr (&x1, &x1x1) != MP_OKAY)
+    goto X1X1;           /* x1x1 = x1*x1 */
+
+  /* now calc (x1+x0)**2 */
+  if (s_mp_add (&x1, &x0, &t1) != MP_OKAY)
+    goto X1X1;           /* t1 = x1 - x0 */
+  if (mp_sqr (&t1, &t1) != MP_OKAY)
+    goto X1X1;           /* t1 = (x1 - x0) * (x1 - x0) */
+
+  /* add x0y0 */
+  if (s_mp_add (&x0x0, &x1x1, &t2) != MP_OKAY)
+    goto X1X1;           /* t2 = x0x0 + x1x1 */
+  if (s_mp_sub (&t1, &t2, &t1) != MP_OKAY)
+    goto X1X1;           /* t1 = (x1+x0)**2 - (x0x0 + x1x1) */
+
+  /* shift by B */
+  if (mp_lshd (&t1, B) != MP_OKAY)
+    goto X1X1;           /* t1 = (x0x0 + x1x1 - (x1-x0)*(x1-x0))<<B */
+  if (mp_lshd (&x1x1, B * 2) != MP_OKAY)
+    goto X1X1;           /* x1x1 = x1x1 << 2*B */
+
+  if (mp_add (&x0x0, &t1, &t1) != MP_OKAY)
+    goto X1X1;           /* t1 = x0x0 + t1 */
+  if (mp_add (&t1, &x1x1, b) != MP_OKAY)
+    goto X1X1;           /* t1 = x0x0 + t1 + x1x1 */
+
+  err = MP_OKAY;
+
+X1X1:mp_clear (&x1x1);
+X0X0:mp_clear (&x0x0);
+T2:mp_clear (&t2);
+T1:mp_clear (&t1);
+X1:mp_clear (&x1);
+X0:mp_clear (&x0);
+ERR:
+  XSCRATCH_RELEASE (mark);
+  return err;
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_karatsuba_sqr.c,v $ */
+/* $Revision: 1.6 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_karatsuba_sqr.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_lcm.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_LCM_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* computes least common multiple as |a*b|/(a, b) */
+int mp_lcm (mp_int * a, mp_int * b, mp_int * c)
+{
+  int     res;
+  mp_int  t1, t2;
+
+
+  if ((res = mp_init_multi (&t1, &t2, NULL)) != MP_OKAY) {
+    return res;
+  }
+
+  /* t1 = get the GCD of the two inputs */
+  if ((res = mp_gcd (a, b, &t1)) != MP_OKAY) {
+    goto LBL_T;
+  }
+
+  /* divide the smallest by the GCD, which always goes in exactly */
+  if (mp_cmp_mag(a, b) == MP_LT) {
+     /* store quotient in t2 such that t2 * b is the LCM */
+     if ((res = mp_divexact(a, &t1, &t2)) != MP_OKAY) {
+        goto LBL_T;
+     }
+     res = mp_mul(b, &t2, c);
+  } else {
+     /* store quotient in t2 such that t2 * a is the LCM */
+     if ((res = mp_divexact(b, &t1, &t2)) != MP_OKAY) {
+        goto LBL_T;
+     }
+     res = mp_mul(a, &t2, c);
+  }
+
+  /* fix the sign to positive */
+  c->sign = MP_ZPOS;
+
+LBL_T:
+  mp_clear_multi (&t1, &t2, NULL);
+  return res;
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_lcm.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_lcm.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_lshd.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_LSHD_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* shift left a certain amount of digits */
+int mp_lshd (mp_int * a, int b)
+{
+  int     x, res;
+
+  /* if its less than zero return */
+  if (b <= 0) {
+    return MP_OKAY;
+  }
+
+  /* grow to fit the new digits */
+  if (a->alloc < a->used + b) {
+     if ((res = mp_grow (a, a->used + b)) != MP_OKAY) {
+       return res;
+     }
+  }
+
+  {
+    register mp_digit *top, *bottom;
+
+    /* increment the used by the shift amount then copy upwards */
+    a->used += b;
+
+    /* top */
+    top = a->dp + a->used - 1;
+
+    /* base */
+    bottom = a->dp + a->used - 1 - b;
+
+    /* much like mp_rshd this is implemented using a sliding window
+     * except the window goes the otherway around.  Copying from
+     * the bottom to the top.  see bn_mp_rshd.c for more info.
+     */
+    for (x = a->used - 1; x >= b; x--) {
+      *top-- = *bottom--;
+    }
+
+    /* zero the lower digits */
+    top = a->dp;
+    for (x = 0; x < b; x++) {
+      *top++ = 0;
+    }
+  }
+  return MP_OKAY;
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_lshd.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_lshd.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_mod.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_MOD_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* c = a mod b, 0 <= c < b */
+int
+mp_mod (mp_int * a, mp_int * b, mp_int * c)
+{
+  mp_int  t;
+  int     res;
+
+  if ((res = mp_init (&t)) != MP_OKAY) {
+    return res;
+  }
+
+  if ((res = mp_div (a, b, NULL, &t)) != MP_OKAY) {
+    mp_clear (&t);
+    return res;
+  }
+
+  if (t.sign != b->sign) {
+    res = mp_add (b, &t, c);
+  } else {
+    res = MP_OKAY;
+    mp_exch (&t, c);
+  }
+
+  mp_clear (&t);
+  return res;
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_mod.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_mod.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_mod_2d.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_MOD_2D_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* calc a value mod 2**b */
+int
+mp_mod_2d (mp_int * a, int b, mp_int * c)
+{
+  int     x, res;
+
+  /* if b is <= 0 then zero the int */
+  if (b <= 0) {
+    mp_zero (c);
+    return MP_OKAY;
+  }
+
+  /* if the modulus is larger than the value than return */
+  if (b >= (int) (a->used * DIGIT_BIT)) {
+    res = mp_copy (a, c);
+    return res;
+  }
+
+  /* copy */
+  if ((res = mp_copy (a, c)) != MP_OKAY) {
+    return res;
+  }
+
+  /* zero digits above the last digit of the modulus */
+  for (x = (b / DIGIT_BIT) + ((b % DIGIT_BIT) == 0 ? 0 : 1); x < c->used; x++) {
+    c->dp[x] = 0;
+  }
+  /* clear the digit that is not completely outside/inside the modulus */
+  c->dp[b / DIGIT_BIT] &=
+    (mp_digit) ((((mp_digit) 1) << (((mp_digit) b) % DIGIT_BIT)) - ((mp_digit) 1));
+  mp_clamp (c);
+  return MP_OKAY;
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_mod_2d.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_mod_2d.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_mod_d.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_MOD_D_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+int
+mp_mod_d (mp_int * a, mp_digit b, mp_digit * c)
+{
+  return mp_div_d(a, b, NULL, c);
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_mod_d.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_mod_d.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_mod_d_multi.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_MOD_D_MULTI_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* residues of a modulo several single digit divisors
+ *
+ * c[i] = |a| mod inv[i].b for i < n where every inv[i] comes from
+ * mp_div_d_setup.  The digits of a are read once, from the top, and
+ * each is taken into all n remainders before the next one, so the n
+ * independent divisions by the precomputed inverses (see mp_div_d_inv)
+ * overlap each other in the pipeline.
+ */
+int mp_mod_d_multi(mp_int *a, mp_digit_inv *inv, int n, mp_digit *c)
+{
+  mp_word p;
+  mp_digit r, u0, q1, x, u1, m, norm;
+  int     ix, iy, shift;
+
+  for (iy = 0; iy < n; iy++) {
+     if (inv[iy].norm == 0) {
+        return MP_VAL;
+     }
+     c[iy] = 0;
+  }
+
+  /* the remainders are kept shifted like their divisors until the end */
+  for (ix = a->used - 1; ix >= 0; ix--) {
+     x = a->dp[ix];
+     for (iy = 0; iy < n; iy++) {
+        norm  = inv[iy].norm;
+        shift = inv[iy].shift;
+        u0 = (x << ((mp_digit)shift)) & MP_MASK;
+        u1 = c[iy] | ((x >> 1) >> ((mp_digit)(DIGIT_BIT - 1 - shift)));
+
+        p  = ((mp_word)inv[iy].inv) * ((mp_word)u1) + ((mp_word)u0);
+        q1 = (((mp_digit)(p >> ((mp_word)DIGIT_BIT))) + u1 + 1) & MP_MASK;
+        r  = (u0 - q1 * norm) & MP_MASK;
+        m  = ((mp_digit)0) - ((mp_digit)(r > (((mp_digit)p) & MP_MASK)));
+        r  = (r + (norm & m)) & MP_MASK;
+        if (r >= norm) {
+           r -= norm;
+        }
+        c[iy] = r;
+     }
+  }
+
+  for (iy = 0; iy < n; iy++) {
+     c[iy] >>= ((mp_digit)inv[iy].shift);
+  }
+
+  return MP_OKAY;
+}
+
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_mod_d_multi.c,v $ */
+/* $Revision: 1.1 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_mod_d_multi.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_montgomery_calc_normalization.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_MONTGOMERY_CALC_NORMALIZATION_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/*
+ * shifts with subtractions when the result is greater than b.
+ *
+ * The method is slightly modified to shift B unconditionally upto just under
+ * the leading bit of b.  This saves alot of multiple precision shifting.
+ */
+int mp_montgomery_calc_normalization (mp_int * a, mp_int * b)
+{
+  int     x, bits, res;
+
+  /* how many bits of last digit does b use */
+  bits = mp_count_bits (b) % DIGIT_BIT;
+
+  if (b->used > 1) {
+     if ((res = mp_2expt (a, (b->used - 1) * DIGIT_BIT + bits - 1)) != MP_OKAY) {
+        return res;
+     }
+  } else {
+     mp_set(a, 1);
+     bits = 1;
+  }
+
+
+  /* now compute C = A * B mod b */
+  for (x = bits - 1; x < (int)DIGIT_BIT; x++) {
+    if ((res = mp_mul_2 (a, a)) != MP_OKAY) {
+      return res;
+    }
+    if (mp_cmp_mag (a, b) != MP_LT) {
+      if ((res = s_mp_sub (a, b, a)) != MP_OKAY) {
+        return res;
+      }
+    }
+  }
+
+  return MP_OKAY;
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_montgomery_calc_normalization.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_montgomery_calc_normalization.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_montgomery_reduce.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_MONTGOMERY_REDUCE_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* computes xR**-1 == x (mod N) via Montgomery Reduction */
+int
+mp_montgomery_reduce (mp_int * x, mp_int * n, mp_digit rho)
+{
+  int     ix, res, digs;
+  mp_digit mu;
+
+  /* can the fast reduction [comba] method be used?
+   *
+   * Note that unlike in mul you're safely allowed *less*
+   * than the available columns [255 per default] since carries
+   * are fixed up in the inner loop.
+   */
+  digs = n->used * 2 + 1;
+  if ((digs < MP_WARRAY) &&
+      n->used <
+      MP_COMBA_MAX) {
+    return fast_mp_montgomery_reduce (x, n, rho);
+  }
+
+  /* grow the input as required */
+  if (x->alloc < digs) {
+    if ((res = mp_grow (x, digs)) != MP_OKAY) {
+      return res;
+    }
+  }
+  x->used = digs;
+
+  for (ix = 0; ix < n->used; ix++) {
+    /* mu = ai * rho mod b
+     *
+     * The value of rho must be precalculated via
+     * montgomery_setup() such that
+     * it equals -1/n0 mod b this allows the
+     * following inner loop to reduce the
+     * input one digit at a time
+     */
+    mu = (mp_digit) (((mp_word)x->dp[ix]) * ((mp_word)rho) & MP_MASK);
+
+    /* a = a + mu * m * b**i */
+    {
+      register int iy;
+      register mp_digit *tmpn, *tmpx, u;
+      register mp_word r;
+
+      /* alias for digits of the modulus */
+      tmpn = n->dp;
+
+      /* alias for the digits of x [the input] */
+      tmpx = x->dp + ix;
+
+      /* set the carry to zero */
+      u = 0;
+
+      /* Multiply and add in place */
+      for (iy = 0; iy < n->used; iy++) {
+        /* compute product and sum */
+        r       = ((mp_word)mu) * ((mp_word)*tmpn++) +
+                  ((mp_word) u) + ((mp_word) * tmpx);
+
+        /* get carry */
+        u       = (mp_digit)(r >> ((mp_word) DIGIT_BIT));
+
+        /* fix digit */
+        *tmpx++ = (mp_digit)(r & ((mp_word) MP_MASK));
+      }
+      /* At this point the ix'th digit of x should be zero */
+
+
+      /* propagate carries upwards as required*/
+      while (u) {
+#ifdef MP_64BIT_FULL
+        *tmpx   += u;
+        u        = (*tmpx++ < u);
+#else
+        *tmpx   += u;
+        u        = *tmpx >> DIGIT_BIT;
+        *tmpx++ &= MP_MASK;
+#endif
+      }
+    }
+  }
+
+  /* at this point the n.used'th least
+   * significant digits of x are all zero
+   * which means we can shift x to the
+   * right by n.used digits and the
+   * residue is unchanged.
+   */
+
+  /* x = x/b**n.used */
+  mp_clamp(x);
+  mp_rshd (x, n->used);
+
+  /* if x >= n then x = x - n */
+  if (mp_cmp_mag (x, n) != MP_LT) {
+    return s_mp_sub (x, n, x);
+  }
+
+  return MP_OKAY;
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_montgomery_reduce.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_montgomery_reduce.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_montgomery_reduce_l.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_MONTGOMERY_REDUCE_L_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
  * guarantee it works.
  *
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
-#include <stdarg.h>
 
-int mp_init_multi(mp_int *mp, ...) 
+/* computes xR**-1 == x (mod n) via Montgomery Reduction with the whole
+ * of rho = -1/n mod R from mp_montgomery_setup_l, R = B**k for n of k
+ * digits and 0 <= x < n*R.
+ *
+ * Instead of a digit of the multiple of n at a time, all of it at once:
+ * m = x*rho mod R is a low short product and x + m*n is a multiple of R.
+ * Of m*n only the part over R is wanted and it comes from a high short
+ * product.  That one leaves out the columns under k - 2, less than R in
+ * all, and as (m*n + (x mod R)) is a multiple of R the missing part is
+ * whatever takes the short product plus x mod R up to the next one.
+ */
+int mp_montgomery_reduce_l (mp_int * x, mp_int * n, mp_int * rho)
 {
-    mp_err res = MP_OKAY;      /* Assume ok until proven otherwise */
-    int n = 0;                 /* Number of ok inits */
-    mp_int* cur_arg = mp;
-    va_list args;
+  mp_int  m, t;
+  int     res, k, ix, up;
+
+  k = n->used;
+  if ((res = mp_init_multi (&m, &t, NULL)) != MP_OKAY) {
+    return res;
+  }
+
+  /* m = x*rho mod R */
+  if ((res = mp_mullo (x, rho, &m, k)) != MP_OKAY) {
+    goto LBL_ERR;
+  }
+
+  /* t = the columns of m*n from k - 2 up, plus x mod R */
+  if ((res = mp_mulhi (&m, n, &t, k - 2)) != MP_OKAY) {
+    goto LBL_ERR;
+  }
+  if ((res = mp_mod_2d (x, DIGIT_BIT * k, &m)) != MP_OKAY) {
+    goto LBL_ERR;
+  }
+  if ((res = s_mp_add (&t, &m, &t)) != MP_OKAY) {
+    goto LBL_ERR;
+  }
+
+  /* x = x div R + t div R, rounded up */
+  up = 0;
+  for (ix = 0; ix < MIN (k, t.used); ix++) {
+    up |= (t.dp[ix] != 0);
+  }
+  mp_rshd (&t, k);
+  if (up != 0 && (res = mp_add_d (&t, 1, &t)) != MP_OKAY) {
+    goto LBL_ERR;
+  }
+  mp_rshd (x, k);
+  if ((res = s_mp_add (x, &t, x)) != MP_OKAY) {
+    goto LBL_ERR;
+  }
+
+  /* if x >= n then x = x - n */
+  if (mp_cmp_mag (x, n) != MP_LT) {
+    res = s_mp_sub (x, n, x);
+  }
+
+LBL_ERR:
+  mp_clear_multi (&m, &t, NULL);
+  return res;
+}
+
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_montgomery_reduce_l.c,v $ */
+/* $Revision: 1.1 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_montgomery_reduce_l.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_montgomery_setup.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_MONTGOMERY_SETUP_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* setups the montgomery reduction stuff */
+int
+mp_montgomery_setup (mp_int * n, mp_digit * rho)
+{
+  mp_digit x, b;
+
+/* fast inversion mod 2**k
+ *
+ * Based on the fact that
+ *
+ * XA = 1 (mod 2**n)  =>  (X(2-XA)) A = 1 (mod 2**2n)
+ *                    =>  2*X*A - X*X*A*A = 1
+ *                    =>  2*(1) - (1)     = 1
+ */
+  b = n->dp[0];
+
+  if ((b & 1) == 0) {
+    return MP_VAL;
+  }
+
+  x = (((b + 2) & 4) << 1) + b; /* here x*a==1 mod 2**4 */
+  x *= 2 - b * x;               /* here x*a==1 mod 2**8 */
+#if !defined(MP_8BIT)
+  x *= 2 - b * x;               /* here x*a==1 mod 2**16 */
+#endif
+#if defined(MP_64BIT) || !(defined(MP_8BIT) || defined(MP_16BIT))
+  x *= 2 - b * x;               /* here x*a==1 mod 2**32 */
+#endif
+#ifdef MP_64BIT
+  x *= 2 - b * x;               /* here x*a==1 mod 2**64 */
+#endif
+
+  /* rho = -1/m mod b */
+  *rho = (unsigned long)(((mp_word)1 << ((mp_word) DIGIT_BIT)) - x) & MP_MASK;
+
+  return MP_OKAY;
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_montgomery_setup.c,v $ */
+/* $Revision: 1.5 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_montgomery_setup.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_montgomery_setup_l.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_MONTGOMERY_SETUP_L_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* rho = -1/n mod B**k for odd n of k digits, for mp_montgomery_reduce_l
+ *
+ * The digit of mp_montgomery_setup is lifted a doubling of digits at a
+ * time: with n*rho = e*B**j - 1 mod B**2j, rho + rho*e*B**j is the
+ * inverse to twice as many digits.  Two low short products a step.
+ */
+int mp_montgomery_setup_l (mp_int * n, mp_int * rho)
+{
+  mp_int  t, e;
+  mp_digit d;
+  int     res, j, j2;
+
+  if ((res = mp_montgomery_setup (n, &d)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_init_multi (&t, &e, NULL)) != MP_OKAY) {
+    return res;
+  }
+  mp_set (rho, d);
+
+  for (j = 1; j < n->used; j = j2) {
+    j2 = MIN (2 * j, n->used);
+
+    /* e = (n*rho + 1) div B**j, to j2 - j digits */
+    if ((res = mp_mullo (n, rho, &t, j2)) != MP_OKAY) {
+      goto LBL_ERR;
+    }
+    if ((res = mp_add_d (&t, 1, &t)) != MP_OKAY) {
+      goto LBL_ERR;
+    }
+    mp_rshd (&t, j);
+
+    /* rho += (rho*e mod B**(j2-j)) * B**j */
+    if ((res = mp_mullo (rho, &t, &e, j2 - j)) != MP_OKAY) {
+      goto LBL_ERR;
+    }
+    if ((res = mp_lshd (&e, j)) != MP_OKAY) {
+      goto LBL_ERR;
+    }
+    if ((res = s_mp_add (rho, &e, rho)) != MP_OKAY) {
+      goto LBL_ERR;
+    }
+  }
+
+LBL_ERR:
+  mp_clear_multi (&t, &e, NULL);
+  return res;
+}
+
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_montgomery_setup_l.c,v $ */
+/* $Revision: 1.1 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_montgomery_setup_l.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_mul.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_MUL_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* high level multiplication (handles sign) */
+int mp_mul (mp_int * a, mp_int * b, mp_int * c)
+{
+  int     res, neg, lo, hi;
+  mp_int *x, *y;
+  neg = (a->sign == b->sign) ? MP_ZPOS : MP_NEG;
+
+  /* x is the longer one, lo and hi the digits of the shorter and longer */
+  x  = (a->used >= b->used) ? a : b;
+  y  = (a->used >= b->used) ? b : a;
+  lo = y->used;
+  hi = x->used;
+
+#if defined(BN_MP_NTT_MUL_C) && defined(MP_64BIT)
+  /* use the three prime NTT? */
+  if (FFT_MUL_METHOD == MP_FFT_NTT && MIN (a->used, b->used) >= NTT_MUL_CUTOFF) {
+    res = mp_ntt_mul(a, b, c);
+  } else 
+#endif
+#ifdef BN_MP_SSA_MUL_C
+  /* use Schonhage-Strassen? */
+  if (FFT_MUL_METHOD == MP_FFT_SSA && MIN (a->used, b->used) >= SSA_MUL_CUTOFF) {
+    res = mp_ssa_mul(a, b, c);
+  } else 
+#endif
+#ifdef BN_MP_CHUNK_MUL_C
+  /* one at least twice as long?  cut it in pieces the size of the other */
+  if (hi >= 2 * lo && lo >= KARATSUBA_MUL_CUTOFF) {
+    res = mp_chunk_mul(x, y, c, lo);
+  } else 
+  /* too long for the comba?  cut the longer one so the pieces are not */
+  if (lo > 0 && lo < KARATSUBA_MUL_CUTOFF && hi + lo + 1 >= MP_WARRAY) {
+    res = mp_chunk_mul(x, y, c, MP_WARRAY - lo - 2);
+  } else 
+#endif
+#ifdef BN_MP_TOOM35_MUL_C
+  /* between 1.2 and 1.5 times as long?  use Toom-3.5 */
+  if (lo >= TOOM_MUL_CUTOFF && 5 * hi >= 6 * lo && 2 * hi < 3 * lo) {
+    res = mp_toom35_mul(x, y, c);
+  } else 
+#endif
+#ifdef BN_MP_TOOM25_MUL_C
+  /* more than 1.4 times as long?  use Toom-2.5 */
+  if (lo >= KARATSUBA_MUL_CUTOFF && 5 * hi >= 7 * lo) {
+    res = mp_toom25_mul(x, y, c);
+  } else 
+#endif
+#ifdef BN_MP_TOOM65_MUL_C
+  /* use Toom-6.5?  a may be up to 7/6 as long as b */
+  if (lo >= TOOM65_MUL_CUTOFF && 6 * hi <= 7 * lo) {
+    res = mp_toom65_mul(x, y, c);
+  } else 
+#endif
+#ifdef BN_MP_TOOM4_MUL_C
+  /* use Toom-4? */
+  if (lo >= TOOM4_MUL_CUTOFF) {
+    res = mp_toom4_mul(x, y, c);
+  } else 
+#endif
+  /* use Toom-Cook? */
+#ifdef BN_MP_TOOM_MUL_C
+  if (MIN (a->used, b->used) >= TOOM_MUL_CUTOFF) {
+    res = mp_toom_mul(a, b, c);
+  } else 
+#endif
+#ifdef BN_MP_KARATSUBA_MUL_C
+  /* use Karatsuba? */
+  if (MIN (a->used, b->used) >= KARATSUBA_MUL_CUTOFF) {
+    res = mp_karatsuba_mul (a, b, c);
+  } else 
+#endif
+  {
+    /* can we use the fast multiplier?
+     *
+     * The fast multiplier can be used if the output will 
+     * have less than MP_WARRAY digits and the number of 
+     * digits won't affect carry propagation
+     */
+    int     digs = a->used + b->used + 1;
+
+#ifdef BN_FAST_S_MP_MUL_DIGS_C
+    if ((digs < MP_WARRAY) &&
+        MIN(a->used, b->used) <= 
+        MP_COMBA_MAX) {
+      res = fast_s_mp_mul_digs (a, b, c, digs);
+    } else 
+#endif
+#ifdef BN_S_MP_MUL_DIGS_C
+      res = s_mp_mul (a, b, c); /* uses s_mp_mul_digs */
+#else
+      res = MP_VAL;
+#endif
 
-    va_start(args, mp);        /* init args to next argument from caller */
-    while (cur_arg != NULL) {
-        if (mp_init(cur_arg) != MP_OKAY) {
-            /* Oops - error! Back-track and mp_clear what we already
-               succeeded in init-ing, then return error.
-            */
-            va_list clean_args;
-            
-            /* end the current list */
-            va_end(args);
-            
-            /* now start cleaning up */            
-            cur_arg = mp;
-            va_start(clean_args, mp);
-            while (n--) {
-                mp_clear(cur_arg);
-                cur_arg = va_arg(clean_args, mp_int*);
-            }
-            va_end(clean_args);
-            res = MP_MEM;
-            break;
-        }
-        n++;
-        cur_arg = va_arg(args, mp_int*);
-    }
-    va_end(args);
-    return res;                /* Assumed ok, if error flagged above. */
+  }
+  c->sign = (c->used > 0) ? neg : MP_ZPOS;
+  return res;
 }
-
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_init_multi.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_mul.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_init_multi.c
+ --   End: vendor/libtommath-0.41/bn_mp_mul.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_init_set.c
+ -- Start: vendor/libtommath-0.41/bn_mp_mul_2.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_INIT_SET_C
+#ifdef BN_MP_MUL_2_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -3688,30 +6977,80 @@ int mp_init_multi(mp_int *mp, ...)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* initialize and set a digit */
-int mp_init_set (mp_int * a, mp_digit b)
+/* b = a*2 */
+int mp_mul_2(mp_int * a, mp_int * b)
 {
-  int err;
-  if ((err = mp_init(a)) != MP_OKAY) {
-     return err;
+  int     x, res, oldused;
+
+  /* grow to accomodate result */
+  if (b->alloc < a->used + 1) {
+    if ((res = mp_grow (b, a->used + 1)) != MP_OKAY) {
+      return res;
+    }
   }
-  mp_set(a, b);
-  return err;
+
+  oldused = b->used;
+  b->used = a->used;
+
+  {
+    register mp_digit r, rr, *tmpa, *tmpb;
+
+    /* alias for source */
+    tmpa = a->dp;
+    
+    /* alias for dest */
+    tmpb = b->dp;
+
+    /* carry */
+    r = 0;
+    for (x = 0; x < a->used; x++) {
+    
+      /* get what will be the *next* carry bit from the 
+       * MSB of the current digit 
+       */
+      rr = *tmpa >> ((mp_digit)(DIGIT_BIT - 1));
+      
+      /* now shift up this digit, add in the carry [from the previous] */
+      *tmpb++ = ((*tmpa++ << ((mp_digit)1)) | r) & MP_MASK;
+      
+      /* copy the carry that would be from the source 
+       * digit into the next iteration 
+       */
+      r = rr;
+    }
+
+    /* new leading digit? */
+    if (r != 0) {
+      /* add a MSB which is always 1 at this point */
+      *tmpb = 1;
+      ++(b->used);
+    }
+
+    /* now zero any excess digits on the destination 
+     * that we didn't write to 
+     */
+    tmpb = b->dp + b->used;
+    for (x = b->used; x < oldused; x++) {
+      *tmpb++ = 0;
+    }
+  }
+  b->sign = a->sign;
+  return MP_OKAY;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_init_set.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_mul_2.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_init_set.c
+ --   End: vendor/libtommath-0.41/bn_mp_mul_2.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_init_set_int.c
+ -- Start: vendor/libtommath-0.41/bn_mp_mul_2d.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_INIT_SET_INT_C
+#ifdef BN_MP_MUL_2D_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -3727,29 +7066,83 @@ int mp_init_set (mp_int * a, mp_digit b)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* initialize and set a digit */
-int mp_init_set_int (mp_int * a, unsigned long b)
+/* shift left by a certain bit count */
+int mp_mul_2d (mp_int * a, int b, mp_int * c)
 {
-  int err;
-  if ((err = mp_init(a)) != MP_OKAY) {
-     return err;
+  mp_digit d;
+  int      res;
+
+  /* copy */
+  if (a != c) {
+     if ((res = mp_copy (a, c)) != MP_OKAY) {
+       return res;
+     }
   }
-  return mp_set_int(a, b);
+
+  if (c->alloc < (int)(c->used + b/DIGIT_BIT + 1)) {
+     if ((res = mp_grow (c, c->used + b / DIGIT_BIT + 1)) != MP_OKAY) {
+       return res;
+     }
+  }
+
+  /* shift by as many digits in the bit count */
+  if (b >= (int)DIGIT_BIT) {
+    if ((res = mp_lshd (c, b / DIGIT_BIT)) != MP_OKAY) {
+      return res;
+    }
+  }
+
+  /* shift any bit count < DIGIT_BIT */
+  d = (mp_digit) (b % DIGIT_BIT);
+  if (d != 0) {
+    register mp_digit *tmpc, shift, mask, r, rr;
+    register int x;
+
+    /* bitmask for carries */
+    mask = (((mp_digit)1) << d) - 1;
+
+    /* shift for msbs */
+    shift = DIGIT_BIT - d;
+
+    /* alias */
+    tmpc = c->dp;
+
+    /* carry */
+    r    = 0;
+    for (x = 0; x < c->used; x++) {
+      /* get the higher bits of the current word */
+      rr = (*tmpc >> shift) & mask;
+
+      /* shift the current word and OR in the carry */
+      *tmpc = ((*tmpc << d) | r) & MP_MASK;
+      ++tmpc;
+
+      /* set the carry to the carry bits of the current word */
+      r = rr;
+    }
+    
+    /* set final carry */
+    if (r != 0) {
+       c->dp[(c->used)++] = r;
+    }
+  }
+  mp_clamp (c);
+  return MP_OKAY;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_init_set_int.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_mul_2d.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_init_set_int.c
+ --   End: vendor/libtommath-0.41/bn_mp_mul_2d.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_init_size.c
+ -- Start: vendor/libtommath-0.41/bn_mp_mul_d.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_INIT_SIZE_C
+#ifdef BN_MP_MUL_D_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -3765,46 +7158,77 @@ int mp_init_set_int (mp_int * a, unsigned long b)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* init an mp_init for a given size */
-int mp_init_size (mp_int * a, int size)
+/* multiply by a digit */
+int
+mp_mul_d (mp_int * a, mp_digit b, mp_int * c)
 {
-  int x;
+  mp_digit u, *tmpa, *tmpc;
+  mp_word  r;
+  int      ix, res, olduse;
 
-  /* pad size so there are always extra digits */
-  size += (MP_PREC * 2) - (size % MP_PREC);	
-  
-  /* alloc mem */
-  a->dp = OPT_CAST(mp_digit) XMALLOC (sizeof (mp_digit) * size);
-  if (a->dp == NULL) {
-    return MP_MEM;
+  /* make sure c is big enough to hold a*b */
+  if (c->alloc < a->used + 1) {
+    if ((res = mp_grow (c, a->used + 1)) != MP_OKAY) {
+      return res;
+    }
   }
 
-  /* set the members */
-  a->used  = 0;
-  a->alloc = size;
-  a->sign  = MP_ZPOS;
+  /* get the original destinations used count */
+  olduse = c->used;
 
-  /* zero the digits */
-  for (x = 0; x < size; x++) {
-      a->dp[x] = 0;
+  /* set the sign */
+  c->sign = a->sign;
+
+  /* alias for a->dp [source] */
+  tmpa = a->dp;
+
+  /* alias for c->dp [dest] */
+  tmpc = c->dp;
+
+  /* zero carry */
+  u = 0;
+
+  /* compute columns */
+  for (ix = 0; ix < a->used; ix++) {
+    /* compute product and carry sum for this term */
+    r       = ((mp_word) u) + ((mp_word)*tmpa++) * ((mp_word)b);
+
+    /* mask off higher bits to get a single digit */
+    *tmpc++ = (mp_digit) (r & ((mp_word) MP_MASK));
+
+    /* send carry into next iteration */
+    u       = (mp_digit) (r >> ((mp_word) DIGIT_BIT));
+  }
+
+  /* store final carry [if any] and increment ix offset  */
+  *tmpc++ = u;
+  ++ix;
+
+  /* now zero digits above the top */
+  while (ix++ < olduse) {
+     *tmpc++ = 0;
   }
 
+  /* set used count */
+  c->used = a->used + 1;
+  mp_clamp(c);
+
   return MP_OKAY;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_init_size.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_mul_d.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_init_size.c
+ --   End: vendor/libtommath-0.41/bn_mp_mul_d.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_invmod.c
+ -- Start: vendor/libtommath-0.41/bn_mp_mulhi.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_INVMOD_C
+#ifdef BN_MP_MULHI_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -3820,41 +7244,214 @@ int mp_init_size (mp_int * a, int size)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* hac 14.61, pp608 */
-int mp_invmod (mp_int * a, mp_int * b, mp_int * c)
+/* c = the columns of |a| * |b| from digs up, the high short product
+ *
+ * Like s_mp_mul_high_digs the partial products a[i]*b[j] with i + j below
+ * digs are left out and the digits of c below digs are zero.  A column
+ * holds at most MIN(a->used, b->used) products so c is short of |a| * |b|
+ * by less than that times 2**(DIGIT_BIT*(digs+1)), callers that want the
+ * product div B**k within one ask for the columns from k - 2 up.  Some
+ * products under digs are counted all the same, what they carry over
+ * only makes c closer.
+ *
+ * Small ones are the comba.  From the Karatsuba cutoff up this is
+ * Mulders' split turned around: with a1 and b1 the top p digits of a and
+ * b, p about 0.7 of the columns wanted, a1*b1 is a whole product for
+ * mp_mul and a1*b0 and a0*b are high short products again.  The digits
+ * of a that only meet the left out columns are dropped before each split
+ * and likewise for b.
+ *
+ * The pieces of a and b are windows on their digits, only ever read.
+ */
+
+/* r += (t div B**from) * B**(at+from), r has room for it */
+static void s_mp_mulhi_add (mp_int * r, mp_int * t, int at, int from)
 {
-  /* b cannot be negative */
-  if (b->sign == MP_NEG || mp_iszero(b) == 1) {
-    return MP_VAL;
-  }
+  mp_digit u, *tmpr, *tmpt;
+  int      ix;
+#ifdef MP_64BIT_FULL
+  mp_word  w;
+#endif
 
-#ifdef BN_FAST_MP_INVMOD_C
-  /* if the modulus is odd we can use a faster routine instead */
-  if (mp_isodd (b) == 1) {
-    return fast_mp_invmod (a, b, c);
+  if (from >= t->used) {
+    return;
+  }
+  tmpr = r->dp + at + from;
+  tmpt = t->dp + from;
+  u    = 0;
+#ifdef MP_64BIT_FULL
+  for (ix = from; ix < t->used; ix++) {
+    w       = ((mp_word)*tmpr) + ((mp_word)*tmpt++) + ((mp_word)u);
+    *tmpr++ = (mp_digit)w;
+    u       = (mp_digit)(w >> ((mp_word)DIGIT_BIT));
+  }
+  while (u != 0) {
+    *tmpr += u;
+    u      = (*tmpr++ < u);
+  }
+#else
+  for (ix = from; ix < t->used; ix++) {
+    *tmpr += *tmpt++ + u;
+    u      = *tmpr >> ((mp_digit)DIGIT_BIT);
+    *tmpr++ &= MP_MASK;
+  }
+  while (u != 0) {
+    *tmpr += u;
+    u      = *tmpr >> ((mp_digit)DIGIT_BIT);
+    *tmpr++ &= MP_MASK;
   }
 #endif
+}
 
-#ifdef BN_MP_INVMOD_SLOW_C
-  return mp_invmod_slow(a, b, c);
-#endif
+/* a window on the digits from..to-1 of a */
+static void s_mp_mulhi_window (mp_int * a, int from, int to, mp_int * w)
+{
+  to       = MIN (to, a->used);
+  from     = MIN (from, to);
+  w->dp    = a->dp + from;
+  w->used  = to - from;
+  w->alloc = to - from;
+  w->sign  = MP_ZPOS;
+  mp_clamp (w);
+}
 
-  return MP_VAL;
+/* r += (the columns of a * b from digs up) * B**at, t is scratch */
+static int s_mp_mulhi (mp_int * a, mp_int * b, mp_int * r, int at, int digs, mp_int * t)
+{
+  mp_int  x, y;
+  int     res, p, lo;
+
+  if (a->used == 0 || b->used == 0 || a->used + b->used - 2 < digs) {
+    return MP_OKAY;
+  }
+
+  /* digits of a below digs - (b->used - 1) meet no column that counts */
+  x  = *a;
+  y  = *b;
+  lo = digs - (y.used - 1);
+  if (lo > 0) {
+    s_mp_mulhi_window (a, lo, a->used, &x);
+    at   += lo;
+    digs -= lo;
+  }
+  lo = digs - (x.used - 1);
+  if (lo > 0) {
+    s_mp_mulhi_window (b, lo, b->used, &y);
+    at   += lo;
+    digs -= lo;
+  }
+
+  /* all of it? */
+  if (digs <= 0 || MP_FFT_SIZE (MIN (x.used, y.used))) {
+    if ((res = mp_mul (&x, &y, t)) != MP_OKAY) {
+      return res;
+    }
+    s_mp_mulhi_add (r, t, at, 0);
+    return MP_OKAY;
+  }
+  if (MIN (x.used, y.used) < KARATSUBA_MUL_CUTOFF) {
+    if ((res = s_mp_mul_high_digs (&x, &y, t, digs)) != MP_OKAY) {
+      return res;
+    }
+    s_mp_mulhi_add (r, t, at, digs);
+    return MP_OKAY;
+  }
+
+  p = x.used + y.used - 1 - digs;
+  p = MIN (MIN (x.used, y.used), p - (3 * p) / 10);
+
+  /* a1*b1 */
+  {
+    mp_int  x1, y1;
+
+    s_mp_mulhi_window (&x, x.used - p, x.used, &x1);
+    s_mp_mulhi_window (&y, y.used - p, y.used, &y1);
+    if ((res = mp_mul (&x1, &y1, t)) != MP_OKAY) {
+      return res;
+    }
+    s_mp_mulhi_add (r, t, at + (x.used - p) + (y.used - p), 0);
+
+    /* a1*b0 */
+    s_mp_mulhi_window (&y, 0, y.used - p, &y1);
+    if ((res = s_mp_mulhi (&x1, &y1, r, at + (x.used - p), digs - (x.used - p), t)) != MP_OKAY) {
+      return res;
+    }
+  }
+
+  /* a0*b */
+  {
+    mp_int  x0;
+
+    s_mp_mulhi_window (&x, 0, x.used - p, &x0);
+    if ((res = s_mp_mulhi (&x0, &y, r, at, digs, t)) != MP_OKAY) {
+      return res;
+    }
+  }
+  return MP_OKAY;
 }
+
+int mp_mulhi (mp_int * a, mp_int * b, mp_int * c, int digs)
+{
+  mp_int  r, t;
+  int     res, ix;
+  size_t  mark;
+
+  if (digs < 0) {
+    digs = 0;
+  }
+
+  /* the comba does it in one go, it leaves what was below digs in c */
+  if (MIN (a->used, b->used) < KARATSUBA_MUL_CUTOFF) {
+    if ((res = s_mp_mul_high_digs (a, b, c, digs)) != MP_OKAY) {
+      return res;
+    }
+    for (ix = 0; ix < MIN (digs, c->used); ix++) {
+      c->dp[ix] = 0;
+    }
+    mp_clamp (c);
+    return MP_OKAY;
+  }
+
+  mark = XSCRATCH_MARK();
+  XSCRATCH_RESERVE(sizeof(mp_digit) * 8 * (2 * (a->used + b->used) + 8 * MP_PREC));
+  if ((res = mp_init_size (&r, a->used + b->used + 1)) != MP_OKAY) {
+    goto LBL_MARK;
+  }
+  if ((res = mp_init_scratch (&t, a->used + b->used + 2)) != MP_OKAY) {
+    goto LBL_R;
+  }
+
+  if ((res = s_mp_mulhi (a, b, &r, 0, digs, &t)) != MP_OKAY) {
+    goto LBL_T;
+  }
+  r.used = a->used + b->used + 1;
+  for (ix = 0; ix < MIN (digs, r.used); ix++) {
+    r.dp[ix] = 0;
+  }
+  mp_clamp (&r);
+  mp_exch (&r, c);
+
+LBL_T:mp_clear (&t);
+LBL_R:mp_clear (&r);
+LBL_MARK:
+  XSCRATCH_RELEASE(mark);
+  return res;
+}
+
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_invmod.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_mulhi.c,v $ */
+/* $Revision: 1.1 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_invmod.c
+ --   End: vendor/libtommath-0.41/bn_mp_mulhi.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_invmod_slow.c
+ -- Start: vendor/libtommath-0.41/bn_mp_mullo.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_INVMOD_SLOW_C
+#ifdef BN_MP_MULLO_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -3870,173 +7467,183 @@ int mp_invmod (mp_int * a, mp_int * b, mp_int * c)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* hac 14.61, pp608 */
-int mp_invmod_slow (mp_int * a, mp_int * b, mp_int * c)
-{
-  mp_int  x, y, u, v, A, B, C, D;
-  int     res;
-
-  /* b cannot be negative */
-  if (b->sign == MP_NEG || mp_iszero(b) == 1) {
-    return MP_VAL;
-  }
+/* c = |a| * |b| mod 2**(DIGIT_BIT*digs), the low short product
+ *
+ * Small ones are the comba, which only forms the columns it needs.  From
+ * the Karatsuba cutoff up this is Mulders' split: for p about 0.7*digs,
+ * a = a1*B**p + a0 and b = b1*B**p + b0,
+ *
+ *   a*b = a0*b0 + (a1*b0 + a0*b1)*B**p   mod B**digs
+ *
+ * where a0*b0 is a whole product for mp_mul and the other two are short
+ * products of digs - p digits, split the same way.  With Karatsuba that
+ * is about 0.8 of the whole product.  An FFT multiplies the whole lot as
+ * fast as the split so past its cutoff the product is not split.
+ *
+ * The pieces of a and b are windows on their digits, only ever read.
+ */
 
-  /* init temps */
-  if ((res = mp_init_multi(&x, &y, &u, &v, 
-                           &A, &B, &C, &D, NULL)) != MP_OKAY) {
-     return res;
+/* r += t * B**at mod B**limit, r has limit digits */
+static void s_mp_mullo_add (mp_int * r, mp_int * t, int at, int limit)
+{
+  mp_digit u, *tmpr, *tmpt;
+  int      ix, n;
+#ifdef MP_64BIT_FULL
+  mp_word  w;
+#endif
+
+  n    = MIN (t->used, limit - at);
+  tmpr = r->dp + at;
+  tmpt = t->dp;
+  u    = 0;
+#ifdef MP_64BIT_FULL
+  for (ix = 0; ix < n; ix++) {
+    w       = ((mp_word)*tmpr) + ((mp_word)*tmpt++) + ((mp_word)u);
+    *tmpr++ = (mp_digit)w;
+    u       = (mp_digit)(w >> ((mp_word)DIGIT_BIT));
+  }
+  for (ix += at; u != 0 && ix < limit; ix++) {
+    *tmpr += u;
+    u      = (*tmpr++ < u);
   }
-
-  /* x = a, y = b */
-  if ((res = mp_mod(a, b, &x)) != MP_OKAY) {
-      goto LBL_ERR;
+#else
+  for (ix = 0; ix < n; ix++) {
+    *tmpr += *tmpt++ + u;
+    u      = *tmpr >> ((mp_digit)DIGIT_BIT);
+    *tmpr++ &= MP_MASK;
   }
-  if ((res = mp_copy (b, &y)) != MP_OKAY) {
-    goto LBL_ERR;
+  for (ix += at; u != 0 && ix < limit; ix++) {
+    *tmpr += u;
+    u      = *tmpr >> ((mp_digit)DIGIT_BIT);
+    *tmpr++ &= MP_MASK;
   }
+#endif
+}
 
-  /* 2. [modified] if x,y are both even then return an error! */
-  if (mp_iseven (&x) == 1 && mp_iseven (&y) == 1) {
-    res = MP_VAL;
-    goto LBL_ERR;
-  }
+/* a window on the digits from..to-1 of a */
+static void s_mp_mullo_window (mp_int * a, int from, int to, mp_int * w)
+{
+  to       = MIN (to, a->used);
+  from     = MIN (from, to);
+  w->dp    = a->dp + from;
+  w->used  = to - from;
+  w->alloc = to - from;
+  w->sign  = MP_ZPOS;
+  mp_clamp (w);
+}
 
-  /* 3. u=x, v=y, A=1, B=0, C=0,D=1 */
-  if ((res = mp_copy (&x, &u)) != MP_OKAY) {
-    goto LBL_ERR;
-  }
-  if ((res = mp_copy (&y, &v)) != MP_OKAY) {
-    goto LBL_ERR;
-  }
-  mp_set (&A, 1);
-  mp_set (&D, 1);
+/* r += (a * b mod B**digs) * B**at, t is scratch */
+static int s_mp_mullo (mp_int * a, mp_int * b, mp_int * r, int at, int digs, mp_int * t)
+{
+  mp_int  x, y;
+  int     res, p, limit;
 
-top:
-  /* 4.  while u is even do */
-  while (mp_iseven (&u) == 1) {
-    /* 4.1 u = u/2 */
-    if ((res = mp_div_2 (&u, &u)) != MP_OKAY) {
-      goto LBL_ERR;
-    }
-    /* 4.2 if A or B is odd then */
-    if (mp_isodd (&A) == 1 || mp_isodd (&B) == 1) {
-      /* A = (A+y)/2, B = (B-x)/2 */
-      if ((res = mp_add (&A, &y, &A)) != MP_OKAY) {
-         goto LBL_ERR;
-      }
-      if ((res = mp_sub (&B, &x, &B)) != MP_OKAY) {
-         goto LBL_ERR;
-      }
-    }
-    /* A = A/2, B = B/2 */
-    if ((res = mp_div_2 (&A, &A)) != MP_OKAY) {
-      goto LBL_ERR;
-    }
-    if ((res = mp_div_2 (&B, &B)) != MP_OKAY) {
-      goto LBL_ERR;
-    }
+  limit = at + digs;
+  s_mp_mullo_window (a, 0, digs, &x);
+  s_mp_mullo_window (b, 0, digs, &y);
+  if (x.used == 0 || y.used == 0) {
+    return MP_OKAY;
   }
 
-  /* 5.  while v is even do */
-  while (mp_iseven (&v) == 1) {
-    /* 5.1 v = v/2 */
-    if ((res = mp_div_2 (&v, &v)) != MP_OKAY) {
-      goto LBL_ERR;
-    }
-    /* 5.2 if C or D is odd then */
-    if (mp_isodd (&C) == 1 || mp_isodd (&D) == 1) {
-      /* C = (C+y)/2, D = (D-x)/2 */
-      if ((res = mp_add (&C, &y, &C)) != MP_OKAY) {
-         goto LBL_ERR;
-      }
-      if ((res = mp_sub (&D, &x, &D)) != MP_OKAY) {
-         goto LBL_ERR;
-      }
-    }
-    /* C = C/2, D = D/2 */
-    if ((res = mp_div_2 (&C, &C)) != MP_OKAY) {
-      goto LBL_ERR;
+  /* nothing to leave out, too small to split or an FFT's? */
+  if (x.used + y.used <= digs || MP_FFT_SIZE (MIN (x.used, y.used))) {
+    if ((res = mp_mul (&x, &y, t)) != MP_OKAY) {
+      return res;
     }
-    if ((res = mp_div_2 (&D, &D)) != MP_OKAY) {
-      goto LBL_ERR;
+    s_mp_mullo_add (r, t, at, limit);
+    return MP_OKAY;
+  }
+  if (MIN (x.used, y.used) < KARATSUBA_MUL_CUTOFF) {
+    if ((res = s_mp_mul_digs (&x, &y, t, digs)) != MP_OKAY) {
+      return res;
     }
+    s_mp_mullo_add (r, t, at, limit);
+    return MP_OKAY;
   }
 
-  /* 6.  if u >= v then */
-  if (mp_cmp (&u, &v) != MP_LT) {
-    /* u = u - v, A = A - C, B = B - D */
-    if ((res = mp_sub (&u, &v, &u)) != MP_OKAY) {
-      goto LBL_ERR;
-    }
+  p = digs - (3 * digs) / 10;
 
-    if ((res = mp_sub (&A, &C, &A)) != MP_OKAY) {
-      goto LBL_ERR;
-    }
+  /* a0*b0 */
+  {
+    mp_int  x0, y0;
 
-    if ((res = mp_sub (&B, &D, &B)) != MP_OKAY) {
-      goto LBL_ERR;
-    }
-  } else {
-    /* v - v - u, C = C - A, D = D - B */
-    if ((res = mp_sub (&v, &u, &v)) != MP_OKAY) {
-      goto LBL_ERR;
+    s_mp_mullo_window (&x, 0, p, &x0);
+    s_mp_mullo_window (&y, 0, p, &y0);
+    if ((res = mp_mul (&x0, &y0, t)) != MP_OKAY) {
+      return res;
     }
+    s_mp_mullo_add (r, t, at, limit);
+  }
 
-    if ((res = mp_sub (&C, &A, &C)) != MP_OKAY) {
-      goto LBL_ERR;
-    }
+  /* a1*b and a0*b1, b and a0 are cut to digs - p digits in there */
+  {
+    mp_int  x1, y1;
 
-    if ((res = mp_sub (&D, &B, &D)) != MP_OKAY) {
-      goto LBL_ERR;
+    s_mp_mullo_window (&x, p, digs, &x1);
+    if ((res = s_mp_mullo (&x1, &y, r, at + p, digs - p, t)) != MP_OKAY) {
+      return res;
+    }
+    s_mp_mullo_window (&y, p, digs, &y1);
+    if ((res = s_mp_mullo (&x, &y1, r, at + p, digs - p, t)) != MP_OKAY) {
+      return res;
     }
   }
+  return MP_OKAY;
+}
 
-  /* if not zero goto step 4 */
-  if (mp_iszero (&u) == 0)
-    goto top;
+int mp_mullo (mp_int * a, mp_int * b, mp_int * c, int digs)
+{
+  mp_int  r, t;
+  int     res;
+  size_t  mark;
 
-  /* now a = C, b = D, gcd == g*v */
+  if (digs <= 0) {
+    mp_zero (c);
+    return MP_OKAY;
+  }
 
-  /* if v != 1 then there is no inverse */
-  if (mp_cmp_d (&v, 1) != MP_EQ) {
-    res = MP_VAL;
-    goto LBL_ERR;
+  /* the comba does it in one go */
+  if (MIN (a->used, b->used) < KARATSUBA_MUL_CUTOFF) {
+    return s_mp_mul_digs (a, b, c, digs);
   }
 
-  /* if its too low */
-  while (mp_cmp_d(&C, 0) == MP_LT) {
-      if ((res = mp_add(&C, b, &C)) != MP_OKAY) {
-         goto LBL_ERR;
-      }
+  mark = XSCRATCH_MARK();
+  XSCRATCH_RESERVE(sizeof(mp_digit) * 8 * (2 * digs + 8 * MP_PREC));
+  if ((res = mp_init_size (&r, digs)) != MP_OKAY) {
+    goto LBL_MARK;
   }
-  
-  /* too big */
-  while (mp_cmp_mag(&C, b) != MP_LT) {
-      if ((res = mp_sub(&C, b, &C)) != MP_OKAY) {
-         goto LBL_ERR;
-      }
+  if ((res = mp_init_scratch (&t, 2 * digs + 2)) != MP_OKAY) {
+    goto LBL_R;
   }
-  
-  /* C is now the inverse */
-  mp_exch (&C, c);
-  res = MP_OKAY;
-LBL_ERR:mp_clear_multi (&x, &y, &u, &v, &A, &B, &C, &D, NULL);
+
+  if ((res = s_mp_mullo (a, b, &r, 0, digs, &t)) != MP_OKAY) {
+    goto LBL_T;
+  }
+  r.used = digs;
+  mp_clamp (&r);
+  mp_exch (&r, c);
+
+LBL_T:mp_clear (&t);
+LBL_R:mp_clear (&r);
+LBL_MARK:
+  XSCRATCH_RELEASE(mark);
   return res;
 }
+
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_invmod_slow.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_mullo.c,v $ */
+/* $Revision: 1.1 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_invmod_slow.c
+ --   End: vendor/libtommath-0.41/bn_mp_mullo.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_is_square.c
+ -- Start: vendor/libtommath-0.41/bn_mp_mulmod.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_IS_SQUARE_C
+#ifdef BN_MP_MULMOD_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -4052,107 +7659,38 @@ LBL_ERR:mp_clear_multi (&x, &y, &u, &v, &A, &B, &C, &D, NULL);
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* Check if remainders are possible squares - fast exclude non-squares */
-static const char rem_128[128] = {
- 0, 0, 1, 1, 0, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1,
- 0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1,
- 1, 0, 1, 1, 0, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1,
- 1, 0, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1,
- 0, 0, 1, 1, 0, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1,
- 1, 0, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1,
- 1, 0, 1, 1, 0, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1,
- 1, 0, 1, 1, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1, 1
-};
-
-static const char rem_105[105] = {
- 0, 0, 1, 1, 0, 1, 1, 1, 1, 0, 1, 1, 1, 1, 1,
- 0, 0, 1, 1, 1, 1, 0, 1, 1, 1, 0, 1, 1, 1, 1,
- 0, 1, 1, 1, 1, 1, 0, 1, 1, 0, 1, 1, 1, 1, 1,
- 1, 0, 1, 1, 0, 1, 0, 1, 1, 1, 1, 1, 1, 1, 1,
- 0, 1, 1, 1, 0, 1, 1, 1, 1, 1, 0, 1, 1, 1, 1,
- 1, 1, 1, 1, 0, 1, 0, 1, 1, 0, 0, 1, 1, 1, 1,
- 1, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0, 1, 1, 1, 1
-};
-
-/* Store non-zero to ret if arg is square, and zero if not */
-int mp_is_square(mp_int *arg,int *ret) 
+/* d = a * b (mod c) */
+int mp_mulmod (mp_int * a, mp_int * b, mp_int * c, mp_int * d)
 {
-  int           res;
-  mp_digit      c;
-  mp_int        t;
-  unsigned long r;
-
-  /* Default to Non-square :) */
-  *ret = MP_NO; 
-
-  if (arg->sign == MP_NEG) {
-    return MP_VAL;
-  }
-
-  /* digits used?  (TSD) */
-  if (arg->used == 0) {
-     return MP_OKAY;
-  }
-
-  /* First check mod 128 (suppose that DIGIT_BIT is at least 7) */
-  if (rem_128[127 & DIGIT(arg,0)] == 1) {
-     return MP_OKAY;
-  }
-
-  /* Next check mod 105 (3*5*7) */
-  if ((res = mp_mod_d(arg,105,&c)) != MP_OKAY) {
-     return res;
-  }
-  if (rem_105[c] == 1) {
-     return MP_OKAY;
-  }
-
+  int     res;
+  mp_int  t;
 
-  if ((res = mp_init_set_int(&t,11L*13L*17L*19L*23L*29L*31L)) != MP_OKAY) {
-     return res;
-  }
-  if ((res = mp_mod(arg,&t,&t)) != MP_OKAY) {
-     goto ERR;
+  if ((res = mp_init (&t)) != MP_OKAY) {
+    return res;
   }
-  r = mp_get_int(&t);
-  /* Check for other prime modules, note it's not an ERROR but we must
-   * free "t" so the easiest way is to goto ERR.  We know that res
-   * is already equal to MP_OKAY from the mp_mod call 
-   */ 
-  if ( (1L<<(r%11)) & 0x5C4L )             goto ERR;
-  if ( (1L<<(r%13)) & 0x9E4L )             goto ERR;
-  if ( (1L<<(r%17)) & 0x5CE8L )            goto ERR;
-  if ( (1L<<(r%19)) & 0x4F50CL )           goto ERR;
-  if ( (1L<<(r%23)) & 0x7ACCA0L )          goto ERR;
-  if ( (1L<<(r%29)) & 0xC2EDD0CL )         goto ERR;
-  if ( (1L<<(r%31)) & 0x6DE2B848L )        goto ERR;
 
-  /* Final check - is sqr(sqrt(arg)) == arg ? */
-  if ((res = mp_sqrt(arg,&t)) != MP_OKAY) {
-     goto ERR;
-  }
-  if ((res = mp_sqr(&t,&t)) != MP_OKAY) {
-     goto ERR;
+  if ((res = mp_mul (a, b, &t)) != MP_OKAY) {
+    mp_clear (&t);
+    return res;
   }
-
-  *ret = (mp_cmp_mag(&t,arg) == MP_EQ) ? MP_YES : MP_NO;
-ERR:mp_clear(&t);
+  res = mp_mod (&t, c, d);
+  mp_clear (&t);
   return res;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_is_square.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_mulmod.c,v $ */
+/* $Revision: 1.5 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_is_square.c
+ --   End: vendor/libtommath-0.41/bn_mp_mulmod.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_jacobi.c
+ -- Start: vendor/libtommath-0.41/bn_mp_n_root.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_JACOBI_C
+#ifdef BN_MP_N_ROOT_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -4168,103 +7706,130 @@ ERR:mp_clear(&t);
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* computes the jacobi c = (a | n) (or Legendre if n is prime)
- * HAC pp. 73 Algorithm 2.149
+/* find the n'th root of an integer 
+ *
+ * Result found such that (c)**b <= a and (c+1)**b > a 
+ *
+ * This algorithm uses Newton's approximation 
+ * x[i+1] = x[i] - f(x[i])/f'(x[i]) 
+ * which will find the root in log(N) time where 
+ * each step involves a fair bit.  This is not meant to 
+ * find huge roots [square and cube, etc].
  */
-int mp_jacobi (mp_int * a, mp_int * p, int *c)
+int mp_n_root (mp_int * a, mp_digit b, mp_int * c)
 {
-  mp_int  a1, p1;
-  int     k, s, r, res;
-  mp_digit residue;
+  mp_int  t1, t2, t3;
+  int     res, neg;
 
-  /* if p <= 0 return MP_VAL */
-  if (mp_cmp_d(p, 0) != MP_GT) {
-     return MP_VAL;
+  /* input must be positive if b is even */
+  if ((b & 1) == 0 && a->sign == MP_NEG) {
+    return MP_VAL;
   }
 
-  /* step 1.  if a == 0, return 0 */
-  if (mp_iszero (a) == 1) {
-    *c = 0;
-    return MP_OKAY;
+  if ((res = mp_init (&t1)) != MP_OKAY) {
+    return res;
   }
 
-  /* step 2.  if a == 1, return 1 */
-  if (mp_cmp_d (a, 1) == MP_EQ) {
-    *c = 1;
-    return MP_OKAY;
+  if ((res = mp_init (&t2)) != MP_OKAY) {
+    goto LBL_T1;
   }
 
-  /* default */
-  s = 0;
-
-  /* step 3.  write a = a1 * 2**k  */
-  if ((res = mp_init_copy (&a1, a)) != MP_OKAY) {
-    return res;
+  if ((res = mp_init (&t3)) != MP_OKAY) {
+    goto LBL_T2;
   }
 
-  if ((res = mp_init (&p1)) != MP_OKAY) {
-    goto LBL_A1;
-  }
+  /* if a is negative fudge the sign but keep track */
+  neg     = a->sign;
+  a->sign = MP_ZPOS;
 
-  /* divide out larger power of two */
-  k = mp_cnt_lsb(&a1);
-  if ((res = mp_div_2d(&a1, k, &a1, NULL)) != MP_OKAY) {
-     goto LBL_P1;
-  }
+  /* t2 = 2 */
+  mp_set (&t2, 2);
 
-  /* step 4.  if e is even set s=1 */
-  if ((k & 1) == 0) {
-    s = 1;
-  } else {
-    /* else set s=1 if p = 1/7 (mod 8) or s=-1 if p = 3/5 (mod 8) */
-    residue = p->dp[0] & 7;
+  do {
+    /* t1 = t2 */
+    if ((res = mp_copy (&t2, &t1)) != MP_OKAY) {
+      goto LBL_T3;
+    }
 
-    if (residue == 1 || residue == 7) {
-      s = 1;
-    } else if (residue == 3 || residue == 5) {
-      s = -1;
+    /* t2 = t1 - ((t1**b - a) / (b * t1**(b-1))) */
+    
+    /* t3 = t1**(b-1) */
+    if ((res = mp_expt_d (&t1, b - 1, &t3)) != MP_OKAY) {   
+      goto LBL_T3;
     }
-  }
 
-  /* step 5.  if p == 3 (mod 4) *and* a1 == 3 (mod 4) then s = -s */
-  if ( ((p->dp[0] & 3) == 3) && ((a1.dp[0] & 3) == 3)) {
-    s = -s;
-  }
+    /* numerator */
+    /* t2 = t1**b */
+    if ((res = mp_mul (&t3, &t1, &t2)) != MP_OKAY) {    
+      goto LBL_T3;
+    }
 
-  /* if a1 == 1 we're done */
-  if (mp_cmp_d (&a1, 1) == MP_EQ) {
-    *c = s;
-  } else {
-    /* n1 = n mod a1 */
-    if ((res = mp_mod (p, &a1, &p1)) != MP_OKAY) {
-      goto LBL_P1;
+    /* t2 = t1**b - a */
+    if ((res = mp_sub (&t2, a, &t2)) != MP_OKAY) {  
+      goto LBL_T3;
     }
-    if ((res = mp_jacobi (&p1, &a1, &r)) != MP_OKAY) {
-      goto LBL_P1;
+
+    /* denominator */
+    /* t3 = t1**(b-1) * b  */
+    if ((res = mp_mul_d (&t3, b, &t3)) != MP_OKAY) {    
+      goto LBL_T3;
+    }
+
+    /* t3 = (t1**b - a)/(b * t1**(b-1)) */
+    if ((res = mp_div (&t2, &t3, &t3, NULL)) != MP_OKAY) {  
+      goto LBL_T3;
+    }
+
+    if ((res = mp_sub (&t1, &t3, &t2)) != MP_OKAY) {
+      goto LBL_T3;
+    }
+  }  while (mp_cmp (&t1, &t2) != MP_EQ);
+
+  /* result can be off by a few so check */
+  for (;;) {
+    if ((res = mp_expt_d (&t1, b, &t2)) != MP_OKAY) {
+      goto LBL_T3;
+    }
+
+    if (mp_cmp (&t2, a) == MP_GT) {
+      if ((res = mp_sub_d (&t1, 1, &t1)) != MP_OKAY) {
+         goto LBL_T3;
+      }
+    } else {
+      break;
     }
-    *c = s * r;
   }
 
-  /* done */
+  /* reset the sign of a first */
+  a->sign = neg;
+
+  /* set the result */
+  mp_exch (&t1, c);
+
+  /* set the sign of the result */
+  c->sign = neg;
+
   res = MP_OKAY;
-LBL_P1:mp_clear (&p1);
-LBL_A1:mp_clear (&a1);
+
+LBL_T3:mp_clear (&t3);
+LBL_T2:mp_clear (&t2);
+LBL_T1:mp_clear (&t1);
   return res;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_jacobi.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_n_root.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_jacobi.c
+ --   End: vendor/libtommath-0.41/bn_mp_n_root.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_karatsuba_mul.c
+ -- Start: vendor/libtommath-0.41/bn_mp_neg.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_KARATSUBA_MUL_C
+#ifdef BN_MP_NEG_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -4280,165 +7845,38 @@ LBL_A1:mp_clear (&a1);
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* c = |a| * |b| using Karatsuba Multiplication using 
- * three half size multiplications
- *
- * Let B represent the radix [e.g. 2**DIGIT_BIT] and 
- * let n represent half of the number of digits in 
- * the min(a,b)
- *
- * a = a1 * B**n + a0
- * b = b1 * B**n + b0
- *
- * Then, a * b => 
-   a1b1 * B**2n + ((a1 + a0)(b1 + b0) - (a0b0 + a1b1)) * B + a0b0
- *
- * Note that a1b1 and a0b0 are used twice and only need to be 
- * computed once.  So in total three half size (half # of 
- * digit) multiplications are performed, a0b0, a1b1 and 
- * (a1+b1)(a0+b0)
- *
- * Note that a multiplication of half the digits requires
- * 1/4th the number of single precision multiplications so in 
- * total after one call 25% of the single precision multiplications 
- * are saved.  Note also that the call to mp_mul can end up back 
- * in this function if the a0, a1, b0, or b1 are above the threshold.  
- * This is known as divide-and-conquer and leads to the famous 
- * O(N**lg(3)) or O(N**1.584) work which is asymptopically lower than 
- * the standard O(N**2) that the baseline/comba methods use.  
- * Generally though the overhead of this method doesn't pay off 
- * until a certain size (N ~ 80) is reached.
- */
-int mp_karatsuba_mul (mp_int * a, mp_int * b, mp_int * c)
+/* b = -a */
+int mp_neg (mp_int * a, mp_int * b)
 {
-  mp_int  x0, x1, y0, y1, t1, x0y0, x1y1;
-  int     B, err;
-
-  /* default the return code to an error */
-  err = MP_MEM;
-
-  /* min # of digits */
-  B = MIN (a->used, b->used);
-
-  /* now divide in two */
-  B = B >> 1;
-
-  /* init copy all the temps */
-  if (mp_init_size (&x0, B) != MP_OKAY)
-    goto ERR;
-  if (mp_init_size (&x1, a->used - B) != MP_OKAY)
-    goto X0;
-  if (mp_init_size (&y0, B) != MP_OKAY)
-    goto X1;
-  if (mp_init_size (&y1, b->used - B) != MP_OKAY)
-    goto Y0;
-
-  /* init temps */
-  if (mp_init_size (&t1, B * 2) != MP_OKAY)
-    goto Y1;
-  if (mp_init_size (&x0y0, B * 2) != MP_OKAY)
-    goto T1;
-  if (mp_init_size (&x1y1, B * 2) != MP_OKAY)
-    goto X0Y0;
-
-  /* now shift the digits */
-  x0.used = y0.used = B;
-  x1.used = a->used - B;
-  y1.used = b->used - B;
-
-  {
-    register int x;
-    register mp_digit *tmpa, *tmpb, *tmpx, *tmpy;
-
-    /* we copy the digits directly instead of using higher level functions
-     * since we also need to shift the digits
-     */
-    tmpa = a->dp;
-    tmpb = b->dp;
-
-    tmpx = x0.dp;
-    tmpy = y0.dp;
-    for (x = 0; x < B; x++) {
-      *tmpx++ = *tmpa++;
-      *tmpy++ = *tmpb++;
-    }
-
-    tmpx = x1.dp;
-    for (x = B; x < a->used; x++) {
-      *tmpx++ = *tmpa++;
-    }
-
-    tmpy = y1.dp;
-    for (x = B; x < b->used; x++) {
-      *tmpy++ = *tmpb++;
-    }
+  int     res;
+  if (a != b) {
+     if ((res = mp_copy (a, b)) != MP_OKAY) {
+        return res;
+     }
   }
 
-  /* only need to clamp the lower words since by definition the 
-   * upper words x1/y1 must have a known number of digits
-   */
-  mp_clamp (&x0);
-  mp_clamp (&y0);
-
-  /* now calc the products x0y0 and x1y1 */
-  /* after this x0 is no longer required, free temp [x0==t2]! */
-  if (mp_mul (&x0, &y0, &x0y0) != MP_OKAY)  
-    goto X1Y1;          /* x0y0 = x0*y0 */
-  if (mp_mul (&x1, &y1, &x1y1) != MP_OKAY)
-    goto X1Y1;          /* x1y1 = x1*y1 */
-
-  /* now calc x1+x0 and y1+y0 */
-  if (s_mp_add (&x1, &x0, &t1) != MP_OKAY)
-    goto X1Y1;          /* t1 = x1 - x0 */
-  if (s_mp_add (&y1, &y0, &x0) != MP_OKAY)
-    goto X1Y1;          /* t2 = y1 - y0 */
-  if (mp_mul (&t1, &x0, &t1) != MP_OKAY)
-    goto X1Y1;          /* t1 = (x1 + x0) * (y1 + y0) */
-
-  /* add x0y0 */
-  if (mp_add (&x0y0, &x1y1, &x0) != MP_OKAY)
-    goto X1Y1;          /* t2 = x0y0 + x1y1 */
-  if (s_mp_sub (&t1, &x0, &t1) != MP_OKAY)
-    goto X1Y1;          /* t1 = (x1+x0)*(y1+y0) - (x1y1 + x0y0) */
-
-  /* shift by B */
-  if (mp_lshd (&t1, B) != MP_OKAY)
-    goto X1Y1;          /* t1 = (x0y0 + x1y1 - (x1-x0)*(y1-y0))<<B */
-  if (mp_lshd (&x1y1, B * 2) != MP_OKAY)
-    goto X1Y1;          /* x1y1 = x1y1 << 2*B */
-
-  if (mp_add (&x0y0, &t1, &t1) != MP_OKAY)
-    goto X1Y1;          /* t1 = x0y0 + t1 */
-  if (mp_add (&t1, &x1y1, c) != MP_OKAY)
-    goto X1Y1;          /* t1 = x0y0 + t1 + x1y1 */
-
-  /* Algorithm succeeded set the return code to MP_OKAY */
-  err = MP_OKAY;
+  if (mp_iszero(b) != MP_YES) {
+     b->sign = (a->sign == MP_ZPOS) ? MP_NEG : MP_ZPOS;
+  } else {
+     b->sign = MP_ZPOS;
+  }
 
-X1Y1:mp_clear (&x1y1);
-X0Y0:mp_clear (&x0y0);
-T1:mp_clear (&t1);
-Y1:mp_clear (&y1);
-Y0:mp_clear (&y0);
-X1:mp_clear (&x1);
-X0:mp_clear (&x0);
-ERR:
-  return err;
+  return MP_OKAY;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_karatsuba_mul.c,v $ */
-/* $Revision: 1.6 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_neg.c,v $ */
+/* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_karatsuba_mul.c
+ --   End: vendor/libtommath-0.41/bn_mp_neg.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_karatsuba_sqr.c
+ -- Start: vendor/libtommath-0.41/bn_mp_ntt_mul.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_KARATSUBA_SQR_C
+#if defined(BN_MP_NTT_MUL_C) && defined(MP_64BIT)
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -4454,186 +7892,471 @@ ERR:
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* Karatsuba squaring, computes b = a*a using three 
- * half size squarings
+/* c = |a| * |b| using number theoretic transforms modulo three primes
  *
- * See comments of karatsuba_mul for details.  It 
- * is essentially the same algorithm but merely 
- * tuned to perform recursive squarings.
+ * The digits of a and b are the coefficients of two polynomials and
+ * their product is a cyclic convolution of L = 2**lg points, found with
+ * a transform modulo each of three primes p = c*2**45 + 1 just under
+ * 2**62.  A coefficient of the product is less than
+ * min(a->used, b->used) * 2**(2*DIGIT_BIT), far below the product of the
+ * primes, so it is put back together exactly from its three residues
+ * (Garner's form of the Chinese remainder theorem) and added into the
+ * result at its digit.
+ *
+ * Products modulo p are Montgomery's with R = 2**64 on the 128 bit
+ * mp_word, which is why this is only built with MP_64BIT.  The data is
+ * kept as it is, only the roots are in Montgomery form so a product with
+ * a root is a single reduction.
+ *
+ * Transforms too big for the cache use Bailey's four step method.  The
+ * L points are seen as an N1 x N2 matrix.  The columns are copied out
+ * NTT_COLS at a time, a cache line from every row, and transformed
+ * together in that small block, then every row is twiddled and
+ * transformed while it is in the cache.  The points come out in a scrambled order which does not matter
+ * to the pointwise products, the inverse undoes the steps in reverse.
+ *
+ * When a and b are the same mp_int only one transform per prime is done,
+ * see mp_ntt_sqr.
  */
-int mp_karatsuba_sqr (mp_int * a, mp_int * b)
+
+/* transforms of at most 2**NTT_FLAT_LOG points are done in one go */
+#define NTT_FLAT_LOG  12
+
+/* columns done together in the four step method, a cache line */
+#define NTT_COLS      8
+
+/* p = c*2**45 + 1 and a generator of its multiplicative group */
+static const ulong64 s_ntt_p[3] = {
+  0x3fffc00000000001ULL, 0x3ffac00000000001ULL, 0x3ff8a00000000001ULL
+};
+static const ulong64 s_ntt_g[3] = { 11, 3, 10 };
+
+typedef struct {
+  ulong64 p,      /* the prime */
+          ninv,   /* -1/p mod 2**64 */
+          r2,     /* R**2 mod p */
+          one;    /* R mod p, one in Montgomery form */
+} ntt_mod;
+
+typedef struct {
+  int      lg, lg1, n1, n2;
+  ulong64  w, wi,         /* L-th root of unity and its inverse */
+          *t1, *t1i,      /* powers of the N1-th root and its inverse */
+          *t2, *t2i,      /* powers of the N2-th root and its inverse */
+          *col;           /* N1 x NTT_COLS points copied out of the matrix */
+} ntt_plan;
+
+/* a*b/R mod p for a*b < p*R */
+static ulong64 s_ntt_mul (ulong64 a, ulong64 b, const ntt_mod * m)
 {
-  mp_int  x0, x1, t1, t2, x0x0, x1x1;
-  int     B, err;
+  mp_word  t;
+  ulong64  q;
+
+  t = ((mp_word)a) * ((mp_word)b);
+  q = ((ulong64)t) * m->ninv;
+  t = (t + ((mp_word)q) * ((mp_word)m->p)) >> 64;
+  q = (ulong64)t;
+  return (q >= m->p) ? q - m->p : q;
+}
 
-  err = MP_MEM;
+/* a*b/R mod p but only reduced below 2p, for a < 4p and b < p or a, b < 2p */
+static ulong64 s_ntt_mul_lazy (ulong64 a, ulong64 b, const ntt_mod * m)
+{
+  mp_word  t;
+  ulong64  q;
 
-  /* min # of digits */
-  B = a->used;
+  t = ((mp_word)a) * ((mp_word)b);
+  q = ((ulong64)t) * m->ninv;
+  return (ulong64)((t + ((mp_word)q) * ((mp_word)m->p)) >> 64);
+}
 
-  /* now divide in two */
-  B = B >> 1;
+static ulong64 s_ntt_sub (ulong64 a, ulong64 b, ulong64 p)
+{
+  return (a >= b) ? a - b : a + (p - b);
+}
 
-  /* init copy all the temps */
-  if (mp_init_size (&x0, B) != MP_OKAY)
-    goto ERR;
-  if (mp_init_size (&x1, a->used - B) != MP_OKAY)
-    goto X0;
+/* b**e mod p, for the setup only */
+static ulong64 s_ntt_pow (ulong64 b, ulong64 e, ulong64 p)
+{
+  mp_word  r = 1, x = b;
 
-  /* init temps */
-  if (mp_init_size (&t1, a->used * 2) != MP_OKAY)
-    goto X1;
-  if (mp_init_size (&t2, a->used * 2) != MP_OKAY)
-    goto T1;
-  if (mp_init_size (&x0x0, B * 2) != MP_OKAY)
-    goto T2;
-  if (mp_init_size (&x1x1, (a->used - B) * 2) != MP_OKAY)
-    goto X0X0;
+  while (e != 0) {
+    if (e & 1) {
+      r = (r * x) % p;
+    }
+    x = (x * x) % p;
+    e >>= 1;
+  }
+  return (ulong64)r;
+}
 
-  {
-    register int x;
-    register mp_digit *dst, *src;
+static void s_ntt_mod_setup (ulong64 p, ntt_mod * m)
+{
+  ulong64  inv;
+  mp_word  r;
+  int      x;
 
-    src = a->dp;
+  /* 1/p mod 2**64 by Newton, p*p == 1 mod 8 */
+  inv = p;
+  for (x = 0; x < 5; x++) {
+    inv *= 2 - p * inv;
+  }
+  r = (((mp_word)1) << 64) % p;
 
-    /* now shift the digits */
-    dst = x0.dp;
-    for (x = 0; x < B; x++) {
-      *dst++ = *src++;
+  m->p    = p;
+  m->ninv = (ulong64)0 - inv;
+  m->one  = (ulong64)r;
+  m->r2   = (ulong64)((r * r) % p);
+}
+
+/* a in Montgomery form */
+static ulong64 s_ntt_mont (ulong64 a, const ntt_mod * m)
+{
+  return s_ntt_mul (a, m->r2, m);
+}
+
+/* t[j] = w**j in Montgomery form for 0 <= j < n/2 */
+static void s_ntt_roots (ulong64 * t, int n, ulong64 w, const ntt_mod * m)
+{
+  int      j;
+
+  w = s_ntt_mont (w, m);
+  t[0] = m->one;
+  for (j = 1; j < n / 2; j++) {
+    t[j] = s_ntt_mul (t[j - 1], w, m);
+  }
+}
+
+/* The butterflies keep the points below 2p and only reduce them all the
+ * way at the end, the primes are small enough that 4p does not overflow.
+ */
+
+/* decimation in frequency transform of the n points x[i*stride + k] for
+ * every 0 <= k < cols, from natural to bit reversed order
+ */
+static void s_ntt_dif (ulong64 * x, int n, int stride, int cols,
+                       const ulong64 * t, const ntt_mod * m)
+{
+  ulong64  p2 = 2 * m->p, *u, *v, s, d, w;
+  int      len, step, i, j, k;
+
+  for (len = n >> 1, step = 1; len >= 1; len >>= 1, step <<= 1) {
+    for (i = 0; i < n; i += 2 * len) {
+      for (j = 0; j < len; j++) {
+        w = t[j * step];
+        u = x + (size_t)(i + j) * stride;
+        v = u + (size_t)len * stride;
+        for (k = 0; k < cols; k++) {
+          s    = u[k] + v[k];
+          d    = u[k] - v[k] + p2;
+          u[k] = (s >= p2) ? s - p2 : s;
+          v[k] = s_ntt_mul_lazy (d, w, m);
+        }
+      }
     }
+  }
+}
 
-    dst = x1.dp;
-    for (x = B; x < a->used; x++) {
-      *dst++ = *src++;
+/* decimation in time transform, from bit reversed to natural order */
+static void s_ntt_dit (ulong64 * x, int n, int stride, int cols,
+                       const ulong64 * t, const ntt_mod * m)
+{
+  ulong64  p2 = 2 * m->p, *u, *v, s, d, w;
+  int      len, step, i, j, k;
+
+  for (len = 1, step = n >> 1; len < n; len <<= 1, step >>= 1) {
+    for (i = 0; i < n; i += 2 * len) {
+      for (j = 0; j < len; j++) {
+        w = t[j * step];
+        u = x + (size_t)(i + j) * stride;
+        v = u + (size_t)len * stride;
+        for (k = 0; k < cols; k++) {
+          s    = s_ntt_mul_lazy (v[k], w, m);
+          d    = u[k] - s + p2;
+          s    = u[k] + s;
+          u[k] = (s >= p2) ? s - p2 : s;
+          v[k] = (d >= p2) ? d - p2 : d;
+        }
+      }
     }
   }
+}
 
-  x0.used = B;
-  x1.used = a->used - B;
+/* x[j] *= w**(j*e) for the row of the four step method with index e */
+static void s_ntt_twiddle (ulong64 * x, int n, ulong64 w, ulong64 e,
+                           const ntt_mod * m)
+{
+  ulong64  f;
+  int      j;
 
-  mp_clamp (&x0);
+  w = s_ntt_mont (s_ntt_pow (w, e, m->p), m);
+  f = w;
+  for (j = 1; j < n; j++) {
+    x[j] = s_ntt_mul_lazy (x[j], f, m);
+    f    = s_ntt_mul (f, w, m);
+  }
+}
 
-  /* now calc the products x0*x0 and x1*x1 */
-  if (mp_sqr (&x0, &x0x0) != MP_OKAY)
-    goto X1X1;           /* x0x0 = x0*x0 */
-  if (mp_sqr (&x1, &x1x1) != MP_OKAY)
-    goto X1X1;           /* x1x1 = x1*x1 */
+static ulong64 s_ntt_bitrev (ulong64 x, int bits)
+{
+  ulong64  r = 0;
+
+  while (bits-- > 0) {
+    r = (r << 1) | (x & 1);
+    x >>= 1;
+  }
+  return r;
+}
+
+/* roots for a transform of 2**lg points modulo m->p, t has room for L */
+static void s_ntt_plan (ntt_plan * pl, int lg, int prime, const ntt_mod * m,
+                        ulong64 * t)
+{
+  ulong64  p = m->p;
+
+  pl->lg  = lg;
+  pl->lg1 = (lg > NTT_FLAT_LOG) ? lg / 2 : 0;
+  pl->n1  = 1 << pl->lg1;
+  pl->n2  = 1 << (lg - pl->lg1);
+  pl->w   = s_ntt_pow (s_ntt_g[prime], (p - 1) >> lg, p);
+  pl->wi  = s_ntt_pow (pl->w, p - 2, p);
+
+  pl->t1  = t;
+  pl->t1i = pl->t1 + pl->n1 / 2;
+  pl->t2  = pl->t1i + pl->n1 / 2;
+  pl->t2i = pl->t2 + pl->n2 / 2;
+  pl->col = pl->t2i + pl->n2 / 2;
+  s_ntt_roots (pl->t1, pl->n1, s_ntt_pow (pl->w, pl->n2, p), m);
+  s_ntt_roots (pl->t1i, pl->n1, s_ntt_pow (pl->wi, pl->n2, p), m);
+  s_ntt_roots (pl->t2, pl->n2, s_ntt_pow (pl->w, pl->n1, p), m);
+  s_ntt_roots (pl->t2i, pl->n2, s_ntt_pow (pl->wi, pl->n1, p), m);
+}
+
+/* copy NTT_COLS columns of the matrix into pl->col, or back when back == 1 */
+static void s_ntt_cols (ulong64 * x, const ntt_plan * pl, int back)
+{
+  ulong64 *c = pl->col;
+  int      i, k;
+
+  for (i = 0; i < pl->n1; i++) {
+    for (k = 0; k < NTT_COLS; k++) {
+      if (back == 1) {
+        x[k] = c[k];
+      } else {
+        c[k] = x[k];
+      }
+    }
+    x += pl->n2;
+    c += NTT_COLS;
+  }
+}
 
-  /* now calc (x1+x0)**2 */
-  if (s_mp_add (&x1, &x0, &t1) != MP_OKAY)
-    goto X1X1;           /* t1 = x1 - x0 */
-  if (mp_sqr (&t1, &t1) != MP_OKAY)
-    goto X1X1;           /* t1 = (x1 - x0) * (x1 - x0) */
+static void s_ntt_forward (ulong64 * x, const ntt_plan * pl, const ntt_mod * m)
+{
+  int      i;
 
-  /* add x0y0 */
-  if (s_mp_add (&x0x0, &x1x1, &t2) != MP_OKAY)
-    goto X1X1;           /* t2 = x0x0 + x1x1 */
-  if (s_mp_sub (&t1, &t2, &t1) != MP_OKAY)
-    goto X1X1;           /* t1 = (x1+x0)**2 - (x0x0 + x1x1) */
+  if (pl->n1 == 1) {
+    s_ntt_dif (x, pl->n2, 1, 1, pl->t2, m);
+    return;
+  }
 
-  /* shift by B */
-  if (mp_lshd (&t1, B) != MP_OKAY)
-    goto X1X1;           /* t1 = (x0x0 + x1x1 - (x1-x0)*(x1-x0))<<B */
-  if (mp_lshd (&x1x1, B * 2) != MP_OKAY)
-    goto X1X1;           /* x1x1 = x1x1 << 2*B */
+  /* the columns, each row left with its bit reversed index */
+  for (i = 0; i < pl->n2; i += NTT_COLS) {
+    s_ntt_cols (x + i, pl, 0);
+    s_ntt_dif (pl->col, pl->n1, NTT_COLS, NTT_COLS, pl->t1, m);
+    s_ntt_cols (x + i, pl, 1);
+  }
 
-  if (mp_add (&x0x0, &t1, &t1) != MP_OKAY)
-    goto X1X1;           /* t1 = x0x0 + t1 */
-  if (mp_add (&t1, &x1x1, b) != MP_OKAY)
-    goto X1X1;           /* t1 = x0x0 + t1 + x1x1 */
+  /* then the rows */
+  for (i = 0; i < pl->n1; i++) {
+    s_ntt_twiddle (x + (size_t)i * pl->n2, pl->n2, pl->w,
+                   s_ntt_bitrev (i, pl->lg1), m);
+    s_ntt_dif (x + (size_t)i * pl->n2, pl->n2, 1, 1, pl->t2, m);
+  }
+}
 
-  err = MP_OKAY;
+static void s_ntt_inverse (ulong64 * x, const ntt_plan * pl, const ntt_mod * m)
+{
+  int      i;
 
-X1X1:mp_clear (&x1x1);
-X0X0:mp_clear (&x0x0);
-T2:mp_clear (&t2);
-T1:mp_clear (&t1);
-X1:mp_clear (&x1);
-X0:mp_clear (&x0);
-ERR:
-  return err;
+  if (pl->n1 == 1) {
+    s_ntt_dit (x, pl->n2, 1, 1, pl->t2i, m);
+    return;
+  }
+
+  for (i = 0; i < pl->n1; i++) {
+    s_ntt_dit (x + (size_t)i * pl->n2, pl->n2, 1, 1, pl->t2i, m);
+    s_ntt_twiddle (x + (size_t)i * pl->n2, pl->n2, pl->wi,
+                   s_ntt_bitrev (i, pl->lg1), m);
+  }
+  for (i = 0; i < pl->n2; i += NTT_COLS) {
+    s_ntt_cols (x + i, pl, 0);
+    s_ntt_dit (pl->col, pl->n1, NTT_COLS, NTT_COLS, pl->t1i, m);
+    s_ntt_cols (x + i, pl, 1);
+  }
 }
-#endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_karatsuba_sqr.c,v $ */
-/* $Revision: 1.6 $ */
-/* $Date: 2006/12/28 01:25:13 $ */
-/*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_karatsuba_sqr.c
- ---------------------------------------------------------------------*/
+/* x = a padded with zeros to L points, full digits can be above p */
+static void s_ntt_load (ulong64 * x, mp_int * a, size_t L, ulong64 p)
+{
+  size_t   i;
 
-/*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_lcm.c
- ---------------------------------------------------------------------*/
-#include <tommath.h>
-#ifdef BN_MP_LCM_C
-/* LibTomMath, multiple-precision integer library -- Tom St Denis
- *
- * LibTomMath is a library that provides multiple-precision
- * integer arithmetic as well as number theoretic functionality.
- *
- * The library was designed directly after the MPI library by
- * Michael Fromberger but has been written from scratch with
- * additional optimizations in place.
- *
- * The library is free for all purposes without any express
- * guarantee it works.
- *
- * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
- */
+  for (i = 0; i < (size_t)a->used; i++) {
+#ifdef MP_64BIT_FULL
+    x[i] = ((ulong64)a->dp[i]) % p;
+#else
+    x[i] = a->dp[i];
+#endif
+  }
+#ifndef MP_64BIT_FULL
+  (void)p;
+#endif
+  for (; i < L; i++) {
+    x[i] = 0;
+  }
+}
 
-/* computes least common multiple as |a*b|/(a, b) */
-int mp_lcm (mp_int * a, mp_int * b, mp_int * c)
+int mp_ntt_mul (mp_int * a, mp_int * b, mp_int * c)
 {
-  int     res;
-  mp_int  t1, t2;
+  mp_int   r;
+  ntt_mod  m[3];
+  ntt_plan pl;
+  ulong64 *buf, *x[3], *y, *tw, s, c12, c13, c23, p12lo, p12hi,
+           v1, v2, v3, a0, a1, a2;
+  mp_word  t, t2, u, h;
+  size_t   L, i, mark;
+  int      res, n, lg, j, sqr;
+
+  if (mp_iszero (a) == MP_YES || mp_iszero (b) == MP_YES) {
+    mp_zero (c);
+    return MP_OKAY;
+  }
 
+  sqr = (a == b) ? 1 : 0;
+  n   = a->used + b->used;
+  for (lg = 1; (((size_t)1) << lg) < (size_t)(n - 1); lg++);
+  L   = ((size_t)1) << lg;
 
-  if ((res = mp_init_multi (&t1, &t2, NULL)) != MP_OKAY) {
-    return res;
+  /* the residues for each prime, the transform of b and the roots */
+  mark = XSCRATCH_MARK ();
+  XSCRATCH_RESERVE (sizeof (ulong64) * (sqr ? 4 : 5) * L);
+  buf = OPT_CAST(ulong64) XSCRATCH_ALLOC (sizeof (ulong64) * (sqr ? 4 : 5) * L);
+  if (buf == NULL) {
+    res = MP_MEM;
+    goto LBL_MARK;
   }
+  x[0] = buf;
+  x[1] = x[0] + L;
+  x[2] = x[1] + L;
+  tw   = x[2] + L;
+  y    = tw + L;
 
-  /* t1 = get the GCD of the two inputs */
-  if ((res = mp_gcd (a, b, &t1)) != MP_OKAY) {
-    goto LBL_T;
+  if ((res = mp_init_size (&r, n)) != MP_OKAY) {
+    goto LBL_BUF;
   }
 
-  /* divide the smallest by the GCD */
-  if (mp_cmp_mag(a, b) == MP_LT) {
-     /* store quotient in t2 such that t2 * b is the LCM */
-     if ((res = mp_div(a, &t1, &t2, NULL)) != MP_OKAY) {
-        goto LBL_T;
-     }
-     res = mp_mul(b, &t2, c);
-  } else {
-     /* store quotient in t2 such that t2 * a is the LCM */
-     if ((res = mp_div(b, &t1, &t2, NULL)) != MP_OKAY) {
-        goto LBL_T;
-     }
-     res = mp_mul(a, &t2, c);
+  for (j = 0; j < 3; j++) {
+    s_ntt_mod_setup (s_ntt_p[j], &m[j]);
+    s_ntt_plan (&pl, lg, j, &m[j], tw);
+
+    /* s = R/L in Montgomery form, the pointwise products are
+     * mont(mont(x, s), y) = x*y/L which leaves the inverse exact
+     */
+    s = s_ntt_mont (s_ntt_mont (s_ntt_pow (L % m[j].p, m[j].p - 2, m[j].p), &m[j]), &m[j]);
+
+    s_ntt_load (x[j], a, L, m[j].p);
+    s_ntt_forward (x[j], &pl, &m[j]);
+    if (sqr == 1) {
+      for (i = 0; i < L; i++) {
+        x[j][i] = s_ntt_mul_lazy (s_ntt_mul_lazy (x[j][i], s, &m[j]), x[j][i], &m[j]);
+      }
+    } else {
+      s_ntt_load (y, b, L, m[j].p);
+      s_ntt_forward (y, &pl, &m[j]);
+      for (i = 0; i < L; i++) {
+        x[j][i] = s_ntt_mul_lazy (s_ntt_mul_lazy (x[j][i], s, &m[j]), y[i], &m[j]);
+      }
+    }
+    s_ntt_inverse (x[j], &pl, &m[j]);
+    for (i = 0; i < L; i++) {
+      x[j][i] = (x[j][i] >= m[j].p) ? x[j][i] - m[j].p : x[j][i];
+    }
   }
 
-  /* fix the sign to positive */
-  c->sign = MP_ZPOS;
+  /* Garner: v = v1 + v2*p1 + v3*p1*p2 with
+   *   v2 = (r2 - v1)/p1 mod p2
+   *   v3 = ((r3 - v1)/p1 - v2)/p2 mod p3
+   * the constants are in Montgomery form so one reduction multiplies
+   */
+  c12 = s_ntt_mont (s_ntt_pow (m[0].p % m[1].p, m[1].p - 2, m[1].p), &m[1]);
+  c13 = s_ntt_mont (s_ntt_pow (m[0].p % m[2].p, m[2].p - 2, m[2].p), &m[2]);
+  c23 = s_ntt_mont (s_ntt_pow (m[1].p % m[2].p, m[2].p - 2, m[2].p), &m[2]);
+  t     = ((mp_word)m[0].p) * ((mp_word)m[1].p);
+  p12lo = (ulong64)t;
+  p12hi = (ulong64)(t >> 64);
+
+  /* the primes are within a factor of two so one subtraction reduces */
+  a0 = a1 = a2 = 0;
+  for (i = 0; i < (size_t)(n - 1); i++) {
+    v1 = x[0][i];
+    v2 = (v1 >= m[1].p) ? v1 - m[1].p : v1;
+    v2 = s_ntt_mul (s_ntt_sub (x[1][i], v2, m[1].p), c12, &m[1]);
+    v3 = (v1 >= m[2].p) ? v1 - m[2].p : v1;
+    v3 = s_ntt_mul (s_ntt_sub (x[2][i], v3, m[2].p), c13, &m[2]);
+    v3 = s_ntt_sub (v3, (v2 >= m[2].p) ? v2 - m[2].p : v2, m[2].p);
+    v3 = s_ntt_mul (v3, c23, &m[2]);
+
+    /* a += v1 + v2*p1 + v3*p1*p2, the top of the sum is p12hi*v3 */
+    t  = ((mp_word)v2) * ((mp_word)m[0].p) + ((mp_word)v1);
+    u  = ((mp_word)v3) * ((mp_word)p12lo);
+    h  = ((mp_word)v3) * ((mp_word)p12hi);
+    t2 = ((mp_word)a0) + ((mp_word)(ulong64)t) + ((mp_word)(ulong64)u);
+    a0 = (ulong64)t2;
+    t2 = (t2 >> 64) + ((mp_word)a1) + (t >> 64) + (u >> 64) + ((mp_word)(ulong64)h);
+    a1 = (ulong64)t2;
+    a2 += (ulong64)(t2 >> 64) + (ulong64)(h >> 64);
+
+    /* one digit out */
+    r.dp[i] = (mp_digit)(a0 & ((ulong64)MP_MASK));
+#ifdef MP_64BIT_FULL
+    a0 = a1;
+    a1 = a2;
+    a2 = 0;
+#else
+    a0 = (a0 >> DIGIT_BIT) | (a1 << (64 - DIGIT_BIT));
+    a1 = (a1 >> DIGIT_BIT) | (a2 << (64 - DIGIT_BIT));
+    a2 >>= DIGIT_BIT;
+#endif
+  }
+  r.dp[i] = (mp_digit)a0;
 
-LBL_T:
-  mp_clear_multi (&t1, &t2, NULL);
+  r.used = n;
+  mp_clamp (&r);
+  r.sign = MP_ZPOS;
+  mp_exch (&r, c);
+  res = MP_OKAY;
+
+  mp_clear (&r);
+LBL_BUF:
+  XFREE (buf);
+LBL_MARK:
+  XSCRATCH_RELEASE (mark);
   return res;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_lcm.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_ntt_mul.c,v $ */
+/* $Revision: 1.1 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_lcm.c
+ --   End: vendor/libtommath-0.41/bn_mp_ntt_mul.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_lshd.c
+ -- Start: vendor/libtommath-0.41/bn_mp_ntt_sqr.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_LSHD_C
+#if defined(BN_MP_NTT_SQR_C) && defined(MP_64BIT)
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -4649,65 +8372,27 @@ LBL_T:
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* shift left a certain amount of digits */
-int mp_lshd (mp_int * a, int b)
+/* b = a*a using the three prime NTT, see mp_ntt_mul which only does one
+ * transform per prime when both of its inputs are the same mp_int
+ */
+int mp_ntt_sqr (mp_int * a, mp_int * b)
 {
-  int     x, res;
-
-  /* if its less than zero return */
-  if (b <= 0) {
-    return MP_OKAY;
-  }
-
-  /* grow to fit the new digits */
-  if (a->alloc < a->used + b) {
-     if ((res = mp_grow (a, a->used + b)) != MP_OKAY) {
-       return res;
-     }
-  }
-
-  {
-    register mp_digit *top, *bottom;
-
-    /* increment the used by the shift amount then copy upwards */
-    a->used += b;
-
-    /* top */
-    top = a->dp + a->used - 1;
-
-    /* base */
-    bottom = a->dp + a->used - 1 - b;
-
-    /* much like mp_rshd this is implemented using a sliding window
-     * except the window goes the otherway around.  Copying from
-     * the bottom to the top.  see bn_mp_rshd.c for more info.
-     */
-    for (x = a->used - 1; x >= b; x--) {
-      *top-- = *bottom--;
-    }
-
-    /* zero the lower digits */
-    top = a->dp;
-    for (x = 0; x < b; x++) {
-      *top++ = 0;
-    }
-  }
-  return MP_OKAY;
+  return mp_ntt_mul (a, a, b);
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_lshd.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_ntt_sqr.c,v $ */
+/* $Revision: 1.1 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_lshd.c
+ --   End: vendor/libtommath-0.41/bn_mp_ntt_sqr.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_mod.c
+ -- Start: vendor/libtommath-0.41/bn_mp_or.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_MOD_C
+#ifdef BN_MP_OR_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -4723,46 +8408,48 @@ int mp_lshd (mp_int * a, int b)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* c = a mod b, 0 <= c < b */
-int
-mp_mod (mp_int * a, mp_int * b, mp_int * c)
+/* OR two ints together */
+int mp_or (mp_int * a, mp_int * b, mp_int * c)
 {
-  mp_int  t;
-  int     res;
-
-  if ((res = mp_init (&t)) != MP_OKAY) {
-    return res;
-  }
-
-  if ((res = mp_div (a, b, NULL, &t)) != MP_OKAY) {
-    mp_clear (&t);
-    return res;
-  }
+  int     res, ix, px;
+  mp_int  t, *x;
 
-  if (t.sign != b->sign) {
-    res = mp_add (b, &t, c);
+  if (a->used > b->used) {
+    if ((res = mp_init_copy (&t, a)) != MP_OKAY) {
+      return res;
+    }
+    px = b->used;
+    x = b;
   } else {
-    res = MP_OKAY;
-    mp_exch (&t, c);
+    if ((res = mp_init_copy (&t, b)) != MP_OKAY) {
+      return res;
+    }
+    px = a->used;
+    x = a;
   }
 
+  for (ix = 0; ix < px; ix++) {
+    t.dp[ix] |= x->dp[ix];
+  }
+  mp_clamp (&t);
+  mp_exch (c, &t);
   mp_clear (&t);
-  return res;
+  return MP_OKAY;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_mod.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_or.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_mod.c
+ --   End: vendor/libtommath-0.41/bn_mp_or.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_mod_2d.c
+ -- Start: vendor/libtommath-0.41/bn_mp_prime_fermat.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_MOD_2D_C
+#ifdef BN_MP_PRIME_FERMAT_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -4778,53 +8465,60 @@ mp_mod (mp_int * a, mp_int * b, mp_int * c)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* calc a value mod 2**b */
-int
-mp_mod_2d (mp_int * a, int b, mp_int * c)
+/* performs one Fermat test.
+ * 
+ * If "a" were prime then b**a == b (mod a) since the order of
+ * the multiplicative sub-group would be phi(a) = a-1.  That means
+ * it would be the same as b**(a mod (a-1)) == b**1 == b (mod a).
+ *
+ * Sets result to 1 if the congruence holds, or zero otherwise.
+ */
+int mp_prime_fermat (mp_int * a, mp_int * b, int *result)
 {
-  int     x, res;
+  mp_int  t;
+  int     err;
 
-  /* if b is <= 0 then zero the int */
-  if (b <= 0) {
-    mp_zero (c);
-    return MP_OKAY;
+  /* default to composite  */
+  *result = MP_NO;
+
+  /* ensure b > 1 */
+  if (mp_cmp_d(b, 1) != MP_GT) {
+     return MP_VAL;
   }
 
-  /* if the modulus is larger than the value than return */
-  if (b >= (int) (a->used * DIGIT_BIT)) {
-    res = mp_copy (a, c);
-    return res;
+  /* init t */
+  if ((err = mp_init (&t)) != MP_OKAY) {
+    return err;
   }
 
-  /* copy */
-  if ((res = mp_copy (a, c)) != MP_OKAY) {
-    return res;
+  /* compute t = b**a mod a */
+  if ((err = mp_exptmod (b, a, a, &t)) != MP_OKAY) {
+    goto LBL_T;
   }
 
-  /* zero digits above the last digit of the modulus */
-  for (x = (b / DIGIT_BIT) + ((b % DIGIT_BIT) == 0 ? 0 : 1); x < c->used; x++) {
-    c->dp[x] = 0;
+  /* is it equal to b? */
+  if (mp_cmp (&t, b) == MP_EQ) {
+    *result = MP_YES;
   }
-  /* clear the digit that is not completely outside/inside the modulus */
-  c->dp[b / DIGIT_BIT] &=
-    (mp_digit) ((((mp_digit) 1) << (((mp_digit) b) % DIGIT_BIT)) - ((mp_digit) 1));
-  mp_clamp (c);
-  return MP_OKAY;
+
+  err = MP_OKAY;
+LBL_T:mp_clear (&t);
+  return err;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_mod_2d.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_prime_fermat.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_mod_2d.c
+ --   End: vendor/libtommath-0.41/bn_mp_prime_fermat.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_mod_d.c
+ -- Start: vendor/libtommath-0.41/bn_mp_prime_is_divisible.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_MOD_D_C
+#ifdef BN_MP_PRIME_IS_DIVISIBLE_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -4840,25 +8534,65 @@ mp_mod_2d (mp_int * a, int b, mp_int * c)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-int
-mp_mod_d (mp_int * a, mp_digit b, mp_digit * c)
+/* determines if an integers is divisible by one 
+ * of the first PRIME_SIZE primes or not
+ *
+ * sets result to 0 if not, 1 if yes
+ */
+
+/* primes tried per pass over a */
+#define PRIME_BATCH 16
+
+int mp_prime_is_divisible (mp_int * a, int *result)
 {
-  return mp_div_d(a, b, NULL, c);
+  int     err, ix, iy, n;
+  mp_digit res[PRIME_BATCH];
+  mp_digit_inv inv[PRIME_BATCH];
+
+  /* default to not */
+  *result = MP_NO;
+
+  /* the primes are done a batch at a time, each batch in a single pass
+   * over a, so a small factor still stops the search early
+   */
+  for (ix = 0; ix < PRIME_SIZE; ix += PRIME_BATCH) {
+    n = MIN(PRIME_BATCH, PRIME_SIZE - ix);
+    for (iy = 0; iy < n; iy++) {
+      if ((err = mp_div_d_setup (ltm_prime_tab[ix + iy], &inv[iy])) != MP_OKAY) {
+        return err;
+      }
+    }
+
+    /* what is a mod LBL_prime_tab[ix..ix+n-1] */
+    if ((err = mp_mod_d_multi (a, inv, n, res)) != MP_OKAY) {
+      return err;
+    }
+
+    /* is any residue zero? */
+    for (iy = 0; iy < n; iy++) {
+      if (res[iy] == 0) {
+        *result = MP_YES;
+        return MP_OKAY;
+      }
+    }
+  }
+
+  return MP_OKAY;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_mod_d.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_prime_is_divisible.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_mod_d.c
+ --   End: vendor/libtommath-0.41/bn_mp_prime_is_divisible.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_montgomery_calc_normalization.c
+ -- Start: vendor/libtommath-0.41/bn_mp_prime_is_prime.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_MONTGOMERY_CALC_NORMALIZATION_C
+#ifdef BN_MP_PRIME_IS_PRIME_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -4874,57 +8608,81 @@ mp_mod_d (mp_int * a, mp_digit b, mp_digit * c)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/*
- * shifts with subtractions when the result is greater than b.
+/* performs a variable number of rounds of Miller-Rabin
  *
- * The method is slightly modified to shift B unconditionally upto just under
- * the leading bit of b.  This saves alot of multiple precision shifting.
+ * Probability of error after t rounds is no more than
+
+ *
+ * Sets result to 1 if probably prime, 0 otherwise
  */
-int mp_montgomery_calc_normalization (mp_int * a, mp_int * b)
+int mp_prime_is_prime (mp_int * a, int t, int *result)
 {
-  int     x, bits, res;
+  mp_int  b;
+  int     ix, err, res;
 
-  /* how many bits of last digit does b use */
-  bits = mp_count_bits (b) % DIGIT_BIT;
+  /* default to no */
+  *result = MP_NO;
 
-  if (b->used > 1) {
-     if ((res = mp_2expt (a, (b->used - 1) * DIGIT_BIT + bits - 1)) != MP_OKAY) {
-        return res;
-     }
-  } else {
-     mp_set(a, 1);
-     bits = 1;
+  /* valid value of t? */
+  if (t <= 0 || t > PRIME_SIZE) {
+    return MP_VAL;
+  }
+
+  /* is the input equal to one of the primes in the table? */
+  for (ix = 0; ix < PRIME_SIZE; ix++) {
+      if (mp_cmp_d(a, ltm_prime_tab[ix]) == MP_EQ) {
+         *result = 1;
+         return MP_OKAY;
+      }
   }
 
+  /* first perform trial division */
+  if ((err = mp_prime_is_divisible (a, &res)) != MP_OKAY) {
+    return err;
+  }
 
-  /* now compute C = A * B mod b */
-  for (x = bits - 1; x < (int)DIGIT_BIT; x++) {
-    if ((res = mp_mul_2 (a, a)) != MP_OKAY) {
-      return res;
+  /* return if it was trivially divisible */
+  if (res == MP_YES) {
+    return MP_OKAY;
+  }
+
+  /* now perform the miller-rabin rounds */
+  if ((err = mp_init (&b)) != MP_OKAY) {
+    return err;
+  }
+
+  for (ix = 0; ix < t; ix++) {
+    /* set the prime */
+    mp_set (&b, ltm_prime_tab[ix]);
+
+    if ((err = mp_prime_miller_rabin (a, &b, &res)) != MP_OKAY) {
+      goto LBL_B;
     }
-    if (mp_cmp_mag (a, b) != MP_LT) {
-      if ((res = s_mp_sub (a, b, a)) != MP_OKAY) {
-        return res;
-      }
+
+    if (res == MP_NO) {
+      goto LBL_B;
     }
   }
 
-  return MP_OKAY;
+  /* passed the test */
+  *result = MP_YES;
+LBL_B:mp_clear (&b);
+  return err;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_montgomery_calc_normalization.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_prime_is_prime.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_montgomery_calc_normalization.c
+ --   End: vendor/libtommath-0.41/bn_mp_prime_is_prime.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_montgomery_reduce.c
+ -- Start: vendor/libtommath-0.41/bn_mp_prime_miller_rabin.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_MONTGOMERY_REDUCE_C
+#ifdef BN_MP_PRIME_MILLER_RABIN_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -4940,116 +8698,101 @@ int mp_montgomery_calc_normalization (mp_int * a, mp_int * b)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* computes xR**-1 == x (mod N) via Montgomery Reduction */
-int
-mp_montgomery_reduce (mp_int * x, mp_int * n, mp_digit rho)
+/* Miller-Rabin test of "a" to the base of "b" as described in 
+ * HAC pp. 139 Algorithm 4.24
+ *
+ * Sets result to 0 if definitely composite or 1 if probably prime.
+ * Randomly the chance of error is no more than 1/4 and often 
+ * very much lower.
+ */
+int mp_prime_miller_rabin (mp_int * a, mp_int * b, int *result)
 {
-  int     ix, res, digs;
-  mp_digit mu;
-
-  /* can the fast reduction [comba] method be used?
-   *
-   * Note that unlike in mul you're safely allowed *less*
-   * than the available columns [255 per default] since carries
-   * are fixed up in the inner loop.
-   */
-  digs = n->used * 2 + 1;
-  if ((digs < MP_WARRAY) &&
-      n->used <
-      (1 << ((CHAR_BIT * sizeof (mp_word)) - (2 * DIGIT_BIT)))) {
-    return fast_mp_montgomery_reduce (x, n, rho);
-  }
-
-  /* grow the input as required */
-  if (x->alloc < digs) {
-    if ((res = mp_grow (x, digs)) != MP_OKAY) {
-      return res;
-    }
-  }
-  x->used = digs;
-
-  for (ix = 0; ix < n->used; ix++) {
-    /* mu = ai * rho mod b
-     *
-     * The value of rho must be precalculated via
-     * montgomery_setup() such that
-     * it equals -1/n0 mod b this allows the
-     * following inner loop to reduce the
-     * input one digit at a time
-     */
-    mu = (mp_digit) (((mp_word)x->dp[ix]) * ((mp_word)rho) & MP_MASK);
-
-    /* a = a + mu * m * b**i */
-    {
-      register int iy;
-      register mp_digit *tmpn, *tmpx, u;
-      register mp_word r;
+  mp_int  n1, y, r;
+  int     s, j, err;
 
-      /* alias for digits of the modulus */
-      tmpn = n->dp;
+  /* default */
+  *result = MP_NO;
 
-      /* alias for the digits of x [the input] */
-      tmpx = x->dp + ix;
+  /* ensure b > 1 */
+  if (mp_cmp_d(b, 1) != MP_GT) {
+     return MP_VAL;
+  }     
 
-      /* set the carry to zero */
-      u = 0;
+  /* get n1 = a - 1 */
+  if ((err = mp_init_copy (&n1, a)) != MP_OKAY) {
+    return err;
+  }
+  if ((err = mp_sub_d (&n1, 1, &n1)) != MP_OKAY) {
+    goto LBL_N1;
+  }
 
-      /* Multiply and add in place */
-      for (iy = 0; iy < n->used; iy++) {
-        /* compute product and sum */
-        r       = ((mp_word)mu) * ((mp_word)*tmpn++) +
-                  ((mp_word) u) + ((mp_word) * tmpx);
+  /* set 2**s * r = n1 */
+  if ((err = mp_init_copy (&r, &n1)) != MP_OKAY) {
+    goto LBL_N1;
+  }
 
-        /* get carry */
-        u       = (mp_digit)(r >> ((mp_word) DIGIT_BIT));
+  /* count the number of least significant bits
+   * which are zero
+   */
+  s = mp_cnt_lsb(&r);
 
-        /* fix digit */
-        *tmpx++ = (mp_digit)(r & ((mp_word) MP_MASK));
-      }
-      /* At this point the ix'th digit of x should be zero */
+  /* now divide n - 1 by 2**s */
+  if ((err = mp_div_2d (&r, s, &r, NULL)) != MP_OKAY) {
+    goto LBL_R;
+  }
 
+  /* compute y = b**r mod a */
+  if ((err = mp_init (&y)) != MP_OKAY) {
+    goto LBL_R;
+  }
+  if ((err = mp_exptmod (b, &r, a, &y)) != MP_OKAY) {
+    goto LBL_Y;
+  }
 
-      /* propagate carries upwards as required*/
-      while (u) {
-        *tmpx   += u;
-        u        = *tmpx >> DIGIT_BIT;
-        *tmpx++ &= MP_MASK;
+  /* if y != 1 and y != n1 do */
+  if (mp_cmp_d (&y, 1) != MP_EQ && mp_cmp (&y, &n1) != MP_EQ) {
+    j = 1;
+    /* while j <= s-1 and y != n1 */
+    while ((j <= (s - 1)) && mp_cmp (&y, &n1) != MP_EQ) {
+      if ((err = mp_sqrmod (&y, a, &y)) != MP_OKAY) {
+         goto LBL_Y;
       }
-    }
-  }
 
-  /* at this point the n.used'th least
-   * significant digits of x are all zero
-   * which means we can shift x to the
-   * right by n.used digits and the
-   * residue is unchanged.
-   */
+      /* if y == 1 then composite */
+      if (mp_cmp_d (&y, 1) == MP_EQ) {
+         goto LBL_Y;
+      }
 
-  /* x = x/b**n.used */
-  mp_clamp(x);
-  mp_rshd (x, n->used);
+      ++j;
+    }
 
-  /* if x >= n then x = x - n */
-  if (mp_cmp_mag (x, n) != MP_LT) {
-    return s_mp_sub (x, n, x);
+    /* if y != n1 then composite */
+    if (mp_cmp (&y, &n1) != MP_EQ) {
+      goto LBL_Y;
+    }
   }
 
-  return MP_OKAY;
+  /* probably prime now */
+  *result = MP_YES;
+LBL_Y:mp_clear (&y);
+LBL_R:mp_clear (&r);
+LBL_N1:mp_clear (&n1);
+  return err;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_montgomery_reduce.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_prime_miller_rabin.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_montgomery_reduce.c
+ --   End: vendor/libtommath-0.41/bn_mp_prime_miller_rabin.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_montgomery_setup.c
+ -- Start: vendor/libtommath-0.41/bn_mp_prime_next_prime.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_MONTGOMERY_SETUP_C
+#ifdef BN_MP_PRIME_NEXT_PRIME_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -5065,130 +8808,172 @@ mp_montgomery_reduce (mp_int * x, mp_int * n, mp_digit rho)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* setups the montgomery reduction stuff */
-int
-mp_montgomery_setup (mp_int * n, mp_digit * rho)
-{
-  mp_digit x, b;
-
-/* fast inversion mod 2**k
- *
- * Based on the fact that
+/* finds the next prime after the number "a" using "t" trials
+ * of Miller-Rabin.
  *
- * XA = 1 (mod 2**n)  =>  (X(2-XA)) A = 1 (mod 2**2n)
- *                    =>  2*X*A - X*X*A*A = 1
- *                    =>  2*(1) - (1)     = 1
+ * bbs_style = 1 means the prime must be congruent to 3 mod 4
  */
-  b = n->dp[0];
+int mp_prime_next_prime(mp_int *a, int t, int bbs_style)
+{
+   int      err, res, x, y;
+   mp_digit res_tab[PRIME_SIZE], step, kstep;
+   mp_digit_inv inv[PRIME_SIZE];
+   mp_int   b;
 
-  if ((b & 1) == 0) {
-    return MP_VAL;
-  }
+   /* ensure t is valid */
+   if (t <= 0 || t > PRIME_SIZE) {
+      return MP_VAL;
+   }
 
-  x = (((b + 2) & 4) << 1) + b; /* here x*a==1 mod 2**4 */
-  x *= 2 - b * x;               /* here x*a==1 mod 2**8 */
-#if !defined(MP_8BIT)
-  x *= 2 - b * x;               /* here x*a==1 mod 2**16 */
-#endif
-#if defined(MP_64BIT) || !(defined(MP_8BIT) || defined(MP_16BIT))
-  x *= 2 - b * x;               /* here x*a==1 mod 2**32 */
-#endif
-#ifdef MP_64BIT
-  x *= 2 - b * x;               /* here x*a==1 mod 2**64 */
-#endif
+   /* force positive */
+   a->sign = MP_ZPOS;
 
-  /* rho = -1/m mod b */
-  *rho = (unsigned long)(((mp_word)1 << ((mp_word) DIGIT_BIT)) - x) & MP_MASK;
+   /* simple algo if a is less than the largest prime in the table */
+   if (mp_cmp_d(a, ltm_prime_tab[PRIME_SIZE-1]) == MP_LT) {
+      /* find which prime it is bigger than */
+      for (x = PRIME_SIZE - 2; x >= 0; x--) {
+          if (mp_cmp_d(a, ltm_prime_tab[x]) != MP_LT) {
+             if (bbs_style == 1) {
+                /* ok we found a prime smaller or
+                 * equal [so the next is larger]
+                 *
+                 * however, the prime must be
+                 * congruent to 3 mod 4
+                 */
+                if ((ltm_prime_tab[x + 1] & 3) != 3) {
+                   /* scan upwards for a prime congruent to 3 mod 4 */
+                   for (y = x + 1; y < PRIME_SIZE; y++) {
+                       if ((ltm_prime_tab[y] & 3) == 3) {
+                          mp_set(a, ltm_prime_tab[y]);
+                          return MP_OKAY;
+                       }
+                   }
+                }
+             } else {
+                mp_set(a, ltm_prime_tab[x + 1]);
+                return MP_OKAY;
+             }
+          }
+      }
+      /* at this point a maybe 1 */
+      if (mp_cmp_d(a, 1) == MP_EQ) {
+         mp_set(a, 2);
+         return MP_OKAY;
+      }
+      /* fall through to the sieve */
+   }
 
-  return MP_OKAY;
-}
-#endif
+   /* generate a prime congruent to 3 mod 4 or 1/3 mod 4? */
+   if (bbs_style == 1) {
+      kstep   = 4;
+   } else {
+      kstep   = 2;
+   }
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_montgomery_setup.c,v $ */
-/* $Revision: 1.5 $ */
-/* $Date: 2006/12/28 01:25:13 $ */
-/*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_montgomery_setup.c
- ---------------------------------------------------------------------*/
+   /* at this point we will use a combination of a sieve and Miller-Rabin */
 
-/*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_mul.c
- ---------------------------------------------------------------------*/
-#include <tommath.h>
-#ifdef BN_MP_MUL_C
-/* LibTomMath, multiple-precision integer library -- Tom St Denis
- *
- * LibTomMath is a library that provides multiple-precision
- * integer arithmetic as well as number theoretic functionality.
- *
- * The library was designed directly after the MPI library by
- * Michael Fromberger but has been written from scratch with
- * additional optimizations in place.
- *
- * The library is free for all purposes without any express
- * guarantee it works.
- *
- * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
- */
+   if (bbs_style == 1) {
+      /* if a mod 4 != 3 subtract the correct value to make it so */
+      if ((a->dp[0] & 3) != 3) {
+         if ((err = mp_sub_d(a, (a->dp[0] & 3) + 1, a)) != MP_OKAY) { return err; };
+      }
+   } else {
+      if (mp_iseven(a) == 1) {
+         /* force odd */
+         if ((err = mp_sub_d(a, 1, a)) != MP_OKAY) {
+            return err;
+         }
+      }
+   }
 
-/* high level multiplication (handles sign) */
-int mp_mul (mp_int * a, mp_int * b, mp_int * c)
-{
-  int     res, neg;
-  neg = (a->sign == b->sign) ? MP_ZPOS : MP_NEG;
+   /* generate the restable, in one pass over a */
+   for (x = 1; x < PRIME_SIZE; x++) {
+      if ((err = mp_div_d_setup(ltm_prime_tab[x], inv + x)) != MP_OKAY) {
+         return err;
+      }
+   }
+   if ((err = mp_mod_d_multi(a, inv + 1, PRIME_SIZE - 1, res_tab + 1)) != MP_OKAY) {
+      return err;
+   }
 
-  /* use Toom-Cook? */
-#ifdef BN_MP_TOOM_MUL_C
-  if (MIN (a->used, b->used) >= TOOM_MUL_CUTOFF) {
-    res = mp_toom_mul(a, b, c);
-  } else 
-#endif
-#ifdef BN_MP_KARATSUBA_MUL_C
-  /* use Karatsuba? */
-  if (MIN (a->used, b->used) >= KARATSUBA_MUL_CUTOFF) {
-    res = mp_karatsuba_mul (a, b, c);
-  } else 
-#endif
-  {
-    /* can we use the fast multiplier?
-     *
-     * The fast multiplier can be used if the output will 
-     * have less than MP_WARRAY digits and the number of 
-     * digits won't affect carry propagation
-     */
-    int     digs = a->used + b->used + 1;
+   /* init temp used for Miller-Rabin Testing */
+   if ((err = mp_init(&b)) != MP_OKAY) {
+      return err;
+   }
 
-#ifdef BN_FAST_S_MP_MUL_DIGS_C
-    if ((digs < MP_WARRAY) &&
-        MIN(a->used, b->used) <= 
-        (1 << ((CHAR_BIT * sizeof (mp_word)) - (2 * DIGIT_BIT)))) {
-      res = fast_s_mp_mul_digs (a, b, c, digs);
-    } else 
-#endif
-#ifdef BN_S_MP_MUL_DIGS_C
-      res = s_mp_mul (a, b, c); /* uses s_mp_mul_digs */
-#else
-      res = MP_VAL;
-#endif
+   for (;;) {
+      /* skip to the next non-trivially divisible candidate */
+      step = 0;
+      do {
+         /* y == 1 if any residue was zero [e.g. cannot be prime] */
+         y     =  0;
+
+         /* increase step to next candidate */
+         step += kstep;
+
+         /* compute the new residue without using division */
+         for (x = 1; x < PRIME_SIZE; x++) {
+             /* add the step to each residue */
+             res_tab[x] += kstep;
+
+             /* subtract the modulus [instead of using division] */
+             if (res_tab[x] >= ltm_prime_tab[x]) {
+                res_tab[x]  -= ltm_prime_tab[x];
+             }
+
+             /* set flag if zero */
+             if (res_tab[x] == 0) {
+                y = 1;
+             }
+         }
+      } while (y == 1 && step < ((MP_MASK - kstep) + 1));
+
+      /* add the step */
+      if ((err = mp_add_d(a, step, a)) != MP_OKAY) {
+         goto LBL_ERR;
+      }
+
+      /* if didn't pass sieve and step == MAX then skip test */
+      if (y == 1 && step >= ((MP_MASK - kstep) + 1)) {
+         continue;
+      }
+
+      /* is this prime? */
+      for (x = 0; x < t; x++) {
+          mp_set(&b, ltm_prime_tab[t]);
+          if ((err = mp_prime_miller_rabin(a, &b, &res)) != MP_OKAY) {
+             goto LBL_ERR;
+          }
+          if (res == MP_NO) {
+             break;
+          }
+      }
+
+      if (res == MP_YES) {
+         break;
+      }
+   }
 
-  }
-  c->sign = (c->used > 0) ? neg : MP_ZPOS;
-  return res;
+   err = MP_OKAY;
+LBL_ERR:
+   mp_clear(&b);
+   return err;
 }
+
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_mul.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_prime_next_prime.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_mul.c
+ --   End: vendor/libtommath-0.41/bn_mp_prime_next_prime.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_mul_2.c
+ -- Start: vendor/libtommath-0.41/bn_mp_prime_rabin_miller_trials.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_MUL_2_C
+#ifdef BN_MP_PRIME_RABIN_MILLER_TRIALS_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -5204,80 +8989,50 @@ int mp_mul (mp_int * a, mp_int * b, mp_int * c)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* b = a*2 */
-int mp_mul_2(mp_int * a, mp_int * b)
-{
-  int     x, res, oldused;
-
-  /* grow to accomodate result */
-  if (b->alloc < a->used + 1) {
-    if ((res = mp_grow (b, a->used + 1)) != MP_OKAY) {
-      return res;
-    }
-  }
-
-  oldused = b->used;
-  b->used = a->used;
 
-  {
-    register mp_digit r, rr, *tmpa, *tmpb;
+static const struct {
+   int k, t;
+} sizes[] = {
+{   128,    28 },
+{   256,    16 },
+{   384,    10 },
+{   512,     7 },
+{   640,     6 },
+{   768,     5 },
+{   896,     4 },
+{  1024,     4 }
+};
 
-    /* alias for source */
-    tmpa = a->dp;
-    
-    /* alias for dest */
-    tmpb = b->dp;
+/* returns # of RM trials required for a given bit size */
+int mp_prime_rabin_miller_trials(int size)
+{
+   int x;
 
-    /* carry */
-    r = 0;
-    for (x = 0; x < a->used; x++) {
-    
-      /* get what will be the *next* carry bit from the 
-       * MSB of the current digit 
-       */
-      rr = *tmpa >> ((mp_digit)(DIGIT_BIT - 1));
-      
-      /* now shift up this digit, add in the carry [from the previous] */
-      *tmpb++ = ((*tmpa++ << ((mp_digit)1)) | r) & MP_MASK;
-      
-      /* copy the carry that would be from the source 
-       * digit into the next iteration 
-       */
-      r = rr;
-    }
+   for (x = 0; x < (int)(sizeof(sizes)/(sizeof(sizes[0]))); x++) {
+       if (sizes[x].k == size) {
+          return sizes[x].t;
+       } else if (sizes[x].k > size) {
+          return (x == 0) ? sizes[0].t : sizes[x - 1].t;
+       }
+   }
+   return sizes[x-1].t + 1;
+}
 
-    /* new leading digit? */
-    if (r != 0) {
-      /* add a MSB which is always 1 at this point */
-      *tmpb = 1;
-      ++(b->used);
-    }
 
-    /* now zero any excess digits on the destination 
-     * that we didn't write to 
-     */
-    tmpb = b->dp + b->used;
-    for (x = b->used; x < oldused; x++) {
-      *tmpb++ = 0;
-    }
-  }
-  b->sign = a->sign;
-  return MP_OKAY;
-}
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_mul_2.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_prime_rabin_miller_trials.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_mul_2.c
+ --   End: vendor/libtommath-0.41/bn_mp_prime_rabin_miller_trials.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_mul_2d.c
+ -- Start: vendor/libtommath-0.41/bn_mp_prime_random_ex.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_MUL_2D_C
+#ifdef BN_MP_PRIME_RANDOM_EX_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -5293,83 +9048,123 @@ int mp_mul_2(mp_int * a, mp_int * b)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* shift left by a certain bit count */
-int mp_mul_2d (mp_int * a, int b, mp_int * c)
+/* makes a truly random prime of a given size (bits),
+ *
+ * Flags are as follows:
+ * 
+ *   LTM_PRIME_BBS      - make prime congruent to 3 mod 4
+ *   LTM_PRIME_SAFE     - make sure (p-1)/2 is prime as well (implies LTM_PRIME_BBS)
+ *   LTM_PRIME_2MSB_OFF - make the 2nd highest bit zero
+ *   LTM_PRIME_2MSB_ON  - make the 2nd highest bit one
+ *
+ * You have to supply a callback which fills in a buffer with random bytes.  "dat" is a parameter you can
+ * have passed to the callback (e.g. a state or something).  This function doesn't use "dat" itself
+ * so it can be NULL
+ *
+ */
+
+/* This is possibly the mother of all prime generation functions, muahahahahaha! */
+int mp_prime_random_ex(mp_int *a, int t, int size, int flags, ltm_prime_callback cb, void *dat)
 {
-  mp_digit d;
-  int      res;
+   unsigned char *tmp, maskAND, maskOR_msb, maskOR_lsb;
+   int res, err, bsize, maskOR_msb_offset;
 
-  /* copy */
-  if (a != c) {
-     if ((res = mp_copy (a, c)) != MP_OKAY) {
-       return res;
-     }
-  }
+   /* sanity check the input */
+   if (size <= 1 || t <= 0) {
+      return MP_VAL;
+   }
 
-  if (c->alloc < (int)(c->used + b/DIGIT_BIT + 1)) {
-     if ((res = mp_grow (c, c->used + b / DIGIT_BIT + 1)) != MP_OKAY) {
-       return res;
-     }
-  }
+   /* LTM_PRIME_SAFE implies LTM_PRIME_BBS */
+   if (flags & LTM_PRIME_SAFE) {
+      flags |= LTM_PRIME_BBS;
+   }
 
-  /* shift by as many digits in the bit count */
-  if (b >= (int)DIGIT_BIT) {
-    if ((res = mp_lshd (c, b / DIGIT_BIT)) != MP_OKAY) {
-      return res;
-    }
-  }
+   /* calc the byte size */
+   bsize = (size>>3) + ((size&7)?1:0);
 
-  /* shift any bit count < DIGIT_BIT */
-  d = (mp_digit) (b % DIGIT_BIT);
-  if (d != 0) {
-    register mp_digit *tmpc, shift, mask, r, rr;
-    register int x;
+   /* we need a buffer of bsize bytes */
+   tmp = OPT_CAST(unsigned char) XMALLOC(bsize);
+   if (tmp == NULL) {
+      return MP_MEM;
+   }
 
-    /* bitmask for carries */
-    mask = (((mp_digit)1) << d) - 1;
+   /* calc the maskAND value for the MSbyte*/
+   maskAND = ((size&7) == 0) ? 0xFF : (0xFF >> (8 - (size & 7)));
 
-    /* shift for msbs */
-    shift = DIGIT_BIT - d;
+   /* calc the maskOR_msb */
+   maskOR_msb        = 0;
+   maskOR_msb_offset = ((size & 7) == 1) ? 1 : 0;
+   if (flags & LTM_PRIME_2MSB_ON) {
+      maskOR_msb       |= 0x80 >> ((9 - size) & 7);
+   }  
 
-    /* alias */
-    tmpc = c->dp;
+   /* get the maskOR_lsb */
+   maskOR_lsb         = 1;
+   if (flags & LTM_PRIME_BBS) {
+      maskOR_lsb     |= 3;
+   }
 
-    /* carry */
-    r    = 0;
-    for (x = 0; x < c->used; x++) {
-      /* get the higher bits of the current word */
-      rr = (*tmpc >> shift) & mask;
+   do {
+      /* read the bytes */
+      if (cb(tmp, bsize, dat) != bsize) {
+         err = MP_VAL;
+         goto error;
+      }
+ 
+      /* work over the MSbyte */
+      tmp[0]    &= maskAND;
+      tmp[0]    |= 1 << ((size - 1) & 7);
 
-      /* shift the current word and OR in the carry */
-      *tmpc = ((*tmpc << d) | r) & MP_MASK;
-      ++tmpc;
+      /* mix in the maskORs */
+      tmp[maskOR_msb_offset]   |= maskOR_msb;
+      tmp[bsize-1]             |= maskOR_lsb;
 
-      /* set the carry to the carry bits of the current word */
-      r = rr;
-    }
-    
-    /* set final carry */
-    if (r != 0) {
-       c->dp[(c->used)++] = r;
-    }
-  }
-  mp_clamp (c);
-  return MP_OKAY;
+      /* read it in */
+      if ((err = mp_read_unsigned_bin(a, tmp, bsize)) != MP_OKAY)     { goto error; }
+
+      /* is it prime? */
+      if ((err = mp_prime_is_prime(a, t, &res)) != MP_OKAY)           { goto error; }
+      if (res == MP_NO) {  
+         continue;
+      }
+
+      if (flags & LTM_PRIME_SAFE) {
+         /* see if (a-1)/2 is prime */
+         if ((err = mp_sub_d(a, 1, a)) != MP_OKAY)                    { goto error; }
+         if ((err = mp_div_2(a, a)) != MP_OKAY)                       { goto error; }
+ 
+         /* is it prime? */
+         if ((err = mp_prime_is_prime(a, t, &res)) != MP_OKAY)        { goto error; }
+      }
+   } while (res == MP_NO);
+
+   if (flags & LTM_PRIME_SAFE) {
+      /* restore a to the original value */
+      if ((err = mp_mul_2(a, a)) != MP_OKAY)                          { goto error; }
+      if ((err = mp_add_d(a, 1, a)) != MP_OKAY)                       { goto error; }
+   }
+
+   err = MP_OKAY;
+error:
+   XFREE(tmp);
+   return err;
 }
+
+
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_mul_2d.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_prime_random_ex.c,v $ */
+/* $Revision: 1.5 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_mul_2d.c
+ --   End: vendor/libtommath-0.41/bn_mp_prime_random_ex.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_mul_d.c
+ -- Start: vendor/libtommath-0.41/bn_mp_radix_power.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_MUL_D_C
+#ifdef BN_MP_RADIX_POWER_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -5385,77 +9180,130 @@ int mp_mul_2d (mp_int * a, int b, mp_int * c)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* multiply by a digit */
-int
-mp_mul_d (mp_int * a, mp_digit b, mp_int * c)
+/* powers of a radix for the divide and conquer conversions
+ *
+ * A number is written out, or read in, k radix digits at a time where
+ * big = radix**k is the largest power of the radix a mp_digit holds.
+ * Above that the conversions split at P(i) = big**(2**i), squared up
+ * from each other the first time one is wanted and kept from then on,
+ * one table per radix.  What mp_div_barrett needs to divide by a power
+ * is only worked out once a division asks for it.
+ *
+ * Like the cutoffs the tables are shared by the whole program, so
+ * conversions running on several threads have to be serialized by the
+ * caller.  mp_radix_power_clear() frees them.
+ */
+static mp_radix_power *s_powers[65];
+static int             s_count[65];
+
+/* k and big = radix**k for the radix, the largest power under 2**DIGIT_BIT */
+int mp_radix_chunk(int radix, int *k, mp_digit *big)
 {
-  mp_digit u, *tmpa, *tmpc;
-  mp_word  r;
-  int      ix, res, olduse;
+  mp_digit b;
+  int      n;
 
-  /* make sure c is big enough to hold a*b */
-  if (c->alloc < a->used + 1) {
-    if ((res = mp_grow (c, a->used + 1)) != MP_OKAY) {
-      return res;
-    }
+  if (radix < 2 || radix > 64) {
+    return MP_VAL;
   }
 
-  /* get the original destinations used count */
-  olduse = c->used;
-
-  /* set the sign */
-  c->sign = a->sign;
-
-  /* alias for a->dp [source] */
-  tmpa = a->dp;
-
-  /* alias for c->dp [dest] */
-  tmpc = c->dp;
-
-  /* zero carry */
-  u = 0;
+  b = (mp_digit)radix;
+  n = 1;
+  while (b <= MP_MASK / (mp_digit)radix) {
+    b *= (mp_digit)radix;
+    ++n;
+  }
 
-  /* compute columns */
-  for (ix = 0; ix < a->used; ix++) {
-    /* compute product and carry sum for this term */
-    r       = ((mp_word) u) + ((mp_word)*tmpa++) * ((mp_word)b);
+  *k   = n;
+  *big = b;
+  return MP_OKAY;
+}
 
-    /* mask off higher bits to get a single digit */
-    *tmpc++ = (mp_digit) (r & ((mp_word) MP_MASK));
+/* *p = P(i) for the radix, set up for mp_div_barrett as well if divide */
+int mp_radix_power_get(int radix, int i, int divide, mp_radix_power **p)
+{
+  mp_radix_power *tab, *e;
+  mp_digit big;
+  int      res, k;
 
-    /* send carry into next iteration */
-    u       = (mp_digit) (r >> ((mp_word) DIGIT_BIT));
+  if (i < 0 || i >= MP_RADIX_POWERS) {
+    return MP_VAL;
+  }
+  if ((res = mp_radix_chunk(radix, &k, &big)) != MP_OKAY) {
+    return res;
   }
 
-  /* store final carry [if any] and increment ix offset  */
-  *tmpc++ = u;
-  ++ix;
+  if ((tab = s_powers[radix]) == NULL) {
+    tab = OPT_CAST(mp_radix_power) XMALLOC(sizeof(mp_radix_power) * MP_RADIX_POWERS);
+    if (tab == NULL) {
+      return MP_MEM;
+    }
+    s_powers[radix] = tab;
+  }
 
-  /* now zero digits above the top */
-  while (ix++ < olduse) {
-     *tmpc++ = 0;
+  /* square up to P(i) */
+  while (s_count[radix] <= i) {
+    e = tab + s_count[radix];
+    if ((res = mp_init_multi(&e->p, &e->norm, &e->mu, NULL)) != MP_OKAY) {
+      return res;
+    }
+    if (s_count[radix] == 0) {
+      mp_set(&e->p, big);
+    } else if ((res = mp_sqr(&e[-1].p, &e->p)) != MP_OKAY) {
+      mp_clear_multi(&e->p, &e->norm, &e->mu, NULL);
+      return res;
+    }
+    e->shift = 0;
+    ++s_count[radix];
   }
 
-  /* set used count */
-  c->used = a->used + 1;
-  mp_clamp(c);
+  e = tab + i;
+  if (divide == MP_YES && mp_iszero(&e->mu) == MP_YES) {
+    /* shift until the top bit of the top digit is set */
+    e->shift = (DIGIT_BIT - (mp_count_bits(&e->p) % DIGIT_BIT)) % DIGIT_BIT;
+    if ((res = mp_mul_2d(&e->p, e->shift, &e->norm)) != MP_OKAY ||
+        (res = mp_reciprocal(&e->norm, &e->mu)) != MP_OKAY) {
+      mp_zero(&e->mu);
+      return res;
+    }
+  }
 
+  *p = e;
   return MP_OKAY;
 }
+
+/* frees the powers of every radix */
+void mp_radix_power_clear(void)
+{
+  mp_radix_power *tab;
+  int radix, i;
+
+  for (radix = 0; radix <= 64; radix++) {
+    if ((tab = s_powers[radix]) == NULL) {
+      continue;
+    }
+    for (i = 0; i < s_count[radix]; i++) {
+      mp_clear_multi(&tab[i].p, &tab[i].norm, &tab[i].mu, NULL);
+    }
+    XFREE(tab);
+    s_powers[radix] = NULL;
+    s_count[radix]  = 0;
+  }
+}
+
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_mul_d.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_radix_power.c,v $ */
+/* $Revision: 1.1 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_mul_d.c
+ --   End: vendor/libtommath-0.41/bn_mp_radix_power.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_mulmod.c
+ -- Start: vendor/libtommath-0.41/bn_mp_radix_size.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_MULMOD_C
+#ifdef BN_MP_RADIX_SIZE_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -5471,38 +9319,99 @@ mp_mul_d (mp_int * a, mp_digit b, mp_int * c)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* d = a * b (mod c) */
-int mp_mulmod (mp_int * a, mp_int * b, mp_int * c, mp_int * d)
+/* returns size of ASCII reprensentation
+ *
+ * With b = mp_count_bits(a) the number is 2**(b-1) <= |a| < 2**b, so it
+ * has between floor((b-1)/log2(radix)) + 1 and floor(b/log2(radix)) + 1
+ * digits (see mp_s_rmap_log2).  Mostly those are the same number and
+ * otherwise a comparison with radix**(digits-1) settles it, which is a
+ * lot less work than the conversion the digits used to be counted by.
+ */
+
+/* c = radix**e for an e that may not fit a mp_digit */
+static int s_mp_radix_expt (int radix, int e, mp_int * c)
 {
-  int     res;
+  int     res, x;
+
+  mp_set (c, 1);
+  for (x = (int) (sizeof(int) * CHAR_BIT) - 2; x >= 0; x--) {
+    if ((res = mp_sqr (c, c)) != MP_OKAY) {
+      return res;
+    }
+    if (((e >> x) & 1) != 0) {
+      if ((res = mp_mul_d (c, (mp_digit) radix, c)) != MP_OKAY) {
+        return res;
+      }
+    }
+  }
+  return MP_OKAY;
+}
+
+int mp_radix_size (mp_int * a, int radix, int *size)
+{
+  int     res, bits, digs, lo, k;
   mp_int  t;
 
-  if ((res = mp_init (&t)) != MP_OKAY) {
-    return res;
+  *size = 0;
+
+  /* make sure the radix is in range */
+  if (radix < 2 || radix > 64) {
+    return MP_VAL;
   }
 
-  if ((res = mp_mul (a, b, &t)) != MP_OKAY) {
-    mp_clear (&t);
-    return res;
+  if (mp_iszero(a) == MP_YES) {
+    *size = 2;
+    return MP_OKAY;
   }
-  res = mp_mod (&t, c, d);
-  mp_clear (&t);
-  return res;
+
+  bits = mp_count_bits (a);
+  if ((radix & (radix - 1)) == 0) {
+    /* every digit takes k bits */
+    for (k = 0; (1 << k) < radix; k++);
+    digs = (bits + k - 1) / k;
+  } else {
+    digs = (int)((((mp_word)bits) * ((mp_word)(mp_s_rmap_log2[radix] + 1))) >> ((mp_word)32)) + 1;
+    lo   = (int)((((mp_word)(bits - 1)) * ((mp_word)mp_s_rmap_log2[radix])) >> ((mp_word)32)) + 1;
+    if (lo < digs) {
+      /* |a| has digs digits if it is radix**(digs-1) or more */
+      if ((res = mp_init (&t)) != MP_OKAY) {
+        return res;
+      }
+      if ((res = s_mp_radix_expt (radix, digs - 1, &t)) != MP_OKAY) {
+        mp_clear (&t);
+        return res;
+      }
+      if (mp_cmp_mag (a, &t) == MP_LT) {
+        --digs;
+      }
+      mp_clear (&t);
+    }
+  }
+
+  /* if it's negative add one for the sign */
+  if (a->sign == MP_NEG) {
+    ++digs;
+  }
+
+  /* return digs + 1, the 1 is for the NULL byte that would be required. */
+  *size = digs + 1;
+  return MP_OKAY;
 }
+
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_mulmod.c,v $ */
-/* $Revision: 1.5 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_radix_size.c,v $ */
+/* $Revision: 1.6 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_mulmod.c
+ --   End: vendor/libtommath-0.41/bn_mp_radix_size.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_n_root.c
+ -- Start: vendor/libtommath-0.41/bn_mp_radix_size_overestimate.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_N_ROOT_C
+#ifdef BN_MP_RADIX_SIZE_OVERESTIMATE_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -5518,130 +9427,54 @@ int mp_mulmod (mp_int * a, mp_int * b, mp_int * c, mp_int * d)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* find the n'th root of an integer 
- *
- * Result found such that (c)**b <= a and (c+1)**b > a 
- *
- * This algorithm uses Newton's approximation 
- * x[i+1] = x[i] - f(x[i])/f'(x[i]) 
- * which will find the root in log(N) time where 
- * each step involves a fair bit.  This is not meant to 
- * find huge roots [square and cube, etc].
+/* an upper bound on mp_radix_size, at most two chars over it for the
+ * radixes that are not a power of two and exact for the others, which
+ * takes no more than mp_count_bits
  */
-int mp_n_root (mp_int * a, mp_digit b, mp_int * c)
+int mp_radix_size_overestimate (mp_int * a, int radix, int *size)
 {
-  mp_int  t1, t2, t3;
-  int     res, neg;
-
-  /* input must be positive if b is even */
-  if ((b & 1) == 0 && a->sign == MP_NEG) {
-    return MP_VAL;
-  }
-
-  if ((res = mp_init (&t1)) != MP_OKAY) {
-    return res;
-  }
+  int     bits, digs, k;
 
-  if ((res = mp_init (&t2)) != MP_OKAY) {
-    goto LBL_T1;
-  }
+  *size = 0;
 
-  if ((res = mp_init (&t3)) != MP_OKAY) {
-    goto LBL_T2;
+  /* make sure the radix is in range */
+  if (radix < 2 || radix > 64) {
+    return MP_VAL;
   }
 
-  /* if a is negative fudge the sign but keep track */
-  neg     = a->sign;
-  a->sign = MP_ZPOS;
-
-  /* t2 = 2 */
-  mp_set (&t2, 2);
-
-  do {
-    /* t1 = t2 */
-    if ((res = mp_copy (&t2, &t1)) != MP_OKAY) {
-      goto LBL_T3;
-    }
-
-    /* t2 = t1 - ((t1**b - a) / (b * t1**(b-1))) */
-    
-    /* t3 = t1**(b-1) */
-    if ((res = mp_expt_d (&t1, b - 1, &t3)) != MP_OKAY) {   
-      goto LBL_T3;
-    }
-
-    /* numerator */
-    /* t2 = t1**b */
-    if ((res = mp_mul (&t3, &t1, &t2)) != MP_OKAY) {    
-      goto LBL_T3;
-    }
-
-    /* t2 = t1**b - a */
-    if ((res = mp_sub (&t2, a, &t2)) != MP_OKAY) {  
-      goto LBL_T3;
-    }
-
-    /* denominator */
-    /* t3 = t1**(b-1) * b  */
-    if ((res = mp_mul_d (&t3, b, &t3)) != MP_OKAY) {    
-      goto LBL_T3;
-    }
-
-    /* t3 = (t1**b - a)/(b * t1**(b-1)) */
-    if ((res = mp_div (&t2, &t3, &t3, NULL)) != MP_OKAY) {  
-      goto LBL_T3;
-    }
-
-    if ((res = mp_sub (&t1, &t3, &t2)) != MP_OKAY) {
-      goto LBL_T3;
-    }
-  }  while (mp_cmp (&t1, &t2) != MP_EQ);
-
-  /* result can be off by a few so check */
-  for (;;) {
-    if ((res = mp_expt_d (&t1, b, &t2)) != MP_OKAY) {
-      goto LBL_T3;
-    }
-
-    if (mp_cmp (&t2, a) == MP_GT) {
-      if ((res = mp_sub_d (&t1, 1, &t1)) != MP_OKAY) {
-         goto LBL_T3;
-      }
-    } else {
-      break;
-    }
+  if (mp_iszero(a) == MP_YES) {
+    *size = 2;
+    return MP_OKAY;
   }
 
-  /* reset the sign of a first */
-  a->sign = neg;
-
-  /* set the result */
-  mp_exch (&t1, c);
-
-  /* set the sign of the result */
-  c->sign = neg;
-
-  res = MP_OKAY;
-
-LBL_T3:mp_clear (&t3);
-LBL_T2:mp_clear (&t2);
-LBL_T1:mp_clear (&t1);
-  return res;
+  /* |a| < 2**bits has at most floor(bits / log2(radix)) + 1 digits */
+  bits = mp_count_bits (a);
+  if ((radix & (radix - 1)) == 0) {
+    for (k = 0; (1 << k) < radix; k++);
+    digs = (bits + k - 1) / k;
+  } else {
+    digs = (int)((((mp_word)bits) * ((mp_word)(mp_s_rmap_log2[radix] + 1))) >> ((mp_word)32)) + 1;
+  }
+
+  /* one more for a sign and one for the NULL byte */
+  *size = digs + ((a->sign == MP_NEG) ? 1 : 0) + 1;
+  return MP_OKAY;
 }
+
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_n_root.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_radix_size_overestimate.c,v $ */
+/* $Revision: 1.1 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_n_root.c
+ --   End: vendor/libtommath-0.41/bn_mp_radix_size_overestimate.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_neg.c
+ -- Start: vendor/libtommath-0.41/bn_mp_radix_smap.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_NEG_C
+#ifdef BN_MP_RADIX_SMAP_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -5657,38 +9490,59 @@ LBL_T1:mp_clear (&t1);
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* b = -a */
-int mp_neg (mp_int * a, mp_int * b)
-{
-  int     res;
-  if (a != b) {
-     if ((res = mp_copy (a, b)) != MP_OKAY) {
-        return res;
-     }
-  }
+/* chars used in radix conversions */
+const char *mp_s_rmap = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz+/";
 
-  if (mp_iszero(b) != MP_YES) {
-     b->sign = (a->sign == MP_ZPOS) ? MP_NEG : MP_ZPOS;
-  } else {
-     b->sign = MP_ZPOS;
-  }
+/* the other way round, the place of every char in mp_s_rmap, 0xff if not there */
+const unsigned char mp_s_rmap_reverse[256] = {
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18,
+  0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32,
+  0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
 
-  return MP_OKAY;
-}
+/* 2**32 / log2(radix) rounded down, 0 where the radix is a power of two */
+const unsigned long mp_s_rmap_log2[65] = {
+  0x00000000UL, 0x00000000UL, 0x00000000UL, 0xa1849cc1UL, 0x00000000UL,
+  0x6e40d1a4UL, 0x6308c91bUL, 0x5b3064ebUL, 0x00000000UL, 0x50c24e60UL,
+  0x4d104d42UL, 0x4a002707UL, 0x4768ce0dUL, 0x452e53e3UL, 0x433cfffbUL,
+  0x41867711UL, 0x00000000UL, 0x3ea16afdUL, 0x3d64598dUL, 0x3c43c230UL,
+  0x3b3b9a42UL, 0x3a4898f0UL, 0x39680b13UL, 0x3897b2b7UL, 0x37d5aed1UL,
+  0x372068d2UL, 0x3676867eUL, 0x35d6deebUL, 0x354071d6UL, 0x34b260c5UL,
+  0x342be986UL, 0x33ac61b9UL, 0x00000000UL, 0x32bfd901UL, 0x3251dcf6UL,
+  0x31e8d59fUL, 0x3184648dUL, 0x312434e8UL, 0x30c7fa34UL, 0x306f6f4cUL,
+  0x301a557fUL, 0x2fc873d1UL, 0x2f799652UL, 0x2f2d8d8fUL, 0x2ee42e16UL,
+  0x2e9d5009UL, 0x2e58cec0UL, 0x2e168874UL, 0x2dd65df7UL, 0x2d983275UL,
+  0x2d5beb38UL, 0x2d216f79UL, 0x2ce8a82eUL, 0x2cb17feaUL, 0x2c7be2b0UL,
+  0x2c47bddbUL, 0x2c14fffcUL, 0x2be398c3UL, 0x2bb378e7UL, 0x2b849210UL,
+  0x2b56d6c7UL, 0x2b2a3a60UL, 0x2afeb0f1UL, 0x2ad42f3cUL, 0x00000000UL
+};
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_neg.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_radix_smap.c,v $ */
+/* $Revision: 1.5 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_neg.c
+ --   End: vendor/libtommath-0.41/bn_mp_radix_smap.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_or.c
+ -- Start: vendor/libtommath-0.41/bn_mp_rand.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_OR_C
+#ifdef BN_MP_RAND_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -5704,48 +9558,53 @@ int mp_neg (mp_int * a, mp_int * b)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* OR two ints together */
-int mp_or (mp_int * a, mp_int * b, mp_int * c)
+/* makes a pseudo-random int of a given size */
+int
+mp_rand (mp_int * a, int digits)
 {
-  int     res, ix, px;
-  mp_int  t, *x;
+  int     res;
+  mp_digit d;
 
-  if (a->used > b->used) {
-    if ((res = mp_init_copy (&t, a)) != MP_OKAY) {
+  mp_zero (a);
+  if (digits <= 0) {
+    return MP_OKAY;
+  }
+
+  /* first place a random non-zero digit */
+  do {
+    d = ((mp_digit) abs (rand ())) & MP_MASK;
+  } while (d == 0);
+
+  if ((res = mp_add_d (a, d, a)) != MP_OKAY) {
+    return res;
+  }
+
+  while (--digits > 0) {
+    if ((res = mp_lshd (a, 1)) != MP_OKAY) {
       return res;
     }
-    px = b->used;
-    x = b;
-  } else {
-    if ((res = mp_init_copy (&t, b)) != MP_OKAY) {
+
+    if ((res = mp_add_d (a, ((mp_digit) abs (rand ())), a)) != MP_OKAY) {
       return res;
     }
-    px = a->used;
-    x = a;
   }
 
-  for (ix = 0; ix < px; ix++) {
-    t.dp[ix] |= x->dp[ix];
-  }
-  mp_clamp (&t);
-  mp_exch (c, &t);
-  mp_clear (&t);
   return MP_OKAY;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_or.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_rand.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_or.c
+ --   End: vendor/libtommath-0.41/bn_mp_rand.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_prime_fermat.c
+ -- Start: vendor/libtommath-0.41/bn_mp_read_radix.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_PRIME_FERMAT_C
+#ifdef BN_MP_READ_RADIX_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -5761,60 +9620,202 @@ int mp_or (mp_int * a, mp_int * b, mp_int * c)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* performs one Fermat test.
- * 
- * If "a" were prime then b**a == b (mod a) since the order of
- * the multiplicative sub-group would be phi(a) = a-1.  That means
- * it would be the same as b**(a mod (a-1)) == b**1 == b (mod a).
+/* read a string [ASCII] in a given radix
  *
- * Sets result to 1 if the congruence holds, or zero otherwise.
+ * The chars are looked up in mp_s_rmap_reverse and k of them go into a
+ * single digit below big = radix**k (see mp_radix_chunk) before the
+ * number is touched, so a short string takes a mp_mul_d and mp_add_d
+ * pass per k chars instead of per char.  From READ_RADIX_DC_CUTOFF
+ * digits worth of chars on the string is split in two, the lower part
+ * k * 2**i chars long for the largest such part that leaves some chars
+ * above it.  Both are read the same way and joined as
+ * high * P(i) + low with the cached power P(i) = big**(2**i) of
+ * mp_radix_power_get, which takes a few multiplications of each size.
+ * A radix that is a power of two takes no multiplications, the bits of
+ * the chars are put straight into the digits.
  */
-int mp_prime_fermat (mp_int * a, mp_int * b, int *result)
+
+/* the value of a char in the radix, radix or more if it has none */
+static int s_mp_radix_value(unsigned char ch, int radix)
 {
-  mp_int  t;
-  int     err;
+  int y = mp_s_rmap_reverse[ch];
 
-  /* default to composite  */
-  *result = MP_NO;
+  /* if the radix < 36 the conversion is case insensitive
+   * this allows numbers like 1AB and 1ab to represent the same  value
+   * [e.g. in hex]
+   */
+  if (radix < 36 && y >= 36 && y < 62) {
+    y -= 26;
+  }
+  return y;
+}
 
-  /* ensure b > 1 */
-  if (mp_cmp_d(b, 1) != MP_GT) {
-     return MP_VAL;
+/* a = the n chars of str, k of them for every digit */
+static int s_mp_read_radix_base(mp_int *a, const unsigned char *str, int n,
+                                int radix, int k, mp_digit big)
+{
+  mp_digit d;
+  int      res, ix, m;
+
+  mp_zero(a);
+
+  /* the first chunk takes what is left over whole chunks of k */
+  m = n % k;
+  if (m == 0) {
+    m = k;
+  }
+  while (n > 0) {
+    d = 0;
+    for (ix = 0; ix < m; ix++) {
+      d = d * (mp_digit)radix + (mp_digit)s_mp_radix_value(*str++, radix);
+    }
+    if ((res = mp_mul_d(a, big, a)) != MP_OKAY) {
+      return res;
+    }
+    if ((res = mp_add_d(a, d, a)) != MP_OKAY) {
+      return res;
+    }
+    n -= m;
+    m  = k;
   }
+  return MP_OKAY;
+}
 
-  /* init t */
-  if ((err = mp_init (&t)) != MP_OKAY) {
-    return err;
+/* a = the n chars of str in the radix 2**b */
+static int s_mp_read_radix_2k(mp_int *a, const unsigned char *str, int n,
+                              int radix, int b)
+{
+  mp_word acc;
+  int     res, have, ix;
+
+  if ((res = mp_grow(a, (n * b) / DIGIT_BIT + 1)) != MP_OKAY) {
+    return res;
   }
 
-  /* compute t = b**a mod a */
-  if ((err = mp_exptmod (b, a, a, &t)) != MP_OKAY) {
+  /* the last char holds the lowest bits */
+  acc  = 0;
+  have = 0;
+  ix   = 0;
+  while (n-- > 0) {
+    acc  |= ((mp_word)s_mp_radix_value(str[n], radix)) << ((mp_word)have);
+    have += b;
+    if (have >= DIGIT_BIT) {
+      a->dp[ix++] = ((mp_digit)acc) & MP_MASK;
+      acc       >>= ((mp_word)DIGIT_BIT);
+      have       -= DIGIT_BIT;
+    }
+  }
+  a->dp[ix++] = (mp_digit)acc;
+  a->used     = ix;
+  mp_clamp(a);
+  return MP_OKAY;
+}
+
+/* a = the n chars of str, n <= k * 2**(i+1) */
+static int s_mp_read_radix_dc(mp_int *a, const unsigned char *str, int n,
+                              int i, int radix, int k, mp_digit big)
+{
+  mp_radix_power *p;
+  mp_int   t;
+  int      res, len;
+
+  /* leave some chars above the lower part */
+  while (i >= 0 && (k << i) >= n) {
+    --i;
+  }
+  if (i < 0 || n < READ_RADIX_DC_CUTOFF * k) {
+    return s_mp_read_radix_base(a, str, n, radix, k, big);
+  }
+
+  if ((res = mp_radix_power_get(radix, i, MP_NO, &p)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_init(&t)) != MP_OKAY) {
+    return res;
+  }
+
+  len = k << i;
+  if ((res = s_mp_read_radix_dc(a, str, n - len, i - 1, radix, k, big)) != MP_OKAY ||
+      (res = s_mp_read_radix_dc(&t, str + n - len, len, i - 1, radix, k, big)) != MP_OKAY ||
+      (res = mp_mul(a, &p->p, a)) != MP_OKAY) {
     goto LBL_T;
   }
+  res = mp_add(a, &t, a);
 
-  /* is it equal to b? */
-  if (mp_cmp (&t, b) == MP_EQ) {
-    *result = MP_YES;
+LBL_T:mp_clear(&t);
+  return res;
+}
+
+int mp_read_radix (mp_int * a, const char *str, int radix)
+{
+  const unsigned char *s;
+  mp_digit big;
+  int      res, neg, k, n, i;
+
+  /* zero the digit bignum */
+  mp_zero(a);
+
+  /* make sure the radix is ok */
+  if ((res = mp_radix_chunk(radix, &k, &big)) != MP_OKAY) {
+    return res;
   }
 
-  err = MP_OKAY;
-LBL_T:mp_clear (&t);
-  return err;
+  /* if the leading digit is a 
+   * minus set the sign to negative. 
+   */
+  if (*str == '-') {
+    ++str;
+    neg = MP_NEG;
+  } else {
+    neg = MP_ZPOS;
+  }
+
+  /* the number ends at the first char that is not a digit of the radix */
+  s = (const unsigned char *)str;
+  n = 0;
+  while (s[n] != 0 && s_mp_radix_value(s[n], radix) < radix) {
+    ++n;
+  }
+  if (n == 0) {
+    return MP_OKAY;
+  }
+
+  if ((radix & (radix - 1)) == 0) {
+    for (i = 0; (1 << i) < radix; i++);
+    res = s_mp_read_radix_2k(a, s, n, radix, i);
+  } else {
+    /* the largest lower part that fits */
+    i = 0;
+    while (i < MP_RADIX_POWERS - 1 && (k << (i + 1)) < n) {
+      ++i;
+    }
+    res = s_mp_read_radix_dc(a, s, n, i, radix, k, big);
+  }
+  if (res != MP_OKAY) {
+    mp_zero(a);
+    return res;
+  }
+
+  /* set the sign only if a != 0 */
+  if (mp_iszero(a) != 1) {
+     a->sign = neg;
+  }
+  return MP_OKAY;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_prime_fermat.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_read_radix.c,v $ */
+/* $Revision: 1.6 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_prime_fermat.c
+ --   End: vendor/libtommath-0.41/bn_mp_read_radix.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_prime_is_divisible.c
+ -- Start: vendor/libtommath-0.41/bn_mp_read_signed_bin.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_PRIME_IS_DIVISIBLE_C
+#ifdef BN_MP_READ_SIGNED_BIN_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -5830,48 +9831,77 @@ LBL_T:mp_clear (&t);
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* determines if an integers is divisible by one 
- * of the first PRIME_SIZE primes or not
- *
- * sets result to 0 if not, 1 if yes
- */
-int mp_prime_is_divisible (mp_int * a, int *result)
+/* read signed bin, big endian, first byte is 0==positive or 1==negative */
+int mp_read_signed_bin (mp_int * a, const unsigned char *b, int c)
 {
-  int     err, ix;
-  mp_digit res;
-
-  /* default to not */
-  *result = MP_NO;
+  int     res;
 
-  for (ix = 0; ix < PRIME_SIZE; ix++) {
-    /* what is a mod LBL_prime_tab[ix] */
-    if ((err = mp_mod_d (a, ltm_prime_tab[ix], &res)) != MP_OKAY) {
-      return err;
-    }
+  /* read magnitude */
+  if ((res = mp_read_unsigned_bin (a, b + 1, c - 1)) != MP_OKAY) {
+    return res;
+  }
 
-    /* is the residue zero? */
-    if (res == 0) {
-      *result = MP_YES;
-      return MP_OKAY;
-    }
+  /* first byte is 0 for positive, non-zero for negative */
+  if (b[0] == 0) {
+     a->sign = MP_ZPOS;
+  } else {
+     a->sign = MP_NEG;
   }
 
   return MP_OKAY;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_prime_is_divisible.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_read_signed_bin.c,v $ */
+/* $Revision: 1.5 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_read_signed_bin.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_read_unsigned_bin.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_READ_UNSIGNED_BIN_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* reads a unsigned char array, assumes the msb is stored first [big endian] */
+int mp_read_unsigned_bin (mp_int * a, const unsigned char *b, int c)
+{
+  if (c <= 0) {
+    mp_zero (a);
+    return MP_OKAY;
+  }
+  return mp_import (a, (size_t)c, 1, 1, 1, 0, b);
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_read_unsigned_bin.c,v $ */
+/* $Revision: 1.5 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_prime_is_divisible.c
+ --   End: vendor/libtommath-0.41/bn_mp_read_unsigned_bin.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_prime_is_prime.c
+ -- Start: vendor/libtommath-0.41/bn_mp_reciprocal.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_PRIME_IS_PRIME_C
+#ifdef BN_MP_RECIPROCAL_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -5887,81 +9917,166 @@ int mp_prime_is_divisible (mp_int * a, int *result)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* performs a variable number of rounds of Miller-Rabin
- *
- * Probability of error after t rounds is no more than
+/* below this many digits the reciprocal is a plain division */
+#define RECIPROCAL_BASE 16
 
- *
- * Sets result to 1 if probably prime, 0 otherwise
+/* X with a*X < b**2n <= a*(X + 2), b = 2**DIGIT_BIT, for a of n digits
+ * whose top digit is at least b/2.  ApproximateReciprocal from Brent and
+ * Zimmermann's "Modern Computer Arithmetic", alg. 3.5: the reciprocal of
+ * the top h digits of a, with h about n/2, and one Newton step.
  */
-int mp_prime_is_prime (mp_int * a, int t, int *result)
+static int s_mp_reciprocal(mp_int *a, mp_int *x)
 {
-  mp_int  b;
-  int     ix, err, res;
+  mp_int  ah, t, u;
+  int     res, n, l, h;
+  size_t  mark;
+
+  n = a->used;
+  if (n <= RECIPROCAL_BASE) {
+    /* ceil(b**2n / a) - 1 */
+    if ((res = mp_2expt(x, 2 * n * DIGIT_BIT)) != MP_OKAY) {
+      return res;
+    }
+    if ((res = mp_sub_d(x, 1, x)) != MP_OKAY) {
+      return res;
+    }
+    return mp_div(x, a, x, NULL);
+  }
+  l = (n - 1) / 2;
+  h = n - l;
 
-  /* default to no */
-  *result = MP_NO;
+  mark = XSCRATCH_MARK();
+  if ((res = mp_init_scratch_multi(2 * n + 2, &ah, &t, &u, NULL)) != MP_OKAY) {
+    goto LBL_MARK;
+  }
 
-  /* valid value of t? */
-  if (t <= 0 || t > PRIME_SIZE) {
-    return MP_VAL;
+  /* x = reciprocal of ah = a div b**l */
+  if ((res = mp_copy(a, &ah)) != MP_OKAY) {
+    goto ERR;
+  }
+  mp_rshd(&ah, l);
+  if ((res = s_mp_reciprocal(&ah, x)) != MP_OKAY) {
+    goto ERR;
   }
 
-  /* is the input equal to one of the primes in the table? */
-  for (ix = 0; ix < PRIME_SIZE; ix++) {
-      if (mp_cmp_d(a, ltm_prime_tab[ix]) == MP_EQ) {
-         *result = 1;
-         return MP_OKAY;
-      }
+  /* t = a * x, brought under b**(n+h) */
+  if ((res = mp_mul(a, x, &t)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_2expt(&u, (n + h) * DIGIT_BIT)) != MP_OKAY) {
+    goto ERR;
+  }
+  while (mp_cmp(&t, &u) != MP_LT) {
+    if ((res = mp_sub_d(x, 1, x)) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = mp_sub(&t, a, &t)) != MP_OKAY) {
+      goto ERR;
+    }
   }
 
-  /* first perform trial division */
-  if ((err = mp_prime_is_divisible (a, &res)) != MP_OKAY) {
-    return err;
+  /* u = ((b**(n+h) - t) div b**l) * x, from the columns that reach
+   * over b**(2h-l) within one
+   */
+  if ((res = mp_sub(&u, &t, &t)) != MP_OKAY) {
+    goto ERR;
+  }
+  mp_rshd(&t, l);
+  if ((res = mp_mulhi(&t, x, &u, 2 * h - l - 2)) != MP_OKAY) {
+    goto ERR;
   }
 
-  /* return if it was trivially divisible */
-  if (res == MP_YES) {
-    return MP_OKAY;
+  /* x = x * b**l + u div b**(2h - l) */
+  mp_rshd(&u, 2 * h - l);
+  if ((res = mp_lshd(x, l)) != MP_OKAY) {
+    goto ERR;
   }
+  res = mp_add(x, &u, x);
 
-  /* now perform the miller-rabin rounds */
-  if ((err = mp_init (&b)) != MP_OKAY) {
-    return err;
+ERR:
+  mp_clear_multi(&ah, &t, &u, NULL);
+LBL_MARK:
+  XSCRATCH_RELEASE(mark);
+  return res;
+}
+
+/* b = floor(2**(2*DIGIT_BIT*n) / a) for a positive a of n digits whose
+ * top bit is set, the mu of mp_reduce_setup, by Newton's iteration.
+ *
+ * About three multiplications of n digits against the O(M(n) log n) of
+ * a division, most of them short products.  The approximation is a few
+ * short and is fixed up with one more low short product.
+ */
+int mp_reciprocal(mp_int *a, mp_int *b)
+{
+  mp_int  x, r;
+  int     res;
+  size_t  mark;
+
+  if (a->sign == MP_NEG || a->used == 0 ||
+      (a->dp[a->used - 1] >> (DIGIT_BIT - 1)) == 0) {
+    return MP_VAL;
   }
 
-  for (ix = 0; ix < t; ix++) {
-    /* set the prime */
-    mp_set (&b, ltm_prime_tab[ix]);
+  mark = XSCRATCH_MARK();
+  XSCRATCH_RESERVE(sizeof(mp_digit) * 12 * (a->used + 8 * MP_PREC));
+  if ((res = mp_init_size(&x, a->used + 2)) != MP_OKAY) {
+    goto LBL_MARK;
+  }
+  if ((res = mp_init_scratch(&r, 2 * a->used + 2)) != MP_OKAY) {
+    goto LBL_X;
+  }
 
-    if ((err = mp_prime_miller_rabin (a, &b, &res)) != MP_OKAY) {
-      goto LBL_B;
-    }
+  if ((res = s_mp_reciprocal(a, &x)) != MP_OKAY) {
+    goto ERR;
+  }
 
-    if (res == MP_NO) {
-      goto LBL_B;
+  /* r = b**2n - a*x, it is in [0, 3a) so under b**(n+1) and that is
+   * all of a*x it takes
+   */
+  if ((res = mp_mullo(a, &x, &r, a->used + 1)) != MP_OKAY) {
+    goto ERR;
+  }
+  if (mp_iszero(&r) == MP_NO) {
+    if ((res = mp_2expt(b, (a->used + 1) * DIGIT_BIT)) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = mp_sub(b, &r, &r)) != MP_OKAY) {
+      goto ERR;
     }
   }
+  while (mp_cmp_mag(&r, a) != MP_LT) {
+    if ((res = mp_add_d(&x, 1, &x)) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = mp_sub(&r, a, &r)) != MP_OKAY) {
+      goto ERR;
+    }
+  }
+  mp_exch(&x, b);
 
-  /* passed the test */
-  *result = MP_YES;
-LBL_B:mp_clear (&b);
-  return err;
+ERR:
+  mp_clear(&r);
+LBL_X:
+  mp_clear(&x);
+LBL_MARK:
+  XSCRATCH_RELEASE(mark);
+  return res;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_prime_is_prime.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_reciprocal.c,v $ */
+/* $Revision: 1.1 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_prime_is_prime.c
+ --   End: vendor/libtommath-0.41/bn_mp_reciprocal.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_prime_miller_rabin.c
+ -- Start: vendor/libtommath-0.41/bn_mp_reduce.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_PRIME_MILLER_RABIN_C
+#ifdef BN_MP_REDUCE_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -5977,101 +10092,179 @@ LBL_B:mp_clear (&b);
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* Miller-Rabin test of "a" to the base of "b" as described in 
- * HAC pp. 139 Algorithm 4.24
- *
- * Sets result to 0 if definitely composite or 1 if probably prime.
- * Randomly the chance of error is no more than 1/4 and often 
- * very much lower.
+/* reduces x mod m, assumes 0 < x < m**2, mu is 
+ * precomputed via mp_reduce_setup.
+ * From HAC pp.604 Algorithm 14.42
  */
-int mp_prime_miller_rabin (mp_int * a, mp_int * b, int *result)
+int mp_reduce (mp_int * x, mp_int * m, mp_int * mu)
 {
-  mp_int  n1, y, r;
-  int     s, j, err;
-
-  /* default */
-  *result = MP_NO;
-
-  /* ensure b > 1 */
-  if (mp_cmp_d(b, 1) != MP_GT) {
-     return MP_VAL;
-  }     
+  mp_int  q;
+  int     res, um = m->used;
 
-  /* get n1 = a - 1 */
-  if ((err = mp_init_copy (&n1, a)) != MP_OKAY) {
-    return err;
-  }
-  if ((err = mp_sub_d (&n1, 1, &n1)) != MP_OKAY) {
-    goto LBL_N1;
+  /* q = x */
+  if ((res = mp_init_copy (&q, x)) != MP_OKAY) {
+    return res;
   }
 
-  /* set 2**s * r = n1 */
-  if ((err = mp_init_copy (&r, &n1)) != MP_OKAY) {
-    goto LBL_N1;
+  /* q1 = x / b**(k-1)  */
+  mp_rshd (&q, um - 1);         
+
+  /* according to HAC this optimization is ok */
+  if (((unsigned long) um) > (((mp_digit)1) << (DIGIT_BIT - 1))) {
+    if ((res = mp_mul (&q, mu, &q)) != MP_OKAY) {
+      goto CLEANUP;
+    }
+  } else {
+#ifdef BN_MP_MULHI_C
+    /* HAC leaves out the columns below um - 1, with um the error is
+     * about um/4 and each is one more subtraction below
+     */
+    if ((res = mp_mulhi (&q, mu, &q, um - 1)) != MP_OKAY) {
+      goto CLEANUP;
+    }
+#elif defined(BN_S_MP_MUL_HIGH_DIGS_C)
+    if ((res = s_mp_mul_high_digs (&q, mu, &q, um)) != MP_OKAY) {
+      goto CLEANUP;
+    }
+#elif defined(BN_FAST_S_MP_MUL_HIGH_DIGS_C)
+    if ((res = fast_s_mp_mul_high_digs (&q, mu, &q, um)) != MP_OKAY) {
+      goto CLEANUP;
+    }
+#else 
+    { 
+      res = MP_VAL;
+      goto CLEANUP;
+    }
+#endif
   }
 
-  /* count the number of least significant bits
-   * which are zero
-   */
-  s = mp_cnt_lsb(&r);
+  /* q3 = q2 / b**(k+1) */
+  mp_rshd (&q, um + 1);         
 
-  /* now divide n - 1 by 2**s */
-  if ((err = mp_div_2d (&r, s, &r, NULL)) != MP_OKAY) {
-    goto LBL_R;
+  /* x = x mod b**(k+1), quick (no division) */
+  if ((res = mp_mod_2d (x, DIGIT_BIT * (um + 1), x)) != MP_OKAY) {
+    goto CLEANUP;
   }
 
-  /* compute y = b**r mod a */
-  if ((err = mp_init (&y)) != MP_OKAY) {
-    goto LBL_R;
+  /* q = q * m mod b**(k+1), quick (no division) */
+#ifdef BN_MP_MULLO_C
+  if ((res = mp_mullo (&q, m, &q, um + 1)) != MP_OKAY) {
+    goto CLEANUP;
   }
-  if ((err = mp_exptmod (b, &r, a, &y)) != MP_OKAY) {
-    goto LBL_Y;
+#else
+  if ((res = s_mp_mul_digs (&q, m, &q, um + 1)) != MP_OKAY) {
+    goto CLEANUP;
   }
+#endif
 
-  /* if y != 1 and y != n1 do */
-  if (mp_cmp_d (&y, 1) != MP_EQ && mp_cmp (&y, &n1) != MP_EQ) {
-    j = 1;
-    /* while j <= s-1 and y != n1 */
-    while ((j <= (s - 1)) && mp_cmp (&y, &n1) != MP_EQ) {
-      if ((err = mp_sqrmod (&y, a, &y)) != MP_OKAY) {
-         goto LBL_Y;
-      }
-
-      /* if y == 1 then composite */
-      if (mp_cmp_d (&y, 1) == MP_EQ) {
-         goto LBL_Y;
-      }
+  /* x = x - q */
+  if ((res = mp_sub (x, &q, x)) != MP_OKAY) {
+    goto CLEANUP;
+  }
 
-      ++j;
-    }
+  /* If x < 0, add b**(k+1) to it */
+  if (mp_cmp_d (x, 0) == MP_LT) {
+    mp_set (&q, 1);
+    if ((res = mp_lshd (&q, um + 1)) != MP_OKAY)
+      goto CLEANUP;
+    if ((res = mp_add (x, &q, x)) != MP_OKAY)
+      goto CLEANUP;
+  }
 
-    /* if y != n1 then composite */
-    if (mp_cmp (&y, &n1) != MP_EQ) {
-      goto LBL_Y;
+  /* Back off if it's too big */
+  while (mp_cmp (x, m) != MP_LT) {
+    if ((res = s_mp_sub (x, m, x)) != MP_OKAY) {
+      goto CLEANUP;
     }
   }
+  
+CLEANUP:
+  mp_clear (&q);
+
+  return res;
+}
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_mp_reduce.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_reduce.c
+ ---------------------------------------------------------------------*/
+
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_reduce_2k.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_REDUCE_2K_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
 
-  /* probably prime now */
-  *result = MP_YES;
-LBL_Y:mp_clear (&y);
-LBL_R:mp_clear (&r);
-LBL_N1:mp_clear (&n1);
-  return err;
+/* reduces a modulo n where n is of the form 2**p - d */
+int mp_reduce_2k(mp_int *a, mp_int *n, mp_digit d)
+{
+   mp_int q;
+   int    p, res;
+   
+   if ((res = mp_init(&q)) != MP_OKAY) {
+      return res;
+   }
+   
+   p = mp_count_bits(n);    
+top:
+   /* q = a/2**p, a = a mod 2**p */
+   if ((res = mp_div_2d(a, p, &q, a)) != MP_OKAY) {
+      goto ERR;
+   }
+   
+   if (d != 1) {
+      /* q = q * d */
+      if ((res = mp_mul_d(&q, d, &q)) != MP_OKAY) { 
+         goto ERR;
+      }
+   }
+   
+   /* a = a + q */
+   if ((res = s_mp_add(a, &q, a)) != MP_OKAY) {
+      goto ERR;
+   }
+   
+   if (mp_cmp_mag(a, n) != MP_LT) {
+      s_mp_sub(a, n, a);
+      goto top;
+   }
+   
+ERR:
+   mp_clear(&q);
+   return res;
 }
+
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_prime_miller_rabin.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_reduce_2k.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_prime_miller_rabin.c
+ --   End: vendor/libtommath-0.41/bn_mp_reduce_2k.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_prime_next_prime.c
+ -- Start: vendor/libtommath-0.41/bn_mp_reduce_2k_l.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_PRIME_NEXT_PRIME_C
+#ifdef BN_MP_REDUCE_2K_L_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -6087,168 +10280,60 @@ LBL_N1:mp_clear (&n1);
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* finds the next prime after the number "a" using "t" trials
- * of Miller-Rabin.
- *
- * bbs_style = 1 means the prime must be congruent to 3 mod 4
- */
-int mp_prime_next_prime(mp_int *a, int t, int bbs_style)
+/* reduces a modulo n where n is of the form 2**p - d 
+   This differs from reduce_2k since "d" can be larger
+   than a single digit.
+*/
+int mp_reduce_2k_l(mp_int *a, mp_int *n, mp_int *d)
 {
-   int      err, res, x, y;
-   mp_digit res_tab[PRIME_SIZE], step, kstep;
-   mp_int   b;
-
-   /* ensure t is valid */
-   if (t <= 0 || t > PRIME_SIZE) {
-      return MP_VAL;
-   }
-
-   /* force positive */
-   a->sign = MP_ZPOS;
-
-   /* simple algo if a is less than the largest prime in the table */
-   if (mp_cmp_d(a, ltm_prime_tab[PRIME_SIZE-1]) == MP_LT) {
-      /* find which prime it is bigger than */
-      for (x = PRIME_SIZE - 2; x >= 0; x--) {
-          if (mp_cmp_d(a, ltm_prime_tab[x]) != MP_LT) {
-             if (bbs_style == 1) {
-                /* ok we found a prime smaller or
-                 * equal [so the next is larger]
-                 *
-                 * however, the prime must be
-                 * congruent to 3 mod 4
-                 */
-                if ((ltm_prime_tab[x + 1] & 3) != 3) {
-                   /* scan upwards for a prime congruent to 3 mod 4 */
-                   for (y = x + 1; y < PRIME_SIZE; y++) {
-                       if ((ltm_prime_tab[y] & 3) == 3) {
-                          mp_set(a, ltm_prime_tab[y]);
-                          return MP_OKAY;
-                       }
-                   }
-                }
-             } else {
-                mp_set(a, ltm_prime_tab[x + 1]);
-                return MP_OKAY;
-             }
-          }
-      }
-      /* at this point a maybe 1 */
-      if (mp_cmp_d(a, 1) == MP_EQ) {
-         mp_set(a, 2);
-         return MP_OKAY;
-      }
-      /* fall through to the sieve */
-   }
-
-   /* generate a prime congruent to 3 mod 4 or 1/3 mod 4? */
-   if (bbs_style == 1) {
-      kstep   = 4;
-   } else {
-      kstep   = 2;
+   mp_int q;
+   int    p, res;
+   
+   if ((res = mp_init(&q)) != MP_OKAY) {
+      return res;
    }
-
-   /* at this point we will use a combination of a sieve and Miller-Rabin */
-
-   if (bbs_style == 1) {
-      /* if a mod 4 != 3 subtract the correct value to make it so */
-      if ((a->dp[0] & 3) != 3) {
-         if ((err = mp_sub_d(a, (a->dp[0] & 3) + 1, a)) != MP_OKAY) { return err; };
-      }
-   } else {
-      if (mp_iseven(a) == 1) {
-         /* force odd */
-         if ((err = mp_sub_d(a, 1, a)) != MP_OKAY) {
-            return err;
-         }
-      }
+   
+   p = mp_count_bits(n);    
+top:
+   /* q = a/2**p, a = a mod 2**p */
+   if ((res = mp_div_2d(a, p, &q, a)) != MP_OKAY) {
+      goto ERR;
    }
-
-   /* generate the restable */
-   for (x = 1; x < PRIME_SIZE; x++) {
-      if ((err = mp_mod_d(a, ltm_prime_tab[x], res_tab + x)) != MP_OKAY) {
-         return err;
-      }
+   
+   /* q = q * d */
+   if ((res = mp_mul(&q, d, &q)) != MP_OKAY) { 
+      goto ERR;
    }
-
-   /* init temp used for Miller-Rabin Testing */
-   if ((err = mp_init(&b)) != MP_OKAY) {
-      return err;
+   
+   /* a = a + q */
+   if ((res = s_mp_add(a, &q, a)) != MP_OKAY) {
+      goto ERR;
    }
-
-   for (;;) {
-      /* skip to the next non-trivially divisible candidate */
-      step = 0;
-      do {
-         /* y == 1 if any residue was zero [e.g. cannot be prime] */
-         y     =  0;
-
-         /* increase step to next candidate */
-         step += kstep;
-
-         /* compute the new residue without using division */
-         for (x = 1; x < PRIME_SIZE; x++) {
-             /* add the step to each residue */
-             res_tab[x] += kstep;
-
-             /* subtract the modulus [instead of using division] */
-             if (res_tab[x] >= ltm_prime_tab[x]) {
-                res_tab[x]  -= ltm_prime_tab[x];
-             }
-
-             /* set flag if zero */
-             if (res_tab[x] == 0) {
-                y = 1;
-             }
-         }
-      } while (y == 1 && step < ((((mp_digit)1)<<DIGIT_BIT) - kstep));
-
-      /* add the step */
-      if ((err = mp_add_d(a, step, a)) != MP_OKAY) {
-         goto LBL_ERR;
-      }
-
-      /* if didn't pass sieve and step == MAX then skip test */
-      if (y == 1 && step >= ((((mp_digit)1)<<DIGIT_BIT) - kstep)) {
-         continue;
-      }
-
-      /* is this prime? */
-      for (x = 0; x < t; x++) {
-          mp_set(&b, ltm_prime_tab[t]);
-          if ((err = mp_prime_miller_rabin(a, &b, &res)) != MP_OKAY) {
-             goto LBL_ERR;
-          }
-          if (res == MP_NO) {
-             break;
-          }
-      }
-
-      if (res == MP_YES) {
-         break;
-      }
+   
+   if (mp_cmp_mag(a, n) != MP_LT) {
+      s_mp_sub(a, n, a);
+      goto top;
    }
-
-   err = MP_OKAY;
-LBL_ERR:
-   mp_clear(&b);
-   return err;
+   
+ERR:
+   mp_clear(&q);
+   return res;
 }
 
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_prime_next_prime.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_reduce_2k_l.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_prime_next_prime.c
+ --   End: vendor/libtommath-0.41/bn_mp_reduce_2k_l.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_prime_rabin_miller_trials.c
+ -- Start: vendor/libtommath-0.41/bn_mp_reduce_2k_setup.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_PRIME_RABIN_MILLER_TRIALS_C
+#ifdef BN_MP_REDUCE_2K_SETUP_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -6264,50 +10349,45 @@ LBL_ERR:
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-
-static const struct {
-   int k, t;
-} sizes[] = {
-{   128,    28 },
-{   256,    16 },
-{   384,    10 },
-{   512,     7 },
-{   640,     6 },
-{   768,     5 },
-{   896,     4 },
-{  1024,     4 }
-};
-
-/* returns # of RM trials required for a given bit size */
-int mp_prime_rabin_miller_trials(int size)
+/* determines the setup value */
+int mp_reduce_2k_setup(mp_int *a, mp_digit *d)
 {
-   int x;
-
-   for (x = 0; x < (int)(sizeof(sizes)/(sizeof(sizes[0]))); x++) {
-       if (sizes[x].k == size) {
-          return sizes[x].t;
-       } else if (sizes[x].k > size) {
-          return (x == 0) ? sizes[0].t : sizes[x - 1].t;
-       }
+   int res, p;
+   mp_int tmp;
+   
+   if ((res = mp_init(&tmp)) != MP_OKAY) {
+      return res;
    }
-   return sizes[x-1].t + 1;
+   
+   p = mp_count_bits(a);
+   if ((res = mp_2expt(&tmp, p)) != MP_OKAY) {
+      mp_clear(&tmp);
+      return res;
+   }
+   
+   if ((res = s_mp_sub(&tmp, a, &tmp)) != MP_OKAY) {
+      mp_clear(&tmp);
+      return res;
+   }
+   
+   *d = tmp.dp[0];
+   mp_clear(&tmp);
+   return MP_OKAY;
 }
-
-
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_prime_rabin_miller_trials.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_reduce_2k_setup.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_prime_rabin_miller_trials.c
+ --   End: vendor/libtommath-0.41/bn_mp_reduce_2k_setup.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_prime_random_ex.c
+ -- Start: vendor/libtommath-0.41/bn_mp_reduce_2k_setup_l.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_PRIME_RANDOM_EX_C
+#ifdef BN_MP_REDUCE_2K_SETUP_L_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -6323,123 +10403,42 @@ int mp_prime_rabin_miller_trials(int size)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* makes a truly random prime of a given size (bits),
- *
- * Flags are as follows:
- * 
- *   LTM_PRIME_BBS      - make prime congruent to 3 mod 4
- *   LTM_PRIME_SAFE     - make sure (p-1)/2 is prime as well (implies LTM_PRIME_BBS)
- *   LTM_PRIME_2MSB_OFF - make the 2nd highest bit zero
- *   LTM_PRIME_2MSB_ON  - make the 2nd highest bit one
- *
- * You have to supply a callback which fills in a buffer with random bytes.  "dat" is a parameter you can
- * have passed to the callback (e.g. a state or something).  This function doesn't use "dat" itself
- * so it can be NULL
- *
- */
-
-/* This is possibly the mother of all prime generation functions, muahahahahaha! */
-int mp_prime_random_ex(mp_int *a, int t, int size, int flags, ltm_prime_callback cb, void *dat)
+/* determines the setup value */
+int mp_reduce_2k_setup_l(mp_int *a, mp_int *d)
 {
-   unsigned char *tmp, maskAND, maskOR_msb, maskOR_lsb;
-   int res, err, bsize, maskOR_msb_offset;
-
-   /* sanity check the input */
-   if (size <= 1 || t <= 0) {
-      return MP_VAL;
-   }
-
-   /* LTM_PRIME_SAFE implies LTM_PRIME_BBS */
-   if (flags & LTM_PRIME_SAFE) {
-      flags |= LTM_PRIME_BBS;
-   }
-
-   /* calc the byte size */
-   bsize = (size>>3) + ((size&7)?1:0);
-
-   /* we need a buffer of bsize bytes */
-   tmp = OPT_CAST(unsigned char) XMALLOC(bsize);
-   if (tmp == NULL) {
-      return MP_MEM;
+   int    res;
+   mp_int tmp;
+   
+   if ((res = mp_init(&tmp)) != MP_OKAY) {
+      return res;
    }
-
-   /* calc the maskAND value for the MSbyte*/
-   maskAND = ((size&7) == 0) ? 0xFF : (0xFF >> (8 - (size & 7)));
-
-   /* calc the maskOR_msb */
-   maskOR_msb        = 0;
-   maskOR_msb_offset = ((size & 7) == 1) ? 1 : 0;
-   if (flags & LTM_PRIME_2MSB_ON) {
-      maskOR_msb       |= 0x80 >> ((9 - size) & 7);
-   }  
-
-   /* get the maskOR_lsb */
-   maskOR_lsb         = 1;
-   if (flags & LTM_PRIME_BBS) {
-      maskOR_lsb     |= 3;
+   
+   if ((res = mp_2expt(&tmp, mp_count_bits(a))) != MP_OKAY) {
+      goto ERR;
    }
-
-   do {
-      /* read the bytes */
-      if (cb(tmp, bsize, dat) != bsize) {
-         err = MP_VAL;
-         goto error;
-      }
- 
-      /* work over the MSbyte */
-      tmp[0]    &= maskAND;
-      tmp[0]    |= 1 << ((size - 1) & 7);
-
-      /* mix in the maskORs */
-      tmp[maskOR_msb_offset]   |= maskOR_msb;
-      tmp[bsize-1]             |= maskOR_lsb;
-
-      /* read it in */
-      if ((err = mp_read_unsigned_bin(a, tmp, bsize)) != MP_OKAY)     { goto error; }
-
-      /* is it prime? */
-      if ((err = mp_prime_is_prime(a, t, &res)) != MP_OKAY)           { goto error; }
-      if (res == MP_NO) {  
-         continue;
-      }
-
-      if (flags & LTM_PRIME_SAFE) {
-         /* see if (a-1)/2 is prime */
-         if ((err = mp_sub_d(a, 1, a)) != MP_OKAY)                    { goto error; }
-         if ((err = mp_div_2(a, a)) != MP_OKAY)                       { goto error; }
- 
-         /* is it prime? */
-         if ((err = mp_prime_is_prime(a, t, &res)) != MP_OKAY)        { goto error; }
-      }
-   } while (res == MP_NO);
-
-   if (flags & LTM_PRIME_SAFE) {
-      /* restore a to the original value */
-      if ((err = mp_mul_2(a, a)) != MP_OKAY)                          { goto error; }
-      if ((err = mp_add_d(a, 1, a)) != MP_OKAY)                       { goto error; }
+   
+   if ((res = s_mp_sub(&tmp, a, d)) != MP_OKAY) {
+      goto ERR;
    }
-
-   err = MP_OKAY;
-error:
-   XFREE(tmp);
-   return err;
+   
+ERR:
+   mp_clear(&tmp);
+   return res;
 }
-
-
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_prime_random_ex.c,v $ */
-/* $Revision: 1.5 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_reduce_2k_setup_l.c,v $ */
+/* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_prime_random_ex.c
+ --   End: vendor/libtommath-0.41/bn_mp_reduce_2k_setup_l.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_radix_size.c
+ -- Start: vendor/libtommath-0.41/bn_mp_reduce_is_2k.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_RADIX_SIZE_C
+#ifdef BN_MP_REDUCE_IS_2K_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -6455,76 +10454,50 @@ error:
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* returns size of ASCII reprensentation */
-int mp_radix_size (mp_int * a, int radix, int *size)
+/* determines if mp_reduce_2k can be used */
+int mp_reduce_is_2k(mp_int *a)
 {
-  int     res, digs;
-  mp_int  t;
-  mp_digit d;
-
-  *size = 0;
-
-  /* special case for binary */
-  if (radix == 2) {
-    *size = mp_count_bits (a) + (a->sign == MP_NEG ? 1 : 0) + 1;
-    return MP_OKAY;
-  }
-
-  /* make sure the radix is in range */
-  if (radix < 2 || radix > 64) {
-    return MP_VAL;
-  }
-
-  if (mp_iszero(a) == MP_YES) {
-    *size = 2;
-    return MP_OKAY;
-  }
-
-  /* digs is the digit count */
-  digs = 0;
-
-  /* if it's negative add one for the sign */
-  if (a->sign == MP_NEG) {
-    ++digs;
-  }
-
-  /* init a copy of the input */
-  if ((res = mp_init_copy (&t, a)) != MP_OKAY) {
-    return res;
-  }
-
-  /* force temp to positive */
-  t.sign = MP_ZPOS; 
-
-  /* fetch out all of the digits */
-  while (mp_iszero (&t) == MP_NO) {
-    if ((res = mp_div_d (&t, (mp_digit) radix, &t, &d)) != MP_OKAY) {
-      mp_clear (&t);
-      return res;
-    }
-    ++digs;
-  }
-  mp_clear (&t);
-
-  /* return digs + 1, the 1 is for the NULL byte that would be required. */
-  *size = digs + 1;
-  return MP_OKAY;
+   int ix, iy, iw;
+   mp_digit iz;
+   
+   if (a->used == 0) {
+      return MP_NO;
+   } else if (a->used == 1) {
+      return MP_YES;
+   } else if (a->used > 1) {
+      iy = mp_count_bits(a);
+      iz = 1;
+      iw = 1;
+    
+      /* Test every bit from the second digit up, must be 1 */
+      for (ix = DIGIT_BIT; ix < iy; ix++) {
+          if ((a->dp[iw] & iz) == 0) {
+             return MP_NO;
+          }
+          iz <<= 1;
+          if (iz > (mp_digit)MP_MASK || iz == 0) {
+             ++iw;
+             iz = 1;
+          }
+      }
+   }
+   return MP_YES;
 }
 
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_radix_size.c,v $ */
-/* $Revision: 1.5 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_reduce_is_2k.c,v $ */
+/* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_radix_size.c
+ --   End: vendor/libtommath-0.41/bn_mp_reduce_is_2k.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_radix_smap.c
+ -- Start: vendor/libtommath-0.41/bn_mp_reduce_is_2k_l.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_RADIX_SMAP_C
+#ifdef BN_MP_REDUCE_IS_2K_L_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -6540,22 +10513,42 @@ int mp_radix_size (mp_int * a, int radix, int *size)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* chars used in radix conversions */
-const char *mp_s_rmap = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz+/";
+/* determines if reduce_2k_l can be used */
+int mp_reduce_is_2k_l(mp_int *a)
+{
+   int ix, iy;
+   
+   if (a->used == 0) {
+      return MP_NO;
+   } else if (a->used == 1) {
+      return MP_YES;
+   } else if (a->used > 1) {
+      /* if more than half of the digits are -1 we're sold */
+      for (iy = ix = 0; ix < a->used; ix++) {
+          if (a->dp[ix] == MP_MASK) {
+              ++iy;
+          }
+      }
+      return (iy >= (a->used/2)) ? MP_YES : MP_NO;
+      
+   }
+   return MP_NO;
+}
+
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_radix_smap.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_reduce_is_2k_l.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_radix_smap.c
+ --   End: vendor/libtommath-0.41/bn_mp_reduce_is_2k_l.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_rand.c
+ -- Start: vendor/libtommath-0.41/bn_mp_reduce_setup.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_RAND_C
+#ifdef BN_MP_REDUCE_SETUP_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -6571,53 +10564,40 @@ const char *mp_s_rmap = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrs
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* makes a pseudo-random int of a given size */
-int
-mp_rand (mp_int * a, int digits)
+/* pre-calculate the value required for Barrett reduction
+ * For a given modulus "b" it calulates the value required in "a"
+ */
+int mp_reduce_setup (mp_int * a, mp_int * b)
 {
   int     res;
-  mp_digit d;
 
-  mp_zero (a);
-  if (digits <= 0) {
-    return MP_OKAY;
+#ifdef BN_MP_RECIPROCAL_C
+  /* a big modulus with its top bit set?  use Newton's iteration */
+  if (b->used >= BZ_DIV_CUTOFF && a != b && b->sign == MP_ZPOS &&
+      (b->dp[b->used - 1] >> (DIGIT_BIT - 1)) == 1) {
+    return mp_reciprocal (b, a);
   }
-
-  /* first place a random non-zero digit */
-  do {
-    d = ((mp_digit) abs (rand ())) & MP_MASK;
-  } while (d == 0);
-
-  if ((res = mp_add_d (a, d, a)) != MP_OKAY) {
+#endif
+  
+  if ((res = mp_2expt (a, b->used * 2 * DIGIT_BIT)) != MP_OKAY) {
     return res;
   }
-
-  while (--digits > 0) {
-    if ((res = mp_lshd (a, 1)) != MP_OKAY) {
-      return res;
-    }
-
-    if ((res = mp_add_d (a, ((mp_digit) abs (rand ())), a)) != MP_OKAY) {
-      return res;
-    }
-  }
-
-  return MP_OKAY;
+  return mp_div (a, b, a, NULL);
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_rand.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_reduce_setup.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_rand.c
+ --   End: vendor/libtommath-0.41/bn_mp_reduce_setup.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_read_radix.c
+ -- Start: vendor/libtommath-0.41/bn_mp_rshd.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_READ_RADIX_C
+#ifdef BN_MP_RSHD_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -6633,131 +10613,70 @@ mp_rand (mp_int * a, int digits)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* read a string [ASCII] in a given radix */
-int mp_read_radix (mp_int * a, const char *str, int radix)
+/* shift right a certain amount of digits */
+void mp_rshd (mp_int * a, int b)
 {
-  int     y, res, neg;
-  char    ch;
-
-  /* zero the digit bignum */
-  mp_zero(a);
+  int     x;
 
-  /* make sure the radix is ok */
-  if (radix < 2 || radix > 64) {
-    return MP_VAL;
+  /* if b <= 0 then ignore it */
+  if (b <= 0) {
+    return;
   }
 
-  /* if the leading digit is a 
-   * minus set the sign to negative. 
-   */
-  if (*str == '-') {
-    ++str;
-    neg = MP_NEG;
-  } else {
-    neg = MP_ZPOS;
+  /* if b > used then simply zero it and return */
+  if (a->used <= b) {
+    mp_zero (a);
+    return;
   }
 
-  /* set the integer to the default of zero */
-  mp_zero (a);
-  
-  /* process each digit of the string */
-  while (*str) {
-    /* if the radix < 36 the conversion is case insensitive
-     * this allows numbers like 1AB and 1ab to represent the same  value
-     * [e.g. in hex]
-     */
-    ch = (char) ((radix < 36) ? toupper (*str) : *str);
-    for (y = 0; y < 64; y++) {
-      if (ch == mp_s_rmap[y]) {
-         break;
-      }
-    }
+  {
+    register mp_digit *bottom, *top;
 
-    /* if the char was found in the map 
-     * and is less than the given radix add it
-     * to the number, otherwise exit the loop. 
-     */
-    if (y < radix) {
-      if ((res = mp_mul_d (a, (mp_digit) radix, a)) != MP_OKAY) {
-         return res;
-      }
-      if ((res = mp_add_d (a, (mp_digit) y, a)) != MP_OKAY) {
-         return res;
-      }
-    } else {
-      break;
-    }
-    ++str;
-  }
-  
-  /* set the sign only if a != 0 */
-  if (mp_iszero(a) != 1) {
-     a->sign = neg;
-  }
-  return MP_OKAY;
-}
-#endif
+    /* shift the digits down */
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_read_radix.c,v $ */
-/* $Revision: 1.5 $ */
-/* $Date: 2006/12/28 01:25:13 $ */
-/*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_read_radix.c
- ---------------------------------------------------------------------*/
+    /* bottom */
+    bottom = a->dp;
 
-/*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_read_signed_bin.c
- ---------------------------------------------------------------------*/
-#include <tommath.h>
-#ifdef BN_MP_READ_SIGNED_BIN_C
-/* LibTomMath, multiple-precision integer library -- Tom St Denis
- *
- * LibTomMath is a library that provides multiple-precision
- * integer arithmetic as well as number theoretic functionality.
- *
- * The library was designed directly after the MPI library by
- * Michael Fromberger but has been written from scratch with
- * additional optimizations in place.
- *
- * The library is free for all purposes without any express
- * guarantee it works.
- *
- * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
- */
+    /* top [offset into digits] */
+    top = a->dp + b;
 
-/* read signed bin, big endian, first byte is 0==positive or 1==negative */
-int mp_read_signed_bin (mp_int * a, const unsigned char *b, int c)
-{
-  int     res;
+    /* this is implemented as a sliding window where 
+     * the window is b-digits long and digits from 
+     * the top of the window are copied to the bottom
+     *
+     * e.g.
 
-  /* read magnitude */
-  if ((res = mp_read_unsigned_bin (a, b + 1, c - 1)) != MP_OKAY) {
-    return res;
-  }
+     b-2 | b-1 | b0 | b1 | b2 | ... | bb |   ---->
+                 /\                   |      ---->
+                  \-------------------/      ---->
+     */
+    for (x = 0; x < (a->used - b); x++) {
+      *bottom++ = *top++;
+    }
 
-  /* first byte is 0 for positive, non-zero for negative */
-  if (b[0] == 0) {
-     a->sign = MP_ZPOS;
-  } else {
-     a->sign = MP_NEG;
+    /* zero the top digits */
+    for (; x < a->used; x++) {
+      *bottom++ = 0;
+    }
   }
-
-  return MP_OKAY;
+  
+  /* remove excess digits */
+  a->used -= b;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_read_signed_bin.c,v $ */
-/* $Revision: 1.5 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_rshd.c,v $ */
+/* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_read_signed_bin.c
+ --   End: vendor/libtommath-0.41/bn_mp_rshd.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_read_unsigned_bin.c
+ -- Start: vendor/libtommath-0.41/bn_mp_set.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_READ_UNSIGNED_BIN_C
+#ifdef BN_MP_SET_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -6773,53 +10692,27 @@ int mp_read_signed_bin (mp_int * a, const unsigned char *b, int c)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* reads a unsigned char array, assumes the msb is stored first [big endian] */
-int mp_read_unsigned_bin (mp_int * a, const unsigned char *b, int c)
+/* set to a digit */
+void mp_set (mp_int * a, mp_digit b)
 {
-  int     res;
-
-  /* make sure there are at least two digits */
-  if (a->alloc < 2) {
-     if ((res = mp_grow(a, 2)) != MP_OKAY) {
-        return res;
-     }
-  }
-
-  /* zero the int */
   mp_zero (a);
-
-  /* read the bytes in */
-  while (c-- > 0) {
-    if ((res = mp_mul_2d (a, 8, a)) != MP_OKAY) {
-      return res;
-    }
-
-#ifndef MP_8BIT
-      a->dp[0] |= *b++;
-      a->used += 1;
-#else
-      a->dp[0] = (*b & MP_MASK);
-      a->dp[1] |= ((*b++ >> 7U) & 1);
-      a->used += 2;
-#endif
-  }
-  mp_clamp (a);
-  return MP_OKAY;
+  a->dp[0] = b & MP_MASK;
+  a->used  = (a->dp[0] != 0) ? 1 : 0;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_read_unsigned_bin.c,v $ */
-/* $Revision: 1.5 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_set.c,v $ */
+/* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_read_unsigned_bin.c
+ --   End: vendor/libtommath-0.41/bn_mp_set.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_reduce.c
+ -- Start: vendor/libtommath-0.41/bn_mp_set_int.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_REDUCE_C
+#ifdef BN_MP_SET_INT_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -6835,98 +10728,88 @@ int mp_read_unsigned_bin (mp_int * a, const unsigned char *b, int c)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* reduces x mod m, assumes 0 < x < m**2, mu is 
- * precomputed via mp_reduce_setup.
- * From HAC pp.604 Algorithm 14.42
- */
-int mp_reduce (mp_int * x, mp_int * m, mp_int * mu)
+/* set a 32-bit const */
+int mp_set_int (mp_int * a, unsigned long b)
 {
-  mp_int  q;
-  int     res, um = m->used;
-
-  /* q = x */
-  if ((res = mp_init_copy (&q, x)) != MP_OKAY) {
-    return res;
-  }
-
-  /* q1 = x / b**(k-1)  */
-  mp_rshd (&q, um - 1);         
+  int     x, res;
 
-  /* according to HAC this optimization is ok */
-  if (((unsigned long) um) > (((mp_digit)1) << (DIGIT_BIT - 1))) {
-    if ((res = mp_mul (&q, mu, &q)) != MP_OKAY) {
-      goto CLEANUP;
-    }
-  } else {
-#ifdef BN_S_MP_MUL_HIGH_DIGS_C
-    if ((res = s_mp_mul_high_digs (&q, mu, &q, um)) != MP_OKAY) {
-      goto CLEANUP;
-    }
-#elif defined(BN_FAST_S_MP_MUL_HIGH_DIGS_C)
-    if ((res = fast_s_mp_mul_high_digs (&q, mu, &q, um)) != MP_OKAY) {
-      goto CLEANUP;
-    }
-#else 
-    { 
-      res = MP_VAL;
-      goto CLEANUP;
+  mp_zero (a);
+  
+  /* set four bits at a time */
+  for (x = 0; x < 8; x++) {
+    /* shift the number up four bits */
+    if ((res = mp_mul_2d (a, 4, a)) != MP_OKAY) {
+      return res;
     }
-#endif
-  }
 
-  /* q3 = q2 / b**(k+1) */
-  mp_rshd (&q, um + 1);         
+    /* OR in the top four bits of the source */
+    a->dp[0] |= (b >> 28) & 15;
 
-  /* x = x mod b**(k+1), quick (no division) */
-  if ((res = mp_mod_2d (x, DIGIT_BIT * (um + 1), x)) != MP_OKAY) {
-    goto CLEANUP;
-  }
+    /* shift the source up to the next four bits */
+    b <<= 4;
 
-  /* q = q * m mod b**(k+1), quick (no division) */
-  if ((res = s_mp_mul_digs (&q, m, &q, um + 1)) != MP_OKAY) {
-    goto CLEANUP;
+    /* ensure that digits are not clamped off */
+    a->used += 1;
   }
+  mp_clamp (a);
+  return MP_OKAY;
+}
+#endif
 
-  /* x = x - q */
-  if ((res = mp_sub (x, &q, x)) != MP_OKAY) {
-    goto CLEANUP;
-  }
+/* $Source: /cvs/libtom/libtommath/bn_mp_set_int.c,v $ */
+/* $Revision: 1.4 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_mp_set_int.c
+ ---------------------------------------------------------------------*/
 
-  /* If x < 0, add b**(k+1) to it */
-  if (mp_cmp_d (x, 0) == MP_LT) {
-    mp_set (&q, 1);
-    if ((res = mp_lshd (&q, um + 1)) != MP_OKAY)
-      goto CLEANUP;
-    if ((res = mp_add (x, &q, x)) != MP_OKAY)
-      goto CLEANUP;
-  }
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_mp_shrink.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_MP_SHRINK_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
 
-  /* Back off if it's too big */
-  while (mp_cmp (x, m) != MP_LT) {
-    if ((res = s_mp_sub (x, m, x)) != MP_OKAY) {
-      goto CLEANUP;
+/* shrink a bignum */
+int mp_shrink (mp_int * a)
+{
+  mp_digit *tmp;
+  if (a->alloc != a->used && a->used > 0) {
+    if ((tmp = OPT_CAST(mp_digit) XREALLOC (a->dp, sizeof (mp_digit) * a->used)) == NULL) {
+      return MP_MEM;
     }
+    a->dp    = tmp;
+    a->alloc = a->used;
   }
-  
-CLEANUP:
-  mp_clear (&q);
-
-  return res;
+  return MP_OKAY;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_reduce.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_shrink.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_reduce.c
+ --   End: vendor/libtommath-0.41/bn_mp_shrink.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_reduce_2k.c
+ -- Start: vendor/libtommath-0.41/bn_mp_signed_bin_size.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_REDUCE_2K_C
+#ifdef BN_MP_SIGNED_BIN_SIZE_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -6942,59 +10825,25 @@ CLEANUP:
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* reduces a modulo n where n is of the form 2**p - d */
-int mp_reduce_2k(mp_int *a, mp_int *n, mp_digit d)
+/* get the size for an signed equivalent */
+int mp_signed_bin_size (mp_int * a)
 {
-   mp_int q;
-   int    p, res;
-   
-   if ((res = mp_init(&q)) != MP_OKAY) {
-      return res;
-   }
-   
-   p = mp_count_bits(n);    
-top:
-   /* q = a/2**p, a = a mod 2**p */
-   if ((res = mp_div_2d(a, p, &q, a)) != MP_OKAY) {
-      goto ERR;
-   }
-   
-   if (d != 1) {
-      /* q = q * d */
-      if ((res = mp_mul_d(&q, d, &q)) != MP_OKAY) { 
-         goto ERR;
-      }
-   }
-   
-   /* a = a + q */
-   if ((res = s_mp_add(a, &q, a)) != MP_OKAY) {
-      goto ERR;
-   }
-   
-   if (mp_cmp_mag(a, n) != MP_LT) {
-      s_mp_sub(a, n, a);
-      goto top;
-   }
-   
-ERR:
-   mp_clear(&q);
-   return res;
+  return 1 + mp_unsigned_bin_size (a);
 }
-
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_reduce_2k.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_signed_bin_size.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_reduce_2k.c
+ --   End: vendor/libtommath-0.41/bn_mp_signed_bin_size.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_reduce_2k_l.c
+ -- Start: vendor/libtommath-0.41/bn_mp_sqr.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_REDUCE_2K_L_C
+#ifdef BN_MP_SQR_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -7010,60 +10859,80 @@ ERR:
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* reduces a modulo n where n is of the form 2**p - d 
-   This differs from reduce_2k since "d" can be larger
-   than a single digit.
-*/
-int mp_reduce_2k_l(mp_int *a, mp_int *n, mp_int *d)
+/* computes b = a*a */
+int
+mp_sqr (mp_int * a, mp_int * b)
 {
-   mp_int q;
-   int    p, res;
-   
-   if ((res = mp_init(&q)) != MP_OKAY) {
-      return res;
-   }
-   
-   p = mp_count_bits(n);    
-top:
-   /* q = a/2**p, a = a mod 2**p */
-   if ((res = mp_div_2d(a, p, &q, a)) != MP_OKAY) {
-      goto ERR;
-   }
-   
-   /* q = q * d */
-   if ((res = mp_mul(&q, d, &q)) != MP_OKAY) { 
-      goto ERR;
-   }
-   
-   /* a = a + q */
-   if ((res = s_mp_add(a, &q, a)) != MP_OKAY) {
-      goto ERR;
-   }
-   
-   if (mp_cmp_mag(a, n) != MP_LT) {
-      s_mp_sub(a, n, a);
-      goto top;
-   }
-   
-ERR:
-   mp_clear(&q);
-   return res;
-}
+  int     res;
 
+#if defined(BN_MP_NTT_SQR_C) && defined(MP_64BIT)
+  /* use the three prime NTT? */
+  if (FFT_MUL_METHOD == MP_FFT_NTT && a->used >= NTT_SQR_CUTOFF) {
+    res = mp_ntt_sqr(a, b);
+  } else 
+#endif
+#ifdef BN_MP_SSA_SQR_C
+  /* use Schonhage-Strassen? */
+  if (FFT_MUL_METHOD == MP_FFT_SSA && a->used >= SSA_SQR_CUTOFF) {
+    res = mp_ssa_sqr(a, b);
+  } else 
+#endif
+#ifdef BN_MP_TOOM65_SQR_C
+  /* use Toom-6.5? */
+  if (a->used >= TOOM65_SQR_CUTOFF) {
+    res = mp_toom65_sqr(a, b);
+  } else 
+#endif
+#ifdef BN_MP_TOOM4_SQR_C
+  /* use Toom-4? */
+  if (a->used >= TOOM4_SQR_CUTOFF) {
+    res = mp_toom4_sqr(a, b);
+  } else 
+#endif
+#ifdef BN_MP_TOOM_SQR_C
+  /* use Toom-Cook? */
+  if (a->used >= TOOM_SQR_CUTOFF) {
+    res = mp_toom_sqr(a, b);
+  /* Karatsuba? */
+  } else 
+#endif
+#ifdef BN_MP_KARATSUBA_SQR_C
+if (a->used >= KARATSUBA_SQR_CUTOFF) {
+    res = mp_karatsuba_sqr (a, b);
+  } else 
+#endif
+  {
+#ifdef BN_FAST_S_MP_SQR_C
+    /* can we use the fast comba multiplier? */
+    if ((a->used * 2 + 1) < MP_WARRAY && 
+         a->used < 
+         (MP_COMBA_MAX >> 1)) {
+      res = fast_s_mp_sqr (a, b);
+    } else
+#endif
+#ifdef BN_S_MP_SQR_C
+      res = s_mp_sqr (a, b);
+#else
+      res = MP_VAL;
+#endif
+  }
+  b->sign = MP_ZPOS;
+  return res;
+}
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_reduce_2k_l.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_sqr.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_reduce_2k_l.c
+ --   End: vendor/libtommath-0.41/bn_mp_sqr.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_reduce_2k_setup.c
+ -- Start: vendor/libtommath-0.41/bn_mp_sqrmod.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_REDUCE_2K_SETUP_C
+#ifdef BN_MP_SQRMOD_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -7079,45 +10948,39 @@ ERR:
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* determines the setup value */
-int mp_reduce_2k_setup(mp_int *a, mp_digit *d)
+/* c = a * a (mod b) */
+int
+mp_sqrmod (mp_int * a, mp_int * b, mp_int * c)
 {
-   int res, p;
-   mp_int tmp;
-   
-   if ((res = mp_init(&tmp)) != MP_OKAY) {
-      return res;
-   }
-   
-   p = mp_count_bits(a);
-   if ((res = mp_2expt(&tmp, p)) != MP_OKAY) {
-      mp_clear(&tmp);
-      return res;
-   }
-   
-   if ((res = s_mp_sub(&tmp, a, &tmp)) != MP_OKAY) {
-      mp_clear(&tmp);
-      return res;
-   }
-   
-   *d = tmp.dp[0];
-   mp_clear(&tmp);
-   return MP_OKAY;
+  int     res;
+  mp_int  t;
+
+  if ((res = mp_init (&t)) != MP_OKAY) {
+    return res;
+  }
+
+  if ((res = mp_sqr (a, &t)) != MP_OKAY) {
+    mp_clear (&t);
+    return res;
+  }
+  res = mp_mod (&t, b, c);
+  mp_clear (&t);
+  return res;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_reduce_2k_setup.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_sqrmod.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_reduce_2k_setup.c
+ --   End: vendor/libtommath-0.41/bn_mp_sqrmod.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_reduce_2k_setup_l.c
+ -- Start: vendor/libtommath-0.41/bn_mp_sqrt.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_REDUCE_2K_SETUP_L_C
+#ifdef BN_MP_SQRT_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -7133,42 +10996,79 @@ int mp_reduce_2k_setup(mp_int *a, mp_digit *d)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* determines the setup value */
-int mp_reduce_2k_setup_l(mp_int *a, mp_int *d)
+/* this function is less generic than mp_n_root, simpler and faster */
+int mp_sqrt(mp_int *arg, mp_int *ret) 
 {
-   int    res;
-   mp_int tmp;
-   
-   if ((res = mp_init(&tmp)) != MP_OKAY) {
-      return res;
-   }
-   
-   if ((res = mp_2expt(&tmp, mp_count_bits(a))) != MP_OKAY) {
-      goto ERR;
-   }
-   
-   if ((res = s_mp_sub(&tmp, a, d)) != MP_OKAY) {
-      goto ERR;
-   }
-   
-ERR:
-   mp_clear(&tmp);
-   return res;
+  int res;
+  mp_int t1,t2;
+
+  /* must be positive */
+  if (arg->sign == MP_NEG) {
+    return MP_VAL;
+  }
+
+  /* easy out */
+  if (mp_iszero(arg) == MP_YES) {
+    mp_zero(ret);
+    return MP_OKAY;
+  }
+
+  if ((res = mp_init_copy(&t1, arg)) != MP_OKAY) {
+    return res;
+  }
+
+  if ((res = mp_init(&t2)) != MP_OKAY) {
+    goto E2;
+  }
+
+  /* First approx. (not very bad for large arg) */
+  mp_rshd (&t1,t1.used/2);
+
+  /* t1 > 0  */ 
+  if ((res = mp_div(arg,&t1,&t2,NULL)) != MP_OKAY) {
+    goto E1;
+  }
+  if ((res = mp_add(&t1,&t2,&t1)) != MP_OKAY) {
+    goto E1;
+  }
+  if ((res = mp_div_2(&t1,&t1)) != MP_OKAY) {
+    goto E1;
+  }
+  /* And now t1 > sqrt(arg) */
+  do { 
+    if ((res = mp_div(arg,&t1,&t2,NULL)) != MP_OKAY) {
+      goto E1;
+    }
+    if ((res = mp_add(&t1,&t2,&t1)) != MP_OKAY) {
+      goto E1;
+    }
+    if ((res = mp_div_2(&t1,&t1)) != MP_OKAY) {
+      goto E1;
+    }
+    /* t1 >= sqrt(arg) >= t2 at this point */
+  } while (mp_cmp_mag(&t1,&t2) == MP_GT);
+
+  mp_exch(&t1,ret);
+
+E1: mp_clear(&t2);
+E2: mp_clear(&t1);
+  return res;
 }
+
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_reduce_2k_setup_l.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_sqrt.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_reduce_2k_setup_l.c
+ --   End: vendor/libtommath-0.41/bn_mp_sqrt.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_reduce_is_2k.c
+ -- Start: vendor/libtommath-0.41/bn_mp_ssa_mul.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_REDUCE_IS_2K_C
+#ifdef BN_MP_SSA_MUL_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -7184,50 +11084,412 @@ ERR:
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* determines if mp_reduce_2k can be used */
-int mp_reduce_is_2k(mp_int *a)
+/* c = |a| * |b| using Schonhage-Strassen multiplication
+ *
+ * a and b are cut into pieces of m bits which become the coefficients
+ * of two polynomials.  Their product, a convolution of K = 2**k points,
+ * is found with a fast Fourier transform in the ring of integers modulo
+ * F = 2**n + 1.  2 has order 2n in that ring, so 2**(2n/K) is a K-th
+ * root of unity and every twiddle factor is just a shift.  n is chosen
+ * with n >= 2m + k + 1 so the coefficients of the product can not wrap
+ * around F, and as a multiple of K/2 so the root is a whole power of 2.
+ *
+ * The K pointwise products of n bit numbers go back through mp_mul, so
+ * they end up here again when they are big enough.  This gives the
+ * O(N log N log log N) running time.
+ *
+ * When a and b are the same mp_int only one transform is needed and
+ * the pointwise products are squarings, see mp_ssa_sqr.
+ */
+
+/* x = x mod F for 0 <= x <= 2**2n, t is a temp */
+static int s_ssa_norm (mp_int * x, int n, mp_int * f, mp_int * t)
 {
-   int ix, iy, iw;
-   mp_digit iz;
-   
-   if (a->used == 0) {
-      return MP_NO;
-   } else if (a->used == 1) {
-      return MP_YES;
-   } else if (a->used > 1) {
-      iy = mp_count_bits(a);
-      iz = 1;
-      iw = 1;
-    
-      /* Test every bit from the second digit up, must be 1 */
-      for (ix = DIGIT_BIT; ix < iy; ix++) {
-          if ((a->dp[iw] & iz) == 0) {
-             return MP_NO;
-          }
-          iz <<= 1;
-          if (iz > (mp_digit)MP_MASK) {
-             ++iw;
-             iz = 1;
-          }
+  int     res;
+
+  /* 2**n == -1 so x == lo - hi */
+  if ((res = mp_div_2d (x, n, t, NULL)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_mod_2d (x, n, x)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_sub (x, t, x)) != MP_OKAY) {
+    return res;
+  }
+  if (x->sign == MP_NEG) {
+    return mp_add (x, f, x);
+  }
+  return MP_OKAY;
+}
+
+/* x = x * 2**s mod F for 0 <= x <= 2**n and 0 <= s < 2n */
+static int s_ssa_mul_2exp (mp_int * x, int s, int n, mp_int * f, mp_int * t)
+{
+  int     res, neg;
+
+  if (s == 0 || mp_iszero (x) == MP_YES) {
+    return MP_OKAY;
+  }
+
+  /* 2**n == -1 */
+  neg = 0;
+  if (s >= n) {
+    s  -= n;
+    neg = 1;
+  }
+
+  if ((res = mp_mul_2d (x, s, x)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = s_ssa_norm (x, n, f, t)) != MP_OKAY) {
+    return res;
+  }
+  if (neg == 1 && mp_iszero (x) == MP_NO) {
+    return mp_sub (f, x, x);
+  }
+  return MP_OKAY;
+}
+
+/* x = x + y mod F */
+static int s_ssa_add (mp_int * x, mp_int * y, mp_int * f)
+{
+  int     res;
+
+  if ((res = mp_add (x, y, x)) != MP_OKAY) {
+    return res;
+  }
+  if (mp_cmp_mag (x, f) != MP_LT) {
+    return mp_sub (x, f, x);
+  }
+  return MP_OKAY;
+}
+
+/* z = x - y mod F */
+static int s_ssa_sub (mp_int * x, mp_int * y, mp_int * z, mp_int * f)
+{
+  int     res;
+
+  if ((res = mp_sub (x, y, z)) != MP_OKAY) {
+    return res;
+  }
+  if (z->sign == MP_NEG) {
+    return mp_add (z, f, z);
+  }
+  return MP_OKAY;
+}
+
+/* forward transform, decimation in frequency, leaves A in bit reversed
+ * order.  The twiddle for butterfly j of a span of len is 2**(j*n/len).
+ */
+static int s_ssa_fft (mp_int * A, int K, int n, mp_int * f, mp_int * t)
+{
+  int     res, len, s, j;
+
+  for (len = K >> 1; len >= 1; len >>= 1) {
+    for (s = 0; s < K; s += len << 1) {
+      for (j = 0; j < len; j++) {
+        if ((res = s_ssa_sub (&A[s + j], &A[s + j + len], t, f)) != MP_OKAY) {
+          return res;
+        }
+        if ((res = s_ssa_add (&A[s + j], &A[s + j + len], f)) != MP_OKAY) {
+          return res;
+        }
+        mp_exch (t, &A[s + j + len]);
+        if ((res = s_ssa_mul_2exp (&A[s + j + len], j * (n / len), n, f, t)) != MP_OKAY) {
+          return res;
+        }
+      }
+    }
+  }
+  return MP_OKAY;
+}
+
+/* inverse transform, decimation in time from bit reversed order back to
+ * natural order, without the division by K
+ */
+static int s_ssa_ifft (mp_int * A, int K, int n, mp_int * f, mp_int * t)
+{
+  int     res, len, s, j, e;
+
+  for (len = 1; len < K; len <<= 1) {
+    for (s = 0; s < K; s += len << 1) {
+      for (j = 0; j < len; j++) {
+        e = j * (n / len);
+        if (e != 0) {
+          e = 2 * n - e;
+        }
+        if ((res = s_ssa_mul_2exp (&A[s + j + len], e, n, f, t)) != MP_OKAY) {
+          return res;
+        }
+        if ((res = s_ssa_sub (&A[s + j], &A[s + j + len], t, f)) != MP_OKAY) {
+          return res;
+        }
+        if ((res = s_ssa_add (&A[s + j], &A[s + j + len], f)) != MP_OKAY) {
+          return res;
+        }
+        mp_exch (t, &A[s + j + len]);
+      }
+    }
+  }
+  return MP_OKAY;
+}
+
+/* out = the len bits of |a| starting at bit off */
+static int s_ssa_get_bits (mp_int * a, int off, int len, mp_int * out)
+{
+  int     res, d0, d1, x;
+
+  d0 = off / DIGIT_BIT;
+  d1 = (off + len + DIGIT_BIT - 1) / DIGIT_BIT;
+  if (d1 > a->used) {
+    d1 = a->used;
+  }
+
+  mp_zero (out);
+  if (d0 >= d1) {
+    return MP_OKAY;
+  }
+  if (out->alloc < d1 - d0) {
+    if ((res = mp_grow (out, d1 - d0)) != MP_OKAY) {
+      return res;
+    }
+  }
+  for (x = d0; x < d1; x++) {
+    out->dp[x - d0] = a->dp[x];
+  }
+  out->used = d1 - d0;
+  mp_clamp (out);
+
+  if ((res = mp_div_2d (out, off % DIGIT_BIT, out, NULL)) != MP_OKAY) {
+    return res;
+  }
+  return mp_mod_2d (out, len, out);
+}
+
+/* r += x * 2**off, r has room for the sum and only the digits at and
+ * above off are touched.  t is a temp.
+ */
+static int s_ssa_add_at (mp_int * r, mp_int * x, int off, mp_int * t)
+{
+  int       res, ix, iy;
+  mp_digit  u;
+#ifdef MP_64BIT_FULL
+  mp_word   w;
+#endif
+
+  if (mp_iszero (x) == MP_YES) {
+    return MP_OKAY;
+  }
+  if ((res = mp_mul_2d (x, off % DIGIT_BIT, t)) != MP_OKAY) {
+    return res;
+  }
+
+  u  = 0;
+  iy = off / DIGIT_BIT;
+#ifdef MP_64BIT_FULL
+  for (ix = 0; ix < t->used; ix++, iy++) {
+    w          = ((mp_word)r->dp[iy]) + ((mp_word)t->dp[ix]) + ((mp_word)u);
+    r->dp[iy]  = (mp_digit)w;
+    u          = (mp_digit)(w >> ((mp_word)DIGIT_BIT));
+  }
+  while (u != 0) {
+    r->dp[iy] += u;
+    u          = (r->dp[iy] < u);
+    ++iy;
+  }
+#else
+  for (ix = 0; ix < t->used; ix++, iy++) {
+    r->dp[iy] += t->dp[ix] + u;
+    u          = r->dp[iy] >> ((mp_digit)DIGIT_BIT);
+    r->dp[iy] &= MP_MASK;
+  }
+  while (u != 0) {
+    r->dp[iy] += u;
+    u          = r->dp[iy] >> ((mp_digit)DIGIT_BIT);
+    r->dp[iy] &= MP_MASK;
+    ++iy;
+  }
+#endif
+  if (iy > r->used) {
+    r->used = iy;
+  }
+  return MP_OKAY;
+}
+
+/* pick k, m and n for a product of abits by bbits bits.  K is about the
+ * square root of the product size, a little under it since the shifts
+ * and adds of the transforms cost more per bit than the products.
+ */
+static void s_ssa_params (int abits, int bbits, int *pk, int *pm, int *pn)
+{
+  int     k, K, lg, q;
+
+  /* k = round(log2(abits + bbits) / 2) - 1 */
+  for (lg = 0; ((abits + bbits) >> lg) > 1; lg++);
+  k = (lg - 1) / 2;
+  if (k < 2) {
+    k = 2;
+  }
+  K = 1 << k;
+
+  /* ceil(abits/m) + ceil(bbits/m) - 1 <= K pieces */
+  *pk = k;
+  *pm = (abits + bbits + K - 2) / (K - 1);
+
+  /* n >= 2m + k + 1, a multiple of K/2 */
+  q   = K >> 1;
+  *pn = ((2 * *pm + k + 1 + q - 1) / q) * q;
+}
+
+int mp_ssa_mul (mp_int * a, mp_int * b, mp_int * c)
+{
+  mp_int  *A, *B, f, t, r;
+  int      res, sqr, k, K, m, n, w, i, na, nb, abits, bbits;
+  size_t   mark;
+
+  sqr   = (a == b);
+  abits = mp_count_bits (a);
+  bbits = mp_count_bits (b);
+  if (abits == 0 || bbits == 0) {
+    mp_zero (c);
+    return MP_OKAY;
+  }
+
+  s_ssa_params (abits, bbits, &k, &m, &n);
+  K  = 1 << k;
+  w  = n / DIGIT_BIT + 2;
+  na = 0;
+  nb = 0;
+
+  /* the coefficients and temps are scratch, the result is built in r */
+  mark = XSCRATCH_MARK ();
+  XSCRATCH_RESERVE (sizeof (mp_digit) * (size_t)((sqr ? 1 : 2) * K + 2) * (2 * w + 3 * MP_PREC));
+
+  B = NULL;
+  if ((A = OPT_CAST(mp_int) XMALLOC (sizeof (mp_int) * K)) == NULL) {
+    res = MP_MEM;
+    goto LBL_MARK;
+  }
+  if (sqr == 0) {
+    if ((B = OPT_CAST(mp_int) XMALLOC (sizeof (mp_int) * K)) == NULL) {
+      res = MP_MEM;
+      goto LBL_ARR;
+    }
+  }
+  for (na = 0; na < K; na++) {
+    if ((res = mp_init_scratch (&A[na], 2 * w)) != MP_OKAY) {
+      goto LBL_ARR;
+    }
+  }
+  if (sqr == 0) {
+    for (nb = 0; nb < K; nb++) {
+      if ((res = mp_init_scratch (&B[nb], 2 * w)) != MP_OKAY) {
+        goto LBL_ARR;
+      }
+    }
+  }
+  if ((res = mp_init_scratch_multi (2 * w, &f, &t, NULL)) != MP_OKAY) {
+    goto LBL_ARR;
+  }
+  if ((res = mp_init_size (&r, (abits + bbits) / DIGIT_BIT + 2)) != MP_OKAY) {
+    goto LBL_FT;
+  }
+
+  /* F = 2**n + 1 */
+  if ((res = mp_2expt (&f, n)) != MP_OKAY) {
+    goto LBL_R;
+  }
+  if ((res = mp_add_d (&f, 1, &f)) != MP_OKAY) {
+    goto LBL_R;
+  }
+
+  /* cut the inputs into m bit pieces and transform them */
+  for (i = 0; i * m < abits; i++) {
+    if ((res = s_ssa_get_bits (a, i * m, m, &A[i])) != MP_OKAY) {
+      goto LBL_R;
+    }
+  }
+  if ((res = s_ssa_fft (A, K, n, &f, &t)) != MP_OKAY) {
+    goto LBL_R;
+  }
+  if (sqr == 0) {
+    for (i = 0; i * m < bbits; i++) {
+      if ((res = s_ssa_get_bits (b, i * m, m, &B[i])) != MP_OKAY) {
+        goto LBL_R;
       }
-   }
-   return MP_YES;
-}
+    }
+    if ((res = s_ssa_fft (B, K, n, &f, &t)) != MP_OKAY) {
+      goto LBL_R;
+    }
+  }
+
+  /* pointwise products */
+  for (i = 0; i < K; i++) {
+    if (sqr == 1) {
+      res = mp_sqr (&A[i], &A[i]);
+    } else {
+      res = mp_mul (&A[i], &B[i], &A[i]);
+    }
+    if (res != MP_OKAY) {
+      goto LBL_R;
+    }
+    if ((res = s_ssa_norm (&A[i], n, &f, &t)) != MP_OKAY) {
+      goto LBL_R;
+    }
+  }
+
+  /* back to the coefficients of the product, divided by K = 2**k */
+  if ((res = s_ssa_ifft (A, K, n, &f, &t)) != MP_OKAY) {
+    goto LBL_R;
+  }
+  for (i = 0; i < K; i++) {
+    if ((res = s_ssa_mul_2exp (&A[i], 2 * n - k, n, &f, &t)) != MP_OKAY) {
+      goto LBL_R;
+    }
+    if ((res = s_ssa_add_at (&r, &A[i], i * m, &t)) != MP_OKAY) {
+      goto LBL_R;
+    }
+  }
 
+  mp_clamp (&r);
+  r.sign = MP_ZPOS;
+  mp_exch (&r, c);
+  res = MP_OKAY;
+
+LBL_R:mp_clear (&r);
+LBL_FT:mp_clear_multi (&f, &t, NULL);
+LBL_ARR:
+  while (na > 0) {
+    mp_clear (&A[--na]);
+  }
+  while (nb > 0) {
+    mp_clear (&B[--nb]);
+  }
+  if (A != NULL) {
+    XFREE (A);
+  }
+  if (B != NULL) {
+    XFREE (B);
+  }
+LBL_MARK:
+  XSCRATCH_RELEASE (mark);
+  return res;
+}
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_reduce_is_2k.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_ssa_mul.c,v $ */
+/* $Revision: 1.1 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_reduce_is_2k.c
+ --   End: vendor/libtommath-0.41/bn_mp_ssa_mul.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_reduce_is_2k_l.c
+ -- Start: vendor/libtommath-0.41/bn_mp_ssa_sqr.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_REDUCE_IS_2K_L_C
+#ifdef BN_MP_SSA_SQR_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -7243,42 +11505,27 @@ int mp_reduce_is_2k(mp_int *a)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* determines if reduce_2k_l can be used */
-int mp_reduce_is_2k_l(mp_int *a)
+/* b = a*a using Schonhage-Strassen, see mp_ssa_mul which only does one
+ * transform when both of its inputs are the same mp_int
+ */
+int mp_ssa_sqr (mp_int * a, mp_int * b)
 {
-   int ix, iy;
-   
-   if (a->used == 0) {
-      return MP_NO;
-   } else if (a->used == 1) {
-      return MP_YES;
-   } else if (a->used > 1) {
-      /* if more than half of the digits are -1 we're sold */
-      for (iy = ix = 0; ix < a->used; ix++) {
-          if (a->dp[ix] == MP_MASK) {
-              ++iy;
-          }
-      }
-      return (iy >= (a->used/2)) ? MP_YES : MP_NO;
-      
-   }
-   return MP_NO;
+  return mp_ssa_mul (a, a, b);
 }
-
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_reduce_is_2k_l.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_ssa_sqr.c,v $ */
+/* $Revision: 1.1 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_reduce_is_2k_l.c
+ --   End: vendor/libtommath-0.41/bn_mp_ssa_sqr.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_reduce_setup.c
+ -- Start: vendor/libtommath-0.41/bn_mp_sub.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_REDUCE_SETUP_C
+#ifdef BN_MP_SUB_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -7294,32 +11541,57 @@ int mp_reduce_is_2k_l(mp_int *a)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* pre-calculate the value required for Barrett reduction
- * For a given modulus "b" it calulates the value required in "a"
- */
-int mp_reduce_setup (mp_int * a, mp_int * b)
+/* high level subtraction (handles signs) */
+int
+mp_sub (mp_int * a, mp_int * b, mp_int * c)
 {
-  int     res;
-  
-  if ((res = mp_2expt (a, b->used * 2 * DIGIT_BIT)) != MP_OKAY) {
-    return res;
+  int     sa, sb, res;
+
+  sa = a->sign;
+  sb = b->sign;
+
+  if (sa != sb) {
+    /* subtract a negative from a positive, OR */
+    /* subtract a positive from a negative. */
+    /* In either case, ADD their magnitudes, */
+    /* and use the sign of the first number. */
+    c->sign = sa;
+    res = s_mp_add (a, b, c);
+  } else {
+    /* subtract a positive from a positive, OR */
+    /* subtract a negative from a negative. */
+    /* First, take the difference between their */
+    /* magnitudes, then... */
+    if (mp_cmp_mag (a, b) != MP_LT) {
+      /* Copy the sign from the first */
+      c->sign = sa;
+      /* The first has a larger or equal magnitude */
+      res = s_mp_sub (a, b, c);
+    } else {
+      /* The result has the *opposite* sign from */
+      /* the first number. */
+      c->sign = (sa == MP_ZPOS) ? MP_NEG : MP_ZPOS;
+      /* The second has a larger magnitude */
+      res = s_mp_sub (b, a, c);
+    }
   }
-  return mp_div (a, b, a, NULL);
+  return res;
 }
+
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_reduce_setup.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_sub.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_reduce_setup.c
+ --   End: vendor/libtommath-0.41/bn_mp_sub.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_rshd.c
+ -- Start: vendor/libtommath-0.41/bn_mp_sub_d.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_RSHD_C
+#ifdef BN_MP_SUB_D_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -7335,106 +11607,105 @@ int mp_reduce_setup (mp_int * a, mp_int * b)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* shift right a certain amount of digits */
-void mp_rshd (mp_int * a, int b)
+/* single digit subtraction */
+int
+mp_sub_d (mp_int * a, mp_digit b, mp_int * c)
 {
-  int     x;
+  mp_digit *tmpa, *tmpc, mu;
+  int       res, ix, oldused;
 
-  /* if b <= 0 then ignore it */
-  if (b <= 0) {
-    return;
+  /* grow c as required */
+  if (c->alloc < a->used + 1) {
+     if ((res = mp_grow(c, a->used + 1)) != MP_OKAY) {
+        return res;
+     }
   }
 
-  /* if b > used then simply zero it and return */
-  if (a->used <= b) {
-    mp_zero (a);
-    return;
+  /* if a is negative just do an unsigned
+   * addition [with fudged signs]
+   */
+  if (a->sign == MP_NEG) {
+     a->sign = MP_ZPOS;
+     res     = mp_add_d(a, b, c);
+     a->sign = c->sign = MP_NEG;
+
+     /* clamp */
+     mp_clamp(c);
+
+     return res;
   }
 
-  {
-    register mp_digit *bottom, *top;
+  /* setup regs */
+  oldused = c->used;
+  tmpa    = a->dp;
+  tmpc    = c->dp;
 
-    /* shift the digits down */
+  /* if a <= b simply fix the single digit */
+  if ((a->used == 1 && a->dp[0] <= b) || a->used == 0) {
+     if (a->used == 1) {
+        *tmpc++ = b - *tmpa;
+     } else {
+        *tmpc++ = b;
+     }
+     ix      = 1;
 
-    /* bottom */
-    bottom = a->dp;
+     /* negative/1digit */
+     c->sign = MP_NEG;
+     c->used = 1;
+  } else {
+     /* positive/size */
+     c->sign = MP_ZPOS;
+     c->used = a->used;
 
-    /* top [offset into digits] */
-    top = a->dp + b;
+#ifdef MP_64BIT_FULL
+     /* full digits, there is no spare top bit to borrow from.  c can be
+      * a so the borrow is found without reading a again
+      */
+     mu       = (*tmpa < b);
+     *tmpc++  = *tmpa++ - b;
 
-    /* this is implemented as a sliding window where 
-     * the window is b-digits long and digits from 
-     * the top of the window are copied to the bottom
-     *
-     * e.g.
+     /* handle rest of the digits, only 0 - 1 borrows */
+     for (ix = 1; ix < a->used; ix++) {
+        *tmpc    = *tmpa++ - mu;
+        mu      &= (*tmpc++ == MP_MASK);
+     }
+#else
+     /* subtract first digit */
+     *tmpc    = *tmpa++ - b;
+     mu       = *tmpc >> (sizeof(mp_digit) * CHAR_BIT - 1);
+     *tmpc++ &= MP_MASK;
 
-     b-2 | b-1 | b0 | b1 | b2 | ... | bb |   ---->
-                 /\                   |      ---->
-                  \-------------------/      ---->
-     */
-    for (x = 0; x < (a->used - b); x++) {
-      *bottom++ = *top++;
-    }
+     /* handle rest of the digits */
+     for (ix = 1; ix < a->used; ix++) {
+        *tmpc    = *tmpa++ - mu;
+        mu       = *tmpc >> (sizeof(mp_digit) * CHAR_BIT - 1);
+        *tmpc++ &= MP_MASK;
+     }
+#endif
+  }
 
-    /* zero the top digits */
-    for (; x < a->used; x++) {
-      *bottom++ = 0;
-    }
+  /* zero excess digits */
+  while (ix++ < oldused) {
+     *tmpc++ = 0;
   }
-  
-  /* remove excess digits */
-  a->used -= b;
+  mp_clamp(c);
+  return MP_OKAY;
 }
-#endif
-
-/* $Source: /cvs/libtom/libtommath/bn_mp_rshd.c,v $ */
-/* $Revision: 1.4 $ */
-/* $Date: 2006/12/28 01:25:13 $ */
-/*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_rshd.c
- ---------------------------------------------------------------------*/
-
-/*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_set.c
- ---------------------------------------------------------------------*/
-#include <tommath.h>
-#ifdef BN_MP_SET_C
-/* LibTomMath, multiple-precision integer library -- Tom St Denis
- *
- * LibTomMath is a library that provides multiple-precision
- * integer arithmetic as well as number theoretic functionality.
- *
- * The library was designed directly after the MPI library by
- * Michael Fromberger but has been written from scratch with
- * additional optimizations in place.
- *
- * The library is free for all purposes without any express
- * guarantee it works.
- *
- * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
- */
 
-/* set to a digit */
-void mp_set (mp_int * a, mp_digit b)
-{
-  mp_zero (a);
-  a->dp[0] = b & MP_MASK;
-  a->used  = (a->dp[0] != 0) ? 1 : 0;
-}
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_set.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_sub_d.c,v $ */
+/* $Revision: 1.6 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_set.c
+ --   End: vendor/libtommath-0.41/bn_mp_sub_d.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_set_int.c
+ -- Start: vendor/libtommath-0.41/bn_mp_submod.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_SET_INT_C
+#ifdef BN_MP_SUBMOD_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -7450,46 +11721,40 @@ void mp_set (mp_int * a, mp_digit b)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* set a 32-bit const */
-int mp_set_int (mp_int * a, unsigned long b)
+/* d = a - b (mod c) */
+int
+mp_submod (mp_int * a, mp_int * b, mp_int * c, mp_int * d)
 {
-  int     x, res;
-
-  mp_zero (a);
-  
-  /* set four bits at a time */
-  for (x = 0; x < 8; x++) {
-    /* shift the number up four bits */
-    if ((res = mp_mul_2d (a, 4, a)) != MP_OKAY) {
-      return res;
-    }
+  int     res;
+  mp_int  t;
 
-    /* OR in the top four bits of the source */
-    a->dp[0] |= (b >> 28) & 15;
 
-    /* shift the source up to the next four bits */
-    b <<= 4;
+  if ((res = mp_init (&t)) != MP_OKAY) {
+    return res;
+  }
 
-    /* ensure that digits are not clamped off */
-    a->used += 1;
+  if ((res = mp_sub (a, b, &t)) != MP_OKAY) {
+    mp_clear (&t);
+    return res;
   }
-  mp_clamp (a);
-  return MP_OKAY;
+  res = mp_mod (&t, c, d);
+  mp_clear (&t);
+  return res;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_set_int.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_submod.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_set_int.c
+ --   End: vendor/libtommath-0.41/bn_mp_submod.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_shrink.c
+ -- Start: vendor/libtommath-0.41/bn_mp_to_signed_bin.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_SHRINK_C
+#ifdef BN_MP_TO_SIGNED_BIN_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -7505,33 +11770,31 @@ int mp_set_int (mp_int * a, unsigned long b)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* shrink a bignum */
-int mp_shrink (mp_int * a)
+/* store in signed [big endian] format */
+int mp_to_signed_bin (mp_int * a, unsigned char *b)
 {
-  mp_digit *tmp;
-  if (a->alloc != a->used && a->used > 0) {
-    if ((tmp = OPT_CAST(mp_digit) XREALLOC (a->dp, sizeof (mp_digit) * a->used)) == NULL) {
-      return MP_MEM;
-    }
-    a->dp    = tmp;
-    a->alloc = a->used;
+  int     res;
+
+  if ((res = mp_to_unsigned_bin (a, b + 1)) != MP_OKAY) {
+    return res;
   }
+  b[0] = (unsigned char) ((a->sign == MP_ZPOS) ? 0 : 1);
   return MP_OKAY;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_shrink.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_to_signed_bin.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_shrink.c
+ --   End: vendor/libtommath-0.41/bn_mp_to_signed_bin.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_signed_bin_size.c
+ -- Start: vendor/libtommath-0.41/bn_mp_to_signed_bin_n.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_SIGNED_BIN_SIZE_C
+#ifdef BN_MP_TO_SIGNED_BIN_N_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -7547,25 +11810,29 @@ int mp_shrink (mp_int * a)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* get the size for an signed equivalent */
-int mp_signed_bin_size (mp_int * a)
+/* store in signed [big endian] format */
+int mp_to_signed_bin_n (mp_int * a, unsigned char *b, unsigned long *outlen)
 {
-  return 1 + mp_unsigned_bin_size (a);
+   if (*outlen < (unsigned long)mp_signed_bin_size(a)) {
+      return MP_VAL;
+   }
+   *outlen = mp_signed_bin_size(a);
+   return mp_to_signed_bin(a, b);
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_signed_bin_size.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_to_signed_bin_n.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_signed_bin_size.c
+ --   End: vendor/libtommath-0.41/bn_mp_to_signed_bin_n.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_sqr.c
+ -- Start: vendor/libtommath-0.41/bn_mp_to_unsigned_bin.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_SQR_C
+#ifdef BN_MP_TO_UNSIGNED_BIN_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -7581,56 +11848,26 @@ int mp_signed_bin_size (mp_int * a)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* computes b = a*a */
-int
-mp_sqr (mp_int * a, mp_int * b)
+/* store in unsigned [big endian] format */
+int mp_to_unsigned_bin (mp_int * a, unsigned char *b)
 {
-  int     res;
-
-#ifdef BN_MP_TOOM_SQR_C
-  /* use Toom-Cook? */
-  if (a->used >= TOOM_SQR_CUTOFF) {
-    res = mp_toom_sqr(a, b);
-  /* Karatsuba? */
-  } else 
-#endif
-#ifdef BN_MP_KARATSUBA_SQR_C
-if (a->used >= KARATSUBA_SQR_CUTOFF) {
-    res = mp_karatsuba_sqr (a, b);
-  } else 
-#endif
-  {
-#ifdef BN_FAST_S_MP_SQR_C
-    /* can we use the fast comba multiplier? */
-    if ((a->used * 2 + 1) < MP_WARRAY && 
-         a->used < 
-         (1 << (sizeof(mp_word) * CHAR_BIT - 2*DIGIT_BIT - 1))) {
-      res = fast_s_mp_sqr (a, b);
-    } else
-#endif
-#ifdef BN_S_MP_SQR_C
-      res = s_mp_sqr (a, b);
-#else
-      res = MP_VAL;
-#endif
-  }
-  b->sign = MP_ZPOS;
-  return res;
+  /* one byte words, so nothing is written for zero */
+  return mp_export (b, NULL, 1, 1, 1, 0, a);
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_sqr.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_to_unsigned_bin.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_sqr.c
+ --   End: vendor/libtommath-0.41/bn_mp_to_unsigned_bin.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_sqrmod.c
+ -- Start: vendor/libtommath-0.41/bn_mp_to_unsigned_bin_n.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_SQRMOD_C
+#ifdef BN_MP_TO_UNSIGNED_BIN_N_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -7646,39 +11883,29 @@ if (a->used >= KARATSUBA_SQR_CUTOFF) {
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* c = a * a (mod b) */
-int
-mp_sqrmod (mp_int * a, mp_int * b, mp_int * c)
+/* store in unsigned [big endian] format */
+int mp_to_unsigned_bin_n (mp_int * a, unsigned char *b, unsigned long *outlen)
 {
-  int     res;
-  mp_int  t;
-
-  if ((res = mp_init (&t)) != MP_OKAY) {
-    return res;
-  }
-
-  if ((res = mp_sqr (a, &t)) != MP_OKAY) {
-    mp_clear (&t);
-    return res;
-  }
-  res = mp_mod (&t, b, c);
-  mp_clear (&t);
-  return res;
+   if (*outlen < (unsigned long)mp_unsigned_bin_size(a)) {
+      return MP_VAL;
+   }
+   *outlen = mp_unsigned_bin_size(a);
+   return mp_to_unsigned_bin(a, b);
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_sqrmod.c,v $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_to_unsigned_bin_n.c,v $ */
 /* $Revision: 1.4 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_sqrmod.c
+ --   End: vendor/libtommath-0.41/bn_mp_to_unsigned_bin_n.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_sqrt.c
+ -- Start: vendor/libtommath-0.41/bn_mp_toom25_mul.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_SQRT_C
+#ifdef BN_MP_TOOM25_MUL_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -7694,79 +11921,171 @@ mp_sqrmod (mp_int * a, mp_int * b, mp_int * c)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* this function is less generic than mp_n_root, simpler and faster */
-int mp_sqrt(mp_int *arg, mp_int *ret) 
+/* multiplication using Toom-2.5, for a about one and a half times as
+ * long as b
+ *
+ * a is cut into three pieces and b into two, B digits each,
+ *
+ *   a = a2 * x**2 + a1 * x + a0,   b = b1 * x + b0,   x = 2**(DIGIT_BIT*B)
+ *
+ * and the product, of degree three in x, is found from its values at
+ * 0, 1, -1 and infinity
+ *
+ *   w0   = a0 * b0
+ *   w1   = (a0 + a1 + a2)(b0 + b1)
+ *   wm1  = (a0 - a1 + a2)(b0 - b1)
+ *   winf = a2 * b1
+ *
+ * as c = winf * x**3 + ((w1 + wm1)/2 - w0) * x**2
+ *        + ((w1 - wm1)/2 - winf) * x + w0
+ *
+ * That is four products of B digits where splitting both into three
+ * pieces, as mp_toom_mul does, leaves the pieces of b mostly empty.
+ */
+int mp_toom25_mul(mp_int *a, mp_int *b, mp_int *c)
 {
-  int res;
-  mp_int t1,t2;
+    mp_int w0, w1, wm1, winf, tmp1, tmp2, a0, a1, a2, b0, b1;
+    int res, B;
+    size_t mark;
 
-  /* must be positive */
-  if (arg->sign == MP_NEG) {
-    return MP_VAL;
-  }
+    /* B */
+    B = MAX((a->used + 2) / 3, (b->used + 1) / 2);
 
-  /* easy out */
-  if (mp_iszero(arg) == MP_YES) {
-    mp_zero(ret);
-    return MP_OKAY;
-  }
+    mark = XSCRATCH_MARK();
+    XSCRATCH_RESERVE(sizeof(mp_digit) * 12 * (a->used + b->used + 8 * MP_PREC));
+    if ((res = mp_init_scratch_multi(a->used + 1, &a0, &a1, &a2, NULL)) != MP_OKAY) {
+       goto LBL_MARK;
+    }
+    if ((res = mp_init_scratch_multi(b->used + 1, &b0, &b1, NULL)) != MP_OKAY) {
+       goto LBL_A;
+    }
+    if ((res = mp_init_scratch_multi(a->used + b->used + 2,
+                                     &w0, &w1, &wm1, &winf,
+                                     &tmp1, &tmp2, NULL)) != MP_OKAY) {
+       goto LBL_B;
+    }
 
-  if ((res = mp_init_copy(&t1, arg)) != MP_OKAY) {
-    return res;
-  }
+    /* a = a2 * B**2 + a1 * B + a0 */
+    if ((res = mp_mod_2d(a, DIGIT_BIT * B, &a0)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_copy(a, &a1)) != MP_OKAY) {
+       goto ERR;
+    }
+    mp_rshd(&a1, B);
+    mp_mod_2d(&a1, DIGIT_BIT * B, &a1);
+    if ((res = mp_copy(a, &a2)) != MP_OKAY) {
+       goto ERR;
+    }
+    mp_rshd(&a2, B*2);
 
-  if ((res = mp_init(&t2)) != MP_OKAY) {
-    goto E2;
-  }
+    /* b = b1 * B + b0 */
+    if ((res = mp_mod_2d(b, DIGIT_BIT * B, &b0)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_copy(b, &b1)) != MP_OKAY) {
+       goto ERR;
+    }
+    mp_rshd(&b1, B);
 
-  /* First approx. (not very bad for large arg) */
-  mp_rshd (&t1,t1.used/2);
+    /* the sign is mp_mul's business */
+    a0.sign = a1.sign = a2.sign = b0.sign = b1.sign = MP_ZPOS;
 
-  /* t1 > 0  */ 
-  if ((res = mp_div(arg,&t1,&t2,NULL)) != MP_OKAY) {
-    goto E1;
-  }
-  if ((res = mp_add(&t1,&t2,&t1)) != MP_OKAY) {
-    goto E1;
-  }
-  if ((res = mp_div_2(&t1,&t1)) != MP_OKAY) {
-    goto E1;
-  }
-  /* And now t1 > sqrt(arg) */
-  do { 
-    if ((res = mp_div(arg,&t1,&t2,NULL)) != MP_OKAY) {
-      goto E1;
+    /* w0 = a0*b0, winf = a2*b1 */
+    if ((res = mp_mul(&a0, &b0, &w0)) != MP_OKAY) {
+       goto ERR;
     }
-    if ((res = mp_add(&t1,&t2,&t1)) != MP_OKAY) {
-      goto E1;
+    if ((res = mp_mul(&a2, &b1, &winf)) != MP_OKAY) {
+       goto ERR;
+    }
+
+    /* w1 = (a0 + a1 + a2)(b0 + b1), wm1 = (a0 - a1 + a2)(b0 - b1) */
+    if ((res = mp_add(&a0, &a2, &a0)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_add(&a0, &a1, &tmp1)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_add(&b0, &b1, &tmp2)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_mul(&tmp1, &tmp2, &w1)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_sub(&a0, &a1, &tmp1)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_sub(&b0, &b1, &tmp2)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_mul(&tmp1, &tmp2, &wm1)) != MP_OKAY) {
+       goto ERR;
+    }
+
+    /* w1 = (w1 - wm1)/2 - winf, wm1 = (w1 + wm1)/2 - w0 */
+    if ((res = mp_sub(&w1, &wm1, &tmp1)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_add(&w1, &wm1, &wm1)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_div_2(&tmp1, &w1)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_sub(&w1, &winf, &w1)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_div_2(&wm1, &wm1)) != MP_OKAY) {
+       goto ERR;
     }
-    if ((res = mp_div_2(&t1,&t1)) != MP_OKAY) {
-      goto E1;
+    if ((res = mp_sub(&wm1, &w0, &wm1)) != MP_OKAY) {
+       goto ERR;
     }
-    /* t1 >= sqrt(arg) >= t2 at this point */
-  } while (mp_cmp_mag(&t1,&t2) == MP_GT);
 
-  mp_exch(&t1,ret);
+    /* shift W[n] by B*n and add them up */
+    if ((res = mp_lshd(&w1, 1*B)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_lshd(&wm1, 2*B)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_lshd(&winf, 3*B)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_add(&w0, &w1, &w0)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_add(&wm1, &winf, &wm1)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_add(&w0, &wm1, c)) != MP_OKAY) {
+       goto ERR;
+    }
 
-E1: mp_clear(&t2);
-E2: mp_clear(&t1);
-  return res;
+ERR:
+    mp_clear_multi(&w0, &w1, &wm1, &winf, &tmp1, &tmp2, NULL);
+LBL_B:
+    mp_clear_multi(&b0, &b1, NULL);
+LBL_A:
+    mp_clear_multi(&a0, &a1, &a2, NULL);
+LBL_MARK:
+    XSCRATCH_RELEASE(mark);
+    return res;
 }
-
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_sqrt.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_toom25_mul.c,v $ */
+/* $Revision: 1.1 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_sqrt.c
+ --   End: vendor/libtommath-0.41/bn_mp_toom25_mul.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_sub.c
+ -- Start: vendor/libtommath-0.41/bn_mp_toom35_mul.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_SUB_C
+#ifdef BN_MP_TOOM35_MUL_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -7782,157 +12101,294 @@ E2: mp_clear(&t1);
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* high level subtraction (handles signs) */
-int
-mp_sub (mp_int * a, mp_int * b, mp_int * c)
-{
-  int     sa, sb, res;
-
-  sa = a->sign;
-  sb = b->sign;
-
-  if (sa != sb) {
-    /* subtract a negative from a positive, OR */
-    /* subtract a positive from a negative. */
-    /* In either case, ADD their magnitudes, */
-    /* and use the sign of the first number. */
-    c->sign = sa;
-    res = s_mp_add (a, b, c);
-  } else {
-    /* subtract a positive from a positive, OR */
-    /* subtract a negative from a negative. */
-    /* First, take the difference between their */
-    /* magnitudes, then... */
-    if (mp_cmp_mag (a, b) != MP_LT) {
-      /* Copy the sign from the first */
-      c->sign = sa;
-      /* The first has a larger or equal magnitude */
-      res = s_mp_sub (a, b, c);
-    } else {
-      /* The result has the *opposite* sign from */
-      /* the first number. */
-      c->sign = (sa == MP_ZPOS) ? MP_NEG : MP_ZPOS;
-      /* The second has a larger magnitude */
-      res = s_mp_sub (b, a, c);
-    }
-  }
-  return res;
-}
-
-#endif
-
-/* $Source: /cvs/libtom/libtommath/bn_mp_sub.c,v $ */
-/* $Revision: 1.4 $ */
-/* $Date: 2006/12/28 01:25:13 $ */
-/*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_sub.c
- ---------------------------------------------------------------------*/
-
-/*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_sub_d.c
- ---------------------------------------------------------------------*/
-#include <tommath.h>
-#ifdef BN_MP_SUB_D_C
-/* LibTomMath, multiple-precision integer library -- Tom St Denis
+/* multiplication using Toom-3.5, for a about four thirds as long as b
  *
- * LibTomMath is a library that provides multiple-precision
- * integer arithmetic as well as number theoretic functionality.
+ * a is cut into four pieces and b into three, B digits each,
  *
- * The library was designed directly after the MPI library by
- * Michael Fromberger but has been written from scratch with
- * additional optimizations in place.
+ *   a = a3 * x**3 + a2 * x**2 + a1 * x + a0
+ *   b = b2 * x**2 + b1 * x + b0,            x = 2**(DIGIT_BIT*B)
  *
- * The library is free for all purposes without any express
- * guarantee it works.
+ * and the six pieces c0 .. c5 of the product come from its values at
+ * 0, 1, -1, 2, -2 and infinity.  w0 = c0 and winf = c5, the rest are
+ * untangled by splitting the values at +-1 and +-2 into their even and
+ * odd parts
  *
- * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ *   (w1 + wm1)/2 = c0 +  c2 +   c4     (w1 - wm1)/2 = c1 +  c3 +   c5
+ *   (w2 + wm2)/2 = c0 + 4c2 + 16c4     (w2 - wm2)/4 = c1 + 4c3 + 16c5
+ *
+ * which leaves two small systems solved with one exact division by 12
+ * and one by 3.  Six products of B digits where mp_toom_mul would need
+ * five of rather more because its pieces are cut to the shorter b.
  */
-
-/* single digit subtraction */
-int
-mp_sub_d (mp_int * a, mp_digit b, mp_int * c)
+int mp_toom35_mul(mp_int *a, mp_int *b, mp_int *c)
 {
-  mp_digit *tmpa, *tmpc, mu;
-  int       res, ix, oldused;
+    mp_int w0, w1, wm1, w2, wm2, winf, tmp1, tmp2, tmp3,
+           a0, a1, a2, a3, b0, b1, b2;
+    int res, B;
+    size_t mark;
 
-  /* grow c as required */
-  if (c->alloc < a->used + 1) {
-     if ((res = mp_grow(c, a->used + 1)) != MP_OKAY) {
-        return res;
-     }
-  }
+    /* B */
+    B = MAX((a->used + 3) / 4, (b->used + 2) / 3);
 
-  /* if a is negative just do an unsigned
-   * addition [with fudged signs]
-   */
-  if (a->sign == MP_NEG) {
-     a->sign = MP_ZPOS;
-     res     = mp_add_d(a, b, c);
-     a->sign = c->sign = MP_NEG;
+    mark = XSCRATCH_MARK();
+    XSCRATCH_RESERVE(sizeof(mp_digit) * 20 * (a->used + b->used + 8 * MP_PREC));
+    if ((res = mp_init_scratch_multi(a->used + 1, &a0, &a1, &a2, &a3, NULL)) != MP_OKAY) {
+       goto LBL_MARK;
+    }
+    if ((res = mp_init_scratch_multi(b->used + 1, &b0, &b1, &b2, NULL)) != MP_OKAY) {
+       goto LBL_A;
+    }
+    if ((res = mp_init_scratch_multi(a->used + b->used + 2,
+                                     &w0, &w1, &wm1, &w2, &wm2, &winf,
+                                     &tmp1, &tmp2, &tmp3, NULL)) != MP_OKAY) {
+       goto LBL_B;
+    }
 
-     /* clamp */
-     mp_clamp(c);
+    /* a = a3 * B**3 + a2 * B**2 + a1 * B + a0 */
+    if ((res = mp_mod_2d(a, DIGIT_BIT * B, &a0)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_copy(a, &a1)) != MP_OKAY) {
+       goto ERR;
+    }
+    mp_rshd(&a1, B);
+    mp_mod_2d(&a1, DIGIT_BIT * B, &a1);
+    if ((res = mp_copy(a, &a2)) != MP_OKAY) {
+       goto ERR;
+    }
+    mp_rshd(&a2, B*2);
+    mp_mod_2d(&a2, DIGIT_BIT * B, &a2);
+    if ((res = mp_copy(a, &a3)) != MP_OKAY) {
+       goto ERR;
+    }
+    mp_rshd(&a3, B*3);
 
-     return res;
-  }
+    /* b = b2 * B**2 + b1 * B + b0 */
+    if ((res = mp_mod_2d(b, DIGIT_BIT * B, &b0)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_copy(b, &b1)) != MP_OKAY) {
+       goto ERR;
+    }
+    mp_rshd(&b1, B);
+    mp_mod_2d(&b1, DIGIT_BIT * B, &b1);
+    if ((res = mp_copy(b, &b2)) != MP_OKAY) {
+       goto ERR;
+    }
+    mp_rshd(&b2, B*2);
 
-  /* setup regs */
-  oldused = c->used;
-  tmpa    = a->dp;
-  tmpc    = c->dp;
+    /* the sign is mp_mul's business */
+    a0.sign = a1.sign = a2.sign = a3.sign = MP_ZPOS;
+    b0.sign = b1.sign = b2.sign = MP_ZPOS;
 
-  /* if a <= b simply fix the single digit */
-  if ((a->used == 1 && a->dp[0] <= b) || a->used == 0) {
-     if (a->used == 1) {
-        *tmpc++ = b - *tmpa;
-     } else {
-        *tmpc++ = b;
-     }
-     ix      = 1;
+    /* w0 = a0*b0, winf = a3*b2 */
+    if ((res = mp_mul(&a0, &b0, &w0)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_mul(&a3, &b2, &winf)) != MP_OKAY) {
+       goto ERR;
+    }
 
-     /* negative/1digit */
-     c->sign = MP_NEG;
-     c->used = 1;
-  } else {
-     /* positive/size */
-     c->sign = MP_ZPOS;
-     c->used = a->used;
+    /* w1 and wm1 from a0 + a2 +- (a1 + a3) and b0 + b2 +- b1 */
+    if ((res = mp_add(&a0, &a2, &tmp1)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_add(&a1, &a3, &tmp2)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_add(&b0, &b2, &tmp3)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_add(&tmp1, &tmp2, &w1)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_sub(&tmp1, &tmp2, &tmp1)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_add(&tmp3, &b1, &tmp2)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_sub(&tmp3, &b1, &tmp3)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_mul(&w1, &tmp2, &w1)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_mul(&tmp1, &tmp3, &wm1)) != MP_OKAY) {
+       goto ERR;
+    }
+
+    /* w2 and wm2 from a0 + 4a2 +- 2(a1 + 4a3) and b0 + 4b2 +- 2b1 */
+    if ((res = mp_mul_2d(&a2, 2, &tmp1)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_add(&tmp1, &a0, &tmp1)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_mul_2d(&a3, 2, &tmp2)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_add(&tmp2, &a1, &tmp2)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_mul_2(&tmp2, &tmp2)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_add(&tmp1, &tmp2, &w2)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_sub(&tmp1, &tmp2, &wm2)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_mul_2d(&b2, 2, &tmp1)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_add(&tmp1, &b0, &tmp1)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_mul_2(&b1, &tmp2)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_add(&tmp1, &tmp2, &tmp3)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_sub(&tmp1, &tmp2, &tmp1)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_mul(&w2, &tmp3, &w2)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_mul(&wm2, &tmp1, &wm2)) != MP_OKAY) {
+       goto ERR;
+    }
+
+    /* even parts: tmp1 = c2 + c4, tmp2 = 4c2 + 16c4 */
+    if ((res = mp_add(&w1, &wm1, &tmp1)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_div_2(&tmp1, &tmp1)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_sub(&tmp1, &w0, &tmp1)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_add(&w2, &wm2, &tmp2)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_div_2(&tmp2, &tmp2)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_sub(&tmp2, &w0, &tmp2)) != MP_OKAY) {
+       goto ERR;
+    }
+
+    /* odd parts: w1 = c1 + c3, w2 = c1 + 4c3 */
+    if ((res = mp_sub(&w1, &wm1, &w1)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_div_2(&w1, &w1)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_sub(&w1, &winf, &w1)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_sub(&w2, &wm2, &w2)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_div_2d(&w2, 2, &w2, NULL)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_mul_2d(&winf, 4, &tmp3)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_sub(&w2, &tmp3, &w2)) != MP_OKAY) {
+       goto ERR;
+    }
+
+    /* c4 = (tmp2 - 4tmp1)/12 and c2 = tmp1 - c4 */
+    if ((res = mp_mul_2d(&tmp1, 2, &tmp3)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_sub(&tmp2, &tmp3, &tmp2)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_div_2d(&tmp2, 2, &tmp2, NULL)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_div_3(&tmp2, &tmp2, NULL)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_sub(&tmp1, &tmp2, &tmp1)) != MP_OKAY) {
+       goto ERR;
+    }
 
-     /* subtract first digit */
-     *tmpc    = *tmpa++ - b;
-     mu       = *tmpc >> (sizeof(mp_digit) * CHAR_BIT - 1);
-     *tmpc++ &= MP_MASK;
+    /* c3 = (w2 - w1)/3 and c1 = w1 - c3 */
+    if ((res = mp_sub(&w2, &w1, &w2)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_div_3(&w2, &w2, NULL)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_sub(&w1, &w2, &w1)) != MP_OKAY) {
+       goto ERR;
+    }
 
-     /* handle rest of the digits */
-     for (ix = 1; ix < a->used; ix++) {
-        *tmpc    = *tmpa++ - mu;
-        mu       = *tmpc >> (sizeof(mp_digit) * CHAR_BIT - 1);
-        *tmpc++ &= MP_MASK;
-     }
-  }
+    /* c = winf*B**5 + c4*B**4 + c3*B**3 + c2*B**2 + c1*B + c0 */
+    if ((res = mp_lshd(&w1, 1*B)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_lshd(&tmp1, 2*B)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_lshd(&w2, 3*B)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_lshd(&tmp2, 4*B)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_lshd(&winf, 5*B)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_add(&w0, &w1, &w0)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_add(&tmp1, &w2, &tmp1)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_add(&tmp2, &winf, &tmp2)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_add(&w0, &tmp1, &w0)) != MP_OKAY) {
+       goto ERR;
+    }
+    if ((res = mp_add(&w0, &tmp2, c)) != MP_OKAY) {
+       goto ERR;
+    }
 
-  /* zero excess digits */
-  while (ix++ < oldused) {
-     *tmpc++ = 0;
-  }
-  mp_clamp(c);
-  return MP_OKAY;
+ERR:
+    mp_clear_multi(&w0, &w1, &wm1, &w2, &wm2, &winf, &tmp1, &tmp2, &tmp3, NULL);
+LBL_B:
+    mp_clear_multi(&b0, &b1, &b2, NULL);
+LBL_A:
+    mp_clear_multi(&a0, &a1, &a2, &a3, NULL);
+LBL_MARK:
+    XSCRATCH_RELEASE(mark);
+    return res;
 }
-
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_sub_d.c,v $ */
-/* $Revision: 1.6 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_toom35_mul.c,v $ */
+/* $Revision: 1.1 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_sub_d.c
+ --   End: vendor/libtommath-0.41/bn_mp_toom35_mul.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_submod.c
+ -- Start: vendor/libtommath-0.41/bn_mp_toom4_mul.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_SUBMOD_C
+#ifdef BN_MP_TOOM4_MUL_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -7948,80 +12404,386 @@ mp_sub_d (mp_int * a, mp_digit b, mp_int * c)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* d = a - b (mod c) */
-int
-mp_submod (mp_int * a, mp_int * b, mp_int * c, mp_int * d)
+/* multiplication using Toom-4 (Bodrato's point set)
+ *
+ * a and b are cut into four pieces of B digits,
+ *
+ *   a = a3 * x**3 + a2 * x**2 + a1 * x + a0,   x = 2**(DIGIT_BIT*B)
+ *
+ * and the seven pieces c0 .. c6 of the product come from its values at
+ * 0, 1, -1, 2, -2, 1/2 and infinity.  The value at 1/2 is taken scaled by
+ * 2**6 so that it stays an integer,
+ *
+ *   wh = (8a0 + 4a1 + 2a2 + a3) * (8b0 + 4b1 + 2b2 + b3)
+ *
+ * w0 = c0 and winf = c6, the values at +-1 and +-2 are split into their
+ * even and odd parts as in mp_toom35_mul, the even ones give c2 and c4 and
+ * with those wh gives a third equation in the odd c1, c3 and c5.  All the
+ * divisions are exact, by powers of two, 3 and 5.
+ *
+ * Seven products of B digits where mp_toom_mul needs five of 4B/3.  When
+ * a and b are the same mp_int the pieces are only evaluated once and the
+ * products are squares, which is what mp_toom4_sqr relies on.
+ */
+
+/* the pieces of a, B digits each bar the top one which gets the rest */
+static int s_toom4_split(mp_int *a, int B, mp_int *p)
 {
-  int     res;
-  mp_int  t;
+  mp_digit *tmpa, *tmpp;
+  int       ix, iy, n, res;
+
+  for (ix = 0; ix < 4; ix++) {
+    n = (ix == 3) ? a->used - 3 * B : MIN (B, a->used - ix * B);
+    n = MAX (n, 0);
+    if ((res = mp_grow (&p[ix], n)) != MP_OKAY) {
+      return res;
+    }
+    tmpa = a->dp + ix * B;
+    tmpp = p[ix].dp;
+    for (iy = 0; iy < n; iy++) {
+      *tmpp++ = *tmpa++;
+    }
+    p[ix].used = n;
+    p[ix].sign = MP_ZPOS;
+    mp_clamp (&p[ix]);
+  }
+  return MP_OKAY;
+}
 
+/* the values of p0 + p1*x + p2*x**2 + p3*x**3 at 1, -1, 2, -2 and,
+ * times 8, at 1/2
+ */
+static int s_toom4_eval(mp_int *p, mp_int *v, mp_int *t)
+{
+  int res;
 
-  if ((res = mp_init (&t)) != MP_OKAY) {
+  /* p0 + p2 +- (p1 + p3) */
+  if ((res = mp_add (&p[0], &p[2], &v[0])) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_add (&p[1], &p[3], t)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_sub (&v[0], t, &v[1])) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_add (&v[0], t, &v[0])) != MP_OKAY) {
     return res;
   }
 
-  if ((res = mp_sub (a, b, &t)) != MP_OKAY) {
-    mp_clear (&t);
+  /* p0 + 4p2 +- 2(p1 + 4p3) */
+  if ((res = mp_mul_2d (&p[2], 2, &v[2])) != MP_OKAY) {
     return res;
   }
-  res = mp_mod (&t, c, d);
-  mp_clear (&t);
-  return res;
+  if ((res = mp_add (&v[2], &p[0], &v[2])) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_mul_2d (&p[3], 2, t)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_add (t, &p[1], t)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_mul_2 (t, t)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_sub (&v[2], t, &v[3])) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_add (&v[2], t, &v[2])) != MP_OKAY) {
+    return res;
+  }
+
+  /* ((2p0 + p1)*2 + p2)*2 + p3 */
+  if ((res = mp_mul_2 (&p[0], &v[4])) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_add (&v[4], &p[1], &v[4])) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_mul_2 (&v[4], &v[4])) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_add (&v[4], &p[2], &v[4])) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_mul_2 (&v[4], &v[4])) != MP_OKAY) {
+    return res;
+  }
+  return mp_add (&v[4], &p[3], &v[4]);
 }
+
+/* r += t * 2**(DIGIT_BIT*off), t is not negative and r has room */
+static void s_toom4_add_at(mp_int *r, mp_int *t, int off)
+{
+  mp_digit u, *tmpr, *tmpt;
+  int      ix;
+#ifdef MP_64BIT_FULL
+  mp_word  w;
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_submod.c,v $ */
-/* $Revision: 1.4 $ */
-/* $Date: 2006/12/28 01:25:13 $ */
-/*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_submod.c
- ---------------------------------------------------------------------*/
+  tmpr = r->dp + off;
+  tmpt = t->dp;
+  u    = 0;
+#ifdef MP_64BIT_FULL
+  for (ix = 0; ix < t->used; ix++) {
+    w       = ((mp_word)*tmpr) + ((mp_word)*tmpt++) + ((mp_word)u);
+    *tmpr++ = (mp_digit)w;
+    u       = (mp_digit)(w >> ((mp_word)DIGIT_BIT));
+  }
+  while (u != 0) {
+    *tmpr += u;
+    u      = (*tmpr++ < u);
+  }
+#else
+  for (ix = 0; ix < t->used; ix++) {
+    *tmpr += *tmpt++ + u;
+    u      = *tmpr >> ((mp_digit)DIGIT_BIT);
+    *tmpr++ &= MP_MASK;
+  }
+  while (u != 0) {
+    *tmpr += u;
+    u      = *tmpr >> ((mp_digit)DIGIT_BIT);
+    *tmpr++ &= MP_MASK;
+  }
+#endif
+}
 
-/*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_to_signed_bin.c
- ---------------------------------------------------------------------*/
-#include <tommath.h>
-#ifdef BN_MP_TO_SIGNED_BIN_C
-/* LibTomMath, multiple-precision integer library -- Tom St Denis
- *
- * LibTomMath is a library that provides multiple-precision
- * integer arithmetic as well as number theoretic functionality.
- *
- * The library was designed directly after the MPI library by
- * Michael Fromberger but has been written from scratch with
- * additional optimizations in place.
- *
- * The library is free for all purposes without any express
- * guarantee it works.
- *
- * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
- */
+int mp_toom4_mul(mp_int *a, mp_int *b, mp_int *c)
+{
+  mp_int  ap[4], bp[4], av[5], bv[5], w[7], r, tmp;
+  int     res, B, ix, sqr;
+  size_t  mark;
+
+  sqr = (a == b);
+
+  /* B */
+  B = (MAX (a->used, b->used) + 3) / 4;
+
+  mark = XSCRATCH_MARK();
+  XSCRATCH_RESERVE(sizeof(mp_digit) * 16 * (a->used + b->used + 8 * MP_PREC));
+  if ((res = mp_init_scratch_multi(B + 1, &ap[0], &ap[1], &ap[2], &ap[3],
+                                   &bp[0], &bp[1], &bp[2], &bp[3], NULL)) != MP_OKAY) {
+    goto LBL_MARK;
+  }
+  if ((res = mp_init_scratch_multi(B + 3, &av[0], &av[1], &av[2], &av[3], &av[4],
+                                   &bv[0], &bv[1], &bv[2], &bv[3], &bv[4],
+                                   &tmp, NULL)) != MP_OKAY) {
+    goto LBL_P;
+  }
+  if ((res = mp_init_scratch_multi(2 * B + 6, &w[0], &w[1], &w[2], &w[3],
+                                   &w[4], &w[5], &w[6], NULL)) != MP_OKAY) {
+    goto LBL_V;
+  }
+  if ((res = mp_init_size(&r, a->used + b->used + 1)) != MP_OKAY) {
+    goto LBL_W;
+  }
+
+  /* the pieces and their values, the sign is mp_mul's business */
+  if ((res = s_toom4_split(a, B, ap)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = s_toom4_eval(ap, av, &tmp)) != MP_OKAY) {
+    goto ERR;
+  }
+  if (sqr == 0) {
+    if ((res = s_toom4_split(b, B, bp)) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = s_toom4_eval(bp, bv, &tmp)) != MP_OKAY) {
+      goto ERR;
+    }
+  }
+
+  /* w = w0, w1, wm1, w2, wm2, wh, winf */
+  if (sqr == 1) {
+    if ((res = mp_sqr(&ap[0], &w[0])) != MP_OKAY) {
+      goto ERR;
+    }
+    for (ix = 0; ix < 5; ix++) {
+      if ((res = mp_sqr(&av[ix], &w[ix + 1])) != MP_OKAY) {
+        goto ERR;
+      }
+    }
+    if ((res = mp_sqr(&ap[3], &w[6])) != MP_OKAY) {
+      goto ERR;
+    }
+  } else {
+    if ((res = mp_mul(&ap[0], &bp[0], &w[0])) != MP_OKAY) {
+      goto ERR;
+    }
+    for (ix = 0; ix < 5; ix++) {
+      if ((res = mp_mul(&av[ix], &bv[ix], &w[ix + 1])) != MP_OKAY) {
+        goto ERR;
+      }
+    }
+    if ((res = mp_mul(&ap[3], &bp[3], &w[6])) != MP_OKAY) {
+      goto ERR;
+    }
+  }
+
+  /* even and odd parts, w1 = c0 + c2 + c4 + c6, wm1 = c1 + c3 + c5,
+   * w2 = c0 + 4c2 + 16c4 + 64c6 and wm2 = c1 + 4c3 + 16c5
+   */
+  if ((res = mp_sub(&w[1], &w[2], &tmp)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_add(&w[1], &w[2], &w[1])) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_div_2(&w[1], &w[1])) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_div_2(&tmp, &w[2])) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_sub(&w[3], &w[4], &tmp)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_add(&w[3], &w[4], &w[3])) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_div_2(&w[3], &w[3])) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_div_2d(&tmp, 2, &w[4], NULL)) != MP_OKAY) {
+    goto ERR;
+  }
+
+  /* w1 = c2 + c4, w2 = (w2 - c0 - 64c6)/4 = c2 + 4c4 */
+  if ((res = mp_sub(&w[1], &w[0], &w[1])) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_sub(&w[1], &w[6], &w[1])) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_sub(&w[3], &w[0], &w[3])) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_mul_2d(&w[6], 6, &tmp)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_sub(&w[3], &tmp, &w[3])) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_div_2d(&w[3], 2, &w[3], NULL)) != MP_OKAY) {
+    goto ERR;
+  }
+
+  /* c4 = (w2 - w1)/3 and c2 = w1 - c4 */
+  if ((res = mp_sub(&w[3], &w[1], &w[3])) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_div_3(&w[3], &w[3], NULL)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_sub(&w[1], &w[3], &w[1])) != MP_OKAY) {
+    goto ERR;
+  }
+
+  /* wh = (wh - 64c0 - 16c2 - 4c4 - c6)/2 = 16c1 + 4c3 + c5 */
+  if ((res = mp_mul_2d(&w[0], 6, &tmp)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_sub(&w[5], &tmp, &w[5])) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_mul_2d(&w[1], 4, &tmp)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_sub(&w[5], &tmp, &w[5])) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_mul_2d(&w[3], 2, &tmp)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_sub(&w[5], &tmp, &w[5])) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_sub(&w[5], &w[6], &w[5])) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_div_2(&w[5], &w[5])) != MP_OKAY) {
+    goto ERR;
+  }
+
+  /* wm2 = (wm2 - wm1)/3 = c3 + 5c5, wh = (16wm1 - wh)/3 = 4c3 + 5c5 */
+  if ((res = mp_sub(&w[4], &w[2], &w[4])) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_div_3(&w[4], &w[4], NULL)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_mul_2d(&w[2], 4, &tmp)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_sub(&tmp, &w[5], &w[5])) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_div_3(&w[5], &w[5], NULL)) != MP_OKAY) {
+    goto ERR;
+  }
+
+  /* c3 = (wh - wm2)/3, c5 = (wm2 - c3)/5 and c1 = wm1 - c3 - c5 */
+  if ((res = mp_sub(&w[5], &w[4], &w[5])) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_div_3(&w[5], &w[5], NULL)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_sub(&w[4], &w[5], &w[4])) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_div_d(&w[4], 5, &w[4], NULL)) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_sub(&w[2], &w[5], &w[2])) != MP_OKAY) {
+    goto ERR;
+  }
+  if ((res = mp_sub(&w[2], &w[4], &w[2])) != MP_OKAY) {
+    goto ERR;
+  }
 
-/* store in signed [big endian] format */
-int mp_to_signed_bin (mp_int * a, unsigned char *b)
-{
-  int     res;
+  /* c = c6*x**6 + ... + c1*x + c0, the c are all positive */
+  r.used = a->used + b->used + 1;
+  s_toom4_add_at(&r, &w[0], 0);
+  s_toom4_add_at(&r, &w[2], 1 * B);
+  s_toom4_add_at(&r, &w[1], 2 * B);
+  s_toom4_add_at(&r, &w[5], 3 * B);
+  s_toom4_add_at(&r, &w[3], 4 * B);
+  s_toom4_add_at(&r, &w[4], 5 * B);
+  s_toom4_add_at(&r, &w[6], 6 * B);
+  mp_clamp(&r);
+  mp_exch(&r, c);
 
-  if ((res = mp_to_unsigned_bin (a, b + 1)) != MP_OKAY) {
-    return res;
-  }
-  b[0] = (unsigned char) ((a->sign == MP_ZPOS) ? 0 : 1);
-  return MP_OKAY;
+ERR:
+  mp_clear(&r);
+LBL_W:
+  mp_clear_multi(&w[0], &w[1], &w[2], &w[3], &w[4], &w[5], &w[6], NULL);
+LBL_V:
+  mp_clear_multi(&av[0], &av[1], &av[2], &av[3], &av[4],
+                 &bv[0], &bv[1], &bv[2], &bv[3], &bv[4], &tmp, NULL);
+LBL_P:
+  mp_clear_multi(&ap[0], &ap[1], &ap[2], &ap[3],
+                 &bp[0], &bp[1], &bp[2], &bp[3], NULL);
+LBL_MARK:
+  XSCRATCH_RELEASE(mark);
+  return res;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_to_signed_bin.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_toom4_mul.c,v $ */
+/* $Revision: 1.1 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_to_signed_bin.c
+ --   End: vendor/libtommath-0.41/bn_mp_toom4_mul.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_to_signed_bin_n.c
+ -- Start: vendor/libtommath-0.41/bn_mp_toom4_sqr.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_TO_SIGNED_BIN_N_C
+#ifdef BN_MP_TOOM4_SQR_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -8037,29 +12799,27 @@ int mp_to_signed_bin (mp_int * a, unsigned char *b)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* store in signed [big endian] format */
-int mp_to_signed_bin_n (mp_int * a, unsigned char *b, unsigned long *outlen)
+/* b = a*a using Toom-4, see mp_toom4_mul which only evaluates the pieces
+ * once and squares when both of its inputs are the same mp_int
+ */
+int mp_toom4_sqr(mp_int *a, mp_int *b)
 {
-   if (*outlen < (unsigned long)mp_signed_bin_size(a)) {
-      return MP_VAL;
-   }
-   *outlen = mp_signed_bin_size(a);
-   return mp_to_signed_bin(a, b);
+  return mp_toom4_mul(a, a, b);
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_to_signed_bin_n.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_toom4_sqr.c,v $ */
+/* $Revision: 1.1 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_to_signed_bin_n.c
+ --   End: vendor/libtommath-0.41/bn_mp_toom4_sqr.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_to_unsigned_bin.c
+ -- Start: vendor/libtommath-0.41/bn_mp_toom65_mul.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_TO_UNSIGNED_BIN_C
+#ifdef BN_MP_TOOM65_MUL_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -8075,46 +12835,482 @@ int mp_to_signed_bin_n (mp_int * a, unsigned char *b, unsigned long *outlen)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* store in unsigned [big endian] format */
-int mp_to_unsigned_bin (mp_int * a, unsigned char *b)
+/* multiplication using Toom-6.5 (Bodrato's point set)
+ *
+ * a is cut into seven pieces and b into six, B digits each,
+ *
+ *   a = a6 * x**6 + ... + a1 * x + a0
+ *   b = b5 * x**5 + ... + b1 * x + b0,      x = 2**(DIGIT_BIT*B)
+ *
+ * which fits a up to 7/6 as long as b.  For two numbers of the same size
+ * a6 is zero and so is the product at infinity, this is then Toom-6 on
+ * eleven products.
+ *
+ * The twelve pieces c0 .. c11 of the product come from its values at 0,
+ * infinity, +-1, +-2, +-4, +-1/2 and +-1/4, the values at 1/s scaled by
+ * s**11 to stay integers.  w0 = c0 and winf = c11, every pair of values
+ * at +-r is split into its even and odd part and those, with c0 and c11
+ * taken out, are values of
+ *
+ *   Q(y) = c2 + c4*y + c6*y**2 + c8*y**3 + c10*y**4
+ *   R(y) = c1 + c3*y + c5*y**2 + c7*y**3 + c9*y**4
+ *
+ * at y = 1, 4, 16 and, scaled by y**4, at y = 1/4 and 1/16.  Both are got
+ * back by s_toom65_interp5, which splits the problem once more into the
+ * parts symmetric and antisymmetric under y -> 1/y.  All divisions are
+ * exact and by small constants.
+ *
+ * When a and b are the same mp_int the pieces are only evaluated once and
+ * the products are squares, which is what mp_toom65_sqr relies on.
+ */
+
+/* the n pieces of a, B digits each bar the top one which gets the rest */
+static int s_toom65_split(mp_int *a, int n, int B, mp_int *p)
 {
-  int     x, res;
-  mp_int  t;
+  mp_digit *tmpa, *tmpp;
+  int       ix, iy, m, res;
 
-  if ((res = mp_init_copy (&t, a)) != MP_OKAY) {
+  for (ix = 0; ix < n; ix++) {
+    m = (ix == n - 1) ? a->used - ix * B : MIN (B, a->used - ix * B);
+    m = MAX (m, 0);
+    if ((res = mp_grow (&p[ix], m)) != MP_OKAY) {
+      return res;
+    }
+    tmpa = a->dp + ix * B;
+    tmpp = p[ix].dp;
+    for (iy = 0; iy < m; iy++) {
+      *tmpp++ = *tmpa++;
+    }
+    p[ix].used = m;
+    p[ix].sign = MP_ZPOS;
+    mp_clamp (&p[ix]);
+  }
+  return MP_OKAY;
+}
+
+/* vp, vm = p0 + p1*x + ... + p(n-1)*x**(n-1) at x = +-2**k, or when rev
+ * is set at x = +-2**-k times 2**(k*(n-1)).  The even and the odd pieces
+ * are summed apart by Horner's rule, from the largest power of two down.
+ */
+static int s_toom65_eval(mp_int *p, int n, int k, int rev, mp_int *vp, mp_int *vm, mp_int *t)
+{
+  mp_int *acc;
+  int     res, ix, iy, par, last;
+
+  for (par = 0; par < 2; par++) {
+    acc  = (par == 0) ? vp : vm;
+    last = par;
+    mp_zero (acc);
+    for (iy = 0; iy < n; iy++) {
+      ix = (rev == 1) ? iy : n - 1 - iy;
+      if ((ix & 1) != par) {
+        continue;
+      }
+      if ((res = mp_mul_2d (acc, 2 * k, acc)) != MP_OKAY) {
+        return res;
+      }
+      if ((res = mp_add (acc, &p[ix], acc)) != MP_OKAY) {
+        return res;
+      }
+      last = ix;
+    }
+    if ((res = mp_mul_2d (acc, k * ((rev == 1) ? n - 1 - last : last), acc)) != MP_OKAY) {
+      return res;
+    }
+  }
+
+  /* vp = even + odd, vm = even - odd */
+  if ((res = mp_sub (vp, vm, t)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_add (vp, vm, vp)) != MP_OKAY) {
     return res;
   }
+  mp_exch (t, vm);
+  return MP_OKAY;
+}
 
-  x = 0;
-  while (mp_iszero (&t) == 0) {
-#ifndef MP_8BIT
-      b[x++] = (unsigned char) (t.dp[0] & 255);
+/* the coefficients q0 .. q4 of a polynomial of degree four from its values
+ *
+ *   v[0] = Q(1), v[1] = Q(4), v[2] = Q(16),
+ *   v[3] = 4**4 * Q(1/4), v[4] = 16**4 * Q(1/16)
+ *
+ * in place, v[i] ends up as qi.  With u0 = q0 + q4, u1 = q1 + q3,
+ * d0 = q0 - q4 and d1 = q1 - q3
+ *
+ *   v[3] - v[1]  =   255d0 +   60d1
+ *   v[4] - v[2]  = 65535d0 + 4080d1
+ *   v[3] + v[1]  =   257u0 +   68u1 +  32q2
+ *   v[4] + v[2]  = 65537u0 + 4112u1 + 512q2
+ *   v[0]         =      u0 +     u1 +    q2
+ */
+static int s_toom65_interp5(mp_int **v, mp_int *t)
+{
+  int res;
+
+  /* v3 = v3 - v1, v1 = v1 + v3 and the same for v4 and v2 */
+  if ((res = mp_sub (v[3], v[1], v[3])) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_mul_2 (v[1], v[1])) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_add (v[1], v[3], v[1])) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_sub (v[4], v[2], v[4])) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_mul_2 (v[2], v[2])) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_add (v[2], v[4], v[2])) != MP_OKAY) {
+    return res;
+  }
+
+  /* v3 = 17d0 + 4d1, v4 = 4369d0 + 272d1, then d0 = (v4 - 68v3)/3213 and
+   * d1 = (v3 - 17d0)/4
+   */
+  if ((res = mp_div_d (v[3], 15, v[3], NULL)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_div_d (v[4], 15, v[4], NULL)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_mul_d (v[3], 68, t)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_sub (v[4], t, v[4])) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_div_d (v[4], 3213, v[4], NULL)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_mul_d (v[4], 17, t)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_sub (v[3], t, v[3])) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_div_2d (v[3], 2, v[3], NULL)) != MP_OKAY) {
+    return res;
+  }
+
+  /* v1 = (v1 - 32v0)/9 = 25u0 + 4u1, v2 = (v2 - 512v0)/225 = 289u0 + 16u1 */
+  if ((res = mp_mul_2d (v[0], 5, t)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_sub (v[1], t, v[1])) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_div_d (v[1], 9, v[1], NULL)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_mul_2d (v[0], 9, t)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_sub (v[2], t, v[2])) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_div_d (v[2], 225, v[2], NULL)) != MP_OKAY) {
+    return res;
+  }
+
+  /* u0 = (v2 - 4v1)/189, u1 = (v1 - 25u0)/4 and q2 = v0 - u0 - u1 */
+  if ((res = mp_mul_2d (v[1], 2, t)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_sub (v[2], t, v[2])) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_div_d (v[2], 189, v[2], NULL)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_mul_d (v[2], 25, t)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_sub (v[1], t, v[1])) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_div_2d (v[1], 2, v[1], NULL)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_sub (v[0], v[2], v[0])) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_sub (v[0], v[1], v[0])) != MP_OKAY) {
+    return res;
+  }
+
+  /* q0, q4 = (u0 +- d0)/2 and q1, q3 = (u1 +- d1)/2 */
+  if ((res = mp_add (v[2], v[4], t)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_sub (v[2], v[4], v[4])) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_div_2 (v[4], v[4])) != MP_OKAY) {
+    return res;
+  }
+  mp_exch (v[0], v[2]);
+  if ((res = mp_div_2 (t, v[0])) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_add (v[1], v[3], t)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_sub (v[1], v[3], v[3])) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_div_2 (v[3], v[3])) != MP_OKAY) {
+    return res;
+  }
+  return mp_div_2 (t, v[1]);
+}
+
+/* r += t * 2**(DIGIT_BIT*off), t is not negative and r has room */
+static void s_toom65_add_at(mp_int *r, mp_int *t, int off)
+{
+  mp_digit u, *tmpr, *tmpt;
+  int      ix;
+#ifdef MP_64BIT_FULL
+  mp_word  w;
+#endif
+
+  tmpr = r->dp + off;
+  tmpt = t->dp;
+  u    = 0;
+#ifdef MP_64BIT_FULL
+  for (ix = 0; ix < t->used; ix++) {
+    w       = ((mp_word)*tmpr) + ((mp_word)*tmpt++) + ((mp_word)u);
+    *tmpr++ = (mp_digit)w;
+    u       = (mp_digit)(w >> ((mp_word)DIGIT_BIT));
+  }
+  while (u != 0) {
+    *tmpr += u;
+    u      = (*tmpr++ < u);
+  }
 #else
-      b[x++] = (unsigned char) (t.dp[0] | ((t.dp[1] & 0x01) << 7));
+  for (ix = 0; ix < t->used; ix++) {
+    *tmpr += *tmpt++ + u;
+    u      = *tmpr >> ((mp_digit)DIGIT_BIT);
+    *tmpr++ &= MP_MASK;
+  }
+  while (u != 0) {
+    *tmpr += u;
+    u      = *tmpr >> ((mp_digit)DIGIT_BIT);
+    *tmpr++ &= MP_MASK;
+  }
 #endif
-    if ((res = mp_div_2d (&t, 8, &t, NULL)) != MP_OKAY) {
-      mp_clear (&t);
-      return res;
+}
+
+int mp_toom65_mul(mp_int *a, mp_int *b, mp_int *c)
+{
+  /* the points +-2**k, k = 0, 1, 2, and +-2**-k, k = 1, 2 */
+  static const int kk[5] = { 0, 1, 2, 1, 2 }, rr[5] = { 0, 0, 0, 1, 1 };
+  mp_int  ap[7], bp[6], w[12], *q[5], ea, eam, eb, ebm, r, tmp;
+  int     res, B, ix, na, sqr;
+  size_t  mark;
+
+  sqr = (a == b);
+
+  /* B, a squared is cut in six like b */
+  if (sqr == 1) {
+    na = 6;
+    B  = (a->used + 5) / 6;
+  } else {
+    na = 7;
+    B  = MAX ((a->used + 6) / 7, (b->used + 5) / 6);
+  }
+
+  mark = XSCRATCH_MARK();
+  XSCRATCH_RESERVE(sizeof(mp_digit) * 8 * (a->used + b->used + 16 * MP_PREC));
+  if ((res = mp_init_scratch_multi(B + 1, &ap[0], &ap[1], &ap[2], &ap[3], &ap[4], &ap[5], &ap[6],
+                                   &bp[0], &bp[1], &bp[2], &bp[3], &bp[4], &bp[5], NULL)) != MP_OKAY) {
+    goto LBL_MARK;
+  }
+  if ((res = mp_init_scratch_multi(B + 3, &ea, &eam, &eb, &ebm, &tmp, NULL)) != MP_OKAY) {
+    goto LBL_P;
+  }
+  if ((res = mp_init_scratch_multi(2 * B + 6, &w[0], &w[1], &w[2], &w[3], &w[4], &w[5],
+                                   &w[6], &w[7], &w[8], &w[9], &w[10], &w[11], NULL)) != MP_OKAY) {
+    goto LBL_E;
+  }
+  if ((res = mp_init_size(&r, a->used + b->used + 1)) != MP_OKAY) {
+    goto LBL_W;
+  }
+
+  /* the pieces, the sign is mp_mul's business */
+  if ((res = s_toom65_split(a, na, B, ap)) != MP_OKAY) {
+    goto ERR;
+  }
+  if (sqr == 0) {
+    if ((res = s_toom65_split(b, 6, B, bp)) != MP_OKAY) {
+      goto ERR;
     }
   }
-  bn_reverse (b, x);
-  mp_clear (&t);
-  return MP_OKAY;
+
+  /* w0 = c0 and winf = c11, zero unless a has a seventh piece */
+  if (sqr == 1) {
+    if ((res = mp_sqr(&ap[0], &w[0])) != MP_OKAY) {
+      goto ERR;
+    }
+    mp_zero(&w[1]);
+  } else {
+    if ((res = mp_mul(&ap[0], &bp[0], &w[0])) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = mp_mul(&ap[6], &bp[5], &w[1])) != MP_OKAY) {
+      goto ERR;
+    }
+  }
+
+  /* w[2+2i], w[3+2i] the values at the point pair i */
+  for (ix = 0; ix < 5; ix++) {
+    if ((res = s_toom65_eval(ap, na, kk[ix], rr[ix], &ea, &eam, &tmp)) != MP_OKAY) {
+      goto ERR;
+    }
+    if (sqr == 1) {
+      if ((res = mp_sqr(&ea, &w[2 + 2*ix])) != MP_OKAY) {
+        goto ERR;
+      }
+      if ((res = mp_sqr(&eam, &w[3 + 2*ix])) != MP_OKAY) {
+        goto ERR;
+      }
+      /* a was scaled by 2**(5k) at 2**-k, the product has to be by 2**(11k) */
+      if (rr[ix] == 1) {
+        if ((res = mp_mul_2d(&w[2 + 2*ix], kk[ix], &w[2 + 2*ix])) != MP_OKAY) {
+          goto ERR;
+        }
+        if ((res = mp_mul_2d(&w[3 + 2*ix], kk[ix], &w[3 + 2*ix])) != MP_OKAY) {
+          goto ERR;
+        }
+      }
+    } else {
+      if ((res = s_toom65_eval(bp, 6, kk[ix], rr[ix], &eb, &ebm, &tmp)) != MP_OKAY) {
+        goto ERR;
+      }
+      if ((res = mp_mul(&ea, &eb, &w[2 + 2*ix])) != MP_OKAY) {
+        goto ERR;
+      }
+      if ((res = mp_mul(&eam, &ebm, &w[3 + 2*ix])) != MP_OKAY) {
+        goto ERR;
+      }
+    }
+  }
+
+  /* w[2+2i] = even part, w[3+2i] = odd part, both times 1 at 2**k and
+   * times 2**(11k) at 2**-k
+   */
+  for (ix = 2; ix < 12; ix += 2) {
+    if ((res = mp_sub(&w[ix], &w[ix + 1], &tmp)) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = mp_add(&w[ix], &w[ix + 1], &w[ix])) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = mp_div_2(&w[ix], &w[ix])) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = mp_div_2(&tmp, &w[ix + 1])) != MP_OKAY) {
+      goto ERR;
+    }
+  }
+
+  /* at y = 4**k, the even part less c0 over y is Q(y), the odd part over
+   * 2**k less c11 * y**5 is R(y), k = ix
+   */
+  for (ix = 0; ix < 3; ix++) {
+    if ((res = mp_sub(&w[2 + 2*ix], &w[0], &w[2 + 2*ix])) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = mp_div_2d(&w[2 + 2*ix], 2 * ix, &w[2 + 2*ix], NULL)) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = mp_div_2d(&w[3 + 2*ix], ix, &w[3 + 2*ix], NULL)) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = mp_mul_2d(&w[1], 10 * ix, &tmp)) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = mp_sub(&w[3 + 2*ix], &tmp, &w[3 + 2*ix])) != MP_OKAY) {
+      goto ERR;
+    }
+  }
+
+  /* at z = 4**k, the even part over 2**k less c0 * z**5 is z**4 * Q(1/z),
+   * the odd part less c11 over z is z**4 * R(1/z), k = ix
+   */
+  for (ix = 1; ix < 3; ix++) {
+    if ((res = mp_div_2d(&w[6 + 2*ix], ix, &w[6 + 2*ix], NULL)) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = mp_mul_2d(&w[0], 10 * ix, &tmp)) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = mp_sub(&w[6 + 2*ix], &tmp, &w[6 + 2*ix])) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = mp_sub(&w[7 + 2*ix], &w[1], &w[7 + 2*ix])) != MP_OKAY) {
+      goto ERR;
+    }
+    if ((res = mp_div_2d(&w[7 + 2*ix], 2 * ix, &w[7 + 2*ix], NULL)) != MP_OKAY) {
+      goto ERR;
+    }
+  }
+
+  /* Q gives c2, c4, .. c10 and R gives c1, c3, .. c9 */
+  for (ix = 0; ix < 5; ix++) {
+    q[ix] = &w[2 + 2*ix];
+  }
+  if ((res = s_toom65_interp5(q, &tmp)) != MP_OKAY) {
+    goto ERR;
+  }
+  for (ix = 0; ix < 5; ix++) {
+    q[ix] = &w[3 + 2*ix];
+  }
+  if ((res = s_toom65_interp5(q, &tmp)) != MP_OKAY) {
+    goto ERR;
+  }
+  for (ix = 0; ix < 5; ix++) {
+    s_toom65_add_at(&r, &w[2 + 2*ix], (2 + 2*ix) * B);
+    s_toom65_add_at(&r, &w[3 + 2*ix], (1 + 2*ix) * B);
+  }
+  s_toom65_add_at(&r, &w[0], 0);
+  s_toom65_add_at(&r, &w[1], 11 * B);
+
+  r.used = a->used + b->used + 1;
+  mp_clamp(&r);
+  mp_exch(&r, c);
+
+ERR:
+  mp_clear(&r);
+LBL_W:
+  mp_clear_multi(&w[0], &w[1], &w[2], &w[3], &w[4], &w[5],
+                 &w[6], &w[7], &w[8], &w[9], &w[10], &w[11], NULL);
+LBL_E:
+  mp_clear_multi(&ea, &eam, &eb, &ebm, &tmp, NULL);
+LBL_P:
+  mp_clear_multi(&ap[0], &ap[1], &ap[2], &ap[3], &ap[4], &ap[5], &ap[6],
+                 &bp[0], &bp[1], &bp[2], &bp[3], &bp[4], &bp[5], NULL);
+LBL_MARK:
+  XSCRATCH_RELEASE(mark);
+  return res;
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_to_unsigned_bin.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_toom65_mul.c,v $ */
+/* $Revision: 1.1 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_to_unsigned_bin.c
+ --   End: vendor/libtommath-0.41/bn_mp_toom65_mul.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
- -- Start: vendor/libtommath-0.41/bn_mp_to_unsigned_bin_n.c
+ -- Start: vendor/libtommath-0.41/bn_mp_toom65_sqr.c
  ---------------------------------------------------------------------*/
 #include <tommath.h>
-#ifdef BN_MP_TO_UNSIGNED_BIN_N_C
+#ifdef BN_MP_TOOM65_SQR_C
 /* LibTomMath, multiple-precision integer library -- Tom St Denis
  *
  * LibTomMath is a library that provides multiple-precision
@@ -8130,22 +13326,20 @@ int mp_to_unsigned_bin (mp_int * a, unsigned char *b)
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* store in unsigned [big endian] format */
-int mp_to_unsigned_bin_n (mp_int * a, unsigned char *b, unsigned long *outlen)
+/* b = a*a using Toom-6.5, see mp_toom65_mul which only evaluates the
+ * pieces once and squares when both of its inputs are the same mp_int
+ */
+int mp_toom65_sqr(mp_int *a, mp_int *b)
 {
-   if (*outlen < (unsigned long)mp_unsigned_bin_size(a)) {
-      return MP_VAL;
-   }
-   *outlen = mp_unsigned_bin_size(a);
-   return mp_to_unsigned_bin(a, b);
+  return mp_toom65_mul(a, a, b);
 }
 #endif
 
-/* $Source: /cvs/libtom/libtommath/bn_mp_to_unsigned_bin_n.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Source: /cvs/libtom/libtommath/bn_mp_toom65_sqr.c,v $ */
+/* $Revision: 1.1 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
- --   End: vendor/libtommath-0.41/bn_mp_to_unsigned_bin_n.c
+ --   End: vendor/libtommath-0.41/bn_mp_toom65_sqr.c
  ---------------------------------------------------------------------*/
 
 /*----------------------------------------------------------------------
@@ -8179,16 +13373,28 @@ int mp_toom_mul(mp_int *a, mp_int *b, mp_int *c)
 {
     mp_int w0, w1, w2, w3, w4, tmp1, tmp2, a0, a1, a2, b0, b1, b2;
     int res, B;
+    size_t mark;
         
-    /* init temps */
-    if ((res = mp_init_multi(&w0, &w1, &w2, &w3, &w4, 
-                             &a0, &a1, &a2, &b0, &b1, 
-                             &b2, &tmp1, &tmp2, NULL)) != MP_OKAY) {
-       return res;
-    }
-    
     /* B */
     B = MIN(a->used, b->used) / 3;
+
+    /* init temps, from scratch memory reserved for this call and the
+     * ones it recurses into.  The pieces of a and b are no bigger than
+     * a and b, the rest have to hold a partial product.
+     */
+    mark = XSCRATCH_MARK();
+    XSCRATCH_RESERVE(sizeof(mp_digit) * 20 * (a->used + b->used + 8 * MP_PREC));
+    if ((res = mp_init_scratch_multi(a->used + 1, &a0, &a1, &a2, NULL)) != MP_OKAY) {
+       goto LBL_MARK;
+    }
+    if ((res = mp_init_scratch_multi(b->used + 1, &b0, &b1, &b2, NULL)) != MP_OKAY) {
+       goto LBL_A;
+    }
+    if ((res = mp_init_scratch_multi(a->used + b->used + 2,
+                             &w0, &w1, &w2, &w3, &w4, 
+                             &tmp1, &tmp2, NULL)) != MP_OKAY) {
+       goto LBL_B;
+    }
     
     /* a = a2 * B**2 + a1 * B + a0 */
     if ((res = mp_mod_2d(a, DIGIT_BIT * B, &a0)) != MP_OKAY) {
@@ -8221,6 +13427,13 @@ int mp_toom_mul(mp_int *a, mp_int *b, mp_int *c)
        goto ERR;
     }
     mp_rshd(&b2, B*2);
+
+    /* work on |a| and |b|, the sign is mp_mul's business.  The pieces
+     * of a negative number are all negative and the interpolation
+     * below does not survive operands of mixed sign.
+     */
+    a0.sign = a1.sign = a2.sign = MP_ZPOS;
+    b0.sign = b1.sign = b2.sign = MP_ZPOS;
     
     /* w0 = a0*b0 */
     if ((res = mp_mul(&a0, &b0, &w0)) != MP_OKAY) {
@@ -8424,9 +13637,13 @@ int mp_toom_mul(mp_int *a, mp_int *b, mp_int *c)
      }     
      
 ERR:
-     mp_clear_multi(&w0, &w1, &w2, &w3, &w4, 
-                    &a0, &a1, &a2, &b0, &b1, 
-                    &b2, &tmp1, &tmp2, NULL);
+     mp_clear_multi(&w0, &w1, &w2, &w3, &w4, &tmp1, &tmp2, NULL);
+LBL_B:
+     mp_clear_multi(&b0, &b1, &b2, NULL);
+LBL_A:
+     mp_clear_multi(&a0, &a1, &a2, NULL);
+LBL_MARK:
+     XSCRATCH_RELEASE(mark);
      return res;
 }     
      
@@ -8465,15 +13682,21 @@ mp_toom_sqr(mp_int *a, mp_int *b)
 {
     mp_int w0, w1, w2, w3, w4, tmp1, a0, a1, a2;
     int res, B;
-
-    /* init temps */
-    if ((res = mp_init_multi(&w0, &w1, &w2, &w3, &w4, &a0, &a1, &a2, &tmp1, NULL)) != MP_OKAY) {
-       return res;
-    }
+    size_t mark;
 
     /* B */
     B = a->used / 3;
 
+    /* init temps from scratch memory, see mp_toom_mul */
+    mark = XSCRATCH_MARK();
+    XSCRATCH_RESERVE(sizeof(mp_digit) * 30 * (a->used + 4 * MP_PREC));
+    if ((res = mp_init_scratch_multi(a->used + 1, &a0, &a1, &a2, NULL)) != MP_OKAY) {
+       goto LBL_MARK;
+    }
+    if ((res = mp_init_scratch_multi(2 * a->used + 2, &w0, &w1, &w2, &w3, &w4, &tmp1, NULL)) != MP_OKAY) {
+       goto LBL_A;
+    }
+
     /* a = a2 * B**2 + a1 * B + a0 */
     if ((res = mp_mod_2d(a, DIGIT_BIT * B, &a0)) != MP_OKAY) {
        goto ERR;
@@ -8659,7 +13882,11 @@ mp_toom_sqr(mp_int *a, mp_int *b)
      }
 
 ERR:
-     mp_clear_multi(&w0, &w1, &w2, &w3, &w4, &a0, &a1, &a2, &tmp1, NULL);
+     mp_clear_multi(&w0, &w1, &w2, &w3, &w4, &tmp1, NULL);
+LBL_A:
+     mp_clear_multi(&a0, &a1, &a2, NULL);
+LBL_MARK:
+     XSCRATCH_RELEASE(mark);
      return res;
 }
 
@@ -8692,17 +13919,165 @@ ERR:
  * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
  */
 
-/* stores a bignum as a ASCII string in a given radix (2..64) */
-int mp_toradix (mp_int * a, char *str, int radix)
+/* stores a bignum as a ASCII string in a given radix (2..64)
+ *
+ * Small numbers are worked down a digit big = radix**k at a time (see
+ * mp_radix_chunk), k radix digits for every division by a single digit.
+ * From TORADIX_DC_CUTOFF digits on the number is split in two at one of
+ * the cached powers P(i) = big**(2**i) of mp_radix_power_get, about the size
+ * of its square root, and both halves are written out the same way, the
+ * lower one padded with zeros to k * 2**i digits.  With the divisions by
+ * the powers done by mp_div_barrett that is a few multiplications of
+ * each size instead of a quadratic number of single digit divisions.
+ * A radix that is a power of two takes no division at all, its digits
+ * are sliced out of the bits of the number one after the other.
+ */
+
+/* writes the radix digits of a, at least pad of them, to *str */
+static int s_mp_toradix_base(mp_int *a, mp_digit_inv *inv, int radix,
+                             int k, int pad, char **str)
 {
-  int     res, digs;
-  mp_int  t;
+  mp_int   t;
   mp_digit d;
-  char   *_s = str;
+  char    *s, *e;
+  int      res, ix;
+
+  if ((res = mp_init_copy(&t, a)) != MP_OKAY) {
+    return res;
+  }
+
+  /* the digits come out least significant first */
+  s = *str;
+  e = s + pad;
+  while (mp_iszero(&t) == MP_NO || s < e) {
+    d = 0;
+    if (mp_iszero(&t) == MP_NO &&
+        (res = mp_div_d_inv(&t, inv, &t, &d)) != MP_OKAY) {
+      mp_clear(&t);
+      return res;
+    }
+    if (mp_iszero(&t) == MP_YES && s + k > e) {
+      /* the leading digit, without its zeros */
+      do {
+        *s++ = mp_s_rmap[d % (mp_digit)radix];
+        d   /= (mp_digit)radix;
+      } while (d != 0);
+    } else if (radix == 10) {
+      for (ix = 0; ix < k; ix++) {
+        *s++ = mp_s_rmap[d % 10u];
+        d   /= 10u;
+      }
+    } else {
+      for (ix = 0; ix < k; ix++) {
+        *s++ = mp_s_rmap[d % (mp_digit)radix];
+        d   /= (mp_digit)radix;
+      }
+    }
+  }
+
+  bn_reverse((unsigned char *)*str, (int)(s - *str));
+  *str = s;
+  mp_clear(&t);
+  return MP_OKAY;
+}
+
+/* writes a < P(i+1) out at *str, padded to pad digits */
+static int s_mp_toradix_dc(mp_int *a, int i, mp_digit_inv *inv, int radix,
+                           int k, int pad, char **str)
+{
+  mp_radix_power *p;
+  mp_int  q, r;
+  int     res, len;
+
+  /* no need to split below P(i) unless the zeros are wanted */
+  if (i >= 0 && pad == 0) {
+    while (i >= 0) {
+      if ((res = mp_radix_power_get(radix, i, MP_NO, &p)) != MP_OKAY) {
+        return res;
+      }
+      if (mp_cmp_mag(a, &p->p) != MP_LT) {
+        break;
+      }
+      --i;
+    }
+  }
+  if (i < 0 || a->used < TORADIX_DC_CUTOFF) {
+    return s_mp_toradix_base(a, inv, radix, k, pad, str);
+  }
+
+  if ((res = mp_radix_power_get(radix, i, MP_YES, &p)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_init_size(&q, a->used + 1)) != MP_OKAY) {
+    return res;
+  }
+  if ((res = mp_init(&r)) != MP_OKAY) {
+    goto LBL_Q;
+  }
+
+  /* q, r = a divmod P(i), the remainder comes out 2**shift too big */
+  if ((res = mp_mul_2d(a, p->shift, &q)) != MP_OKAY ||
+      (res = mp_div_barrett(&q, &p->norm, &p->mu, &q, &r)) != MP_OKAY ||
+      (res = mp_div_2d(&r, p->shift, &r, NULL)) != MP_OKAY) {
+    goto LBL_R;
+  }
+
+  len = k << i;
+  if ((res = s_mp_toradix_dc(&q, i - 1, inv, radix, k,
+                             (pad > len) ? (pad - len) : 0, str)) != MP_OKAY) {
+    goto LBL_R;
+  }
+  mp_clear(&q);
+  res = s_mp_toradix_dc(&r, i - 1, inv, radix, k, len, str);
+
+LBL_R:mp_clear(&r);
+LBL_Q:mp_clear(&q);
+  return res;
+}
+
+/* writes the digits of a in the radix 2**b to *str */
+static void s_mp_toradix_2k(mp_int *a, int b, char **str)
+{
+  mp_word  acc;
+  mp_digit mask;
+  char    *s, *e;
+  int      ix, have;
+
+  /* the digits are written from the end, where the bits of a start */
+  mask = (((mp_digit)1) << ((mp_digit)b)) - 1;
+  e    = *str;
+  s    = e + (mp_count_bits(a) + b - 1) / b;
+  *str = s;
+
+  acc  = 0;
+  have = 0;
+  for (ix = 0; ix < a->used; ix++) {
+    acc  |= ((mp_word)a->dp[ix]) << ((mp_word)have);
+    have += DIGIT_BIT;
+    while (have >= b && s > e) {
+      *--s  = mp_s_rmap[((mp_digit)acc) & mask];
+      acc >>= ((mp_word)b);
+      have -= b;
+    }
+  }
+
+  /* the top digit with fewer than b bits left */
+  if (s > e) {
+    *--s = mp_s_rmap[(mp_digit)acc];
+  }
+}
+
+int mp_toradix (mp_int * a, char *str, int radix)
+{
+  mp_radix_power *p;
+  mp_digit_inv inv;
+  mp_digit big;
+  mp_int   t;
+  int      res, k, i;
 
   /* check range of the radix */
-  if (radix < 2 || radix > 64) {
-    return MP_VAL;
+  if ((res = mp_radix_chunk(radix, &k, &big)) != MP_OKAY) {
+    return res;
   }
 
   /* quick out if its zero */
@@ -8712,43 +14087,49 @@ int mp_toradix (mp_int * a, char *str, int radix)
      return MP_OKAY;
   }
 
-  if ((res = mp_init_copy (&t, a)) != MP_OKAY) {
-    return res;
-  }
-
   /* if it is negative output a - */
-  if (t.sign == MP_NEG) {
-    ++_s;
+  if (a->sign == MP_NEG) {
     *str++ = '-';
-    t.sign = MP_ZPOS;
   }
 
-  digs = 0;
-  while (mp_iszero (&t) == 0) {
-    if ((res = mp_div_d (&t, (mp_digit) radix, &t, &d)) != MP_OKAY) {
-      mp_clear (&t);
-      return res;
-    }
-    *str++ = mp_s_rmap[d];
-    ++digs;
+  /* |a| as a window onto a */
+  t      = *a;
+  t.sign = MP_ZPOS;
+
+  if ((radix & (radix - 1)) == 0) {
+    for (i = 0; (1 << i) < radix; i++);
+    s_mp_toradix_2k(&t, i, &str);
+    *str = '\0';
+    return MP_OKAY;
   }
 
-  /* reverse the digits of the string.  In this case _s points
-   * to the first digit [exluding the sign] of the number]
-   */
-  bn_reverse ((unsigned char *)_s, digs);
+  if ((res = mp_div_d_setup(big, &inv)) != MP_OKAY) {
+    return res;
+  }
+
+  /* the first power whose square has a's size */
+  i = -1;
+  if (t.used >= TORADIX_DC_CUTOFF) {
+    do {
+      if ((res = mp_radix_power_get(radix, ++i, MP_NO, &p)) != MP_OKAY) {
+        return res;
+      }
+    } while (2 * p->p.used - 2 < t.used);
+  }
+
+  if ((res = s_mp_toradix_dc(&t, i, &inv, radix, k, 0, &str)) != MP_OKAY) {
+    return res;
+  }
 
   /* append a NULL so the string is properly terminated */
   *str = '\0';
-
-  mp_clear (&t);
   return MP_OKAY;
 }
 
 #endif
 
 /* $Source: /cvs/libtom/libtommath/bn_mp_toradix.c,v $ */
-/* $Revision: 1.4 $ */
+/* $Revision: 1.5 $ */
 /* $Date: 2006/12/28 01:25:13 $ */
 /*----------------------------------------------------------------------
  --   End: vendor/libtommath-0.41/bn_mp_toradix.c
@@ -9152,6 +14533,9 @@ s_mp_add (mp_int * a, mp_int * b, mp_int * c)
 
   {
     register mp_digit u, *tmpa, *tmpb, *tmpc;
+#ifdef MP_64BIT_FULL
+    register mp_word r;
+#endif
     register int i;
 
     /* alias for digit pointers */
@@ -9167,6 +14551,19 @@ s_mp_add (mp_int * a, mp_int * b, mp_int * c)
 
     /* zero the carry */
     u = 0;
+#ifdef MP_64BIT_FULL
+    /* the digits have no room for the carry, the mp_word does */
+    for (i = 0; i < min; i++) {
+      r       = ((mp_word)*tmpa++) + ((mp_word)*tmpb++) + ((mp_word)u);
+      *tmpc++ = (mp_digit)r;
+      u       = (mp_digit)(r >> ((mp_word)DIGIT_BIT));
+    }
+    for (; i < max; i++) {
+      r       = ((mp_word)x->dp[i]) + ((mp_word)u);
+      *tmpc++ = (mp_digit)r;
+      u       = (mp_digit)(r >> ((mp_word)DIGIT_BIT));
+    }
+#else
     for (i = 0; i < min; i++) {
       /* Compute the sum at one digit, T[i] = A[i] + B[i] + U */
       *tmpc = *tmpa++ + *tmpb++ + u;
@@ -9193,6 +14590,7 @@ s_mp_add (mp_int * a, mp_int * b, mp_int * c)
         *tmpc++ &= MP_MASK;
       }
     }
+#endif
 
     /* add carry */
     *tmpc++ = u;
@@ -9298,6 +14696,12 @@ int s_mp_exptmod (mp_int * G, mp_int * X, mp_int * P, mp_int * Y, int redmode)
         goto LBL_MU;
      }
      redux = mp_reduce;
+  } else if (redmode == 2) {
+     /* Montgomery with short products, mu is all of -1/P mod R */
+     if ((err = mp_montgomery_setup_l (P, &mu)) != MP_OKAY) {
+        goto LBL_MU;
+     }
+     redux = mp_montgomery_reduce_l;
   } else {
      if ((err = mp_reduce_2k_setup_l (P, &mu)) != MP_OKAY) {
         goto LBL_MU;
@@ -9313,7 +14717,15 @@ int s_mp_exptmod (mp_int * G, mp_int * X, mp_int * P, mp_int * Y, int redmode)
    * The first half of the table is not 
    * computed though accept for M[0] and M[1]
    */
-  if ((err = mp_mod (G, P, &M[1])) != MP_OKAY) {
+  if (redmode == 2) {
+     /* M[1] = G * R mod P */
+     if ((err = mp_montgomery_calc_normalization (&M[1], P)) != MP_OKAY) {
+       goto LBL_MU;
+     }
+     if ((err = mp_mulmod (G, &M[1], P, &M[1])) != MP_OKAY) {
+       goto LBL_MU;
+     }
+  } else if ((err = mp_mod (G, P, &M[1])) != MP_OKAY) {
     goto LBL_MU;
   }
 
@@ -9353,7 +14765,14 @@ int s_mp_exptmod (mp_int * G, mp_int * X, mp_int * P, mp_int * Y, int redmode)
   if ((err = mp_init (&res)) != MP_OKAY) {
     goto LBL_MU;
   }
-  mp_set (&res, 1);
+  if (redmode == 2) {
+     /* one is R mod P in the Montgomery system */
+     if ((err = mp_montgomery_calc_normalization (&res, P)) != MP_OKAY) {
+       goto LBL_RES;
+     }
+  } else {
+     mp_set (&res, 1);
+  }
 
   /* set initial mode and bit cnt */
   mode   = 0;
@@ -9454,6 +14873,13 @@ int s_mp_exptmod (mp_int * G, mp_int * X, mp_int * P, mp_int * Y, int redmode)
     }
   }
 
+  if (redmode == 2) {
+     /* take the factor of R back out */
+     if ((err = redux (&res, P, &mu)) != MP_OKAY) {
+       goto LBL_RES;
+     }
+  }
+
   mp_exch (&res, Y);
   err = MP_OKAY;
 LBL_RES:mp_clear (&res);
@@ -9509,7 +14935,7 @@ int s_mp_mul_digs (mp_int * a, mp_int * b, mp_int * c, int digs)
   /* can we use the fast multiplier? */
   if (((digs) < MP_WARRAY) &&
       MIN (a->used, b->used) < 
-          (1 << ((CHAR_BIT * sizeof (mp_word)) - (2 * DIGIT_BIT)))) {
+          MP_COMBA_MAX) {
     return fast_s_mp_mul_digs (a, b, c, digs);
   }
 
@@ -9606,7 +15032,7 @@ s_mp_mul_high_digs (mp_int * a, mp_int * b, mp_int * c, int digs)
   /* can we use the fast multiplier? */
 #ifdef BN_FAST_S_MP_MUL_HIGH_DIGS_C
   if (((a->used + b->used + 1) < MP_WARRAY)
-      && MIN (a->used, b->used) < (1 << ((CHAR_BIT * sizeof (mp_word)) - (2 * DIGIT_BIT)))) {
+      && MIN (a->used, b->used) < MP_COMBA_MAX) {
     return fast_s_mp_mul_high_digs (a, b, c, digs);
   }
 #endif
@@ -9625,13 +15051,16 @@ s_mp_mul_high_digs (mp_int * a, mp_int * b, mp_int * c, int digs)
     /* left hand side of A[ix] * B[iy] */
     tmpx = a->dp[ix];
 
+    /* the first digit of b that makes a column from digs up */
+    iy = MAX (digs - ix, 0);
+
     /* alias to the address of where the digits will be stored */
-    tmpt = &(t.dp[digs]);
+    tmpt = &(t.dp[ix + iy]);
 
     /* alias for where to read the right hand side from */
-    tmpy = b->dp + (digs - ix);
+    tmpy = b->dp + iy;
 
-    for (iy = digs - ix; iy < pb; iy++) {
+    for (; iy < pb; iy++) {
       /* calculate the double precision result */
       r       = ((mp_word)*tmpt) +
                 ((mp_word)tmpx) * ((mp_word)*tmpy++) +
@@ -9659,6 +15088,265 @@ s_mp_mul_high_digs (mp_int * a, mp_int * b, mp_int * c, int digs)
  --   End: vendor/libtommath-0.41/bn_s_mp_mul_high_digs.c
  ---------------------------------------------------------------------*/
 
+/*----------------------------------------------------------------------
+ -- Start: vendor/libtommath-0.41/bn_s_mp_mul_simd.c
+ ---------------------------------------------------------------------*/
+#include <tommath.h>
+#ifdef BN_S_MP_MUL_SIMD_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtom.org
+ */
+
+/* Comba multiplication with vector instructions
+ *
+ * The digits are cut into limbs of 52 bits, the width of the double
+ * precision mantissa and of the AVX-512 IFMA multipliers.  Column k of
+ * the product is then the sum over i of the low halves of a[i]*b[k-i]
+ * plus the high halves of a[i]*b[k-1-i], 52 bits each, and eight (four
+ * for AVX2) neighbouring columns are one vector.  For every limb of a a
+ * window of b is loaded unaligned, b is padded with zeros so no window
+ * runs off its ends, and the high halves are moved up a column once per
+ * block.  The columns are at most 2**62 so the carries are left until
+ * the end, when the limbs are put back into digits.
+ *
+ * AVX2 has no 52 bit multiplier, it gets the halves from the double
+ * precision FMA: hi = fma(a, b, 2**104) rounds a*b to a multiple of
+ * 2**52 held in the mantissa and lo = fma(a, b, 2**104 - hi) is what is
+ * left, which can be negative.  Both are summed as their bit patterns,
+ * less the constants added once per term.
+ *
+ * Which kernel runs is COMBA_MUL_METHOD, picked from what the processor
+ * has the first time it is needed.
+ */
+
+#ifdef MP_COMBA_SIMD
+#include <immintrin.h>
+
+typedef unsigned long long mp_limb;
+
+#define LIMB_BITS    52
+#define LIMB_MASK    ((((mp_limb)1) << LIMB_BITS) - 1)
+
+/* limbs in the longest product the comba sees, and the padding */
+#define SIMD_LIMBS   ((MP_WARRAY * DIGIT_BIT) / LIMB_BITS + 2)
+#define SIMD_PAD     8
+
+typedef union {
+  mp_limb u;
+  double  d;
+  long long s;
+} simd_limb;
+
+/* x = the n 52 bit limbs of a */
+static int s_simd_load (mp_int * a, simd_limb * x)
+{
+  int      ix, n, q, r;
+  mp_digit lo, hi;
+
+  n = (a->used * DIGIT_BIT + LIMB_BITS - 1) / LIMB_BITS;
+  for (ix = 0; ix < n; ix++) {
+    q  = (ix * LIMB_BITS) / DIGIT_BIT;
+    r  = (ix * LIMB_BITS) % DIGIT_BIT;
+    lo = a->dp[q];
+    hi = (q + 1 < a->used) ? a->dp[q + 1] : 0;
+    x[ix].u = (mp_limb)((((mp_word)lo) | (((mp_word)hi) << ((mp_word)DIGIT_BIT))) >> r) & LIMB_MASK;
+  }
+  return n;
+}
+
+__attribute__((target("avx512f,avx512ifma")))
+static void s_simd_ifma (simd_limb * A, int na, simd_limb * B, int nb, simd_limb * W)
+{
+  int     ix, iy, i0, i1, blocks;
+  __m512i lo, hi, lo2, hi2, av, bv, prev;
+
+  blocks = (na + nb + 7) / 8;
+  prev   = _mm512_setzero_si512 ();
+  for (ix = 0; ix < blocks; ix++) {
+    lo = hi = lo2 = hi2 = _mm512_setzero_si512 ();
+
+    /* only the limbs of a whose window overlaps b */
+    i0 = MAX (0, 8 * ix - nb + 1);
+    i1 = MIN (na - 1, 8 * ix + 7);
+
+    /* two chains so the multipliers are not waiting on each other */
+    for (iy = i0; iy < i1; iy += 2) {
+      av  = _mm512_set1_epi64 (A[iy].s);
+      bv  = _mm512_loadu_si512 ((void *)(B + 8 * ix - iy));
+      lo  = _mm512_madd52lo_epu64 (lo, av, bv);
+      hi  = _mm512_madd52hi_epu64 (hi, av, bv);
+      av  = _mm512_set1_epi64 (A[iy + 1].s);
+      bv  = _mm512_loadu_si512 ((void *)(B + 8 * ix - iy - 1));
+      lo2 = _mm512_madd52lo_epu64 (lo2, av, bv);
+      hi2 = _mm512_madd52hi_epu64 (hi2, av, bv);
+    }
+    if (iy == i1) {
+      av  = _mm512_set1_epi64 (A[iy].s);
+      bv  = _mm512_loadu_si512 ((void *)(B + 8 * ix - iy));
+      lo  = _mm512_madd52lo_epu64 (lo, av, bv);
+      hi  = _mm512_madd52hi_epu64 (hi, av, bv);
+    }
+    lo = _mm512_add_epi64 (lo, lo2);
+    hi = _mm512_add_epi64 (hi, hi2);
+
+    /* the high halves belong one column up */
+    _mm512_storeu_si512 ((void *)(W + 8 * ix), _mm512_add_epi64 (lo, _mm512_alignr_epi64 (hi, prev, 7)));
+    prev = hi;
+  }
+  _mm512_storeu_si512 ((void *)(W + 8 * ix), _mm512_alignr_epi64 (_mm512_setzero_si512 (), prev, 7));
+}
+
+__attribute__((target("avx2,fma")))
+static void s_simd_avx2 (simd_limb * A, int na, simd_limb * B, int nb, simd_limb * W)
+{
+  int       ix, iy, i0, i1, blocks;
+  long long n;
+  __m256d   av, bv, ph, pl, c104, c52;
+  __m256i   lo, hi, prev, t;
+
+  /* 2**104 and 2**52 + 2**51 */
+  c104 = _mm256_set1_pd (20282409603651670423947251286016.0);
+  c52  = _mm256_set1_pd (6755399441055744.0);
+
+  for (ix = 0; ix < na; ix++) {
+    A[ix].d = (double)A[ix].u;
+  }
+  for (ix = -SIMD_PAD; ix < nb + SIMD_PAD; ix++) {
+    B[ix].d = (double)B[ix].u;
+  }
+
+  blocks = (na + nb + 3) / 4;
+  prev   = _mm256_setzero_si256 ();
+  for (ix = 0; ix < blocks; ix++) {
+    lo = hi = _mm256_setzero_si256 ();
+    i0 = MAX (0, 4 * ix - nb + 1);
+    i1 = MIN (na - 1, 4 * ix + 3);
+    for (iy = i0; iy <= i1; iy++) {
+      av = _mm256_broadcast_sd (&A[iy].d);
+      bv = _mm256_loadu_pd (&B[4 * ix - iy].d);
+      ph = _mm256_fmadd_pd (av, bv, c104);
+      pl = _mm256_fmadd_pd (av, bv, _mm256_sub_pd (c104, ph));
+      hi = _mm256_add_epi64 (hi, _mm256_castpd_si256 (ph));
+      lo = _mm256_add_epi64 (lo, _mm256_castpd_si256 (_mm256_add_pd (pl, c52)));
+    }
+
+    /* take the constants out again, once for every term */
+    n  = (long long)(i1 - i0 + 1);
+    hi = _mm256_sub_epi64 (hi, _mm256_set1_epi64x (n * 0x4670000000000000LL));
+    lo = _mm256_sub_epi64 (lo, _mm256_set1_epi64x (n * 0x4338000000000000LL));
+
+    /* the high halves belong one column up, [prev3 hi0 hi1 hi2] */
+    t = _mm256_blend_epi32 (_mm256_permute4x64_epi64 (hi, 0x93), _mm256_permute4x64_epi64 (prev, 0xff), 0x03);
+    _mm256_storeu_si256 ((void *)(W + 4 * ix), _mm256_add_epi64 (lo, t));
+    prev = hi;
+  }
+  t = _mm256_blend_epi32 (_mm256_setzero_si256 (), _mm256_permute4x64_epi64 (prev, 0xff), 0x03);
+  _mm256_storeu_si256 ((void *)(W + 4 * ix), t);
+}
+
+/* the best kernel this processor can run */
+int mp_comba_best (void)
+{
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("avx512ifma")) {
+    return MP_COMBA_IFMA;
+  }
+  if (__builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma")) {
+    return MP_COMBA_AVX2;
+  }
+  return MP_COMBA_SCALAR;
+}
+
+/* c = |a| * |b| with the kernel COMBA_MUL_METHOD names, the caller has
+ * already resolved MP_COMBA_DETECT and checked it is not the scalar one
+ */
+int s_mp_mul_simd (mp_int * a, mp_int * b, mp_int * c)
+{
+  simd_limb A[SIMD_LIMBS], B[SIMD_LIMBS + 2 * SIMD_PAD], W[SIMD_LIMBS + 2 * SIMD_PAD];
+  simd_limb *pb;
+  int       res, na, nb, nw, ix, q, r, olduse, digs;
+  long long carry;
+  mp_word   w;
+
+  /* read both before c is written, it can be either of them */
+  pb = B + SIMD_PAD;
+  na = s_simd_load (a, A);
+  nb = s_simd_load (b, pb);
+  for (ix = 0; ix < SIMD_PAD; ix++) {
+    pb[ix - SIMD_PAD].u = 0;
+    pb[nb + ix].u = 0;
+  }
+
+  digs = a->used + b->used;
+  if (c->alloc < digs) {
+    if ((res = mp_grow (c, digs)) != MP_OKAY) {
+      return res;
+    }
+  }
+
+  /* W[] gets the columns, one block more than the product */
+  if (COMBA_MUL_METHOD == MP_COMBA_IFMA) {
+    s_simd_ifma (A, na, pb, nb, W);
+    nw = 8 * ((na + nb + 7) / 8) + 8;
+  } else {
+    s_simd_avx2 (A, na, pb, nb, W);
+    nw = 4 * ((na + nb + 3) / 4) + 4;
+  }
+
+  /* carry the columns into limbs */
+  carry = 0;
+  for (ix = 0; ix < nw; ix++) {
+    carry   += W[ix].s;
+    W[ix].u  = ((mp_limb)carry) & LIMB_MASK;
+    carry  >>= LIMB_BITS;
+  }
+
+  /* and the limbs into digits, three limbs cover any digit */
+  olduse  = c->used;
+  c->used = digs;
+  for (ix = 0; ix < digs; ix++) {
+    q = (ix * DIGIT_BIT) / LIMB_BITS;
+    r = (ix * DIGIT_BIT) % LIMB_BITS;
+    w = ((mp_word)W[q].u) | (((mp_word)W[q + 1].u) << ((mp_word)LIMB_BITS)) |
+        (((mp_word)W[q + 2].u) << ((mp_word)(2 * LIMB_BITS)));
+    c->dp[ix] = ((mp_digit)(w >> r)) & MP_MASK;
+  }
+  for (; ix < olduse; ix++) {
+    c->dp[ix] = 0;
+  }
+  mp_clamp (c);
+  return MP_OKAY;
+}
+
+#else
+
+int mp_comba_best (void)
+{
+  return MP_COMBA_SCALAR;
+}
+
+#endif
+
+#endif
+
+/* $Source: /cvs/libtom/libtommath/bn_s_mp_mul_simd.c,v $ */
+/* $Revision: 1.1 $ */
+/* $Date: 2006/12/28 01:25:13 $ */
+/*----------------------------------------------------------------------
+ --   End: vendor/libtommath-0.41/bn_s_mp_mul_simd.c
+ ---------------------------------------------------------------------*/
+
 /*----------------------------------------------------------------------
  -- Start: vendor/libtommath-0.41/bn_s_mp_sqr.c
  ---------------------------------------------------------------------*/
@@ -9686,6 +15374,10 @@ int s_mp_sqr (mp_int * a, mp_int * b)
   int     res, ix, iy, pa;
   mp_word r;
   mp_digit u, tmpx, *tmpt;
+#ifdef MP_64BIT_FULL
+  mp_word  w;
+  mp_digit c;
+#endif
 
   pa = a->used;
   if ((res = mp_init_size (&t, 2*pa + 1)) != MP_OKAY) {
@@ -9713,6 +15405,29 @@ int s_mp_sqr (mp_int * a, mp_int * b)
     /* alias for where to store the results */
     tmpt        = t.dp + (2*ix + 1);
     
+#ifdef MP_64BIT_FULL
+    /* t + 2*x*y + carry does not fit a mp_word here, so the carry is a
+     * mp_word and the bits above the mp_word are counted in c
+     */
+    w = u;
+    for (iy = ix + 1; iy < pa; iy++) {
+      r       = ((mp_word)tmpx) * ((mp_word)a->dp[iy]);
+      c       = (mp_digit)(r >> ((mp_word)(2 * DIGIT_BIT - 1)));
+      r       = r + r;
+      r      += (mp_word) *tmpt;
+      c      += (mp_digit)(r < ((mp_word) *tmpt));
+      r      += w;
+      c      += (mp_digit)(r < w);
+      *tmpt++ = (mp_digit) r;
+      w       = (r >> ((mp_word) DIGIT_BIT)) | (((mp_word) c) << ((mp_word) DIGIT_BIT));
+    }
+    /* propagate upwards */
+    while (w != ((mp_word) 0)) {
+      r       = ((mp_word) *tmpt) + w;
+      *tmpt++ = (mp_digit) r;
+      w       = r >> ((mp_word) DIGIT_BIT);
+    }
+#else
     for (iy = ix + 1; iy < pa; iy++) {
       /* first calculate the product */
       r       = ((mp_word)tmpx) * ((mp_word)a->dp[iy]);
@@ -9734,6 +15449,7 @@ int s_mp_sqr (mp_int * a, mp_int * b)
       *tmpt++ = (mp_digit) (r & ((mp_word) MP_MASK));
       u       = (mp_digit)(r >> ((mp_word) DIGIT_BIT));
     }
+#endif
   }
 
   mp_clamp (&t);
@@ -9791,6 +15507,9 @@ s_mp_sub (mp_int * a, mp_int * b, mp_int * c)
 
   {
     register mp_digit u, *tmpa, *tmpb, *tmpc;
+#ifdef MP_64BIT_FULL
+    register mp_word r;
+#endif
     register int i;
 
     /* alias for digit pointers */
@@ -9800,6 +15519,21 @@ s_mp_sub (mp_int * a, mp_int * b, mp_int * c)
 
     /* set carry to zero */
     u = 0;
+#ifdef MP_64BIT_FULL
+    /* the digits have no spare top bit, the borrow is the top of the
+     * difference taken as a mp_word
+     */
+    for (i = 0; i < min; i++) {
+      r       = ((mp_word)*tmpa++) - ((mp_word)*tmpb++) - ((mp_word)u);
+      *tmpc++ = (mp_digit)r;
+      u       = (mp_digit)(r >> ((mp_word)(CHAR_BIT * sizeof (mp_word) - 1)));
+    }
+    for (; i < max; i++) {
+      r       = ((mp_word)*tmpa++) - ((mp_word)u);
+      *tmpc++ = (mp_digit)r;
+      u       = (mp_digit)(r >> ((mp_word)(CHAR_BIT * sizeof (mp_word) - 1)));
+    }
+#else
     for (i = 0; i < min; i++) {
       /* T[i] = A[i] - B[i] - U */
       *tmpc = *tmpa++ - *tmpb++ - u;
@@ -9826,6 +15560,7 @@ s_mp_sub (mp_int * a, mp_int * b, mp_int * c)
       /* Clear carry from T[i] */
       *tmpc++ &= MP_MASK;
     }
+#endif
 
     /* clear digits above used (since we may not have grown result above) */
     for (i = c->used; i < olduse; i++) {
@@ -9879,7 +15614,38 @@ int     KARATSUBA_MUL_CUTOFF = 80,      /* Min. number of digits before Karatsub
         KARATSUBA_SQR_CUTOFF = 120,     /* Min. number of digits before Karatsuba squaring is used. */
         
         TOOM_MUL_CUTOFF      = 350,      /* no optimal values of these are known yet so set em high */
-        TOOM_SQR_CUTOFF      = 400; 
+        TOOM_SQR_CUTOFF      = 400, 
+
+        TOOM4_MUL_CUTOFF     = 600,      /* Min. number of digits before Toom-4 is used. */
+        TOOM4_SQR_CUTOFF     = 600,
+        TOOM65_MUL_CUTOFF    = 1300,     /* Min. number of digits before Toom-6.5 is used. */
+        TOOM65_SQR_CUTOFF    = 1600,
+
+        SSA_MUL_CUTOFF       = 3500,     /* Min. number of digits before Schonhage-Strassen is used. */
+        SSA_SQR_CUTOFF       = 3500,
+
+        NTT_MUL_CUTOFF       = 3500,     /* Min. number of digits before the three prime NTT is used. */
+        NTT_SQR_CUTOFF       = 3500,
+
+        SIMD_MUL_CUTOFF      = 24,       /* Min. digits before the comba multiplier uses vector instructions. */
+        SIMD_SQR_CUTOFF      = 64,
+
+        BZ_DIV_CUTOFF        = 60,       /* Min. digits of quotient and divisor before Burnikel-Ziegler division is used. */
+
+        TORADIX_DC_CUTOFF    = 40,       /* Min. digits before mp_toradix splits the number at a power of the radix. */
+        READ_RADIX_DC_CUTOFF = 40;       /* Min. digits before mp_read_radix splits the string at a power of the radix. */
+
+/* the multiplier past the cutoffs above Toom-Cook, the NTT is the faster
+ * one where it can be built
+ */
+#ifdef MP_64BIT
+int     FFT_MUL_METHOD       = MP_FFT_NTT;
+#else
+int     FFT_MUL_METHOD       = MP_FFT_SSA;
+#endif
+
+/* the comba kernel, picked from the processor unless it is set first */
+int     COMBA_MUL_METHOD     = MP_COMBA_DETECT;
 #endif
 
 /* $Source: /cvs/libtom/libtommath/bncore.c,v $ */
@@ -33,8 +33,159 @@ static VALUE ltm_two_to_the(VALUE self, VALUE other)
     return result;
 }
 
+/*
+ * call-seq:
+ *  digit_pool? -> true or false
+ *
+ * Are the digits of Bignums being recycled through the digit pool?
+ */
+static VALUE ltm_digit_pool_p(VALUE self)
+{
+    return ltm_digit_pool_enabled() ? Qtrue : Qfalse;
+}
+
+/*
+ * call-seq:
+ *  digit_pool = true or false
+ *
+ * Switch the digit pool on or off.  Memory already in the pool is given
+ * back when it is switched off.  Builds made with LTM_NO_DIGIT_POOL
+ * ignore this.
+ */
+static VALUE ltm_digit_pool_set(VALUE self, VALUE on)
+{
+    ltm_digit_pool_enable(RTEST(on));
+    return on;
+}
+
+/*
+ * call-seq:
+ *  digit_pool_stats -> hash
+ *
+ * The digit pool counters: <tt>:hits</tt> and <tt>:misses</tt> for
+ * allocations that were and were not served from the pool, and
+ * <tt>:pooled_bytes</tt> for the memory waiting in it to be reused.
+ */
+static VALUE ltm_digit_pool_stats_hash(VALUE self)
+{
+    ltm_digit_pool_stats stats;
+    VALUE result = rb_hash_new();
+
+    ltm_digit_pool_get_stats(&stats);
+    rb_hash_aset(result,ID2SYM(rb_intern("hits")),ULONG2NUM(stats.hits));
+    rb_hash_aset(result,ID2SYM(rb_intern("misses")),ULONG2NUM(stats.misses));
+    rb_hash_aset(result,ID2SYM(rb_intern("pooled_bytes")),ULONG2NUM(stats.pooled_bytes));
+    return result;
+}
 
 
+/*
+ * call-seq:
+ *  fft_multiplier -> :ntt, :ssa or :none
+ *
+ * The multiplier used for products too big for Toom-Cook: the three
+ * prime number theoretic transform (<tt>:ntt</tt>), Schonhage-Strassen
+ * (<tt>:ssa</tt>) or none at all, Toom-Cook all the way up
+ * (<tt>:none</tt>).
+ */
+static VALUE ltm_fft_multiplier(VALUE self)
+{
+    switch (FFT_MUL_METHOD) {
+    case MP_FFT_NTT:
+        return ID2SYM(rb_intern("ntt"));
+    case MP_FFT_SSA:
+        return ID2SYM(rb_intern("ssa"));
+    default:
+        return ID2SYM(rb_intern("none"));
+    }
+}
+
+/*
+ * call-seq:
+ *  fft_multiplier = :ntt, :ssa or :none
+ *
+ * Pick the multiplier for products too big for Toom-Cook.  This is
+ * process wide and meant for benchmarking them against each other.
+ * <tt>:ntt</tt> needs a build with 64-bit digits.
+ */
+static VALUE ltm_fft_multiplier_set(VALUE self, VALUE method)
+{
+    ID id;
+
+    Check_Type(method, T_SYMBOL);
+    id = SYM2ID(method);
+    if (id == rb_intern("ntt")) {
+#ifdef MP_64BIT
+        FFT_MUL_METHOD = MP_FFT_NTT;
+#else
+        rb_raise(eLT_M_Error, "The NTT multiplier needs 64-bit digits\n");
+#endif
+    } else if (id == rb_intern("ssa")) {
+        FFT_MUL_METHOD = MP_FFT_SSA;
+    } else if (id == rb_intern("none")) {
+        FFT_MUL_METHOD = MP_FFT_NONE;
+    } else {
+        rb_raise(rb_eArgError, "Unknown FFT multiplier %s", rb_id2name(id));
+    }
+    return method;
+}
+
+
+/*
+ * call-seq:
+ *  comba_kernel -> :ifma, :avx2 or :scalar
+ *
+ * The inner loop of the comba multiplier, the one used below the
+ * Karatsuba cutoff: AVX-512 IFMA (<tt>:ifma</tt>), AVX2 with FMA
+ * (<tt>:avx2</tt>) or plain C (<tt>:scalar</tt>).  Unless it was set
+ * it is the best the processor has.
+ */
+static VALUE ltm_comba_kernel(VALUE self)
+{
+    if (COMBA_MUL_METHOD == MP_COMBA_DETECT) {
+        COMBA_MUL_METHOD = mp_comba_best();
+    }
+    switch (COMBA_MUL_METHOD) {
+    case MP_COMBA_IFMA:
+        return ID2SYM(rb_intern("ifma"));
+    case MP_COMBA_AVX2:
+        return ID2SYM(rb_intern("avx2"));
+    default:
+        return ID2SYM(rb_intern("scalar"));
+    }
+}
+
+/*
+ * call-seq:
+ *  comba_kernel = :ifma, :avx2 or :scalar
+ *
+ * Pick the inner loop of the comba multiplier.  This is process wide and
+ * meant for benchmarking them against each other, a kernel the processor
+ * or the build does not have is refused.
+ */
+static VALUE ltm_comba_kernel_set(VALUE self, VALUE method)
+{
+    ID id;
+    int kernel;
+
+    Check_Type(method, T_SYMBOL);
+    id = SYM2ID(method);
+    if (id == rb_intern("ifma")) {
+        kernel = MP_COMBA_IFMA;
+    } else if (id == rb_intern("avx2")) {
+        kernel = MP_COMBA_AVX2;
+    } else if (id == rb_intern("scalar")) {
+        kernel = MP_COMBA_SCALAR;
+    } else {
+        rb_raise(rb_eArgError, "Unknown comba kernel %s", rb_id2name(id));
+    }
+    if (kernel > mp_comba_best()) {
+        rb_raise(eLT_M_Error, "The %s comba kernel is not available here\n", rb_id2name(id));
+    }
+    COMBA_MUL_METHOD = kernel;
+    return method;
+}
+
 
 /**********************************************************************
  *                   Ruby extension initialization                    *
@@ -61,6 +212,13 @@ void Init_libtommath()
     /* LibTom::Math:: <methods> */
     rb_define_module_function(mLT_M,"pow2",ltm_two_to_the,1); 
     rb_define_module_function(mLT_M,"two_to_the",ltm_two_to_the,1); 
+    rb_define_module_function(mLT_M,"digit_pool?",ltm_digit_pool_p,0);
+    rb_define_module_function(mLT_M,"digit_pool=",ltm_digit_pool_set,1);
+    rb_define_module_function(mLT_M,"digit_pool_stats",ltm_digit_pool_stats_hash,0);
+    rb_define_module_function(mLT_M,"fft_multiplier",ltm_fft_multiplier,0);
+    rb_define_module_function(mLT_M,"fft_multiplier=",ltm_fft_multiplier_set,1);
+    rb_define_module_function(mLT_M,"comba_kernel",ltm_comba_kernel,0);
+    rb_define_module_function(mLT_M,"comba_kernel=",ltm_comba_kernel_set,1);
 
     /*
      * class LibTom::Math::Bignum
@@ -68,6 +226,7 @@ void Init_libtommath()
     cLT_M_Bignum = rb_define_class_under(mLT_M,"Bignum",rb_cNumeric); /* in ltm_bignum.c */
     rb_define_alloc_func(cLT_M_Bignum,ltm_bignum_alloc); /* in ltm_bignum.c */
     rb_define_singleton_method(cLT_M_Bignum,"random_of_size",ltm_bignum_random_of_size,1); /* in ltm_bignum.c */
+    rb_define_singleton_method(cLT_M_Bignum,"from_bytes",ltm_bignum_from_bytes,-1); /* in ltm_bignum.c */
     rb_define_method(cLT_M_Bignum,"initialize",ltm_bignum_initialize,-1); /* in ltm_bignum.c */
     rb_define_method(cLT_M_Bignum,"initialize_copy",ltm_bignum_initialize_copy,1); /* in ltm_bignum.c */
     rb_define_method(cLT_M_Bignum,"to_s",ltm_bignum_to_s, -1); /* in ltm_bignum.c */ 
@@ -96,11 +255,23 @@ void Init_libtommath()
     rb_define_alias(cLT_M_Bignum, "mod","%"); /* in ltm_bignum.c */
     rb_define_alias(cLT_M_Bignum, "modulo","%"); /* in ltm_bignum.c */
     rb_define_method(cLT_M_Bignum, "divmod",ltm_bignum_divmod, 1); /* in ltm_bignum.c */
+    rb_define_method(cLT_M_Bignum, "divexact",ltm_bignum_divexact, 1); /* in ltm_bignum.c */
     rb_define_method(cLT_M_Bignum, "**",ltm_bignum_pow, 1); /* in ltm_bignum.c */
 
+    /* in place arithmetic, these change the receiver and return it */
+    rb_define_method(cLT_M_Bignum, "add!",ltm_bignum_add_bang, 1); /* in ltm_bignum.c */
+    rb_define_method(cLT_M_Bignum, "sub!",ltm_bignum_subtract_bang, 1); /* in ltm_bignum.c */
+    rb_define_method(cLT_M_Bignum, "mul!",ltm_bignum_multiply_bang, 1); /* in ltm_bignum.c */
+    rb_define_method(cLT_M_Bignum, "sqr!",ltm_bignum_squared_bang, 0); /* in ltm_bignum.c */
+    rb_define_method(cLT_M_Bignum, "mod!",ltm_bignum_modulo_bang, 1); /* in ltm_bignum.c */
+    rb_define_method(cLT_M_Bignum, "shl!",ltm_bignum_lshift_bits_bang, 1); /* in ltm_bignum.c */
+    rb_define_method(cLT_M_Bignum, "shr!",ltm_bignum_rshift_bits_bang, 1); /* in ltm_bignum.c */
+
     /* utility methods */
     rb_define_method(cLT_M_Bignum, "size",ltm_bignum_size, 0); /* in ltm_bignum.c */
     rb_define_method(cLT_M_Bignum, "to_f",ltm_bignum_to_f, 0); /* in ltm_bignum.c */
+    rb_define_method(cLT_M_Bignum, "to_bytes",ltm_bignum_to_bytes, -1); /* in ltm_bignum.c */
+    rb_define_method(cLT_M_Bignum, "to_i",ltm_bignum_to_i, 0); /* in ltm_bignum.c */
     rb_define_method(cLT_M_Bignum, "even?",ltm_bignum_even, 0); /* in ltm_bignum.c */
     rb_define_method(cLT_M_Bignum, "odd?",ltm_bignum_odd, 0); /* in ltm_bignum.c */
     rb_define_method(cLT_M_Bignum, "nonzero?",ltm_bignum_nonzero,0); /* in ltm_bignum.c */
@@ -108,6 +279,7 @@ void Init_libtommath()
     rb_define_method(cLT_M_Bignum, "zero!",ltm_bignum_zero_bang,0); /* in ltm_bignum.c */
     rb_define_method(cLT_M_Bignum, "hash",ltm_bignum_hash, 0); /* in ltm_bignum.c */
     rb_define_method(cLT_M_Bignum, "num_bits",ltm_bignum_num_bits,0); /* in ltm_bignum.c */
+    rb_define_method(cLT_M_Bignum, "num_digits",ltm_bignum_num_digits,-1); /* in ltm_bignum.c */
 
     /* logical / bitwise  operators */
     rb_define_method(cLT_M_Bignum, "&",ltm_bignum_bit_and, 1); /* in ltm_bignum.c */
@@ -167,4 +339,17 @@ void Init_libtommath()
     cLT_M_Prime = rb_define_class_under(mLT_M,"Prime",rb_cObject); /* in ltm_prime.c */
     rb_define_singleton_method(cLT_M_Prime,"num_miller_rabin_trials_for",ltm_prime_num_miller_rabin_trials,1);/* in ltm_prime.c */
     rb_define_singleton_method(cLT_M_Prime,"random_of_size",ltm_prime_random_of_size,-1);/* in ltm_prime.c */
+
+    /*
+     * class Divisor
+     */
+    cLT_M_Divisor = rb_define_class_under(mLT_M,"Divisor",rb_cObject); /* in ltm_divisor.c */
+    rb_define_alloc_func(cLT_M_Divisor,ltm_divisor_alloc); /* in ltm_divisor.c */
+    rb_define_method(cLT_M_Divisor,"initialize",ltm_divisor_initialize,1); /* in ltm_divisor.c */
+    rb_define_method(cLT_M_Divisor,"initialize_copy",ltm_divisor_initialize_copy,1); /* in ltm_divisor.c */
+    rb_define_method(cLT_M_Divisor,"divisor",ltm_divisor_divisor,0); /* in ltm_divisor.c */
+    rb_define_method(cLT_M_Divisor,"div",ltm_divisor_div,1); /* in ltm_divisor.c */
+    rb_define_method(cLT_M_Divisor,"mod",ltm_divisor_mod,1); /* in ltm_divisor.c */
+    rb_define_alias(cLT_M_Divisor,"modulo","mod"); /* in ltm_divisor.c */
+    rb_define_method(cLT_M_Divisor,"divmod",ltm_divisor_divmod,1); /* in ltm_divisor.c */
 }
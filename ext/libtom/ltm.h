@@ -5,14 +5,121 @@
 #include <math.h>
 #include <tommath.h>
 
+#ifdef HAVE_RB_THREAD_CALL_WITHOUT_GVL
+#include <ruby/thread.h>
+#endif
+
+/* accessors that older rubies do not have */
+#ifndef RSTRING_PTR
+#define RSTRING_PTR(str) (RSTRING(str)->ptr)
+#endif
+#ifndef RSTRING_LEN
+#define RSTRING_LEN(str) (RSTRING(str)->len)
+#endif
+#ifndef RFLOAT_VALUE
+#define RFLOAT_VALUE(flt) (RFLOAT(flt)->value)
+#endif
+#ifndef rb_check_frozen
+#define rb_check_frozen(obj) do { if (OBJ_FROZEN(obj)) rb_error_frozen(rb_obj_classname(obj)); } while (0)
+#endif
+#ifndef RB_GC_GUARD
+#define RB_GC_GUARD(v) (*(volatile VALUE *)&(v))
+#endif
+
 
 /* Module and Class */
 extern VALUE mLT; 
 extern VALUE mLT_M;
 extern VALUE cLT_M_Bignum;
 extern VALUE cLT_M_Prime;
+extern VALUE cLT_M_Divisor;
 extern VALUE eLT_M_Error;
 
+/* every block of memory handed to libtommath is preceded by one of these */
+typedef struct {
+    size_t size;      /* usable bytes after the header */
+    size_t type;      /* one of the LTM_BLOCK_ values  */
+} ltm_block_header;
+
+#define LTM_BLOCK_HEAP      0   /* straight from the system allocator     */
+#define LTM_BLOCK_EMBEDDED  1   /* the digits inside a Bignum             */
+#define LTM_BLOCK_POOLED    2   /* a size class block from the digit pool */
+#define LTM_BLOCK_SCRATCH   3   /* carved out of the thread's scratch arena */
+
+#define LTM_BLOCK_HEADER(p) (((ltm_block_header*)(p)) - 1)
+
+/* counters kept by the digit pool */
+typedef struct {
+    unsigned long hits;          /* allocations served from a free list  */
+    unsigned long misses;        /* poolable allocations that were not   */
+    unsigned long pooled_bytes;  /* bytes sitting in free lists right now */
+} ltm_digit_pool_stats;
+
+/* digits a Bignum holds inside itself before it needs the heap, the same
+ * as what mp_init would have allocated
+ */
+#define LTM_EMBEDDED_DIGITS MP_PREC
+
+/* what a Bignum wraps, the mp_int has to come first */
+typedef struct {
+    mp_int           mp;
+    ltm_block_header header;
+    mp_digit         digits[LTM_EMBEDDED_DIGITS];
+} ltm_bignum;
+
+#define LTM_EMBEDDED_P(bn) ((bn)->mp.dp == (bn)->digits)
+
+/* Bignums wrap an ltm_bignum, as TypedData on rubies that have it so the
+ * GC can see how big the digits are
+ */
+#ifdef TypedData_Wrap_Struct
+extern const rb_data_type_t ltm_bignum_type;
+#define LTM_WRAP_STRUCT(klass,bn) (TypedData_Wrap_Struct(klass,&ltm_bignum_type,bn))
+#define LTM_GET_STRUCT(obj,bn) (TypedData_Get_Struct(obj,mp_int,&ltm_bignum_type,bn))
+#else
+#define LTM_WRAP_STRUCT(klass,bn) (Data_Wrap_Struct(klass,NULL,ltm_bignum_free,bn))
+#define LTM_GET_STRUCT(obj,bn) (Data_Get_Struct(obj,mp_int,bn))
+#endif
+
+/* how an operand of multiply or divide can be strength reduced */
+#define LTM_OPERAND_GENERAL 0   /* needs the full mp_int routine   */
+#define LTM_OPERAND_DIGIT   1   /* magnitude fits in one mp_digit  */
+#define LTM_OPERAND_POW2    2   /* magnitude is 2**power           */
+
+typedef struct {
+    int      kind;
+    int      sign;
+    mp_digit digit;  /* magnitude when kind is LTM_OPERAND_DIGIT */
+    int      power;  /* exponent when kind is LTM_OPERAND_POW2   */
+} ltm_operand;
+
+/* operands of at least this many bits are worked on with the GVL released */
+#define LTM_NOGVL_BITS 512
+
+#ifdef HAVE_RB_THREAD_CALL_WITHOUT_GVL
+#define LTM_WITHOUT_GVL_P(bits) ((bits) >= LTM_NOGVL_BITS)
+#else
+#define LTM_WITHOUT_GVL_P(bits) (0)
+#endif
+
+/* most operands one ltm_without_gvl call copies */
+#define LTM_NOGVL_OPERANDS 3
+
+/* returned by work that stopped early because ruby wanted the thread */
+#define LTM_INTERRUPTED (-100)
+
+/* work handed to ltm_without_gvl, it must not touch any ruby objects and
+ * should return LTM_INTERRUPTED soon after *interrupted goes non zero
+ */
+typedef int (*ltm_nogvl_func)(void *data, volatile int *interrupted);
+
+/* passed through mp_prime_random_ex to ltm_bignum_random_prime_callback */
+typedef struct {
+    int without_gvl;            /* the callback has to take the GVL to call rand */
+    volatile int *interrupted;  /* non zero when no more bytes should be given   */
+    int state;                  /* rb_protect state when rand raised             */
+} ltm_random_prime_data;
+
 /**********************************************************************
  *                             Prototypes                             *
  **********************************************************************/
@@ -20,14 +127,37 @@ extern VALUE eLT_M_Error;
 /* internal functions, not part of the API */
 extern mp_int* value_to_mp_int(VALUE);
 extern mp_int* num_to_mp_int(VALUE);
+extern VALUE num_to_ltm_bignum(VALUE);
+extern int fixnum_to_mp_digit(VALUE, mp_digit*, int*);
+extern mp_int* fixnum_to_mp_int(VALUE, mp_int*, mp_digit*);
+extern int mp_int_cmp_digit(mp_int*, mp_digit, int);
+extern int classify_operand(VALUE, ltm_operand*);
+extern int integer_to_mp_int(VALUE, mp_int*);
+extern VALUE mp_int_to_integer(mp_int*);
+extern VALUE mp_int_to_rstring(mp_int*, int);
 extern int ltm_bignum_random_prime_callback(unsigned char*, int, void*);
+extern int ltm_without_gvl(ltm_nogvl_func, void*, mp_int**[], int, mp_int*, int);
+extern int ltm_prime_is_prime(mp_int*, int, int*, volatile int*);
+extern VALUE ltm_bignum_from_mp_int(mp_int*);
+extern void* ltm_xmalloc(size_t);
+extern void* ltm_xcalloc(size_t, size_t);
+extern void* ltm_xrealloc(void*, size_t);
+extern void ltm_xfree(void*);
+extern void ltm_adjust_memory_usage(long);
+extern void ltm_scratch_reserve(size_t);
+extern size_t ltm_scratch_mark(void);
+extern void* ltm_scratch_alloc(size_t);
+extern void ltm_scratch_release(size_t);
+extern int ltm_digit_pool_enabled(void);
+extern void ltm_digit_pool_enable(int);
+extern void ltm_digit_pool_get_stats(ltm_digit_pool_stats*);
 
 
 /** Bignum **/
-extern VALUE is_2(VALUE);
 extern VALUE ltm_bignum_abs(VALUE self);
 extern VALUE ltm_bignum_add_modulus(VALUE self, VALUE p1, VALUE p2);
 extern VALUE ltm_bignum_add(VALUE self, VALUE other);
+extern VALUE ltm_bignum_add_bang(VALUE self, VALUE other);
 extern VALUE ltm_bignum_alloc(VALUE);;
 extern VALUE ltm_bignum_bit_and(VALUE self, VALUE other);
 extern VALUE ltm_bignum_bit_negation(VALUE self);
@@ -36,6 +166,7 @@ extern VALUE ltm_bignum_bit_ref(VALUE self);
 extern VALUE ltm_bignum_bit_xor(VALUE self, VALUE other);
 extern VALUE ltm_bignum_coerce(VALUE self, VALUE other);
 extern VALUE ltm_bignum_divide(VALUE self, VALUE other);
+extern VALUE ltm_bignum_divexact(VALUE self, VALUE other);
 extern VALUE ltm_bignum_divisible_by_some_primes(VALUE self);
 extern VALUE ltm_bignum_divmod(VALUE self, VALUE other);
 extern VALUE ltm_bignum_eql(VALUE self, VALUE other);
@@ -43,6 +174,7 @@ extern VALUE ltm_bignum_eq(VALUE self, VALUE other);
 extern VALUE ltm_bignum_even(VALUE self);
 extern VALUE ltm_bignum_exponent_modulus(VALUE self, VALUE p1, VALUE p2);
 extern VALUE ltm_bignum_extended_euclidian(VALUE self, VALUE p1);
+extern VALUE ltm_bignum_from_bytes(int argc, VALUE *argv, VALUE self);
 extern VALUE ltm_bignum_greatest_common_divisor(VALUE self, VALUE p1);
 extern VALUE ltm_bignum_hash(VALUE self);
 extern VALUE ltm_bignum_initialize_copy(VALUE copy, VALUE orig);
@@ -54,14 +186,18 @@ extern VALUE ltm_bignum_jacobi(VALUE self, VALUE p);
 extern VALUE ltm_bignum_least_common_multiple(VALUE self, VALUE p1);
 extern VALUE ltm_bignum_left_shift_digits(VALUE self, VALUE other);
 extern VALUE ltm_bignum_lshift_bits(VALUE self, VALUE other);
+extern VALUE ltm_bignum_lshift_bits_bang(VALUE self, VALUE other);
 extern VALUE ltm_bignum_modulo_2d(VALUE self, VALUE other);
 extern VALUE ltm_bignum_modulo(VALUE self, VALUE other);
+extern VALUE ltm_bignum_modulo_bang(VALUE self, VALUE other);
 extern VALUE ltm_bignum_multiply_modulus(VALUE self, VALUE p1, VALUE p2);
 extern VALUE ltm_bignum_multiply(VALUE self, VALUE other);
+extern VALUE ltm_bignum_multiply_bang(VALUE self, VALUE other);
 extern VALUE ltm_bignum_next_prime(int argc, VALUE* argv, VALUE self);
 extern VALUE ltm_bignum_nonzero(VALUE self);
 extern VALUE ltm_bignum_nth_root(VALUE self, VALUE p1);
 extern VALUE ltm_bignum_num_bits(VALUE self);
+extern VALUE ltm_bignum_num_digits(int argc, VALUE *argv, VALUE self);
 extern VALUE ltm_bignum_odd(VALUE self);
 extern VALUE ltm_bignum_passes_fermat_primality(VALUE self,VALUE p1);
 extern VALUE ltm_bignum_passes_miller_rabin(VALUE self,VALUE p1);
@@ -70,14 +206,19 @@ extern VALUE ltm_bignum_random_of_size(VALUE self, VALUE other);
 extern VALUE ltm_bignum_remainder(VALUE self, VALUE other);
 extern VALUE ltm_bignum_right_shift_digits(VALUE self, VALUE other);
 extern VALUE ltm_bignum_rshift_bits(VALUE self, VALUE other);
+extern VALUE ltm_bignum_rshift_bits_bang(VALUE self, VALUE other);
 extern VALUE ltm_bignum_size(VALUE self);
 extern VALUE ltm_bignum_spaceship(VALUE self, VALUE other);
 extern VALUE ltm_bignum_squared(VALUE self);
+extern VALUE ltm_bignum_squared_bang(VALUE self);
 extern VALUE ltm_bignum_square_modulus(VALUE self, VALUE p1);
 extern VALUE ltm_bignum_square_root(VALUE self);
 extern VALUE ltm_bignum_subtract_modulus(VALUE self, VALUE p1, VALUE p2);
 extern VALUE ltm_bignum_subtract(VALUE self, VALUE other);
+extern VALUE ltm_bignum_subtract_bang(VALUE self, VALUE other);
+extern VALUE ltm_bignum_to_bytes(int argc, VALUE *argv, VALUE self);
 extern VALUE ltm_bignum_to_f(VALUE self);
+extern VALUE ltm_bignum_to_i(VALUE self);
 extern VALUE ltm_bignum_to_s(int argc, VALUE *argv, VALUE self);
 extern VALUE ltm_bignum_uminus(VALUE self);
 extern VALUE ltm_bignum_zero_bang(VALUE self);
@@ -87,6 +228,15 @@ extern VALUE ltm_prime_random_of_size(int argc, VALUE* argv, VALUE self);
 
 /** Prime **/
 
+/** Divisor **/
+extern VALUE ltm_divisor_alloc(VALUE);
+extern VALUE ltm_divisor_div(VALUE self, VALUE other);
+extern VALUE ltm_divisor_divisor(VALUE self);
+extern VALUE ltm_divisor_divmod(VALUE self, VALUE other);
+extern VALUE ltm_divisor_initialize_copy(VALUE copy, VALUE orig);
+extern VALUE ltm_divisor_initialize(VALUE self, VALUE other);
+extern VALUE ltm_divisor_mod(VALUE self, VALUE other);
+
 /**********************************************************************
  *                           Useful MACROS                            *
  **********************************************************************/
@@ -97,7 +247,16 @@ extern VALUE ltm_prime_random_of_size(int argc, VALUE* argv, VALUE self);
 #define ALLOC_LTM_BIGNUM (ltm_bignum_alloc(cLT_M_Bignum))
 #define NEW_LTM_BIGNUM_FROM(other) (rb_class_new_instance(1,&other,cLT_M_Bignum))
 #define NUM2MP_INT(obj) (num_to_mp_int(obj))
-#define IS_2(obj) (Qtrue == is_2(obj))
+#define NUM2LTM_BIGNUM(obj) (num_to_ltm_bignum(obj))
+
+/* number of mp_digits it takes to hold the magnitude of any Fixnum */
+#define FIXNUM_MP_DIGITS ((int)((sizeof(long) * CHAR_BIT + DIGIT_BIT - 1) / DIGIT_BIT))
+
+/* high bits of each mp_digit that are not part of the number */
+#define MP_DIGIT_NAILS (sizeof(mp_digit) * CHAR_BIT - DIGIT_BIT)
+
+/* like NUM2MP_INT but Fixnums are read into the caller's stack mp_int */
+#define NUM2MP_INT_STACK(obj,tmp,digits) (FIXNUM_P(obj) ? fixnum_to_mp_int(obj,tmp,digits) : num_to_mp_int(obj))
 
 #endif
 
@@ -0,0 +1,493 @@
+#include "ltm.h"
+#include <string.h>
+
+/**********************************************************************
+ *                  Memory handed out to libtommath                   *
+ **********************************************************************/
+
+/*
+ * libtommath is built with XMALLOC, XREALLOC, XCALLOC and XFREE pointing
+ * at the functions below.  Every block they hand out is preceded by an
+ * ltm_block_header recording its size and where it came from, which lets
+ * the GC be told exactly how much memory the digits take up.
+ *
+ * A Bignum keeps its first LTM_EMBEDDED_DIGITS digits inside itself
+ * behind the same kind of header, marked as embedded.  That storage
+ * belongs to the Bignum, so it is never freed here, and growing past it
+ * moves the digits out to the heap.
+ *
+ * Blocks up to LTM_POOL_MAX_CLASS_BYTES are rounded up to a power of two
+ * size class and recycled through per thread free lists (the digit
+ * pool), since mp_grow and the temporaries of every operation would
+ * otherwise go to malloc over and over.  A block that still fits its
+ * class is also resized in place.  The pool can be switched off at run
+ * time, or at build time by defining LTM_NO_DIGIT_POOL.
+ *
+ * The big routines (Karatsuba, Toom, exptmod, division and inversion)
+ * take their temporaries from a per thread scratch arena instead, a
+ * single buffer that is bumped through and handed back in one go when
+ * the routine returns.  Whatever does not fit in it comes from the heap.
+ *
+ * Defining LTM_RUBY_XMALLOC takes the memory from ruby's xmalloc instead
+ * of malloc, which does the GC accounting itself.
+ */
+
+#if defined(__GNUC__)
+#  define LTM_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#  define LTM_THREAD_LOCAL __declspec(thread)
+#else
+   /* no thread local storage, no pool and no arena */
+#  define LTM_NO_DIGIT_POOL
+#  define LTM_NO_SCRATCH_ARENA
+#endif
+
+#if defined(LTM_THREAD_LOCAL) && !defined(_WIN32)
+#  define LTM_THREAD_EXIT
+#  include <pthread.h>
+#endif
+
+#ifdef __GNUC__
+#  define LTM_ATOMIC_ADD(var,n) ((void)__sync_fetch_and_add(&(var),(n)))
+#  define LTM_ATOMIC_SUB(var,n) ((void)__sync_fetch_and_sub(&(var),(n)))
+#else
+#  define LTM_ATOMIC_ADD(var,n) ((void)((var) += (n)))
+#  define LTM_ATOMIC_SUB(var,n) ((void)((var) -= (n)))
+#endif
+
+#ifdef LTM_RUBY_XMALLOC
+#  define SYSTEM_MALLOC(n)    ruby_xmalloc(n)
+#  define SYSTEM_REALLOC(p,n) ruby_xrealloc((p),(n))
+#  define SYSTEM_FREE(p)      ruby_xfree(p)
+#  define SYSTEM_ADJUST(n)    ((void)(n))
+#else
+#  define SYSTEM_MALLOC(n)    malloc(n)
+#  define SYSTEM_REALLOC(p,n) realloc((p),(n))
+#  define SYSTEM_FREE(p)      free(p)
+#  define SYSTEM_ADJUST(n)    ltm_adjust_memory_usage(n)
+#endif
+
+/* the smallest class is what mp_init asks for, each class doubles it */
+#define LTM_POOL_MIN_CLASS_BYTES  (MP_PREC * sizeof(mp_digit))
+#define LTM_POOL_CLASSES          10
+#define LTM_POOL_MAX_CLASS_BYTES  (LTM_POOL_MIN_CLASS_BYTES << (LTM_POOL_CLASSES - 1))
+
+/* the most a single thread keeps in its free lists */
+#define LTM_POOL_MAX_THREAD_BYTES (1UL << 20)
+
+/* the scratch arena keeps what it has up to this size between calls */
+#define LTM_SCRATCH_KEEP_BYTES    (1UL << 20)
+
+/* scratch blocks, with their headers, are kept this aligned */
+#define LTM_SCRATCH_ALIGN         16
+
+/* a free block in a free list, kept in the block's own storage */
+typedef struct ltm_pool_link {
+    struct ltm_pool_link *next;
+} ltm_pool_link;
+
+static ltm_digit_pool_stats pool_stats = { 0, 0, 0 };
+
+#ifndef LTM_NO_DIGIT_POOL
+static volatile int pool_enabled = 1;
+
+static LTM_THREAD_LOCAL ltm_pool_link *free_lists[LTM_POOL_CLASSES];
+static LTM_THREAD_LOCAL unsigned long thread_pooled_bytes = 0;
+#else
+static volatile int pool_enabled = 0;
+#endif
+
+#ifndef LTM_NO_SCRATCH_ARENA
+static LTM_THREAD_LOCAL char  *scratch_base = NULL;
+static LTM_THREAD_LOCAL size_t scratch_size = 0;
+static LTM_THREAD_LOCAL size_t scratch_used = 0;
+#endif
+
+static void thread_register(void);
+
+
+/*
+ * get a block with room for _n_ bytes from the system
+ */
+static void* system_block(size_t n, size_t type)
+{
+    ltm_block_header *header = (ltm_block_header*)SYSTEM_MALLOC(sizeof(ltm_block_header) + n);
+
+    if (NULL == header) {
+        return NULL;
+    }
+    header->size = n;
+    header->type = type;
+    SYSTEM_ADJUST((long)n);
+
+    return header + 1;
+}
+
+
+/*
+ * give a block back to the system
+ */
+static void system_release(ltm_block_header *header)
+{
+    SYSTEM_ADJUST(-(long)header->size);
+    SYSTEM_FREE(header);
+}
+
+
+#ifndef LTM_NO_DIGIT_POOL
+
+/*
+ * the size class that holds _n_ bytes, or -1 if _n_ is too big to pool
+ */
+static int pool_class_of(size_t n)
+{
+    size_t size = LTM_POOL_MIN_CLASS_BYTES;
+    int c;
+
+    for (c = 0; c < LTM_POOL_CLASSES; c++, size <<= 1) {
+        if (n <= size) {
+            return c;
+        }
+    }
+    return -1;
+}
+
+
+/*
+ * put every block the calling thread has pooled back to the system
+ */
+static void pool_drain(void)
+{
+    ltm_pool_link *link;
+    ltm_block_header *header;
+    int c;
+
+    for (c = 0; c < LTM_POOL_CLASSES; c++) {
+        while (NULL != (link = free_lists[c])) {
+            free_lists[c] = link->next;
+            header = LTM_BLOCK_HEADER(link);
+            thread_pooled_bytes -= header->size;
+            LTM_ATOMIC_SUB(pool_stats.pooled_bytes,header->size);
+            system_release(header);
+        }
+    }
+}
+
+
+/*
+ * a block of class _c_, from the free list when there is one
+ */
+static void* pool_block(int c)
+{
+    ltm_pool_link *link = free_lists[c];
+    size_t size = LTM_POOL_MIN_CLASS_BYTES << c;
+
+    if (NULL != link) {
+        free_lists[c] = link->next;
+        thread_pooled_bytes -= size;
+        LTM_ATOMIC_SUB(pool_stats.pooled_bytes,size);
+        LTM_ATOMIC_ADD(pool_stats.hits,1);
+        return link;
+    }
+
+    LTM_ATOMIC_ADD(pool_stats.misses,1);
+    return system_block(size,LTM_BLOCK_POOLED);
+}
+
+
+/*
+ * return a pooled block to the calling thread's free list, or to the
+ * system once the thread holds as much as it is allowed to
+ */
+static void pool_release(ltm_block_header *header)
+{
+    ltm_pool_link *link = (ltm_pool_link*)(header + 1);
+    int c;
+
+    if (!pool_enabled || (thread_pooled_bytes + header->size > LTM_POOL_MAX_THREAD_BYTES)) {
+        system_release(header);
+        return;
+    }
+
+    thread_register();
+    c = pool_class_of(header->size);
+    link->next    = free_lists[c];
+    free_lists[c] = link;
+    thread_pooled_bytes += header->size;
+    LTM_ATOMIC_ADD(pool_stats.pooled_bytes,header->size);
+}
+
+#else
+#define pool_release(header) system_release(header)
+#endif
+
+
+/*
+ * give the calling thread's scratch arena back to the system
+ */
+static void scratch_free(void)
+{
+#ifndef LTM_NO_SCRATCH_ARENA
+    if (NULL != scratch_base) {
+        SYSTEM_ADJUST(-(long)scratch_size);
+        SYSTEM_FREE(scratch_base);
+        scratch_base = NULL;
+        scratch_size = 0;
+        scratch_used = 0;
+    }
+#endif
+}
+
+
+#ifdef LTM_THREAD_EXIT
+/*
+ * Free lists and the scratch arena belong to a thread and are released
+ * when it exits, through the destructor of a pthread key that is set the
+ * first time the thread holds on to any memory.
+ */
+static pthread_key_t  thread_key;
+static pthread_once_t thread_key_once = PTHREAD_ONCE_INIT;
+static LTM_THREAD_LOCAL int thread_key_set = 0;
+
+static void thread_exit(void *unused)
+{
+#ifndef LTM_NO_DIGIT_POOL
+    pool_drain();
+#endif
+    scratch_free();
+}
+
+static void thread_key_create(void)
+{
+    pthread_key_create(&thread_key,thread_exit);
+}
+
+static void thread_register(void)
+{
+    if (!thread_key_set) {
+        pthread_once(&thread_key_once,thread_key_create);
+        pthread_setspecific(thread_key,&thread_key_set);
+        thread_key_set = 1;
+    }
+}
+#else
+static void thread_register(void)
+{
+}
+#endif
+
+
+/*
+ * allocate _n_ bytes of storage for libtommath
+ */
+void* ltm_xmalloc(size_t n)
+{
+#ifndef LTM_NO_DIGIT_POOL
+    int c;
+
+    if (pool_enabled && (0 <= (c = pool_class_of(n)))) {
+        return pool_block(c);
+    }
+#endif
+    return system_block(n,LTM_BLOCK_HEAP);
+}
+
+
+/*
+ * allocate _n_ zeroed elements of _s_ bytes for libtommath
+ */
+void* ltm_xcalloc(size_t n, size_t s)
+{
+    void *p = ltm_xmalloc(n * s);
+
+    if (NULL != p) {
+        memset(p,0,n * s);
+    }
+    return p;
+}
+
+
+/*
+ * resize the block _p_ to _n_ bytes.  Embedded, pooled and scratch
+ * blocks stay where they are while _n_ fits in them and are copied out
+ * otherwise.
+ */
+void* ltm_xrealloc(void *p, size_t n)
+{
+    ltm_block_header *header;
+    void *q;
+    size_t old_size;
+
+    if (NULL == p) {
+        return ltm_xmalloc(n);
+    }
+
+    header = LTM_BLOCK_HEADER(p);
+    if (LTM_BLOCK_HEAP != header->type) {
+        if (n <= header->size) {
+            return p;
+        }
+        if (NULL != (q = ltm_xmalloc(n))) {
+            memcpy(q,p,header->size);
+            ltm_xfree(p);
+        }
+        return q;
+    }
+
+    old_size = header->size;
+    if (NULL == (header = (ltm_block_header*)SYSTEM_REALLOC(header,sizeof(ltm_block_header) + n))) {
+        return NULL;
+    }
+    header->size = n;
+    SYSTEM_ADJUST((long)n - (long)old_size);
+
+    return header + 1;
+}
+
+
+/*
+ * release the block _p_, embedded storage is left to its Bignum and
+ * scratch memory to ltm_scratch_release
+ */
+void ltm_xfree(void *p)
+{
+    ltm_block_header *header;
+
+    if (NULL == p) {
+        return;
+    }
+
+    header = LTM_BLOCK_HEADER(p);
+    switch (header->type) {
+        case LTM_BLOCK_EMBEDDED:
+        case LTM_BLOCK_SCRATCH:
+            break;
+        case LTM_BLOCK_POOLED:
+            pool_release(header);
+            break;
+        default:
+            system_release(header);
+            break;
+    }
+}
+
+
+/*
+ * Make sure the scratch arena has _n_ bytes, when nothing is using it.
+ * Called with the estimate of the outermost routine, the ones it calls
+ * find the arena busy and take what they need from it.
+ */
+void ltm_scratch_reserve(size_t n)
+{
+#ifndef LTM_NO_SCRATCH_ARENA
+    char *base;
+
+    if ((0 != scratch_used) || (n <= scratch_size)) {
+        return;
+    }
+
+    scratch_free();
+    if (NULL != (base = (char*)SYSTEM_MALLOC(n))) {
+        thread_register();
+        scratch_base = base;
+        scratch_size = n;
+        SYSTEM_ADJUST((long)n);
+    }
+#endif
+}
+
+
+/*
+ * where the scratch arena is up to, for ltm_scratch_release
+ */
+size_t ltm_scratch_mark(void)
+{
+#ifndef LTM_NO_SCRATCH_ARENA
+    return scratch_used;
+#else
+    return 0;
+#endif
+}
+
+
+/*
+ * _n_ bytes of scratch memory, from the heap if the arena is full
+ */
+void* ltm_scratch_alloc(size_t n)
+{
+#ifndef LTM_NO_SCRATCH_ARENA
+    ltm_block_header *header;
+    size_t need = (sizeof(ltm_block_header) + n + LTM_SCRATCH_ALIGN - 1) & ~((size_t)LTM_SCRATCH_ALIGN - 1);
+
+    if (need <= scratch_size - scratch_used) {
+        header = (ltm_block_header*)(scratch_base + scratch_used);
+        header->size = n;
+        header->type = LTM_BLOCK_SCRATCH;
+        scratch_used += need;
+        return header + 1;
+    }
+#endif
+    return ltm_xmalloc(n);
+}
+
+
+/*
+ * hand back everything allocated from the arena since _mark_, a big
+ * arena is let go of once it is no longer in use
+ */
+void ltm_scratch_release(size_t mark)
+{
+#ifndef LTM_NO_SCRATCH_ARENA
+    scratch_used = mark;
+    if ((0 == scratch_used) && (scratch_size > LTM_SCRATCH_KEEP_BYTES)) {
+        scratch_free();
+    }
+#endif
+}
+
+
+/*
+ * Keeps ruby's GC informed of the memory held in digits, so that big
+ * numbers count towards the next collection like memory from xmalloc
+ * does.
+ */
+void ltm_adjust_memory_usage(long n)
+{
+#ifdef HAVE_RB_GC_ADJUST_MEMORY_USAGE
+    rb_gc_adjust_memory_usage((ssize_t)n);
+#endif
+}
+
+
+/*
+ * is the digit pool handing out memory?
+ */
+int ltm_digit_pool_enabled(void)
+{
+    return pool_enabled;
+}
+
+
+/*
+ * Switch the digit pool on or off.  Switching it off drains the calling
+ * thread's free lists, blocks already out are freed as they come back.
+ * Without the pool compiled in this does nothing.
+ */
+void ltm_digit_pool_enable(int on)
+{
+#ifndef LTM_NO_DIGIT_POOL
+    pool_enabled = on ? 1 : 0;
+    if (!pool_enabled) {
+        pool_drain();
+    }
+#endif
+}
+
+
+/*
+ * copy out the pool counters
+ */
+void ltm_digit_pool_get_stats(ltm_digit_pool_stats *stats)
+{
+    *stats = pool_stats;
+}
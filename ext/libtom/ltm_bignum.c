@@ -34,6 +34,148 @@ VALUE ltm_bignum_random_of_size(VALUE self, VALUE other)
 }
 
 
+/*
+ * How to_bytes and from_bytes lay the bytes out, see there
+ */
+typedef struct {
+    int  order;     /* 1 for the most significant word first, -1 for last */
+    int  endian;    /* 1 for big endian words, -1 for little endian words */
+    long word;      /* bytes in a word                                    */
+    long width;     /* bytes in all, 0 for as few as it takes             */
+    int  is_signed; /* two's complement                                   */
+} ltm_byte_layout;
+
+static int ltm_byte_order(VALUE options, const char *key, int native_ok)
+{
+    VALUE value = rb_hash_aref(options,ID2SYM(rb_intern(key)));
+    ID id;
+    union {
+        unsigned long l;
+        unsigned char c[sizeof(unsigned long)];
+    } u;
+
+    if (Qnil == value) {
+        return 1;
+    }
+    Check_Type(value, T_SYMBOL);
+    id = SYM2ID(value);
+    if (id == rb_intern("big")) {
+        return 1;
+    } else if (id == rb_intern("little")) {
+        return -1;
+    } else if (native_ok && (id == rb_intern("native"))) {
+        u.l = 1;
+        return (u.c[0] == 1) ? -1 : 1;
+    }
+    rb_raise(rb_eArgError, "%s must be :big or :little%s", key,
+        native_ok ? " or :native" : "");
+    return 0;
+}
+
+static void ltm_byte_layout_get(int argc, VALUE *argv, ltm_byte_layout *layout)
+{
+    VALUE options;
+    VALUE value;
+
+    layout->order     = 1;
+    layout->endian    = 1;
+    layout->word      = 1;
+    layout->width     = 0;
+    layout->is_signed = 0;
+
+    if (argc > 0) {
+        options = argv[0];
+        Check_Type(options, T_HASH);
+
+        layout->order  = ltm_byte_order(options,"order",0);
+        layout->endian = ltm_byte_order(options,"endian",1);
+
+        value = rb_hash_aref(options,ID2SYM(rb_intern("word")));
+        if (Qnil != value) {
+            layout->word = NUM2LONG(value);
+            if (layout->word < 1) {
+                rb_raise(rb_eArgError, "word size must be at least 1 byte");
+            }
+        }
+
+        value = rb_hash_aref(options,ID2SYM(rb_intern("width")));
+        if (Qnil != value) {
+            layout->width = NUM2LONG(value);
+            if ((layout->width < 0) || (layout->width % layout->word)) {
+                rb_raise(rb_eArgError, "width must be a multiple of the word size");
+            }
+        }
+
+        value = rb_hash_aref(options,ID2SYM(rb_intern("signed")));
+        layout->is_signed = RTEST(value) ? 1 : 0;
+    }
+}
+
+/*
+ * call-seq:
+ *  LibTom::Math::Bignum.from_bytes(string, options = {}) -> bignum
+ *
+ * Read a Bignum from the bytes in _string_, which are laid out the way
+ * <tt>bignum.to_bytes(options)</tt> writes them; see there for the
+ * options.  The length of _string_ must be a multiple of the word size
+ * and with <tt>:signed => true</tt> the top bit of the most significant
+ * byte is the sign.  This runs in time linear in the length of _string_.
+ */
+VALUE ltm_bignum_from_bytes(int argc, VALUE *argv, VALUE self)
+{
+    VALUE result = ALLOC_LTM_BIGNUM;
+    mp_int *a    = MP_INT(result);
+    mp_int t;
+    ltm_byte_layout layout;
+    VALUE string;
+    const unsigned char *bytes;
+    long len;
+    long top;
+    int mp_result;
+
+    if ((argc < 1) || (argc > 2)) {
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..2)", argc);
+    }
+    string = argv[0];
+    StringValue(string);
+    ltm_byte_layout_get(argc - 1,argv + 1,&layout);
+
+    bytes = (const unsigned char *)RSTRING_PTR(string);
+    len   = RSTRING_LEN(string);
+    if (len % layout.word) {
+        rb_raise(rb_eArgError, "%ld bytes are not a whole number of %ld byte words",
+            len,layout.word);
+    }
+
+    if (MP_OKAY != (mp_result = mp_import(a,(size_t)(len / layout.word),layout.order,
+                    (size_t)layout.word,layout.endian,0,bytes))) {
+        rb_raise(eLT_M_Error, "Failure reading %ld bytes : %s\n",
+            len,mp_error_to_string(mp_result));
+    }
+
+    /* the sign bit is set, so the bytes hold a - 2**(8*len) */
+    if (layout.is_signed && (len > 0)) {
+        top = (layout.order == 1) ? 0 : len - layout.word;
+        top += (layout.endian == 1) ? 0 : layout.word - 1;
+        if (bytes[top] & 0x80) {
+            if (MP_OKAY != (mp_result = mp_init(&t))) {
+                rb_raise(eLT_M_Error, "Failure reading %ld bytes : %s\n",
+                    len,mp_error_to_string(mp_result));
+            }
+            if ((MP_OKAY != (mp_result = mp_2expt(&t,(int)(8 * len)))) ||
+                (MP_OKAY != (mp_result = mp_sub(a,&t,a)))) {
+                mp_clear(&t);
+                rb_raise(eLT_M_Error, "Failure reading %ld bytes : %s\n",
+                    len,mp_error_to_string(mp_result));
+            }
+            mp_clear(&t);
+        }
+    }
+    RB_GC_GUARD(string);
+    return result;
+}
+
+
 
 /**********************************************************************
  *                       Class Instance Methods                       *
@@ -89,7 +231,7 @@ VALUE ltm_bignum_coerce(VALUE self, VALUE other)
 VALUE ltm_bignum_uminus(VALUE self)
 {
     mp_int *a     = MP_INT(self);
-    VALUE b_value = rb_funcall(self,rb_intern("dup"),0);
+    VALUE b_value = ALLOC_LTM_BIGNUM;
     mp_int *b     = MP_INT(b_value);
     int mp_result;
 
@@ -110,7 +252,7 @@ VALUE ltm_bignum_uminus(VALUE self)
 VALUE ltm_bignum_abs(VALUE self)
 {
     mp_int *a     = MP_INT(self);
-    VALUE b_value = rb_funcall(self,rb_intern("dup"),0);
+    VALUE b_value = ALLOC_LTM_BIGNUM;
     mp_int *b     = MP_INT(b_value);
     int mp_result;
 
@@ -122,6 +264,25 @@ VALUE ltm_bignum_abs(VALUE self)
 }
 
 
+/*
+ * c = a + other, c may be a
+ */
+static int ltm_add_into(mp_int *a, VALUE other, mp_int *c)
+{
+    mp_int *b;
+    mp_int b_tmp;
+    mp_digit b_digits[FIXNUM_MP_DIGITS];
+    mp_digit d;
+    int sign;
+
+    /* single digit Fixnums go straight to the digit adder */
+    if (FIXNUM_P(other) && fixnum_to_mp_digit(other,&d,&sign)) {
+        return (MP_ZPOS == sign) ? mp_add_d(a,d,c) : mp_sub_d(a,d,c);
+    }
+    b = NUM2MP_INT_STACK(other,&b_tmp,b_digits);
+    return mp_add(a,b,c);
+}
+
 /*
  * call-seq:
  *   bignum + numeric -> bignum
@@ -132,12 +293,11 @@ VALUE ltm_bignum_abs(VALUE self)
 VALUE ltm_bignum_add(VALUE self, VALUE other)
 {
     mp_int *a    = MP_INT(self);
-    mp_int *b    = NUM2MP_INT(other);
     VALUE result = ALLOC_LTM_BIGNUM;
     mp_int *c    = MP_INT(result);
     int mp_result;
 
-    if (MP_OKAY != (mp_result = mp_add(a,b,c))) {
+    if (MP_OKAY != (mp_result = ltm_add_into(a,other,c))) {
         rb_raise(eLT_M_Error,"Failure to add two Bignums: %s", 
                 mp_error_to_string(mp_result));
     }
@@ -146,6 +306,48 @@ VALUE ltm_bignum_add(VALUE self, VALUE other)
 }
 
 
+/*
+ * call-seq:
+ *   bignum.add!(numeric) -> bignum
+ *
+ * Adds _numeric_ to _bignum_ in place and returns _bignum_.  The digits
+ * of _bignum_ are reused, so nothing is allocated unless the sum needs
+ * more room than _bignum_ already has.
+ */
+VALUE ltm_bignum_add_bang(VALUE self, VALUE other)
+{
+    mp_int *a = MP_INT(self);
+    int mp_result;
+
+    rb_check_frozen(self);
+    if (MP_OKAY != (mp_result = ltm_add_into(a,other,a))) {
+        rb_raise(eLT_M_Error,"Failure to add two Bignums: %s", 
+                mp_error_to_string(mp_result));
+    }
+
+    return self;
+}
+
+
+/*
+ * c = a - other, c may be a
+ */
+static int ltm_subtract_into(mp_int *a, VALUE other, mp_int *c)
+{
+    mp_int *b;
+    mp_int b_tmp;
+    mp_digit b_digits[FIXNUM_MP_DIGITS];
+    mp_digit d;
+    int sign;
+
+    /* single digit Fixnums go straight to the digit subtractor */
+    if (FIXNUM_P(other) && fixnum_to_mp_digit(other,&d,&sign)) {
+        return (MP_ZPOS == sign) ? mp_sub_d(a,d,c) : mp_add_d(a,d,c);
+    }
+    b = NUM2MP_INT_STACK(other,&b_tmp,b_digits);
+    return mp_sub(a,b,c);
+}
+
 /*
  * call-seq:
  *   bignum - numeric -> bignum
@@ -156,12 +358,11 @@ VALUE ltm_bignum_add(VALUE self, VALUE other)
 VALUE ltm_bignum_subtract(VALUE self, VALUE other)
 {
     mp_int *a    = MP_INT(self);
-    mp_int *b    = NUM2MP_INT(other);
     VALUE result = ALLOC_LTM_BIGNUM;
     mp_int *c    = MP_INT(result);
     int mp_result;
 
-    if (MP_OKAY != (mp_result = mp_sub(a,b,c))) {
+    if (MP_OKAY != (mp_result = ltm_subtract_into(a,other,c))) {
         rb_raise(eLT_M_Error,"Failure to subtract two Bignums: %s", 
                 mp_error_to_string(mp_result));
     }
@@ -170,6 +371,27 @@ VALUE ltm_bignum_subtract(VALUE self, VALUE other)
 }
 
 
+/*
+ * call-seq:
+ *   bignum.sub!(numeric) -> bignum
+ *
+ * Subtracts _numeric_ from _bignum_ in place and returns _bignum_.
+ */
+VALUE ltm_bignum_subtract_bang(VALUE self, VALUE other)
+{
+    mp_int *a = MP_INT(self);
+    int mp_result;
+
+    rb_check_frozen(self);
+    if (MP_OKAY != (mp_result = ltm_subtract_into(a,other,a))) {
+        rb_raise(eLT_M_Error,"Failure to subtract two Bignums: %s", 
+                mp_error_to_string(mp_result));
+    }
+
+    return self;
+}
+
+
 /*
  * call-seq:
  *  bignum == numeric -> true, false
@@ -188,8 +410,21 @@ VALUE ltm_bignum_eq(VALUE self, VALUE other)
 {
     mp_int *a = MP_INT(self);
     mp_int *b ;
+    mp_int b_tmp;
+    mp_digit b_digits[FIXNUM_MP_DIGITS];
+    mp_digit digit;
+    int sign;
     double d;
  
+    /* Fixnums are compared without converting to a Bignum */
+    if (FIXNUM_P(other)) {
+        if (fixnum_to_mp_digit(other,&digit,&sign)) {
+            return ((MP_EQ == mp_int_cmp_digit(a,digit,sign)) ? Qtrue : Qfalse);
+        }
+        b = fixnum_to_mp_int(other,&b_tmp,b_digits);
+        return ((MP_EQ == mp_cmp(a,b)) ? Qtrue : Qfalse);
+    }
+
     /* we can only compare to other Numerics */
     if (Qfalse == rb_obj_is_kind_of(other,rb_cNumeric)) { 
         return Qfalse; 
@@ -199,7 +434,7 @@ VALUE ltm_bignum_eq(VALUE self, VALUE other)
      * after the decimal point, we will definitely not equal
      */
     if (TYPE(other) == T_FLOAT) {
-        d = RFLOAT(other)->value;
+        d = RFLOAT_VALUE(other);
         if (floor(d) != d) {
             return Qfalse;
         }
@@ -247,10 +482,6 @@ VALUE ltm_bignum_to_s(int argc, VALUE *argv, VALUE self)
 {
     mp_int *a      = MP_INT(self);
     int radix      = 10;
-    int mp_size    = 0;
-    int mp_result;
-    VALUE result;
-    char *mp_str;
 
     /* converting to a particular base */
     if (argc > 0) {
@@ -262,20 +493,57 @@ VALUE ltm_bignum_to_s(int argc, VALUE *argv, VALUE self)
         rb_raise(rb_eArgError, "radix must be betwen 2 and 64 inclusive");
     }
 
-    /* create a local string then convert it to an RSTRING */
-    if (MP_OKAY != (mp_result = mp_radix_size(a,radix,&mp_size))) {
-        rb_raise(eLT_M_Error, "%s", mp_error_to_string(mp_result));
-    }
+    return mp_int_to_rstring(a,radix);
+}
 
-    mp_str = ALLOC_N(char,mp_size);
-    if (MP_OKAY != (mp_result = mp_toradix(a,mp_str,radix))) {
-        rb_raise(eLT_M_Error, "%s", mp_error_to_string(mp_result));
+
+/*
+ * c = self * other, c may be the mp_int of self
+ */
+static int ltm_multiply_into(VALUE self, VALUE other, mp_int *c)
+{
+    mp_int *a = MP_INT(self);
+    mp_int *b;
+    mp_int b_tmp;
+    mp_digit b_digits[FIXNUM_MP_DIGITS];
+    ltm_operand op;
+    int mp_result;
+
+    if (self == other) {
+        /* x * x is a square */
+        mp_result = mp_sqr(a,c);
+    } else if (LTM_OPERAND_GENERAL != classify_operand(other,&op)) {
+        /* _numeric_ is a power of 2 or a single digit */
+        if (LTM_OPERAND_POW2 == op.kind) {
+            mp_result = mp_mul_2d(a,op.power,c);
+        } else {
+            mp_result = mp_mul_d(a,op.digit,c);
+        }
+        if ((MP_OKAY == mp_result) && (MP_NEG == op.sign)) {
+            mp_neg(c,c);
+        }
+    } else {
+        b = NUM2MP_INT_STACK(other,&b_tmp,b_digits);
+
+        /* multiplication commutes, so _bignum_ may be the cheap one */
+        switch (classify_operand(self,&op)) {
+        case LTM_OPERAND_POW2:
+            mp_result = mp_mul_2d(b,op.power,c);
+            break;
+        case LTM_OPERAND_DIGIT:
+            mp_result = mp_mul_d(b,op.digit,c);
+            break;
+        default:
+            mp_result = mp_mul(a,b,c);
+            break;
+        }
+        if ((MP_OKAY == mp_result) && (LTM_OPERAND_GENERAL != op.kind) && (MP_NEG == op.sign)) {
+            mp_neg(c,c);
+        }
     }
-    result = rb_str_new(mp_str,mp_size-1); 
-    free(mp_str);
-    return result;
-}
 
+    return mp_result;
+}
 
 /*
  * call-seq:
@@ -288,41 +556,37 @@ VALUE ltm_bignum_multiply(VALUE self, VALUE other)
 {
     VALUE result = ALLOC_LTM_BIGNUM;
     mp_int *c    = MP_INT(result);
-    mp_int *a;
     int mp_result;
-    int self_is_2, other_is_2;
 
-    /* first find out if one of the values is a 2 or not.  Then we can use the fast
-     * multiplier
-     */
-    self_is_2 = IS_2(self);
-    other_is_2 = IS_2(other);
-   
-    /* using fast multiplier */
-    if (self_is_2 || other_is_2) {
-        if (self_is_2 && IS_LTM_BIGNUM(other)) {
-            a = MP_INT(other);
-        } else {
-            a = MP_INT(self);
-        }
-        if (MP_OKAY != (mp_result = mp_mul_2(a,c))) {
-            rb_raise(eLT_M_Error,"Failure to multiply Bignums: %s", 
+    if (MP_OKAY != (mp_result = ltm_multiply_into(self,other,c))) {
+        rb_raise(eLT_M_Error,"Failure to multiply Bignums: %s", 
                 mp_error_to_string(mp_result));
-        }
-    } else {
-        /* both of the operands are is not 2, so use the normal multiplier */
-        mp_int *b;
+    }
 
-        a = MP_INT(self);
-        b = NUM2MP_INT(other);
+    return result;
+}
 
-        if (MP_OKAY != (mp_result = mp_mul(a,b,c))) {
-            rb_raise(eLT_M_Error,"Failure to multiply Bignums: %s", 
-                    mp_error_to_string(mp_result));
-        }
+
+/*
+ * call-seq:
+ *  bignum.mul!(numeric) -> bignum
+ *
+ * Multiplies _bignum_ by _numeric_ in place and returns _bignum_.
+ * Single digits, powers of 2 and products below the Karatsuba cutoff
+ * are done in the existing digits of _bignum_.
+ */
+VALUE ltm_bignum_multiply_bang(VALUE self, VALUE other)
+{
+    mp_int *a = MP_INT(self);
+    int mp_result;
+
+    rb_check_frozen(self);
+    if (MP_OKAY != (mp_result = ltm_multiply_into(self,other,a))) {
+        rb_raise(eLT_M_Error,"Failure to multiply Bignums: %s", 
+                mp_error_to_string(mp_result));
     }
 
-    return result;
+    return self;
 }
 
 
@@ -340,30 +604,38 @@ VALUE ltm_bignum_divide(VALUE self, VALUE other)
     mp_int *a    = MP_INT(self);
     VALUE result = ALLOC_LTM_BIGNUM;
     mp_int *c    = MP_INT(result);
+    mp_int *b;
+    mp_int b_tmp;
+    mp_digit b_digits[FIXNUM_MP_DIGITS];
+    ltm_operand op;
     int mp_result;
     
-    /* first find out if b is 2 or not.  Then we can use the fast
-     * divisor
+    /* powers of 2 are a shift, single digits use the digit divisor and
+     * both fix up the sign afterwards
      */
-    if (IS_2(other)) {
-        if (MP_OKAY != (mp_result = mp_div_2(a,c))) {
-            rb_raise(eLT_M_Error,"Failure to divide Bignums: %s", 
-                mp_error_to_string(mp_result));
-        }
-    } else {
-        /* both of the operands are not 2, so use the normal divisor */
-        mp_int *b;
-
-        a = MP_INT(self);
-        b = NUM2MP_INT(other);
+    switch (classify_operand(other,&op)) {
+    case LTM_OPERAND_POW2:
+        mp_result = mp_div_2d(a,op.power,c,NULL);
+        break;
+    case LTM_OPERAND_DIGIT:
+        mp_result = mp_div_d(a,op.digit,c,NULL);
+        break;
+    default:
+        b = NUM2MP_INT_STACK(other,&b_tmp,b_digits);
+        mp_result = mp_div(a,b,c,NULL);
+        break;
+    }
 
-        if (MP_OKAY != (mp_result = mp_div(a,b,c,NULL))) {
-            if (MP_VAL == mp_result) {
-                rb_raise(rb_eZeroDivError,"divide by 0");
-            }
-            rb_raise(eLT_M_Error,"Failure to divide Bignums: %s", 
-                    mp_error_to_string(mp_result));
+    if (MP_OKAY != mp_result) {
+        if (MP_VAL == mp_result) {
+            rb_raise(rb_eZeroDivError,"divide by 0");
         }
+        rb_raise(eLT_M_Error,"Failure to divide Bignums: %s", 
+                mp_error_to_string(mp_result));
+    }
+
+    if ((LTM_OPERAND_GENERAL != op.kind) && (MP_NEG == op.sign)) {
+        mp_neg(c,c);
     }
 
     return result;
@@ -379,12 +651,37 @@ VALUE ltm_bignum_divide(VALUE self, VALUE other)
 VALUE ltm_bignum_remainder(VALUE self, VALUE other)
 {
     mp_int *a    = MP_INT(self);
-    mp_int *b    = NUM2MP_INT(other);
     VALUE result = ALLOC_LTM_BIGNUM;
     mp_int *c    = MP_INT(result);
+    mp_int *b;
+    mp_int b_tmp;
+    mp_digit b_digits[FIXNUM_MP_DIGITS];
+    mp_digit r;
+    ltm_operand op;
     int mp_result;
     
-    if (MP_OKAY != (mp_result = mp_div(a,b,NULL,c))) {
+    /* the remainder takes the sign of _bignum_, which mp_mod_2d keeps
+     * and which has to be put back on the result of mp_mod_d
+     */
+    switch (classify_operand(other,&op)) {
+    case LTM_OPERAND_POW2:
+        mp_result = mp_mod_2d(a,op.power,c);
+        break;
+    case LTM_OPERAND_DIGIT:
+        if (MP_OKAY == (mp_result = mp_mod_d(a,op.digit,&r))) {
+            mp_set(c,r);
+            if (MP_NEG == SIGN(a)) {
+                mp_neg(c,c);
+            }
+        }
+        break;
+    default:
+        b = NUM2MP_INT_STACK(other,&b_tmp,b_digits);
+        mp_result = mp_div(a,b,NULL,c);
+        break;
+    }
+
+    if (MP_OKAY != mp_result) {
         if (MP_VAL == mp_result) {
             rb_raise(rb_eZeroDivError,"divide by 0");
         }
@@ -396,6 +693,53 @@ VALUE ltm_bignum_remainder(VALUE self, VALUE other)
 }
 
 
+/*
+ * c = a mod other, c may be a
+ */
+static int ltm_modulo_into(mp_int *a, VALUE other, mp_int *c)
+{
+    mp_int *b;
+    mp_int b_tmp;
+    mp_digit b_digits[FIXNUM_MP_DIGITS];
+    mp_digit r;
+    ltm_operand op;
+    int a_sign = SIGN(a);
+    int mp_result;
+
+    /* a non zero remainder whose sign differs from the divisor is moved
+     * over to the divisor's side of zero
+     */
+    switch (classify_operand(other,&op)) {
+    case LTM_OPERAND_POW2:
+        mp_result = mp_mod_2d(a,op.power,c);
+        if ((MP_OKAY == mp_result) && !mp_iszero(c) && (SIGN(c) != op.sign)) {
+            b = NUM2MP_INT_STACK(other,&b_tmp,b_digits);
+            mp_result = mp_add(c,b,c);
+        }
+        break;
+    case LTM_OPERAND_DIGIT:
+        if (MP_OKAY == (mp_result = mp_mod_d(a,op.digit,&r))) {
+            if ((0 != r) && (a_sign != op.sign)) {
+                r = op.digit - r;
+            }
+            mp_set(c,r);
+            if (MP_NEG == op.sign) {
+                mp_neg(c,c);
+            }
+        }
+        break;
+    default:
+        b = NUM2MP_INT_STACK(other,&b_tmp,b_digits);
+        mp_result = mp_div(a,b,NULL,c);
+        if ((MP_OKAY == mp_result) && !mp_iszero(c) && (SIGN(c) != SIGN(b))) {
+            mp_result = mp_add(c,b,c);
+        }
+        break;
+    }
+
+    return mp_result;
+}
+
 /*
  * call-seq:
  *   bignum % numeric -> bignum
@@ -407,12 +751,11 @@ VALUE ltm_bignum_remainder(VALUE self, VALUE other)
 VALUE ltm_bignum_modulo(VALUE self, VALUE other)
 {
     mp_int *a    = MP_INT(self);
-    mp_int *b    = NUM2MP_INT(other);
     VALUE result = ALLOC_LTM_BIGNUM;
     mp_int *c    = MP_INT(result);
     int mp_result;
 
-    if (MP_OKAY != (mp_result = mp_mod(a,b,c))) {
+    if (MP_OKAY != (mp_result = ltm_modulo_into(a,other,c))) {
         if (MP_VAL == mp_result) {
             rb_raise(rb_eZeroDivError,"divide by 0");
         }
@@ -423,17 +766,50 @@ VALUE ltm_bignum_modulo(VALUE self, VALUE other)
     return result;
 }
 
+
+/*
+ * call-seq:
+ *   bignum.mod!(numeric) -> bignum
+ *
+ * Replaces _bignum_ with _bignum_ modulo _numeric_ and returns it.
+ * Single digit and power of 2 moduli are done without allocating.
+ *
+ *  acc.mul!(x).mod!(m)     # acc = acc * x % m
+ */
+VALUE ltm_bignum_modulo_bang(VALUE self, VALUE other)
+{
+    mp_int *a = MP_INT(self);
+    int mp_result;
+
+    rb_check_frozen(self);
+    if (MP_OKAY != (mp_result = ltm_modulo_into(a,other,a))) {
+        if (MP_VAL == mp_result) {
+            rb_raise(rb_eZeroDivError,"divide by 0");
+        }
+        rb_raise(eLT_M_Error,"Failure to modulo Bignum: %s", 
+                mp_error_to_string(mp_result));
+    }
+
+    return self;
+}
+
 /*
  * call-seq:
  *   bignum.divmod(numeric) => [ quotient, modulus ]
  *
  * Divides _bignum_ by _numeric_ and returns an array containing the
- * +quotient+ and the +modulus+.
+ * +quotient+ and the +modulus+.  Both come out of a single division and
+ * are floored like Integer#divmod, so the modulus has the sign of
+ * _numeric_ and <tt>quotient * numeric + modulus == bignum</tt>.
  */
 VALUE ltm_bignum_divmod(VALUE self, VALUE other)
 {
     mp_int *a = MP_INT(self);
-    mp_int *b = NUM2MP_INT(other);
+    mp_int *b;
+    mp_int b_tmp;
+    mp_digit b_digits[FIXNUM_MP_DIGITS];
+    mp_digit r;
+    ltm_operand op;
     int mp_result;
 
     VALUE div = ALLOC_LTM_BIGNUM;
@@ -442,9 +818,27 @@ VALUE ltm_bignum_divmod(VALUE self, VALUE other)
     mp_int *m_div= MP_INT(div);
     mp_int *m_mod = MP_INT(mod);
 
+    /* the quotient and remainder both come out truncated first */
+    switch (classify_operand(other,&op)) {
+    case LTM_OPERAND_POW2:
+        mp_result = mp_div_2d(a,op.power,m_div,m_mod);
+        break;
+    case LTM_OPERAND_DIGIT:
+        if (MP_OKAY == (mp_result = mp_div_d(a,op.digit,m_div,&r))) {
+            mp_set(m_mod,r);
+            if (MP_NEG == SIGN(a)) {
+                mp_neg(m_mod,m_mod);
+            }
+        }
+        break;
+    default:
+        b = NUM2MP_INT_STACK(other,&b_tmp,b_digits);
+        op.sign = SIGN(b);
+        mp_result = mp_div(a,b,m_div,m_mod);
+        break;
+    }
 
-    /* calc div */
-    if (MP_OKAY != (mp_result = mp_div(a,b,m_div,NULL))) {
+    if (MP_OKAY != mp_result) {
         if (MP_VAL == mp_result) {
             rb_raise(rb_eZeroDivError,"divide by 0");
         }
@@ -452,12 +846,24 @@ VALUE ltm_bignum_divmod(VALUE self, VALUE other)
                 mp_error_to_string(mp_result));
     }
 
+    if ((LTM_OPERAND_GENERAL != op.kind) && (MP_NEG == op.sign)) {
+        mp_neg(m_div,m_div);
+    }
 
-    /* calc mod */
-    if (MP_OKAY != (mp_result = mp_mod(a,b,m_mod))) {
-        if (MP_VAL == mp_result) {
-            rb_raise(rb_eZeroDivError,"divide by 0");
+    /* then they are floored: a remainder on the other side of zero from
+     * the divisor moves over to its side and the quotient drops by one,
+     * so that quotient * numeric + modulus is still bignum
+     */
+    if (!mp_iszero(m_mod) && (SIGN(m_mod) != op.sign)) {
+        if (LTM_OPERAND_GENERAL != op.kind) {
+            b = NUM2MP_INT_STACK(other,&b_tmp,b_digits);
+        }
+        if (MP_OKAY == (mp_result = mp_add(m_mod,b,m_mod))) {
+            mp_result = mp_sub_d(m_div,1,m_div);
         }
+    }
+
+    if (MP_OKAY != mp_result) {
         rb_raise(eLT_M_Error,"Failure to divmod Bignum: %s", 
                 mp_error_to_string(mp_result));
     }
@@ -465,6 +871,51 @@ VALUE ltm_bignum_divmod(VALUE self, VALUE other)
     return rb_ary_new3(2,div,mod);
 }
 
+
+/*
+ * call-seq:
+ *   bignum.divexact(numeric) -> bignum
+ *
+ * Divides _bignum_ by _numeric_ when _numeric_ is known to divide
+ * _bignum_ exactly, which is quite a bit faster than a general
+ * division.  The result is meaningless if there is a remainder.
+ */
+VALUE ltm_bignum_divexact(VALUE self, VALUE other)
+{
+    mp_int *a    = MP_INT(self);
+    VALUE result = ALLOC_LTM_BIGNUM;
+    mp_int *c    = MP_INT(result);
+    mp_int *b;
+    mp_int b_tmp;
+    mp_digit b_digits[FIXNUM_MP_DIGITS];
+    ltm_operand op;
+    int mp_result;
+
+    /* the remainder is zero by contract so a power of 2 is just a shift */
+    switch (classify_operand(other,&op)) {
+    case LTM_OPERAND_POW2:
+        mp_result = mp_div_2d(a,op.power,c,NULL);
+        if (MP_NEG == op.sign) {
+            mp_neg(c,c);
+        }
+        break;
+    default:
+        b = NUM2MP_INT_STACK(other,&b_tmp,b_digits);
+        mp_result = mp_divexact(a,b,c);
+        break;
+    }
+
+    if (MP_OKAY != mp_result) {
+        if (MP_VAL == mp_result) {
+            rb_raise(rb_eZeroDivError,"divide by 0");
+        }
+        rb_raise(eLT_M_Error,"Failure to divide Bignums: %s", 
+                mp_error_to_string(mp_result));
+    }
+
+    return result;
+}
+
 /*
  * call-seq:
  *  bignum.size -> int
@@ -496,27 +947,11 @@ VALUE ltm_bignum_to_f(VALUE self)
 
     VALUE tmp_float;
     VALUE tmp_string;
-    int mp_result;
-    int mp_size;
-    char *mp_str;
 
     /* do an endrun around the issue, convert ourselves to a string and
      * then convert the string to a float
      */
-    if (MP_OKAY != (mp_result = mp_radix_size(a,10,&mp_size))) {
-        rb_raise(eLT_M_Error, "Unable to convert Bignum to Float: %s", 
-                mp_error_to_string(mp_result));
-    }
-
-    mp_str = ALLOC_N(char,mp_size);
-
-    if (MP_OKAY != (mp_result = mp_toradix(a,mp_str,10))) {
-        rb_raise(eLT_M_Error, "Unable to convert Bignum to Float: %s", 
-                mp_error_to_string(mp_result));
-    }
-
-    tmp_string = rb_str_new2(mp_str); 
-    free(mp_str);
+    tmp_string = mp_int_to_rstring(a,10);
 
     /* convert the new ruby string into a float then convert that to a float  */
     tmp_float =  rb_funcall(tmp_string,rb_intern("to_f"),0);
@@ -525,6 +960,115 @@ VALUE ltm_bignum_to_f(VALUE self)
     return rb_float_new(f);
 }
 
+/*
+ * call-seq:
+ *  bignum.to_i -> integer
+ *
+ * Returns the value of _bignum_ as a ruby *Integer*.  The digits are
+ * copied over directly, no decimal string is involved.
+ */
+VALUE ltm_bignum_to_i(VALUE self)
+{
+    return mp_int_to_integer(MP_INT(self));
+}
+
+
+/*
+ * call-seq:
+ *  bignum.to_bytes(options = {}) -> string
+ *
+ * Returns _bignum_ as a binary string, written straight from its digits
+ * in time linear in its size.  The options are
+ *
+ * <tt>:word</tt>::   bytes in a word, 1 by default
+ * <tt>:order</tt>::  <tt>:big</tt> (the default) puts the most
+ *                    significant word first, <tt>:little</tt> last
+ * <tt>:endian</tt>:: the bytes within a word, <tt>:big</tt> (the
+ *                    default), <tt>:little</tt> or <tt>:native</tt>
+ * <tt>:signed</tt>:: two's complement, which negative values need
+ * <tt>:width</tt>::  total bytes, a multiple of <tt>:word</tt>; the value
+ *                    is padded out to it and RangeError is raised if it
+ *                    does not fit
+ *
+ * Without a <tt>:width</tt> the string is as few words as hold the
+ * value, and its sign bit if <tt>:signed</tt>, but at least one word.
+ * <tt>LibTom::Math::Bignum.from_bytes</tt> reads it back.
+ */
+VALUE ltm_bignum_to_bytes(int argc, VALUE *argv, VALUE self)
+{
+    mp_int *a = MP_INT(self);
+    mp_int t;
+    mp_int *out = a;
+    ltm_byte_layout layout;
+    VALUE result;
+    unsigned char *bytes;
+    size_t count;
+    long bits;
+    long len;
+    int mp_result;
+
+    if (argc > 1) {
+        rb_raise(rb_eArgError, "wrong number of arguments (%d for 0..1)", argc);
+    }
+    ltm_byte_layout_get(argc,argv,&layout);
+
+    /* the bits the value takes, and a sign bit if signed; a negative
+     * power of two needs none on top of its magnitude
+     */
+    bits = mp_count_bits(a);
+    if (layout.is_signed) {
+        if (!((MP_NEG == a->sign) && (mp_cnt_lsb(a) == bits - 1))) {
+            bits += 1;
+        }
+    } else if (MP_NEG == a->sign) {
+        rb_raise(rb_eRangeError, "can't write a negative Bignum as unsigned bytes");
+    }
+
+    len = (bits + 8 * layout.word - 1) / (8 * layout.word);
+    len = ((len > 0) ? len : 1) * layout.word;
+    if (0 == layout.width) {
+        layout.width = len;
+    } else if (len > layout.width) {
+        rb_raise(rb_eRangeError, "Bignum too big for %ld bytes", layout.width);
+    }
+
+    /* negative values are written as 2**(8*width) - |a| */
+    if (MP_NEG == a->sign) {
+        if (MP_OKAY != (mp_result = mp_init(&t))) {
+            rb_raise(eLT_M_Error, "Failure writing bytes : %s\n",
+                mp_error_to_string(mp_result));
+        }
+        if ((MP_OKAY != (mp_result = mp_2expt(&t,(int)(8 * layout.width)))) ||
+            (MP_OKAY != (mp_result = mp_add(&t,a,&t)))) {
+            mp_clear(&t);
+            rb_raise(eLT_M_Error, "Failure writing bytes : %s\n",
+                mp_error_to_string(mp_result));
+        }
+        out = &t;
+    }
+
+    /* words the value does not fill are zero, in front of it for big
+     * word order and behind it for little
+     */
+    result = rb_str_new(NULL,layout.width);
+    bytes  = (unsigned char *)RSTRING_PTR(result);
+    memset(bytes,0,layout.width);
+    count  = (mp_count_bits(out) + 8 * layout.word - 1) / (8 * layout.word);
+    if (1 == layout.order) {
+        bytes += layout.width - (long)count * layout.word;
+    }
+    mp_result = mp_export(bytes,NULL,layout.order,(size_t)layout.word,layout.endian,0,out);
+    if (out == &t) {
+        mp_clear(&t);
+    }
+    if (MP_OKAY != mp_result) {
+        rb_raise(eLT_M_Error, "Failure writing bytes : %s\n",
+            mp_error_to_string(mp_result));
+    }
+    return result;
+}
+
+
 /*
  * call-seq:
  *  bignum <=> numeric -> -1,0,1
@@ -536,9 +1080,21 @@ VALUE ltm_bignum_to_f(VALUE self)
 VALUE ltm_bignum_spaceship(VALUE self, VALUE other)
 {
     mp_int *a = MP_INT(self);
-    mp_int *b = NUM2MP_INT(other);
+    mp_int *b;
+    mp_int b_tmp;
+    mp_digit b_digits[FIXNUM_MP_DIGITS];
+    mp_digit d;
+    int sign;
+    int cmp;
+
+    if (FIXNUM_P(other) && fixnum_to_mp_digit(other,&d,&sign)) {
+        cmp = mp_int_cmp_digit(a,d,sign);
+    } else {
+        b   = NUM2MP_INT_STACK(other,&b_tmp,b_digits);
+        cmp = mp_cmp(a,b);
+    }
 
-    switch (mp_cmp(a,b)) {
+    switch (cmp) {
         case MP_LT:
             return INT2FIX(-1);
             break;
@@ -813,6 +1369,49 @@ VALUE ltm_bignum_rshift_bits(VALUE self, VALUE other)
     return result;
 }
 
+/*
+ * call-seq:
+ *  bignum.shl!(N) -> bignum
+ *
+ * Left shifts _bignum_ by _N_ bits in place and returns _bignum_.
+ */
+VALUE ltm_bignum_lshift_bits_bang(VALUE self, VALUE other)
+{
+    mp_int *a = MP_INT(self);
+    unsigned long shift_width = NUM2ULONG(other);
+    int mp_result;
+
+    rb_check_frozen(self);
+    if (MP_OKAY != (mp_result = mp_mul_2d(a,shift_width,a))) {
+        rb_raise(eLT_M_Error, "Failure left shift of %lu bits Bignum: %s", 
+            shift_width,mp_error_to_string(mp_result));
+    }
+
+    return self;
+}
+
+
+/*
+ * call-seq:
+ *  bignum.shr!(N) -> bignum
+ *
+ * Right shifts _bignum_ by _N_ bits in place and returns _bignum_.
+ */
+VALUE ltm_bignum_rshift_bits_bang(VALUE self, VALUE other)
+{
+    mp_int *a = MP_INT(self);
+    unsigned long shift_width = NUM2ULONG(other);
+    int mp_result;
+
+    rb_check_frozen(self);
+    if (MP_OKAY != (mp_result = mp_div_2d(a,shift_width,a,NULL))) {
+        rb_raise(eLT_M_Error, "Failure right shift of %lu bits Bignum: %s", 
+            shift_width,mp_error_to_string(mp_result));
+    }
+
+    return self;
+}
+
 /*
  * call-seq:
  *  ~bignum -> raises NotImplementedError
@@ -851,6 +1450,37 @@ VALUE ltm_bignum_num_bits(VALUE self)
 }
 
 
+/*
+ * call-seq:
+ *  bignum.num_digits(radix = 10) -> int
+ *
+ * Return the number of digits of _bignum_ in base _radix_, without the
+ * sign, which is <tt>abs.to_s(radix).size</tt> without the conversion.
+ * The count comes from the number of bits and is only checked against
+ * a power of _radix_ where that leaves two possibilities.
+ */
+VALUE ltm_bignum_num_digits(int argc, VALUE *argv, VALUE self)
+{
+    mp_int *a = MP_INT(self);
+    int radix = 10;
+    int mp_size,mp_result;
+
+    if (argc > 0) {
+        radix = NUM2INT(argv[0]);
+    }
+    if ((radix < 2) || (radix > 64)) {
+        rb_raise(rb_eArgError, "radix must be betwen 2 and 64 inclusive");
+    }
+
+    if (MP_OKAY != (mp_result = mp_radix_size(a,radix,&mp_size))) {
+        rb_raise(eLT_M_Error, "%s", mp_error_to_string(mp_result));
+    }
+
+    /* less the NULL byte and the sign */
+    return INT2FIX(mp_size - 1 - ((MP_NEG == SIGN(a)) ? 1 : 0));
+}
+
+
 /*
  * call-seq:
  *  bignum.right_shift_digits(n) -> bignum
@@ -932,6 +1562,26 @@ VALUE ltm_bignum_squared(VALUE self)
 }
 
 
+/*
+ * call-seq:
+ *  bignum.sqr! -> bignum
+ *
+ * Squares _bignum_ in place and returns _bignum_.
+ */
+VALUE ltm_bignum_squared_bang(VALUE self)
+{
+    mp_int *a = MP_INT(self);
+    int mp_result ;
+
+    rb_check_frozen(self);
+    if (MP_OKAY != (mp_result = mp_sqr(a,a))) {
+        rb_raise(eLT_M_Error, "Failure squaring Bignum : %s\n",
+            mp_error_to_string(mp_result));
+    }
+    return self;
+}
+
+
 /*
  * call-seq:
  *  bignum.mod_2n(n) -> bignum
@@ -1071,26 +1721,64 @@ VALUE ltm_bignum_inverse_modulus(VALUE self, VALUE p1)
 }
 
 
+/*
+ * operands of exponent_modulus while the GVL is released
+ */
+typedef struct {
+    mp_int *a;
+    mp_int *b;
+    mp_int *c;
+    mp_int *d;
+} ltm_exptmod_args;
+
+static int ltm_exptmod_without_gvl(void *data, volatile int *interrupted)
+{
+    ltm_exptmod_args *args = (ltm_exptmod_args*)data;
+
+    return mp_exptmod(args->a,args->b,args->c,args->d);
+}
+
 /*
  * call-seq:
  *  bignum.exponent_modulus(numeric1,numeric2) -> bignum
  *
  * Returns (_bignum_ ** _numeric1_) mod _numeric2_
+ *
+ * Other ruby threads keep running while large values are worked on.
  */
 VALUE ltm_bignum_exponent_modulus(VALUE self, VALUE p1, VALUE p2)
 {
-    mp_int *a    = MP_INT(self);
-    mp_int *b    = NUM2MP_INT(p1);
-    mp_int *c    = NUM2MP_INT(p2);
-    VALUE result = ALLOC_LTM_BIGNUM;
-    mp_int *d    = MP_INT(result);
+    VALUE b_value = NUM2LTM_BIGNUM(p1);
+    VALUE c_value = NUM2LTM_BIGNUM(p2);
+    ltm_exptmod_args args;
+    mp_int **operands[3];
+    mp_int d;
     int mp_result;
-    
-    if (MP_OKAY != (mp_result = mp_exptmod(a,b,c,d))) {
+
+    if (MP_OKAY != (mp_result = mp_init(&d))) {
         rb_raise(eLT_M_Error, "Failure calculating exponent_modulus: %s\n",
             mp_error_to_string(mp_result));
     }
-    return result;
+
+    args.a = MP_INT(self);
+    args.b = MP_INT(b_value);
+    args.c = MP_INT(c_value);
+    args.d = &d;
+    operands[0] = &args.a;
+    operands[1] = &args.b;
+    operands[2] = &args.c;
+
+    mp_result = ltm_without_gvl(ltm_exptmod_without_gvl,&args,operands,3,&d,mp_count_bits(args.c));
+    RB_GC_GUARD(self);
+    RB_GC_GUARD(b_value);
+    RB_GC_GUARD(c_value);
+
+    if (MP_OKAY != mp_result) {
+        mp_clear(&d);
+        rb_raise(eLT_M_Error, "Failure calculating exponent_modulus: %s\n",
+            mp_error_to_string(mp_result));
+    }
+    return ltm_bignum_from_mp_int(&d);
 }
 
 
@@ -1368,6 +2056,22 @@ VALUE ltm_bignum_passes_miller_rabin(VALUE self,VALUE p1)
 }
 
 
+/*
+ * operands of is_prime? while the GVL is released
+ */
+typedef struct {
+    mp_int *a;
+    int t;
+    int passed;
+} ltm_is_prime_args;
+
+static int ltm_is_prime_without_gvl(void *data, volatile int *interrupted)
+{
+    ltm_is_prime_args *args = (ltm_is_prime_args*)data;
+
+    return ltm_prime_is_prime(args->a,args->t,&args->passed,interrupted);
+}
+
 /*
  * call-seq:
  *  bignum.is_prime?( trials = default ) -> true, false
@@ -1375,18 +2079,20 @@ VALUE ltm_bignum_passes_miller_rabin(VALUE self,VALUE p1)
  * Tests to see if _bignum_ is prime by doing a trial division
  * (is_divisible_by_some_primes?) followed by _trials_ rounds of
  * Miller-Rabin tests.  By default, _trials_ is the value returned from
- * num_miller_rabin_trails(bignum.num_bits).
+ * num_miller_rabin_trails(bignum.num_bits).  Other ruby threads keep
+ * running while large values are tested.
  */
 VALUE ltm_bignum_is_prime(int argc, VALUE* argv, VALUE self)
 {
     mp_int *a    = MP_INT(self);
+    ltm_is_prime_args args;
+    mp_int **operands[1];
     int t;       
     int num_bits;
-    int passed;
     int mp_result;
 
+    num_bits = mp_count_bits(a);
     if (argc == 0) {
-        num_bits = mp_count_bits(a);
         t = mp_prime_rabin_miller_trials(num_bits);
     } else {
         t = FIX2INT(argv[0]);
@@ -1400,12 +2106,82 @@ VALUE ltm_bignum_is_prime(int argc, VALUE* argv, VALUE self)
         rb_raise(rb_eArgError,"Number of Miller-Rabin trials must be > 0 and < %d\n",PRIME_SIZE);
     }
 
-    if (MP_OKAY != (mp_result = mp_prime_is_prime(a,t,&passed))) {
+    args.a      = a;
+    args.t      = t;
+    args.passed = 0;
+    operands[0] = &args.a;
+
+    mp_result = ltm_without_gvl(ltm_is_prime_without_gvl,&args,operands,1,NULL,num_bits);
+    RB_GC_GUARD(self);
+
+    if (MP_OKAY != mp_result) {
         rb_raise(eLT_M_Error, "Failure testing for primality : %s\n",
             mp_error_to_string(mp_result));
     }
   
-    return (passed == 0) ? Qfalse : Qtrue; 
+    return (args.passed == 0) ? Qfalse : Qtrue; 
+}
+
+
+/*
+ * operands of next_prime while the GVL is released
+ */
+typedef struct {
+    mp_int *a;
+    mp_int *b;
+    int trials;
+    int congruency;
+} ltm_next_prime_args;
+
+/*
+ * Same search as mp_prime_next_prime, but each candidate goes through
+ * ltm_prime_is_prime so a search over large numbers can be interrupted.
+ * Below the end of the prime table the table lookup in
+ * mp_prime_next_prime is used as is.
+ */
+static int ltm_next_prime_without_gvl(void *data, volatile int *interrupted)
+{
+    ltm_next_prime_args *args = (ltm_next_prime_args*)data;
+    mp_int *b = args->b;
+    mp_digit step;
+    int passed = 0;
+    int mp_result;
+
+    /* next_prime operates in place, so start from a fresh copy of a */
+    if (MP_OKAY != (mp_result = mp_copy(args->a,b))) {
+        return mp_result;
+    }
+    b->sign = MP_ZPOS;
+
+    if ((args->trials <= 0) || (args->trials > PRIME_SIZE) ||
+        (MP_LT == mp_cmp_d(b,ltm_prime_tab[PRIME_SIZE-1]))) {
+        return mp_prime_next_prime(b,args->trials,args->congruency);
+    }
+
+    /* back up to an odd number, or one congruent to 3 mod 4, so that
+     * stepping forward from it lands on the candidates
+     */
+    if (args->congruency) {
+        step = 4;
+        if (3 != (b->dp[0] & 3)) {
+            mp_result = mp_sub_d(b,(b->dp[0] & 3) + 1,b);
+        }
+    } else {
+        step = 2;
+        if (mp_iseven(b)) {
+            mp_result = mp_sub_d(b,1,b);
+        }
+    }
+
+    while ((MP_OKAY == mp_result) && !passed) {
+        if (*interrupted) {
+            return LTM_INTERRUPTED;
+        }
+        if (MP_OKAY == (mp_result = mp_add_d(b,step,b))) {
+            mp_result = ltm_prime_is_prime(b,args->trials,&passed,interrupted);
+        }
+    }
+    return mp_result;
 }
 
 
@@ -1424,12 +2200,15 @@ VALUE ltm_bignum_is_prime(int argc, VALUE* argv, VALUE self)
  * <b><tt>:congruency</tt></b>::    +true+ or +false+.  Should the prime
  *                                  returned be congruent to 3 mod 4.
  *                                  The default is +false+.
+ *
+ * Other ruby threads keep running while large values are searched.
  */
 VALUE ltm_bignum_next_prime(int argc, VALUE* argv, VALUE self)
 {
     mp_int *a    = MP_INT(self);
-    VALUE result = ALLOC_LTM_BIGNUM;
-    mp_int *b    = MP_INT(result);
+    ltm_next_prime_args args;
+    mp_int **operands[1];
+    mp_int b;
 
     VALUE options;
     int num_bits;
@@ -1474,20 +2253,28 @@ VALUE ltm_bignum_next_prime(int argc, VALUE* argv, VALUE self)
         rb_raise(rb_eArgError,"Congruency must be true or false\n");
     }
 
-    /* options checked, now find a prime, first we have to copy over a
-     * since next_prime operates in place
-     */
-    if (MP_OKAY != (mp_result = mp_copy(a,b))) {
+    /* options checked, now find a prime */
+    if (MP_OKAY != (mp_result = mp_init(&b))) {
             rb_raise(eLT_M_Error, "Failure to find next prime: %s", 
                 mp_error_to_string(mp_result));
     }
 
-    if (MP_OKAY != (mp_result = mp_prime_next_prime(b,trials,congruency))) {
+    args.a          = a;
+    args.b          = &b;
+    args.trials     = trials;
+    args.congruency = congruency;
+    operands[0]     = &args.a;
+
+    mp_result = ltm_without_gvl(ltm_next_prime_without_gvl,&args,operands,1,&b,mp_count_bits(a));
+    RB_GC_GUARD(self);
+
+    if (MP_OKAY != mp_result) {
+            mp_clear(&b);
             rb_raise(eLT_M_Error, "Failure to find next prime: %s", 
                 mp_error_to_string(mp_result));
     }
 
-    return result;
+    return ltm_bignum_from_mp_int(&b);
 }
 
 
@@ -1510,9 +2297,8 @@ VALUE ltm_bignum_initialize(int argc, VALUE *argv, VALUE self)
     mp_int *orig;
     VALUE arg;
     VALUE arg2;
-    VALUE arg_tmp;
-    unsigned long from_val = 0L;
-    long signed_val = 0;
+    mp_int fix;
+    mp_digit fix_digits[FIXNUM_MP_DIGITS];
     int radix = 10;
     int mp_result = 0;
 
@@ -1533,30 +2319,19 @@ VALUE ltm_bignum_initialize(int argc, VALUE *argv, VALUE self)
     /* If we are not a Bignum then convert */
     if (!IS_LTM_BIGNUM(arg)) {
 
-        /* first pass, everything is converted to a ::Bignum or an integer */
+        /* first pass, everything is converted to a ::Bignum, a Fixnum or
+         * a String
+         */
         switch (TYPE(arg)) {
         case T_FIXNUM:
+        case T_BIGNUM:
         case T_STRING:
-            /* fixnums and strings are okay, they fall through to the 2nd pass */
+            /* integers and strings are okay, they fall through to the 2nd pass */
             arg2 = arg;
             break;
         case T_FLOAT:
-            /* Just call .to_i on the float and then to_s if it was converted
-             * to a ::Bignum
-             */
-            arg_tmp = rb_funcall(arg,rb_intern("to_i"),0);
-            if (TYPE(arg_tmp) == T_BIGNUM) {
-                arg2 = rb_funcall(arg_tmp,rb_intern("to_s"),0);
-            } else {
-                arg2 = arg_tmp;
-            }
-            break;
-
-        case T_BIGNUM:
-            /* bignums get converted to strings which we will read in on the
-             * 2nd pass
-             */
-            arg2 = rb_funcall(arg,rb_intern("to_s"),0);
+            /* Just call .to_i on the float, that gives a Fixnum or a ::Bignum */
+            arg2 = rb_funcall(arg,rb_intern("to_i"),0);
             break;
         default:
             /* If it is a descendant of Numeric try and convert it */
@@ -1569,27 +2344,29 @@ VALUE ltm_bignum_initialize(int argc, VALUE *argv, VALUE self)
 
         }
 
-        /* second pass, everything is either a T_STRING or a T_FIXNUM */
-        Data_Get_Struct(self,mp_int,bn);
+        /* second pass, everything is either a T_STRING, T_BIGNUM or a T_FIXNUM */
+        LTM_GET_STRUCT(self,bn);
         switch (TYPE(arg2)) {
         case T_FIXNUM:
-            /* if arg2 is Fixnum then we convert to a ulong and then set the sign
-             * as appropriate
+            /* if arg2 is Fixnum then split it into digits on the stack
+             * and copy those in, mp_set_int only handles 32 bits
              */
-            signed_val = NUM2LONG(arg2);
-            from_val   = (signed_val < 0) ? (-signed_val) : (signed_val);
-            if (MP_OKAY != (mp_result = mp_init_set_int(bn,(unsigned long)from_val))) {
+            fixnum_to_mp_int(arg2,&fix,fix_digits);
+            if (MP_OKAY != (mp_result = mp_copy(&fix,bn))) {
                 rb_raise(eLT_M_Error, "%s", mp_error_to_string(mp_result));
             }
-            if (signed_val < 0) {
-                mp_neg(bn,bn);
+            break;
+        case T_BIGNUM:
+            /* ::Bignums have their digits copied over directly */
+            if (MP_OKAY != (mp_result = integer_to_mp_int(arg2,bn))) {
+                rb_raise(eLT_M_Error, "%s", mp_error_to_string(mp_result));
             }
             break;
         case T_STRING:
             /* if arg is a string then assume that it is a number and
              * convert it as such
              */
-            if (MP_OKAY != (mp_result = mp_read_radix(bn,RSTRING(arg2)->ptr,radix))) {
+            if (MP_OKAY != (mp_result = mp_read_radix(bn,RSTRING_PTR(arg2),radix))) {
                 rb_raise(eLT_M_Error, "%s", mp_error_to_string(mp_result));
             }
             break;
@@ -1599,9 +2376,9 @@ VALUE ltm_bignum_initialize(int argc, VALUE *argv, VALUE self)
         }
     } else {
         /* we are initializing from a Bignum so copy */
-        Data_Get_Struct(self,mp_int,bn);
+        LTM_GET_STRUCT(self,bn);
         orig = MP_INT(arg);
-        if (MP_OKAY != (mp_result = mp_init_copy(bn,orig))) {
+        if (MP_OKAY != (mp_result = mp_copy(orig,bn))) {
             rb_raise(eLT_M_Error, "%s", mp_error_to_string(mp_result));
         }
     }
@@ -1625,8 +2402,10 @@ VALUE ltm_bignum_initialize_copy(VALUE copy, VALUE orig)
     m_orig = MP_INT(orig);
     m_copy = MP_INT(copy);
 
-    /* copy the internals using the mp_init_copy method to copy a bignum */
-    if (MP_OKAY != (mp_result = mp_init_copy(m_copy,m_orig))) {
+    /* the copy was already initialized by the allocator, so copy the
+     * internals over the top of it
+     */
+    if (MP_OKAY != (mp_result = mp_copy(m_orig,m_copy))) {
         rb_raise(eLT_M_Error, "%s", mp_error_to_string(mp_result));
     }
 
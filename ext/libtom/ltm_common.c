@@ -7,13 +7,13 @@
 #if LTM_DEBUG
 /*
  *   This is only used in debugging.  The memory allocated by this
- *   method must be free()'d by the caller.
+ *   method must be xfree()'d by the caller.
  */
 char * mp_int_to_s(mp_int *a)
 {   
     int mp_size,mp_result;
     char *mp_str;
-    if (MP_OKAY != (mp_result = mp_radix_size(a,10,&mp_size))) {
+    if (MP_OKAY != (mp_result = mp_radix_size_overestimate(a,10,&mp_size))) {
         rb_raise(eLT_M_Error, "%s", mp_error_to_string(mp_result));
     }
 
@@ -33,16 +33,26 @@ char * mp_int_to_s(mp_int *a)
  */
 mp_int* num_to_mp_int(VALUE i)
 {
-    mp_int* result;
+    return MP_INT(num_to_ltm_bignum(i));
+}
+
+
+/*
+ * Like num_to_mp_int but hands back the Bignum itself, so that a caller
+ * that lets go of the GVL can keep a temporary alive with RB_GC_GUARD.
+ */
+VALUE num_to_ltm_bignum(VALUE i)
+{
+    VALUE result;
 
     if (IS_LTM_BIGNUM(i)) {
-        result = MP_INT(i);
+        result = i;
     } else {
         switch (TYPE(i)) {
             case T_FIXNUM:
             case T_BIGNUM:
             case T_FLOAT:
-                result = MP_INT(NEW_LTM_BIGNUM_FROM(i));
+                result = NEW_LTM_BIGNUM_FROM(i);
                 break;
             default:
                 rb_raise(rb_eTypeError, "unable to convert %s to a Bignum",
@@ -55,51 +65,216 @@ mp_int* num_to_mp_int(VALUE i)
 
 
 /*
- * See if the given Value has the integer value 2
+ * If the Fixnum _obj_ has a magnitude that fits in a single mp_digit,
+ * put the magnitude in *d and the sign (MP_ZPOS or MP_NEG) in *sign
+ * and return 1.  Otherwise return 0 and leave *d and *sign alone.
+ */
+int fixnum_to_mp_digit(VALUE obj, mp_digit *d, int *sign)
+{
+    long val = FIX2LONG(obj);
+    unsigned long mag = (val < 0) ? -(unsigned long)val : (unsigned long)val;
+
+    if (mag > (unsigned long)MP_MASK) {
+        return 0;
+    }
+    *d    = (mp_digit)mag;
+    *sign = (val < 0) ? MP_NEG : MP_ZPOS;
+    return 1;
+}
+
+
+/*
+ * Fill in the caller's mp_int _a_ with the value of the Fixnum _obj_
+ * using _digits_ (FIXNUM_MP_DIGITS long) as the digit storage.  Nothing
+ * is allocated, so _a_ is only good as a read only operand and must
+ * never be passed to mp_clear or used as a destination.
+ */
+mp_int* fixnum_to_mp_int(VALUE obj, mp_int *a, mp_digit *digits)
+{
+    long val = FIX2LONG(obj);
+    unsigned long mag = (val < 0) ? -(unsigned long)val : (unsigned long)val;
+
+    a->dp    = digits;
+    a->alloc = FIXNUM_MP_DIGITS;
+    a->used  = 0;
+    a->sign  = (val < 0) ? MP_NEG : MP_ZPOS;
+
+    while (mag > 0) {
+        a->dp[a->used++] = (mp_digit)(mag & MP_MASK);
+        /* in two steps, DIGIT_BIT can be the width of a long */
+        mag = (mag >> 1) >> (DIGIT_BIT - 1);
+    }
+    return a;
+}
+
+
+/*
+ * Compare _a_ with the single digit value _d_ with sign _sign_ and
+ * return MP_LT, MP_EQ or MP_GT.  mp_cmp_d only deals with positive
+ * digits so negative ones are done by comparing magnitudes.
  */
-VALUE is_2(VALUE obj)
+int mp_int_cmp_digit(mp_int *a, mp_digit d, int sign)
 {
-    mp_int *a = NULL;
-    int val = -1;
-    int digit_count = 0;
+    mp_int mag;
 
-    switch (TYPE(obj)) {
-    case T_FIXNUM:
-        val = FIX2INT(obj);
-        break;
-    case T_FLOAT:
-        val = NUM2INT(obj);
-        break;
-    case T_BIGNUM:
-        if ((RBIGNUM(obj)->len == 1)) {
-            val = NUM2INT(obj);
+    if (MP_ZPOS == sign) {
+        return mp_cmp_d(a,d);
+    }
+
+    if (MP_ZPOS == SIGN(a)) {
+        return MP_GT;
+    }
+
+    /* both negative, the one with the larger magnitude is smaller */
+    mag      = *a;
+    mag.sign = MP_ZPOS;
+    return -mp_cmp_d(&mag,d);
+}
+
+
+/*
+ * Classify _obj_ as an operand of multiply or divide so the caller can
+ * pick a cheaper routine than the general one.  Only the sign and the
+ * top digit are looked at up front, the remaining digits are only
+ * scanned when the top digit is already a power of 2, and that scan
+ * stops at the first non zero digit.
+ *
+ * Anything that is not a Fixnum or a LibTom::Math::Bignum is
+ * LTM_OPERAND_GENERAL.
+ */
+int classify_operand(VALUE obj, ltm_operand *op)
+{
+    mp_int *a;
+    mp_digit top;
+    unsigned long mag;
+    long val;
+    int i;
+
+    op->kind  = LTM_OPERAND_GENERAL;
+    op->sign  = MP_ZPOS;
+    op->digit = 0;
+    op->power = 0;
+
+    if (FIXNUM_P(obj)) {
+        val      = FIX2LONG(obj);
+        mag      = (val < 0) ? -(unsigned long)val : (unsigned long)val;
+        op->sign = (val < 0) ? MP_NEG : MP_ZPOS;
+
+        if ((0 != mag) && (0 == (mag & (mag - 1)))) {
+            op->kind = LTM_OPERAND_POW2;
+            while (mag > 1) {
+                mag >>= 1;
+                op->power++;
+            }
+        } else if (mag <= (unsigned long)MP_MASK) {
+            op->kind  = LTM_OPERAND_DIGIT;
+            op->digit = (mp_digit)mag;
+        }
+    } else if (IS_LTM_BIGNUM(obj)) {
+        a        = MP_INT(obj);
+        op->sign = SIGN(a);
+
+        if (0 == a->used) {
+            op->kind = LTM_OPERAND_DIGIT;
+            return op->kind;
         }
-        break;
-    case T_DATA:
-        if (IS_LTM_BIGNUM(obj)) {
-            a = MP_INT(obj);
-            if (MP_OKAY == mp_radix_size(a,10,&digit_count)) {
-                /* digit count is the number of digits + space for the 
-                 * '\0' in the string.  Normally mp_radix_size is used
-                 * to allocate space for a string to hold the number
-                 */
-                if (2 == digit_count) {
-                    val = (int)mp_get_int(a);
-                    if (SIGN(a) == MP_NEG) {
-                        val = -val;
-                    }
-                }
+
+        top = a->dp[a->used - 1];
+        if (0 == (top & (top - 1))) {
+            for (i = 0; (i < a->used - 1) && (0 == a->dp[i]); i++) { }
+            if (i == a->used - 1) {
+                op->kind  = LTM_OPERAND_POW2;
+                op->power = mp_cnt_lsb(a);
+                return op->kind;
             }
         }
-        break;
-    default:
-        /* nothing to do here, if it is not numeric then it we return
-         * false 
-         * */
-        break;
+
+        if (1 == a->used) {
+            op->kind  = LTM_OPERAND_DIGIT;
+            op->digit = top;
+        }
     }
 
-    return (2 == val) ? Qtrue : Qfalse;
+    return op->kind;
+}
+
+
+/*
+ * Read the ruby ::Integer _obj_ into the already initialized _a_.  When
+ * the ruby has rb_integer_pack the digits are copied straight out of
+ * _obj_, otherwise _obj_ goes through a decimal string.
+ */
+int integer_to_mp_int(VALUE obj, mp_int *a)
+{
+#ifdef INTEGER_PACK_LSWORD_FIRST
+    int num_digits = (int)rb_absint_numwords(obj,DIGIT_BIT,NULL);
+    int mp_result;
+    int sign;
+    int i;
+
+    if (MP_OKAY != (mp_result = mp_grow(a,num_digits))) {
+        return mp_result;
+    }
+
+    sign = rb_integer_pack(obj,a->dp,num_digits,sizeof(mp_digit),MP_DIGIT_NAILS,
+                           INTEGER_PACK_LSWORD_FIRST | INTEGER_PACK_NATIVE_BYTE_ORDER);
+
+    /* digits above used are expected to be zero */
+    for (i = num_digits; i < a->used; i++) {
+        a->dp[i] = 0;
+    }
+    a->used = num_digits;
+    a->sign = (sign < 0) ? MP_NEG : MP_ZPOS;
+    mp_clamp(a);
+    return MP_OKAY;
+#else
+    VALUE str = rb_funcall(obj,rb_intern("to_s"),0);
+    return mp_read_radix(a,RSTRING_PTR(str),10);
+#endif
+}
+
+
+/*
+ * Convert _a_ to a ruby ::Integer, a Fixnum or a ::Bignum depending on
+ * its size.  When the ruby has rb_integer_unpack the digits are handed
+ * over directly, otherwise _a_ goes through a decimal string.
+ */
+VALUE mp_int_to_integer(mp_int *a)
+{
+#ifdef INTEGER_PACK_LSWORD_FIRST
+    int flags = INTEGER_PACK_LSWORD_FIRST | INTEGER_PACK_NATIVE_BYTE_ORDER;
+
+    if (MP_NEG == SIGN(a)) {
+        flags |= INTEGER_PACK_NEGATIVE;
+    }
+    return rb_integer_unpack(a->dp,a->used,sizeof(mp_digit),MP_DIGIT_NAILS,flags);
+#else
+    return rb_str_to_inum(mp_int_to_rstring(a,10),10,Qfalse);
+#endif
+}
+
+
+/*
+ * Convert _a_ to a ruby String in base _radix_.  The String is made as
+ * long as mp_radix_size_overestimate allows for, mp_toradix writes into
+ * it directly and it is cut back to what was written.
+ */
+VALUE mp_int_to_rstring(mp_int *a, int radix)
+{
+    int mp_size,mp_result;
+    VALUE result;
+
+    if (MP_OKAY != (mp_result = mp_radix_size_overestimate(a,radix,&mp_size))) {
+        rb_raise(eLT_M_Error, "%s", mp_error_to_string(mp_result));
+    }
+
+    /* room for mp_size - 1 chars and the NULL byte */
+    result = rb_str_new(NULL,mp_size-1);
+    if (MP_OKAY != (mp_result = mp_toradix(a,RSTRING_PTR(result),radix))) {
+        rb_raise(eLT_M_Error, "%s", mp_error_to_string(mp_result));
+    }
+    rb_str_resize(result,(long)strlen(RSTRING_PTR(result)));
+    return result;
 }
 
 
@@ -111,7 +286,7 @@ mp_int* value_to_mp_int(VALUE obj)
     mp_int* bn;
 
     if (IS_LTM_BIGNUM(obj)) {
-        Data_Get_Struct(obj,mp_int,bn);
+        LTM_GET_STRUCT(obj,bn);
     } else {
         rb_raise(rb_eTypeError,"not a Bignum");
     }
@@ -119,21 +294,254 @@ mp_int* value_to_mp_int(VALUE obj)
 }
 
 /*
- * random_prime callback.  Uses the ruby rand method to fill a buffer of
- * length N with bytes and return the buffer
+ * Fill the ltm_random_bytes buffer using the ruby rand method.  Needs
+ * the GVL.
  */
-int ltm_bignum_random_prime_callback(unsigned char *buf, int len, void *dat)
+typedef struct {
+    unsigned char *buf;
+    int len;
+    int state;
+} ltm_random_bytes;
+
+static VALUE ltm_random_bytes_fill(VALUE arg)
 {
-    int i ; 
+    ltm_random_bytes *bytes = (ltm_random_bytes*)arg;
     VALUE max = INT2NUM(256);
     VALUE num;
+    int i;
 
-    for (i = 0 ; i < len ; i++) {
+    for (i = 0 ; i < bytes->len ; i++) {
         num = rb_funcall(rb_mKernel,rb_intern("rand"),1,max);
-        buf[i] = 0xff & (NUM2INT(num));
+        bytes->buf[i] = 0xff & (NUM2INT(num));
     }
+    return Qnil;
+}
 
-    return i;
+#ifdef HAVE_RB_THREAD_CALL_WITHOUT_GVL
+/*
+ * Called through rb_thread_call_with_gvl, nothing may be raised out of
+ * here so rand is protected and its state handed back.
+ */
+static void* ltm_random_bytes_fill_with_gvl(void *arg)
+{
+    ltm_random_bytes *bytes = (ltm_random_bytes*)arg;
+
+    rb_protect(ltm_random_bytes_fill,(VALUE)bytes,&bytes->state);
+    return NULL;
+}
+#endif
+
+/*
+ * random_prime callback.  Uses the ruby rand method to fill a buffer of
+ * length N with bytes and return the buffer.  _dat_ is NULL or an
+ * ltm_random_prime_data, when that says the GVL has been released it is
+ * taken back for the call to rand, and if rand raises the state is
+ * saved and 0 is returned so that mp_prime_random_ex gives up.  The
+ * same happens once the thread has been interrupted.
+ */
+int ltm_bignum_random_prime_callback(unsigned char *buf, int len, void *dat)
+{
+    ltm_random_prime_data *data = (ltm_random_prime_data*)dat;
+    ltm_random_bytes bytes;
+
+    bytes.buf   = buf;
+    bytes.len   = len;
+    bytes.state = 0;
+
+    if ((NULL != data) && (NULL != data->interrupted) && *data->interrupted) {
+        return 0;
+    }
+
+#ifdef HAVE_RB_THREAD_CALL_WITHOUT_GVL
+    if ((NULL != data) && data->without_gvl) {
+        rb_thread_call_with_gvl(ltm_random_bytes_fill_with_gvl,&bytes);
+        if (0 != bytes.state) {
+            data->state = bytes.state;
+            return 0;
+        }
+        return len;
+    }
+#endif
+
+    ltm_random_bytes_fill((VALUE)&bytes);
+    return len;
+}
+
+
+/*
+ * Bookkeeping for one ltm_without_gvl call
+ */
+typedef struct {
+    ltm_nogvl_func func;
+    void *data;
+    volatile int interrupted;
+    int mp_result;
+} ltm_nogvl_call;
+
+static void* ltm_nogvl_run(void *arg)
+{
+    ltm_nogvl_call *call = (ltm_nogvl_call*)arg;
+
+    call->mp_result = call->func(call->data,&call->interrupted);
+    return NULL;
+}
+
+#ifdef HAVE_RB_THREAD_CALL_WITHOUT_GVL
+/*
+ * Unblocking function, ruby calls this from another thread when it
+ * wants this one back (Thread#raise, Thread#kill, signals ...)
+ */
+static void ltm_nogvl_unblock(void *arg)
+{
+    ((ltm_nogvl_call*)arg)->interrupted = 1;
+}
+
+static VALUE ltm_nogvl_protected(VALUE arg)
+{
+    rb_thread_call_without_gvl(ltm_nogvl_run,(void*)arg,ltm_nogvl_unblock,(void*)arg);
+    return Qnil;
+}
+#endif
+
+/*
+ * Run _func_ on _data_ and return what it returns.  When _bits_ is at
+ * least LTM_NOGVL_BITS the GVL is released for the call so other ruby
+ * threads keep running.
+ *
+ * _operands_ points at the _count_ (at most LTM_NOGVL_OPERANDS) mp_int
+ * pointers in _data_ that belong to ruby objects.  Once the GVL is
+ * released another thread can run a bang method on one of them and
+ * reallocate or free its digits, so for that call each is pointed at a
+ * private copy, and back at the original when the call is done.
+ *
+ * If the thread is interrupted _func_ is asked to stop, and when the
+ * pending interrupt raises, _scratch_ (the caller's half built result,
+ * may be NULL) is cleared before the exception goes on up.  Interrupts
+ * that do not raise, like a signal trap, just get _func_ run again.
+ *
+ * Anything else _func_ reads has to stay alive and unchanged until this
+ * returns, and results must only be wrapped in ruby objects afterwards.
+ */
+int ltm_without_gvl(ltm_nogvl_func func, void *data, mp_int **operands[], int count,
+                    mp_int *scratch, int bits)
+{
+    ltm_nogvl_call call;
+    int state = 0;
+#ifdef HAVE_RB_THREAD_CALL_WITHOUT_GVL
+    mp_int copies[LTM_NOGVL_OPERANDS];
+    mp_int *originals[LTM_NOGVL_OPERANDS];
+    int i;
+#endif
+
+    call.func      = func;
+    call.data      = data;
+    call.mp_result = MP_OKAY;
+
+#ifdef HAVE_RB_THREAD_CALL_WITHOUT_GVL
+    if (LTM_WITHOUT_GVL_P(bits)) {
+        for (i = 0; i < count; i++) {
+            originals[i] = *operands[i];
+            if (MP_OKAY != (call.mp_result = mp_init_copy(&copies[i],originals[i]))) {
+                break;
+            }
+            *operands[i] = &copies[i];
+        }
+        if (i == count) {
+            do {
+                call.interrupted = 0;
+                rb_protect(ltm_nogvl_protected,(VALUE)&call,&state);
+            } while ((0 == state) && (LTM_INTERRUPTED == call.mp_result));
+        }
+        while (i-- > 0) {
+            mp_clear(&copies[i]);
+            *operands[i] = originals[i];
+        }
+
+        if (0 != state) {
+            if (NULL != scratch) {
+                mp_clear(scratch);
+            }
+            rb_jump_tag(state);
+        }
+        return call.mp_result;
+    }
+#endif
+
+    call.interrupted = 0;
+    ltm_nogvl_run(&call);
+    return call.mp_result;
+}
+
+
+/*
+ * mp_prime_is_prime, but the Miller-Rabin rounds stop early with
+ * LTM_INTERRUPTED once *interrupted goes non zero.
+ */
+int ltm_prime_is_prime(mp_int *a, int t, int *result, volatile int *interrupted)
+{
+    mp_int b;
+    int ix, mp_result, res;
+
+    *result = MP_NO;
+
+    if ((t <= 0) || (t > PRIME_SIZE)) {
+        return MP_VAL;
+    }
+
+    /* is the input equal to one of the primes in the table? */
+    for (ix = 0; ix < PRIME_SIZE; ix++) {
+        if (MP_EQ == mp_cmp_d(a,ltm_prime_tab[ix])) {
+            *result = MP_YES;
+            return MP_OKAY;
+        }
+    }
+
+    /* first perform trial division */
+    if (MP_OKAY != (mp_result = mp_prime_is_divisible(a,&res))) {
+        return mp_result;
+    }
+    if (MP_YES == res) {
+        return MP_OKAY;
+    }
+
+    if (MP_OKAY != (mp_result = mp_init(&b))) {
+        return mp_result;
+    }
+
+    for (ix = 0; ix < t; ix++) {
+        if (*interrupted) {
+            mp_result = LTM_INTERRUPTED;
+            break;
+        }
+
+        mp_set(&b,ltm_prime_tab[ix]);
+        if (MP_OKAY != (mp_result = mp_prime_miller_rabin(a,&b,&res))) {
+            break;
+        }
+        if (MP_NO == res) {
+            break;
+        }
+    }
+
+    if ((MP_OKAY == mp_result) && (MP_YES == res)) {
+        *result = MP_YES;
+    }
+    mp_clear(&b);
+    return mp_result;
+}
+
+
+/*
+ * Allocate a new Bignum and move the value of the caller's _a_ into it.
+ * Used for results computed without the GVL.  _a_ is cleared.
+ */
+VALUE ltm_bignum_from_mp_int(mp_int *a)
+{
+    VALUE result = ALLOC_LTM_BIGNUM;
+
+    mp_exch(a,MP_INT(result));
+    mp_clear(a);
+    return result;
 }
 
 /**********************************************************************
@@ -141,29 +549,62 @@ int ltm_bignum_random_prime_callback(unsigned char *buf, int len, void *dat)
  **********************************************************************/
 
 /*
- * garbage collector free method for mp_int structures
+ * garbage collector free method for ltm_bignum structures
  */ 
-static void ltm_bignum_free(mp_int *bn) 
+static void ltm_bignum_free(void *ptr) 
 {
-        mp_clear(bn);
-            free(bn);
-                return ;
+    ltm_bignum *bn = (ltm_bignum*)ptr;
+
+    mp_clear(&bn->mp);
+    xfree(bn);
+    return ;
 }
 
+#ifdef TypedData_Wrap_Struct
 /*
- * Allocator for mp_int structures
+ * garbage collector size method for ltm_bignum structures, the struct
+ * itself plus the digits once they have moved out to the heap.
+ */
+static size_t ltm_bignum_memsize(const void *ptr)
+{
+    const ltm_bignum *bn = (const ltm_bignum*)ptr;
+    size_t size = sizeof(ltm_bignum);
+
+    if (!LTM_EMBEDDED_P(bn) && (NULL != bn->mp.dp)) {
+        size += sizeof(ltm_block_header) + LTM_BLOCK_HEADER(bn->mp.dp)->size;
+    }
+    return size;
+}
+
+const rb_data_type_t ltm_bignum_type = {
+    "LibTom::Math::Bignum",
+    { NULL, ltm_bignum_free, ltm_bignum_memsize, },
+#ifdef RUBY_TYPED_FREE_IMMEDIATELY
+    NULL, NULL, RUBY_TYPED_FREE_IMMEDIATELY
+#endif
+};
+#endif
+
+/*
+ * Allocator for Bignums.  The mp_int starts out on the digits embedded
+ * in the ltm_bignum, so a new Bignum is a single allocation.
  */
 VALUE ltm_bignum_alloc(VALUE klass)
 {
-    mp_int *bn = ALLOC(mp_int);
-    VALUE  obj = (VALUE)NULL;
-    int mp_result = MP_OKAY;
+    ltm_bignum *bn = ALLOC(ltm_bignum);
+    int i;
 
-    if (MP_OKAY == (mp_result = mp_init(bn))) {
-        obj = Data_Wrap_Struct(klass,NULL,ltm_bignum_free,bn);
-    } else {
-        rb_raise(eLT_M_Error, "Failure to allocate Bignum: %s", mp_error_to_string(mp_result));
-    }    
-    return obj; 
+    bn->header.size     = sizeof(bn->digits);
+    bn->header.type     = LTM_BLOCK_EMBEDDED;
+    for (i = 0; i < LTM_EMBEDDED_DIGITS; i++) {
+        bn->digits[i] = 0;
+    }
+
+    bn->mp.dp    = bn->digits;
+    bn->mp.used  = 0;
+    bn->mp.alloc = LTM_EMBEDDED_DIGITS;
+    bn->mp.sign  = MP_ZPOS;
+
+    return LTM_WRAP_STRUCT(klass,bn);
 }
 
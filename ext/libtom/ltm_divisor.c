@@ -0,0 +1,305 @@
+#include "ruby.h"
+#include <tommath.h>
+#include "ltm.h"
+
+/**********************************************************************
+ *                             Prototypes                             *
+ **********************************************************************/
+
+/* Class */
+VALUE cLT_M_Divisor;
+extern VALUE eLT_M_Error;
+
+/*
+ * What a Divisor wraps.  The divisor is shifted up until the top bit of
+ * its top digit is set, which is what mp_div_barrett wants, and the
+ * dividends are shifted by the same amount on the way in.
+ */
+typedef struct {
+    mp_int d;      /* the divisor as given              */
+    mp_int norm;   /* |d| * 2**shift                    */
+    mp_int mu;     /* mp_reciprocal(norm)               */
+    int    shift;
+} ltm_divisor;
+
+/**********************************************************************
+ *                   Ruby Object life-cycle methods                   *
+ **********************************************************************/
+
+/*
+ * garbage collector free method for ltm_divisor structures
+ */
+static void ltm_divisor_free(void *ptr)
+{
+    ltm_divisor *dv = (ltm_divisor*)ptr;
+
+    mp_clear_multi(&dv->d,&dv->norm,&dv->mu,NULL);
+    xfree(dv);
+    return ;
+}
+
+#ifdef TypedData_Wrap_Struct
+/*
+ * garbage collector size method for ltm_divisor structures
+ */
+static size_t ltm_divisor_memsize(const void *ptr)
+{
+    const ltm_divisor *dv = (const ltm_divisor*)ptr;
+
+    return sizeof(ltm_divisor) +
+        sizeof(mp_digit) * (dv->d.alloc + dv->norm.alloc + dv->mu.alloc);
+}
+
+static const rb_data_type_t ltm_divisor_type = {
+    "LibTom::Math::Divisor",
+    { NULL, ltm_divisor_free, ltm_divisor_memsize, },
+#ifdef RUBY_TYPED_FREE_IMMEDIATELY
+    NULL, NULL, RUBY_TYPED_FREE_IMMEDIATELY
+#endif
+};
+
+#define LTM_DIVISOR_WRAP(klass,dv) (TypedData_Wrap_Struct(klass,&ltm_divisor_type,dv))
+#define LTM_DIVISOR_GET(obj,dv) (TypedData_Get_Struct(obj,ltm_divisor,&ltm_divisor_type,dv))
+#else
+#define LTM_DIVISOR_WRAP(klass,dv) (Data_Wrap_Struct(klass,NULL,ltm_divisor_free,dv))
+#define LTM_DIVISOR_GET(obj,dv) (Data_Get_Struct(obj,ltm_divisor,dv))
+#endif
+
+/*
+ * Allocator for Divisors, a new one divides by 0 until it is initialized
+ */
+VALUE ltm_divisor_alloc(VALUE klass)
+{
+    ltm_divisor *dv = ALLOC(ltm_divisor);
+    int mp_result;
+
+    if (MP_OKAY != (mp_result = mp_init_multi(&dv->d,&dv->norm,&dv->mu,NULL))) {
+        xfree(dv);
+        rb_raise(eLT_M_Error,"Failure to allocate Divisor: %s",
+                mp_error_to_string(mp_result));
+    }
+    dv->shift = 0;
+
+    return LTM_DIVISOR_WRAP(klass,dv);
+}
+
+
+/*
+ * Get the ltm_divisor out of _self_, raising if it was never set up
+ */
+static ltm_divisor* ltm_divisor_get(VALUE self)
+{
+    ltm_divisor *dv;
+
+    LTM_DIVISOR_GET(self,dv);
+    if (mp_iszero(&dv->d)) {
+        rb_raise(rb_eZeroDivError,"divide by 0");
+    }
+    return dv;
+}
+
+
+/*
+ * call-seq:
+ *   Divisor.new(numeric) -> divisor
+ *
+ * Sets up a Divisor for _numeric_.  The reciprocal of the divisor is
+ * worked out here once, by Newton's iteration, after which every
+ * division by the Divisor costs about two multiplications per block of
+ * dividend digits as long as the divisor, instead of a long division.
+ * It pays off when the same number divides many others.
+ *
+ *  d = LibTom::Math::Divisor.new(m)
+ *  residues = numbers.collect { |x| d.mod(x) }
+ */
+VALUE ltm_divisor_initialize(VALUE self, VALUE other)
+{
+    ltm_divisor *dv;
+    VALUE tmp = NUM2LTM_BIGNUM(other);
+    mp_int *b = MP_INT(tmp);
+    int mp_result;
+
+    LTM_DIVISOR_GET(self,dv);
+    if (mp_iszero(b)) {
+        rb_raise(rb_eZeroDivError,"divide by 0");
+    }
+
+    /* shift until the top bit of the top digit is set */
+    dv->shift = (int)((DIGIT_BIT - (mp_count_bits(b) % DIGIT_BIT)) % DIGIT_BIT);
+    if ((MP_OKAY != (mp_result = mp_copy(b,&dv->d))) ||
+        (MP_OKAY != (mp_result = mp_abs(b,&dv->norm))) ||
+        (MP_OKAY != (mp_result = mp_mul_2d(&dv->norm,dv->shift,&dv->norm))) ||
+        (MP_OKAY != (mp_result = mp_reciprocal(&dv->norm,&dv->mu)))) {
+        mp_zero(&dv->d);
+        rb_raise(eLT_M_Error,"Failure to set up Divisor: %s",
+                mp_error_to_string(mp_result));
+    }
+    RB_GC_GUARD(tmp);
+
+    return self;
+}
+
+
+/*
+ * call-seq:
+ *   divisor.initialize_copy(other) -> divisor
+ *
+ * Copies the divisor and its reciprocal from _other_.
+ */
+VALUE ltm_divisor_initialize_copy(VALUE copy, VALUE orig)
+{
+    ltm_divisor *dst, *src;
+    int mp_result;
+
+    if (copy == orig) {
+        return copy;
+    }
+    LTM_DIVISOR_GET(copy,dst);
+    LTM_DIVISOR_GET(orig,src);
+
+    if ((MP_OKAY != (mp_result = mp_copy(&src->d,&dst->d))) ||
+        (MP_OKAY != (mp_result = mp_copy(&src->norm,&dst->norm))) ||
+        (MP_OKAY != (mp_result = mp_copy(&src->mu,&dst->mu)))) {
+        mp_zero(&dst->d);
+        rb_raise(eLT_M_Error,"Failure to copy Divisor: %s",
+                mp_error_to_string(mp_result));
+    }
+    dst->shift = src->shift;
+
+    return copy;
+}
+
+
+/*
+ * q = a / d truncated and r = a % d floored, either may be NULL.  When
+ * both are wanted q is floored too, the way divmod pairs them.  The
+ * quotient of a * 2**shift by the shifted divisor is the same one and
+ * the remainder comes out 2**shift times too big.
+ */
+static int ltm_divisor_divmod_into(ltm_divisor *dv, mp_int *a, mp_int *q, mp_int *r)
+{
+    mp_int t;
+    int mp_result;
+
+    if (MP_OKAY != (mp_result = mp_init_size(&t,a->used + 1))) {
+        return mp_result;
+    }
+    if (MP_OKAY != (mp_result = mp_mul_2d(a,dv->shift,&t))) {
+        goto ERR;
+    }
+    if (MP_OKAY != (mp_result = mp_div_barrett(&t,&dv->norm,&dv->mu,q,&t))) {
+        goto ERR;
+    }
+
+    if ((NULL != q) && (MP_NEG == SIGN(&dv->d))) {
+        mp_neg(q,q);
+    }
+    if (NULL != r) {
+        if (MP_OKAY != (mp_result = mp_div_2d(&t,dv->shift,r,NULL))) {
+            goto ERR;
+        }
+        if (!mp_iszero(r) && (SIGN(r) != SIGN(&dv->d))) {
+            if ((MP_OKAY == (mp_result = mp_add(r,&dv->d,r))) && (NULL != q)) {
+                mp_result = mp_sub_d(q,1,q);
+            }
+        }
+    }
+
+ERR:
+    mp_clear(&t);
+    return mp_result;
+}
+
+
+/*
+ * call-seq:
+ *   divisor.div(numeric) -> bignum
+ *
+ * Divides _numeric_ by the divisor, the same as <tt>numeric / d</tt>.
+ */
+VALUE ltm_divisor_div(VALUE self, VALUE other)
+{
+    ltm_divisor *dv = ltm_divisor_get(self);
+    VALUE tmp    = NUM2LTM_BIGNUM(other);
+    mp_int *a    = MP_INT(tmp);
+    VALUE result = ALLOC_LTM_BIGNUM;
+    int mp_result;
+
+    if (MP_OKAY != (mp_result = ltm_divisor_divmod_into(dv,a,MP_INT(result),NULL))) {
+        rb_raise(eLT_M_Error,"Failure to divide Bignum: %s",
+                mp_error_to_string(mp_result));
+    }
+    RB_GC_GUARD(tmp);
+
+    return result;
+}
+
+
+/*
+ * call-seq:
+ *   divisor.mod(numeric) -> bignum
+ *
+ * Takes _numeric_ modulo the divisor, the same as <tt>numeric % d</tt>.
+ */
+VALUE ltm_divisor_mod(VALUE self, VALUE other)
+{
+    ltm_divisor *dv = ltm_divisor_get(self);
+    VALUE tmp    = NUM2LTM_BIGNUM(other);
+    mp_int *a    = MP_INT(tmp);
+    VALUE result = ALLOC_LTM_BIGNUM;
+    int mp_result;
+
+    if (MP_OKAY != (mp_result = ltm_divisor_divmod_into(dv,a,NULL,MP_INT(result)))) {
+        rb_raise(eLT_M_Error,"Failure to modulo Bignum: %s",
+                mp_error_to_string(mp_result));
+    }
+    RB_GC_GUARD(tmp);
+
+    return result;
+}
+
+
+/*
+ * call-seq:
+ *   divisor.divmod(numeric) -> [ quotient, modulus ]
+ *
+ * The same as <tt>numeric.divmod(d)</tt>, both from a single division.
+ */
+VALUE ltm_divisor_divmod(VALUE self, VALUE other)
+{
+    ltm_divisor *dv = ltm_divisor_get(self);
+    VALUE tmp = NUM2LTM_BIGNUM(other);
+    mp_int *a = MP_INT(tmp);
+    VALUE div = ALLOC_LTM_BIGNUM;
+    VALUE mod = ALLOC_LTM_BIGNUM;
+    int mp_result;
+
+    if (MP_OKAY != (mp_result = ltm_divisor_divmod_into(dv,a,MP_INT(div),MP_INT(mod)))) {
+        rb_raise(eLT_M_Error,"Failure to divmod Bignum: %s",
+                mp_error_to_string(mp_result));
+    }
+    RB_GC_GUARD(tmp);
+
+    return rb_ary_new3(2,div,mod);
+}
+
+
+/*
+ * call-seq:
+ *   divisor.divisor -> bignum
+ *
+ * The number this Divisor divides by.
+ */
+VALUE ltm_divisor_divisor(VALUE self)
+{
+    ltm_divisor *dv = ltm_divisor_get(self);
+    VALUE result = ALLOC_LTM_BIGNUM;
+    int mp_result;
+
+    if (MP_OKAY != (mp_result = mp_copy(&dv->d,MP_INT(result)))) {
+        rb_raise(eLT_M_Error,"Failure to copy Bignum: %s",
+                mp_error_to_string(mp_result));
+    }
+
+    return result;
+}
@@ -34,6 +34,41 @@ VALUE ltm_prime_num_miller_rabin_trials(VALUE self, VALUE other)
 }
 
 
+/*
+ * operands of random_of_size while the GVL is released
+ */
+typedef struct {
+    mp_int *a;
+    int trials;
+    int num_bits;
+    int flags;
+    ltm_random_prime_data data;
+} ltm_random_of_size_args;
+
+/*
+ * The candidates are drawn by ltm_bignum_random_prime_callback, which
+ * also gets the GVL back for rand.  Once ruby wants the thread the next
+ * batch of random bytes is refused, which makes mp_prime_random_ex give
+ * up on the search.
+ */
+static int ltm_random_of_size_without_gvl(void *data, volatile int *interrupted)
+{
+    ltm_random_of_size_args *args = (ltm_random_of_size_args*)data;
+    int mp_result;
+
+    args->data.interrupted = interrupted;
+    mp_result = mp_prime_random_ex(args->a,args->trials,args->num_bits,args->flags,
+                                   ltm_bignum_random_prime_callback,&args->data);
+
+    if (0 != args->data.state) {
+        return MP_VAL;
+    }
+    if ((MP_OKAY != mp_result) && *interrupted) {
+        return LTM_INTERRUPTED;
+    }
+    return mp_result;
+}
+
 /*
  * call-seq:
  *  random_of_size( n, options = Hash.new ) -> bignum
@@ -53,11 +88,13 @@ VALUE ltm_prime_num_miller_rabin_trials(VALUE self, VALUE other)
  * <b><tt>:msb</tt></b>::           Set this to +true+ to forece the 2nd
  *                                  most significant bit of the resulting 
  *                                  prime to be 1.
+ *
+ * Other ruby threads keep running while large primes are searched for.
  */
 VALUE ltm_prime_random_of_size(int argc, VALUE* argv, VALUE self)
 {
-    VALUE result = ALLOC_LTM_BIGNUM;
-    mp_int *a    = MP_INT(result);
+    ltm_random_of_size_args args;
+    mp_int a;
 
     int num_bits;
     VALUE options;
@@ -110,13 +147,34 @@ VALUE ltm_prime_random_of_size(int argc, VALUE* argv, VALUE self)
         trials = mp_prime_rabin_miller_trials(num_bits);
     }
 
-    if (MP_OKAY != (mp_result = mp_prime_random_ex(a,trials,num_bits,flags,
-                                                   ltm_bignum_random_prime_callback,NULL))) {
+    if (MP_OKAY != (mp_result = mp_init(&a))) {
+            rb_raise(eLT_M_Error, "Failure to find a %d bit random prime: %s", 
+                num_bits,mp_error_to_string(mp_result));
+    }
+
+    args.a                = &a;
+    args.trials           = trials;
+    args.num_bits         = num_bits;
+    args.flags            = flags;
+    args.data.without_gvl = LTM_WITHOUT_GVL_P(num_bits);
+    args.data.interrupted = NULL;
+    args.data.state       = 0;
+
+    mp_result = ltm_without_gvl(ltm_random_of_size_without_gvl,&args,NULL,0,&a,num_bits);
+
+    /* rand raised while the GVL was released */
+    if (0 != args.data.state) {
+        mp_clear(&a);
+        rb_jump_tag(args.data.state);
+    }
+
+    if (MP_OKAY != mp_result) {
+            mp_clear(&a);
             rb_raise(eLT_M_Error, "Failure to find a %d bit random prime: %s", 
                 num_bits,mp_error_to_string(mp_result));
     }
 
-    return result;
+    return ltm_bignum_from_mp_int(&a);
 
 }
 
@@ -1,5 +1,36 @@
 require 'rubygems'
 require 'mkrf'
 Mkrf::Generator.new('libtommath') do |g|
-    # completely self contained, defaults work great.
+    # completely self contained, defaults work great.  Rubies that can
+    # run C code without the GVL get long calculations done that way.
+    if g.include_header('ruby/thread.h') and g.has_function?('rb_thread_call_without_gvl')
+        g.add_define('HAVE_RB_THREAD_CALL_WITHOUT_GVL')
+    end
+
+    # libtommath gets its memory from ltm_alloc.c, which lets Bignums keep
+    # small values inside themselves and tells the GC about the rest where
+    # the ruby allows it
+    g.add_define('XMALLOC=ltm_xmalloc')
+    g.add_define('XREALLOC=ltm_xrealloc')
+    g.add_define('XCALLOC=ltm_xcalloc')
+    g.add_define('XFREE=ltm_xfree')
+
+    # and the temporaries of the big routines from its scratch arena
+    g.add_define('XSCRATCH_RESERVE=ltm_scratch_reserve')
+    g.add_define('XSCRATCH_MARK=ltm_scratch_mark')
+    g.add_define('XSCRATCH_ALLOC=ltm_scratch_alloc')
+    g.add_define('XSCRATCH_RELEASE=ltm_scratch_release')
+
+    # LTM_NO_DIGIT_POOL=1 in the environment builds without the digit
+    # pool, LTM_RUBY_XMALLOC=1 takes digit memory from ruby's xmalloc
+    %w[ LTM_NO_DIGIT_POOL LTM_RUBY_XMALLOC ].each do |flag|
+        g.add_define(flag) if ENV[flag]
+    end
+    # LTM_64BIT_FULL=1 uses all 64 bits of the digits on x86_64 and
+    # aarch64 instead of 60, the carries then go through the 128 bit words
+    g.add_define('MP_64BIT_FULL') if ENV['LTM_64BIT_FULL']
+
+    if g.has_function?('rb_gc_adjust_memory_usage')
+        g.add_define('HAVE_RB_GC_ADJUST_MEMORY_USAGE')
+    end
 end
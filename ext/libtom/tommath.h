@@ -46,7 +46,7 @@ extern "C" {
 
 
 /* detect 64-bit mode if possible */
-#if defined(__x86_64__) 
+#if defined(__x86_64__) || defined(__aarch64__)
    #if !(defined(MP_64BIT) && defined(MP_16BIT) && defined(MP_8BIT))
       #define MP_64BIT
    #endif
@@ -76,7 +76,15 @@ extern "C" {
    typedef unsigned long      mp_digit;
    typedef unsigned long      mp_word __attribute__ ((mode(TI)));
 
+#ifdef MP_64BIT_FULL
+   /* every bit of the mp_digit is used.  A mp_word then only holds a
+    * product and a digit, so the routines that add up more than that
+    * keep a third digit for the carries.
+    */
+   #define DIGIT_BIT          64
+#else
    #define DIGIT_BIT          60
+#endif
 #else
    /* this is the default case, 28-bit digits */
    
@@ -121,6 +129,23 @@ extern "C" {
    #endif
 #endif
 
+/* scratch memory for the temporaries of the big routines.  MARK and
+ * RELEASE bracket a call, RESERVE hints at how much the whole call will
+ * want, and memory from ALLOC is handed back by RELEASE as well as XFREE.
+ * The default is plain heap memory.
+ */
+#ifndef XSCRATCH_ALLOC
+   #define XSCRATCH_RESERVE(n)
+   #define XSCRATCH_MARK()      ((size_t)0)
+   #define XSCRATCH_ALLOC(n)    XMALLOC(n)
+   #define XSCRATCH_RELEASE(m)
+#else
+   extern void   XSCRATCH_RESERVE(size_t n);
+   extern size_t XSCRATCH_MARK(void);
+   extern void  *XSCRATCH_ALLOC(size_t n);
+   extern void   XSCRATCH_RELEASE(size_t m);
+#endif
+
 
 /* otherwise the bits per digit is calculated automatically from the size of a mp_digit */
 #ifndef DIGIT_BIT
@@ -128,7 +153,11 @@ extern "C" {
 #endif
 
 #define MP_DIGIT_BIT     DIGIT_BIT
+#ifdef MP_64BIT_FULL
+#define MP_MASK          ((mp_digit)(~((mp_digit)0)))
+#else
 #define MP_MASK          ((((mp_digit)1)<<((mp_digit)DIGIT_BIT))-((mp_digit)1))
+#endif
 #define MP_DIGIT_MAX     MP_MASK
 
 /* equalities */
@@ -158,7 +187,45 @@ typedef int           mp_err;
 extern int KARATSUBA_MUL_CUTOFF,
            KARATSUBA_SQR_CUTOFF,
            TOOM_MUL_CUTOFF,
-           TOOM_SQR_CUTOFF;
+           TOOM_SQR_CUTOFF,
+           TOOM4_MUL_CUTOFF,
+           TOOM4_SQR_CUTOFF,
+           TOOM65_MUL_CUTOFF,
+           TOOM65_SQR_CUTOFF,
+           SSA_MUL_CUTOFF,
+           SSA_SQR_CUTOFF,
+           NTT_MUL_CUTOFF,
+           NTT_SQR_CUTOFF,
+           SIMD_MUL_CUTOFF,
+           SIMD_SQR_CUTOFF,
+           BZ_DIV_CUTOFF,
+           TORADIX_DC_CUTOFF,
+           READ_RADIX_DC_CUTOFF;
+
+/* which FFT multiplier mp_mul and mp_sqr use past their cutoffs */
+#define MP_FFT_NONE        0   /* none, Toom-Cook all the way up */
+#define MP_FFT_SSA         1   /* Schonhage-Strassen */
+#define MP_FFT_NTT         2   /* three prime NTT, MP_64BIT only */
+
+extern int FFT_MUL_METHOD;
+
+/* would mp_mul hand operands of n digits to the FFT? */
+#define MP_FFT_SIZE(n) \
+   ((FFT_MUL_METHOD == MP_FFT_NTT && (n) >= NTT_MUL_CUTOFF) || \
+    (FFT_MUL_METHOD == MP_FFT_SSA && (n) >= SSA_MUL_CUTOFF))
+
+/* which kernel the comba multiplier and squarer use */
+#define MP_COMBA_DETECT   -1   /* the best one the processor has, found on first use */
+#define MP_COMBA_SCALAR    0   /* plain C */
+#define MP_COMBA_AVX2      1   /* AVX2 and FMA on 52 bit limbs */
+#define MP_COMBA_IFMA      2   /* AVX-512 IFMA on 52 bit limbs */
+
+extern int COMBA_MUL_METHOD;
+
+/* the vector kernels are built for x86_64 with GCC or clang */
+#if defined(MP_64BIT) && defined(__x86_64__) && defined(__GNUC__) && !defined(MP_NO_SIMD)
+   #define MP_COMBA_SIMD
+#endif
 
 /* define this to use lower memory usage routines (exptmods mostly) */
 /* #define MP_LOW_MEM */
@@ -173,7 +240,28 @@ extern int KARATSUBA_MUL_CUTOFF,
 #endif
 
 /* size of comba arrays, should be at least 2 * 2**(BITS_PER_WORD - BITS_PER_DIGIT*2) */
+#ifdef MP_64BIT_FULL
+#define MP_WARRAY               512
+#else
 #define MP_WARRAY               (1 << (sizeof(mp_word) * CHAR_BIT - 2 * DIGIT_BIT + 1))
+#endif
+
+/* most products a comba column can add up before its mp_word overflows,
+ * the full digit combas carry into a third digit and have no limit
+ */
+#ifdef MP_64BIT_FULL
+#define MP_COMBA_MAX            MP_WARRAY
+#else
+#define MP_COMBA_MAX            (1 << ((CHAR_BIT * sizeof (mp_word)) - (2 * DIGIT_BIT)))
+#endif
+
+#ifdef MP_64BIT_FULL
+/* a full digit comba column is _W with the digit c2 on top of it */
+#define MP_COMBA_ADD(_W, c2, t) \
+   do { mp_word _t = (t); (_W) += _t; (c2) += (mp_digit)((_W) < _t); } while (0)
+#define MP_COMBA_NEXT(_W, c2) \
+   do { (_W) = ((_W) >> ((mp_word)DIGIT_BIT)) | (((mp_word)(c2)) << ((mp_word)DIGIT_BIT)); (c2) = 0; } while (0)
+#endif
 
 /* the infamous mp_int structure */
 typedef struct  {
@@ -181,6 +269,23 @@ typedef struct  {
     mp_digit *dp;
 } mp_int;
 
+/* a single digit divisor with its precomputed inverse, see mp_div_d_setup */
+typedef struct {
+    mp_digit b,       /* the divisor                                     */
+             norm,    /* b << shift, with bit DIGIT_BIT-1 set            */
+             inv;     /* floor((2**(2*DIGIT_BIT) - 1)/norm) - 2**DIGIT_BIT */
+    int      shift;
+} mp_digit_inv;
+
+/* P(i) = (radix**k)**(2**i) for the radix conversions, see mp_radix_power_get */
+#define MP_RADIX_POWERS 32
+typedef struct {
+    mp_int p,         /* the power                                        */
+           norm,      /* p << shift, with the top bit of the top digit set */
+           mu;        /* mp_reciprocal(norm), 0 until a division wants it  */
+    int    shift;
+} mp_radix_power;
+
 /* callback for mp_prime_random, should fill dst with random bytes and return how many read [upto len] */
 typedef int ltm_prime_callback(unsigned char *dst, int len, void *dat);
 
@@ -217,6 +322,14 @@ int mp_grow(mp_int *a, int size);
 /* init to a given number of digits */
 int mp_init_size(mp_int *a, int size);
 
+/* init a temporary of a given size from scratch memory, it must be
+ * cleared before the XSCRATCH_RELEASE of the caller and never handed out
+ */
+int mp_init_scratch(mp_int *a, int size);
+
+/* init a NULL terminated series of scratch temporaries of the same size */
+int mp_init_scratch_multi(int size, mp_int *mp, ...);
+
 /* ---> Basic Manipulations <--- */
 #define mp_iszero(a) (((a)->used == 0) ? MP_YES : MP_NO)
 #define mp_iseven(a) (((a)->used > 0 && (((a)->dp[0] & 1) == 0)) ? MP_YES : MP_NO)
@@ -316,12 +429,27 @@ int mp_sub(mp_int *a, mp_int *b, mp_int *c);
 /* c = a * b */
 int mp_mul(mp_int *a, mp_int *b, mp_int *c);
 
+/* c = |a| * |b| mod 2**(DIGIT_BIT*digs), the low short product */
+int mp_mullo(mp_int *a, mp_int *b, mp_int *c, int digs);
+
+/* c = |a| * |b| without the columns below digs, the high short product */
+int mp_mulhi(mp_int *a, mp_int *b, mp_int *c, int digs);
+
 /* b = a*a  */
 int mp_sqr(mp_int *a, mp_int *b);
 
 /* a/b => cb + d == a */
 int mp_div(mp_int *a, mp_int *b, mp_int *c, mp_int *d);
 
+/* a/b => cb + d == a, by Burnikel-Ziegler recursive division */
+int mp_div_bz(mp_int *a, mp_int *b, mp_int *c, mp_int *d);
+
+/* a/b => cb + d == a, for b normalized and mu = mp_reciprocal(b) */
+int mp_div_barrett(mp_int *a, mp_int *b, mp_int *mu, mp_int *c, mp_int *d);
+
+/* c = a/b where b is known to divide a exactly */
+int mp_divexact(mp_int *a, mp_int *b, mp_int *c);
+
 /* c = a mod b, 0 <= c < b  */
 int mp_mod(mp_int *a, mp_int *b, mp_int *c);
 
@@ -342,6 +470,12 @@ int mp_mul_d(mp_int *a, mp_digit b, mp_int *c);
 /* a/b => cb + d == a */
 int mp_div_d(mp_int *a, mp_digit b, mp_int *c, mp_digit *d);
 
+/* precompute the inverse of b for mp_div_d_inv and mp_mod_d_multi */
+int mp_div_d_setup(mp_digit b, mp_digit_inv *inv);
+
+/* a/b => cb + d == a, b set up with mp_div_d_setup */
+int mp_div_d_inv(mp_int *a, mp_digit_inv *inv, mp_int *c, mp_digit *d);
+
 /* a/3 => 3c + d == a */
 int mp_div_3(mp_int *a, mp_int *c, mp_digit *d);
 
@@ -351,6 +485,9 @@ int mp_expt_d(mp_int *a, mp_digit b, mp_int *c);
 /* c = a mod b, 0 <= c < b  */
 int mp_mod_d(mp_int *a, mp_digit b, mp_digit *c);
 
+/* c[i] = a mod inv[i].b for i < n, all in a single pass over a */
+int mp_mod_d_multi(mp_int *a, mp_digit_inv *inv, int n, mp_digit *c);
+
 /* ---> number theory <--- */
 
 /* d = a + b (mod c) */
@@ -395,6 +532,9 @@ int mp_jacobi(mp_int *a, mp_int *n, int *c);
 /* used to setup the Barrett reduction for a given modulus b */
 int mp_reduce_setup(mp_int *a, mp_int *b);
 
+/* b = floor(2**(2*DIGIT_BIT*a->used) / a) for a with its top bit set */
+int mp_reciprocal(mp_int *a, mp_int *b);
+
 /* Barrett Reduction, computes a (mod b) with a precomputed value c
  *
  * Assumes that 0 < a <= b*b, note if 0 > a > -(b*b) then you can merely
@@ -413,6 +553,12 @@ int mp_montgomery_calc_normalization(mp_int *a, mp_int *b);
 /* computes x/R == x (mod N) via Montgomery Reduction */
 int mp_montgomery_reduce(mp_int *a, mp_int *m, mp_digit mp);
 
+/* setups the montgomery reduction with all of -1/a mod R */
+int mp_montgomery_setup_l(mp_int *a, mp_int *mp);
+
+/* computes x/R == x (mod N) with short products, mp from mp_montgomery_setup_l */
+int mp_montgomery_reduce_l(mp_int *a, mp_int *m, mp_int *mp);
+
 /* returns 1 if a is a valid DR modulus */
 int mp_dr_is_modulus(mp_int *a);
 
@@ -524,6 +670,10 @@ int mp_read_unsigned_bin(mp_int *a, const unsigned char *b, int c);
 int mp_to_unsigned_bin(mp_int *a, unsigned char *b);
 int mp_to_unsigned_bin_n (mp_int * a, unsigned char *b, unsigned long *outlen);
 
+/* words of size bytes, order/endian 1 for most significant first, -1 for least, endian 0 for native */
+int mp_export(void *rop, size_t *countp, int order, size_t size, int endian, size_t nails, mp_int *op);
+int mp_import(mp_int *rop, size_t count, int order, size_t size, int endian, size_t nails, const void *op);
+
 int mp_signed_bin_size(mp_int *a);
 int mp_read_signed_bin(mp_int *a, const unsigned char *b, int c);
 int mp_to_signed_bin(mp_int *a,  unsigned char *b);
@@ -533,6 +683,16 @@ int mp_read_radix(mp_int *a, const char *str, int radix);
 int mp_toradix(mp_int *a, char *str, int radix);
 int mp_toradix_n(mp_int * a, char *str, int radix, int maxlen);
 int mp_radix_size(mp_int *a, int radix, int *size);
+int mp_radix_size_overestimate(mp_int *a, int radix, int *size);
+
+/* k and big = radix**k, the most digits of the radix a mp_digit holds */
+int mp_radix_chunk(int radix, int *k, mp_digit *big);
+
+/* *p = big**(2**i) from the cache, with its reciprocal if divide is MP_YES */
+int mp_radix_power_get(int radix, int i, int divide, mp_radix_power **p);
+
+/* frees the cached powers of every radix */
+void mp_radix_power_clear(void);
 
 int mp_fread(mp_int *a, int radix, FILE *stream);
 int mp_fwrite(mp_int *a, int radix, FILE *stream);
@@ -559,10 +719,25 @@ int fast_s_mp_mul_high_digs(mp_int *a, mp_int *b, mp_int *c, int digs);
 int s_mp_mul_high_digs(mp_int *a, mp_int *b, mp_int *c, int digs);
 int fast_s_mp_sqr(mp_int *a, mp_int *b);
 int s_mp_sqr(mp_int *a, mp_int *b);
+int s_mp_mul_simd(mp_int *a, mp_int *b, mp_int *c);
+int mp_comba_best(void);
 int mp_karatsuba_mul(mp_int *a, mp_int *b, mp_int *c);
 int mp_toom_mul(mp_int *a, mp_int *b, mp_int *c);
 int mp_karatsuba_sqr(mp_int *a, mp_int *b);
 int mp_toom_sqr(mp_int *a, mp_int *b);
+int mp_toom25_mul(mp_int *a, mp_int *b, mp_int *c);
+int mp_toom35_mul(mp_int *a, mp_int *b, mp_int *c);
+int mp_toom4_mul(mp_int *a, mp_int *b, mp_int *c);
+int mp_toom4_sqr(mp_int *a, mp_int *b);
+int mp_toom65_mul(mp_int *a, mp_int *b, mp_int *c);
+int mp_toom65_sqr(mp_int *a, mp_int *b);
+int mp_chunk_mul(mp_int *a, mp_int *b, mp_int *c, int size);
+int mp_ssa_mul(mp_int *a, mp_int *b, mp_int *c);
+int mp_ssa_sqr(mp_int *a, mp_int *b);
+#ifdef MP_64BIT
+int mp_ntt_mul(mp_int *a, mp_int *b, mp_int *c);
+int mp_ntt_sqr(mp_int *a, mp_int *b);
+#endif
 int fast_mp_invmod(mp_int *a, mp_int *b, mp_int *c);
 int mp_invmod_slow (mp_int * a, mp_int * b, mp_int * c);
 int fast_mp_montgomery_reduce(mp_int *a, mp_int *m, mp_digit mp);
@@ -571,6 +746,8 @@ int s_mp_exptmod (mp_int * G, mp_int * X, mp_int * P, mp_int * Y, int mode);
 void bn_reverse(unsigned char *s, int len);
 
 extern const char *mp_s_rmap;
+extern const unsigned char mp_s_rmap_reverse[256];
+extern const unsigned long mp_s_rmap_log2[65];
 
 #ifdef __cplusplus
    }
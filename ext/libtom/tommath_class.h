@@ -20,6 +20,7 @@
 #define BN_MP_ADD_D_C
 #define BN_MP_ADDMOD_C
 #define BN_MP_AND_C
+#define BN_MP_CHUNK_MUL_C
 #define BN_MP_CLAMP_C
 #define BN_MP_CLEAR_C
 #define BN_MP_CLEAR_MULTI_C
@@ -33,11 +34,17 @@
 #define BN_MP_DIV_2_C
 #define BN_MP_DIV_2D_C
 #define BN_MP_DIV_3_C
+#define BN_MP_DIV_BARRETT_C
+#define BN_MP_DIV_BZ_C
 #define BN_MP_DIV_D_C
+#define BN_MP_DIV_D_INV_C
+#define BN_MP_DIV_D_SETUP_C
+#define BN_MP_DIVEXACT_C
 #define BN_MP_DR_IS_MODULUS_C
 #define BN_MP_DR_REDUCE_C
 #define BN_MP_DR_SETUP_C
 #define BN_MP_EXCH_C
+#define BN_MP_EXPORT_C
 #define BN_MP_EXPT_D_C
 #define BN_MP_EXPTMOD_C
 #define BN_MP_EXPTMOD_FAST_C
@@ -47,9 +54,12 @@
 #define BN_MP_GCD_C
 #define BN_MP_GET_INT_C
 #define BN_MP_GROW_C
+#define BN_MP_IMPORT_C
 #define BN_MP_INIT_C
 #define BN_MP_INIT_COPY_C
 #define BN_MP_INIT_MULTI_C
+#define BN_MP_INIT_SCRATCH_C
+#define BN_MP_INIT_SCRATCH_MULTI_C
 #define BN_MP_INIT_SET_C
 #define BN_MP_INIT_SET_INT_C
 #define BN_MP_INIT_SIZE_C
@@ -64,16 +74,23 @@
 #define BN_MP_MOD_C
 #define BN_MP_MOD_2D_C
 #define BN_MP_MOD_D_C
+#define BN_MP_MOD_D_MULTI_C
 #define BN_MP_MONTGOMERY_CALC_NORMALIZATION_C
 #define BN_MP_MONTGOMERY_REDUCE_C
+#define BN_MP_MONTGOMERY_REDUCE_L_C
 #define BN_MP_MONTGOMERY_SETUP_C
+#define BN_MP_MONTGOMERY_SETUP_L_C
 #define BN_MP_MUL_C
 #define BN_MP_MUL_2_C
 #define BN_MP_MUL_2D_C
 #define BN_MP_MUL_D_C
+#define BN_MP_MULHI_C
+#define BN_MP_MULLO_C
 #define BN_MP_MULMOD_C
 #define BN_MP_N_ROOT_C
 #define BN_MP_NEG_C
+#define BN_MP_NTT_MUL_C
+#define BN_MP_NTT_SQR_C
 #define BN_MP_OR_C
 #define BN_MP_PRIME_FERMAT_C
 #define BN_MP_PRIME_IS_DIVISIBLE_C
@@ -82,12 +99,15 @@
 #define BN_MP_PRIME_NEXT_PRIME_C
 #define BN_MP_PRIME_RABIN_MILLER_TRIALS_C
 #define BN_MP_PRIME_RANDOM_EX_C
+#define BN_MP_RADIX_POWER_C
 #define BN_MP_RADIX_SIZE_C
+#define BN_MP_RADIX_SIZE_OVERESTIMATE_C
 #define BN_MP_RADIX_SMAP_C
 #define BN_MP_RAND_C
 #define BN_MP_READ_RADIX_C
 #define BN_MP_READ_SIGNED_BIN_C
 #define BN_MP_READ_UNSIGNED_BIN_C
+#define BN_MP_RECIPROCAL_C
 #define BN_MP_REDUCE_C
 #define BN_MP_REDUCE_2K_C
 #define BN_MP_REDUCE_2K_L_C
@@ -104,6 +124,8 @@
 #define BN_MP_SQR_C
 #define BN_MP_SQRMOD_C
 #define BN_MP_SQRT_C
+#define BN_MP_SSA_MUL_C
+#define BN_MP_SSA_SQR_C
 #define BN_MP_SUB_C
 #define BN_MP_SUB_D_C
 #define BN_MP_SUBMOD_C
@@ -111,6 +133,12 @@
 #define BN_MP_TO_SIGNED_BIN_N_C
 #define BN_MP_TO_UNSIGNED_BIN_C
 #define BN_MP_TO_UNSIGNED_BIN_N_C
+#define BN_MP_TOOM25_MUL_C
+#define BN_MP_TOOM35_MUL_C
+#define BN_MP_TOOM4_MUL_C
+#define BN_MP_TOOM4_SQR_C
+#define BN_MP_TOOM65_MUL_C
+#define BN_MP_TOOM65_SQR_C
 #define BN_MP_TOOM_MUL_C
 #define BN_MP_TOOM_SQR_C
 #define BN_MP_TORADIX_C
@@ -124,6 +152,7 @@
 #define BN_S_MP_EXPTMOD_C
 #define BN_S_MP_MUL_DIGS_C
 #define BN_S_MP_MUL_HIGH_DIGS_C
+#define BN_S_MP_MUL_SIMD_C
 #define BN_S_MP_SQR_C
 #define BN_S_MP_SUB_C
 #define BNCORE_C
@@ -134,6 +163,7 @@
 #endif
 
 #if defined(BN_FAST_MP_INVMOD_C)
+   #define BN_MP_INIT_SCRATCH_MULTI_C
    #define BN_MP_ISEVEN_C
    #define BN_MP_INIT_MULTI_C
    #define BN_MP_COPY_C
@@ -159,6 +189,7 @@
 #endif
 
 #if defined(BN_FAST_S_MP_MUL_DIGS_C)
+   #define BN_S_MP_MUL_SIMD_C
    #define BN_MP_GROW_C
    #define BN_MP_CLAMP_C
 #endif
@@ -169,6 +200,7 @@
 #endif
 
 #if defined(BN_FAST_S_MP_SQR_C)
+   #define BN_S_MP_MUL_SIMD_C
    #define BN_MP_GROW_C
    #define BN_MP_CLAMP_C
 #endif
@@ -208,6 +240,15 @@
    #define BN_MP_CLEAR_C
 #endif
 
+#if defined(BN_MP_CHUNK_MUL_C)
+   #define BN_MP_ZERO_C
+   #define BN_MP_INIT_SIZE_C
+   #define BN_MP_CLAMP_C
+   #define BN_MP_MUL_C
+   #define BN_MP_EXCH_C
+   #define BN_MP_CLEAR_C
+#endif
+
 #if defined(BN_MP_CLAMP_C)
 #endif
 
@@ -240,6 +281,8 @@
 #endif
 
 #if defined(BN_MP_DIV_C)
+   #define BN_MP_DIV_BZ_C
+   #define BN_MP_INIT_SCRATCH_C
    #define BN_MP_ISZERO_C
    #define BN_MP_CMP_MAG_C
    #define BN_MP_COPY_C
@@ -288,11 +331,82 @@
    #define BN_MP_CLEAR_C
 #endif
 
+#if defined(BN_MP_DIV_BARRETT_C)
+   #define BN_MP_CMP_MAG_C
+   #define BN_MP_COPY_C
+   #define BN_MP_ZERO_C
+   #define BN_MP_INIT_SIZE_C
+   #define BN_MP_INIT_SCRATCH_MULTI_C
+   #define BN_MP_GROW_C
+   #define BN_MP_CLAMP_C
+   #define BN_MP_RSHD_C
+   #define BN_MP_MULHI_C
+   #define BN_MP_MULLO_C
+   #define BN_MP_MOD_2D_C
+   #define BN_MP_SUB_C
+   #define BN_MP_SET_C
+   #define BN_MP_LSHD_C
+   #define BN_MP_ADD_C
+   #define BN_MP_ADD_D_C
+   #define BN_S_MP_SUB_C
+   #define BN_MP_EXCH_C
+   #define BN_MP_CLEAR_C
+   #define BN_MP_CLEAR_MULTI_C
+#endif
+
+#if defined(BN_MP_DIV_BZ_C)
+   #define BN_MP_INIT_SCRATCH_MULTI_C
+   #define BN_MP_INIT_SIZE_C
+   #define BN_MP_ISZERO_C
+   #define BN_MP_CMP_MAG_C
+   #define BN_MP_COPY_C
+   #define BN_MP_ZERO_C
+   #define BN_MP_COUNT_BITS_C
+   #define BN_MP_ABS_C
+   #define BN_MP_MUL_2D_C
+   #define BN_MP_DIV_2D_C
+   #define BN_MP_MOD_2D_C
+   #define BN_MP_LSHD_C
+   #define BN_MP_RSHD_C
+   #define BN_MP_ADD_C
+   #define BN_MP_SUB_C
+   #define BN_MP_SUB_D_C
+   #define BN_MP_MUL_C
+   #define BN_MP_DIV_C
+   #define BN_MP_EXCH_C
+   #define BN_MP_CLEAR_C
+   #define BN_MP_CLEAR_MULTI_C
+#endif
+
 #if defined(BN_MP_DIV_D_C)
    #define BN_MP_ISZERO_C
    #define BN_MP_COPY_C
    #define BN_MP_DIV_2D_C
    #define BN_MP_DIV_3_C
+   #define BN_MP_DIV_D_SETUP_C
+   #define BN_MP_DIV_D_INV_C
+   #define BN_MP_INIT_SIZE_C
+   #define BN_MP_CLAMP_C
+   #define BN_MP_EXCH_C
+   #define BN_MP_CLEAR_C
+#endif
+
+#if defined(BN_MP_DIV_D_INV_C)
+   #define BN_MP_INIT_SIZE_C
+   #define BN_MP_CLAMP_C
+   #define BN_MP_EXCH_C
+   #define BN_MP_CLEAR_C
+#endif
+
+#if defined(BN_MP_DIV_D_SETUP_C)
+#endif
+
+#if defined(BN_MP_DIVEXACT_C)
+   #define BN_MP_ISZERO_C
+   #define BN_MP_ZERO_C
+   #define BN_MP_INIT_COPY_C
+   #define BN_MP_CNT_LSB_C
+   #define BN_MP_DIV_2D_C
    #define BN_MP_INIT_SIZE_C
    #define BN_MP_CLAMP_C
    #define BN_MP_EXCH_C
@@ -315,6 +429,10 @@
 #if defined(BN_MP_EXCH_C)
 #endif
 
+#if defined(BN_MP_EXPORT_C)
+   #define BN_MP_COUNT_BITS_C
+#endif
+
 #if defined(BN_MP_EXPT_D_C)
    #define BN_MP_INIT_COPY_C
    #define BN_MP_SET_C
@@ -338,6 +456,7 @@
 #endif
 
 #if defined(BN_MP_EXPTMOD_FAST_C)
+   #define BN_MP_INIT_SCRATCH_C
    #define BN_MP_COUNT_BITS_C
    #define BN_MP_INIT_C
    #define BN_MP_CLEAR_C
@@ -404,6 +523,12 @@
 #if defined(BN_MP_GROW_C)
 #endif
 
+#if defined(BN_MP_IMPORT_C)
+   #define BN_MP_ZERO_C
+   #define BN_MP_GROW_C
+   #define BN_MP_CLAMP_C
+#endif
+
 #if defined(BN_MP_INIT_C)
 #endif
 
@@ -417,6 +542,15 @@
    #define BN_MP_CLEAR_C
 #endif
 
+#if defined(BN_MP_INIT_SCRATCH_C)
+#endif
+
+#if defined(BN_MP_INIT_SCRATCH_MULTI_C)
+   #define BN_MP_ERR_C
+   #define BN_MP_INIT_SCRATCH_C
+   #define BN_MP_CLEAR_C
+#endif
+
 #if defined(BN_MP_INIT_SET_C)
    #define BN_MP_INIT_C
    #define BN_MP_SET_C
@@ -439,6 +573,7 @@
 #endif
 
 #if defined(BN_MP_INVMOD_SLOW_C)
+   #define BN_MP_INIT_SCRATCH_MULTI_C
    #define BN_MP_ISZERO_C
    #define BN_MP_INIT_MULTI_C
    #define BN_MP_MOD_C
@@ -478,8 +613,8 @@
 #endif
 
 #if defined(BN_MP_KARATSUBA_MUL_C)
+   #define BN_MP_INIT_SCRATCH_C
    #define BN_MP_MUL_C
-   #define BN_MP_INIT_SIZE_C
    #define BN_MP_CLAMP_C
    #define BN_MP_SUB_C
    #define BN_MP_ADD_C
@@ -488,7 +623,7 @@
 #endif
 
 #if defined(BN_MP_KARATSUBA_SQR_C)
-   #define BN_MP_INIT_SIZE_C
+   #define BN_MP_INIT_SCRATCH_C
    #define BN_MP_CLAMP_C
    #define BN_MP_SQR_C
    #define BN_MP_SUB_C
@@ -502,7 +637,7 @@
    #define BN_MP_INIT_MULTI_C
    #define BN_MP_GCD_C
    #define BN_MP_CMP_MAG_C
-   #define BN_MP_DIV_C
+   #define BN_MP_DIVEXACT_C
    #define BN_MP_MUL_C
    #define BN_MP_CLEAR_MULTI_C
 #endif
@@ -530,6 +665,9 @@
    #define BN_MP_DIV_D_C
 #endif
 
+#if defined(BN_MP_MOD_D_MULTI_C)
+#endif
+
 #if defined(BN_MP_MONTGOMERY_CALC_NORMALIZATION_C)
    #define BN_MP_COUNT_BITS_C
    #define BN_MP_2EXPT_C
@@ -548,10 +686,42 @@
    #define BN_S_MP_SUB_C
 #endif
 
+#if defined(BN_MP_MONTGOMERY_REDUCE_L_C)
+   #define BN_MP_INIT_MULTI_C
+   #define BN_MP_MULLO_C
+   #define BN_MP_MULHI_C
+   #define BN_MP_MOD_2D_C
+   #define BN_S_MP_ADD_C
+   #define BN_MP_RSHD_C
+   #define BN_MP_ADD_D_C
+   #define BN_MP_CMP_MAG_C
+   #define BN_S_MP_SUB_C
+   #define BN_MP_CLEAR_MULTI_C
+#endif
+
 #if defined(BN_MP_MONTGOMERY_SETUP_C)
 #endif
 
+#if defined(BN_MP_MONTGOMERY_SETUP_L_C)
+   #define BN_MP_MONTGOMERY_SETUP_C
+   #define BN_MP_INIT_MULTI_C
+   #define BN_MP_SET_C
+   #define BN_MP_MULLO_C
+   #define BN_MP_ADD_D_C
+   #define BN_MP_RSHD_C
+   #define BN_MP_LSHD_C
+   #define BN_S_MP_ADD_C
+   #define BN_MP_CLEAR_MULTI_C
+#endif
+
 #if defined(BN_MP_MUL_C)
+   #define BN_MP_NTT_MUL_C
+   #define BN_MP_SSA_MUL_C
+   #define BN_MP_CHUNK_MUL_C
+   #define BN_MP_TOOM35_MUL_C
+   #define BN_MP_TOOM25_MUL_C
+   #define BN_MP_TOOM65_MUL_C
+   #define BN_MP_TOOM4_MUL_C
    #define BN_MP_TOOM_MUL_C
    #define BN_MP_KARATSUBA_MUL_C
    #define BN_FAST_S_MP_MUL_DIGS_C
@@ -575,6 +745,27 @@
    #define BN_MP_CLAMP_C
 #endif
 
+#if defined(BN_MP_MULHI_C)
+   #define BN_S_MP_MUL_HIGH_DIGS_C
+   #define BN_MP_CLAMP_C
+   #define BN_MP_MUL_C
+   #define BN_MP_INIT_SIZE_C
+   #define BN_MP_INIT_SCRATCH_C
+   #define BN_MP_EXCH_C
+   #define BN_MP_CLEAR_C
+#endif
+
+#if defined(BN_MP_MULLO_C)
+   #define BN_MP_ZERO_C
+   #define BN_S_MP_MUL_DIGS_C
+   #define BN_MP_CLAMP_C
+   #define BN_MP_MUL_C
+   #define BN_MP_INIT_SIZE_C
+   #define BN_MP_INIT_SCRATCH_C
+   #define BN_MP_EXCH_C
+   #define BN_MP_CLEAR_C
+#endif
+
 #if defined(BN_MP_MULMOD_C)
    #define BN_MP_INIT_C
    #define BN_MP_MUL_C
@@ -618,7 +809,8 @@
 #endif
 
 #if defined(BN_MP_PRIME_IS_DIVISIBLE_C)
-   #define BN_MP_MOD_D_C
+   #define BN_MP_DIV_D_SETUP_C
+   #define BN_MP_MOD_D_MULTI_C
 #endif
 
 #if defined(BN_MP_PRIME_IS_PRIME_C)
@@ -647,7 +839,8 @@
    #define BN_MP_SET_C
    #define BN_MP_SUB_D_C
    #define BN_MP_ISEVEN_C
-   #define BN_MP_MOD_D_C
+   #define BN_MP_DIV_D_SETUP_C
+   #define BN_MP_MOD_D_MULTI_C
    #define BN_MP_INIT_C
    #define BN_MP_ADD_D_C
    #define BN_MP_PRIME_MILLER_RABIN_C
@@ -666,14 +859,35 @@
    #define BN_MP_ADD_D_C
 #endif
 
-#if defined(BN_MP_RADIX_SIZE_C)
+#if defined(BN_MP_RADIX_POWER_C)
+   #define BN_MP_INIT_MULTI_C
+   #define BN_MP_SET_C
+   #define BN_MP_SQR_C
+   #define BN_MP_CLEAR_MULTI_C
    #define BN_MP_COUNT_BITS_C
-   #define BN_MP_INIT_COPY_C
+   #define BN_MP_MUL_2D_C
+   #define BN_MP_RECIPROCAL_C
+   #define BN_MP_ZERO_C
+#endif
+
+#if defined(BN_MP_RADIX_SIZE_C)
    #define BN_MP_ISZERO_C
-   #define BN_MP_DIV_D_C
+   #define BN_MP_COUNT_BITS_C
+   #define BN_MP_RADIX_SMAP_C
+   #define BN_MP_INIT_C
+   #define BN_MP_SET_C
+   #define BN_MP_SQR_C
+   #define BN_MP_MUL_D_C
+   #define BN_MP_CMP_MAG_C
    #define BN_MP_CLEAR_C
 #endif
 
+#if defined(BN_MP_RADIX_SIZE_OVERESTIMATE_C)
+   #define BN_MP_ISZERO_C
+   #define BN_MP_COUNT_BITS_C
+   #define BN_MP_RADIX_SMAP_C
+#endif
+
 #if defined(BN_MP_RADIX_SMAP_C)
    #define BN_MP_S_RMAP_C
 #endif
@@ -691,6 +905,13 @@
    #define BN_MP_MUL_D_C
    #define BN_MP_ADD_D_C
    #define BN_MP_ISZERO_C
+   #define BN_MP_RADIX_POWER_C
+   #define BN_MP_INIT_C
+   #define BN_MP_MUL_C
+   #define BN_MP_ADD_C
+   #define BN_MP_CLEAR_C
+   #define BN_MP_GROW_C
+   #define BN_MP_CLAMP_C
 #endif
 
 #if defined(BN_MP_READ_SIGNED_BIN_C)
@@ -698,10 +919,31 @@
 #endif
 
 #if defined(BN_MP_READ_UNSIGNED_BIN_C)
-   #define BN_MP_GROW_C
    #define BN_MP_ZERO_C
-   #define BN_MP_MUL_2D_C
-   #define BN_MP_CLAMP_C
+   #define BN_MP_IMPORT_C
+#endif
+
+#if defined(BN_MP_RECIPROCAL_C)
+   #define BN_MP_2EXPT_C
+   #define BN_MP_SUB_D_C
+   #define BN_MP_DIV_C
+   #define BN_MP_INIT_SCRATCH_MULTI_C
+   #define BN_MP_INIT_SCRATCH_C
+   #define BN_MP_INIT_SIZE_C
+   #define BN_MP_COPY_C
+   #define BN_MP_RSHD_C
+   #define BN_MP_LSHD_C
+   #define BN_MP_MUL_C
+   #define BN_MP_MULHI_C
+   #define BN_MP_MULLO_C
+   #define BN_MP_CMP_C
+   #define BN_MP_CMP_MAG_C
+   #define BN_MP_SUB_C
+   #define BN_MP_ADD_C
+   #define BN_MP_ADD_D_C
+   #define BN_MP_EXCH_C
+   #define BN_MP_CLEAR_C
+   #define BN_MP_CLEAR_MULTI_C
 #endif
 
 #if defined(BN_MP_REDUCE_C)
@@ -709,9 +951,11 @@
    #define BN_MP_INIT_COPY_C
    #define BN_MP_RSHD_C
    #define BN_MP_MUL_C
+   #define BN_MP_MULHI_C
    #define BN_S_MP_MUL_HIGH_DIGS_C
    #define BN_FAST_S_MP_MUL_HIGH_DIGS_C
    #define BN_MP_MOD_2D_C
+   #define BN_MP_MULLO_C
    #define BN_S_MP_MUL_DIGS_C
    #define BN_MP_SUB_C
    #define BN_MP_CMP_D_C
@@ -770,6 +1014,7 @@
 #endif
 
 #if defined(BN_MP_REDUCE_SETUP_C)
+   #define BN_MP_RECIPROCAL_C
    #define BN_MP_2EXPT_C
    #define BN_MP_DIV_C
 #endif
@@ -796,6 +1041,10 @@
 #endif
 
 #if defined(BN_MP_SQR_C)
+   #define BN_MP_NTT_SQR_C
+   #define BN_MP_SSA_SQR_C
+   #define BN_MP_TOOM65_SQR_C
+   #define BN_MP_TOOM4_SQR_C
    #define BN_MP_TOOM_SQR_C
    #define BN_MP_KARATSUBA_SQR_C
    #define BN_FAST_S_MP_SQR_C
@@ -823,6 +1072,45 @@
    #define BN_MP_CLEAR_C
 #endif
 
+#if defined(BN_MP_SSA_MUL_C)
+   #define BN_MP_COUNT_BITS_C
+   #define BN_MP_ZERO_C
+   #define BN_MP_INIT_SCRATCH_C
+   #define BN_MP_INIT_SCRATCH_MULTI_C
+   #define BN_MP_INIT_SIZE_C
+   #define BN_MP_2EXPT_C
+   #define BN_MP_ADD_D_C
+   #define BN_MP_DIV_2D_C
+   #define BN_MP_MOD_2D_C
+   #define BN_MP_MUL_2D_C
+   #define BN_MP_ADD_C
+   #define BN_MP_SUB_C
+   #define BN_MP_CMP_MAG_C
+   #define BN_MP_GROW_C
+   #define BN_MP_CLAMP_C
+   #define BN_MP_EXCH_C
+   #define BN_MP_MUL_C
+   #define BN_MP_SQR_C
+   #define BN_MP_CLEAR_C
+   #define BN_MP_CLEAR_MULTI_C
+#endif
+
+#if defined(BN_MP_SSA_SQR_C)
+   #define BN_MP_SSA_MUL_C
+#endif
+
+#if defined(BN_MP_NTT_MUL_C)
+   #define BN_MP_ZERO_C
+   #define BN_MP_INIT_SIZE_C
+   #define BN_MP_CLAMP_C
+   #define BN_MP_EXCH_C
+   #define BN_MP_CLEAR_C
+#endif
+
+#if defined(BN_MP_NTT_SQR_C)
+   #define BN_MP_NTT_MUL_C
+#endif
+
 #if defined(BN_MP_SUB_C)
    #define BN_S_MP_ADD_C
    #define BN_MP_CMP_MAG_C
@@ -852,10 +1140,7 @@
 #endif
 
 #if defined(BN_MP_TO_UNSIGNED_BIN_C)
-   #define BN_MP_INIT_COPY_C
-   #define BN_MP_ISZERO_C
-   #define BN_MP_DIV_2D_C
-   #define BN_MP_CLEAR_C
+   #define BN_MP_EXPORT_C
 #endif
 
 #if defined(BN_MP_TO_UNSIGNED_BIN_N_C)
@@ -863,8 +1148,87 @@
    #define BN_MP_TO_UNSIGNED_BIN_C
 #endif
 
+#if defined(BN_MP_TOOM25_MUL_C)
+   #define BN_MP_INIT_SCRATCH_MULTI_C
+   #define BN_MP_MOD_2D_C
+   #define BN_MP_COPY_C
+   #define BN_MP_RSHD_C
+   #define BN_MP_MUL_C
+   #define BN_MP_ADD_C
+   #define BN_MP_SUB_C
+   #define BN_MP_DIV_2_C
+   #define BN_MP_LSHD_C
+   #define BN_MP_CLEAR_MULTI_C
+#endif
+
+#if defined(BN_MP_TOOM35_MUL_C)
+   #define BN_MP_INIT_SCRATCH_MULTI_C
+   #define BN_MP_MOD_2D_C
+   #define BN_MP_COPY_C
+   #define BN_MP_RSHD_C
+   #define BN_MP_MUL_C
+   #define BN_MP_ADD_C
+   #define BN_MP_SUB_C
+   #define BN_MP_MUL_2_C
+   #define BN_MP_MUL_2D_C
+   #define BN_MP_DIV_2_C
+   #define BN_MP_DIV_2D_C
+   #define BN_MP_DIV_3_C
+   #define BN_MP_LSHD_C
+   #define BN_MP_CLEAR_MULTI_C
+#endif
+
+#if defined(BN_MP_TOOM4_MUL_C)
+   #define BN_MP_INIT_SCRATCH_MULTI_C
+   #define BN_MP_INIT_SIZE_C
+   #define BN_MP_GROW_C
+   #define BN_MP_CLAMP_C
+   #define BN_MP_MUL_C
+   #define BN_MP_SQR_C
+   #define BN_MP_ADD_C
+   #define BN_MP_SUB_C
+   #define BN_MP_MUL_2_C
+   #define BN_MP_MUL_2D_C
+   #define BN_MP_DIV_2_C
+   #define BN_MP_DIV_2D_C
+   #define BN_MP_DIV_3_C
+   #define BN_MP_DIV_D_C
+   #define BN_MP_EXCH_C
+   #define BN_MP_CLEAR_C
+   #define BN_MP_CLEAR_MULTI_C
+#endif
+
+#if defined(BN_MP_TOOM4_SQR_C)
+   #define BN_MP_TOOM4_MUL_C
+#endif
+
+#if defined(BN_MP_TOOM65_MUL_C)
+   #define BN_MP_INIT_SCRATCH_MULTI_C
+   #define BN_MP_INIT_SIZE_C
+   #define BN_MP_GROW_C
+   #define BN_MP_CLAMP_C
+   #define BN_MP_ZERO_C
+   #define BN_MP_MUL_C
+   #define BN_MP_SQR_C
+   #define BN_MP_ADD_C
+   #define BN_MP_SUB_C
+   #define BN_MP_MUL_2_C
+   #define BN_MP_MUL_2D_C
+   #define BN_MP_MUL_D_C
+   #define BN_MP_DIV_2_C
+   #define BN_MP_DIV_2D_C
+   #define BN_MP_DIV_D_C
+   #define BN_MP_EXCH_C
+   #define BN_MP_CLEAR_C
+   #define BN_MP_CLEAR_MULTI_C
+#endif
+
+#if defined(BN_MP_TOOM65_SQR_C)
+   #define BN_MP_TOOM65_MUL_C
+#endif
+
 #if defined(BN_MP_TOOM_MUL_C)
-   #define BN_MP_INIT_MULTI_C
+   #define BN_MP_INIT_SCRATCH_MULTI_C
    #define BN_MP_MOD_2D_C
    #define BN_MP_COPY_C
    #define BN_MP_RSHD_C
@@ -881,7 +1245,7 @@
 #endif
 
 #if defined(BN_MP_TOOM_SQR_C)
-   #define BN_MP_INIT_MULTI_C
+   #define BN_MP_INIT_SCRATCH_MULTI_C
    #define BN_MP_MOD_2D_C
    #define BN_MP_COPY_C
    #define BN_MP_RSHD_C
@@ -898,11 +1262,20 @@
 #endif
 
 #if defined(BN_MP_TORADIX_C)
-   #define BN_MP_ISZERO_C
+   #define BN_MP_RADIX_POWER_C
    #define BN_MP_INIT_COPY_C
-   #define BN_MP_DIV_D_C
+   #define BN_MP_DIV_D_INV_C
+   #define BN_MP_DIV_D_SETUP_C
    #define BN_MP_CLEAR_C
    #define BN_MP_S_RMAP_C
+   #define BN_REVERSE_C
+   #define BN_MP_CMP_MAG_C
+   #define BN_MP_INIT_SIZE_C
+   #define BN_MP_INIT_C
+   #define BN_MP_MUL_2D_C
+   #define BN_MP_DIV_BARRETT_C
+   #define BN_MP_DIV_2D_C
+   #define BN_MP_COUNT_BITS_C
 #endif
 
 #if defined(BN_MP_TORADIX_N_C)
@@ -946,6 +1319,10 @@
    #define BN_MP_REDUCE_C
    #define BN_MP_REDUCE_2K_SETUP_L_C
    #define BN_MP_REDUCE_2K_L_C
+   #define BN_MP_MONTGOMERY_SETUP_L_C
+   #define BN_MP_MONTGOMERY_REDUCE_L_C
+   #define BN_MP_MONTGOMERY_CALC_NORMALIZATION_C
+   #define BN_MP_MULMOD_C
    #define BN_MP_MOD_C
    #define BN_MP_COPY_C
    #define BN_MP_SQR_C
@@ -970,6 +1347,11 @@
    #define BN_MP_CLEAR_C
 #endif
 
+#if defined(BN_S_MP_MUL_SIMD_C)
+   #define BN_MP_GROW_C
+   #define BN_MP_CLAMP_C
+#endif
+
 #if defined(BN_S_MP_SQR_C)
    #define BN_MP_INIT_SIZE_C
    #define BN_MP_CLAMP_C
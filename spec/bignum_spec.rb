@@ -49,6 +49,39 @@ describe LibTom::Math::Bignum, "instantiations" do
         c.object_id.should_not == b.object_id
     end
 
+    it "should report the size of its digits to ObjectSpace" do
+        require 'objspace'
+        small = LibTom::Math::Bignum.new(1)
+        big   = LibTom::Math::Bignum.new(2**100_000)
+        ObjectSpace.memsize_of(big).should > ObjectSpace.memsize_of(small) + 100_000/8
+    end
+
+    it "should keep its value while growing out of and back into a small size" do
+        b = LibTom::Math::Bignum.new(3)
+        (1..40).each { |i| b.mul!(2**60 + i) }
+        (1..40).each { |i| b = b.divexact(2**60 + i) }
+        b.should == 3
+        c = LibTom::Math::Bignum.new(2**5000)
+        c.shr!(4990)
+        c.should == 1024
+        c.add!(2**4000)
+        c.should == 2**4000 + 1024
+    end
+
+    it "should give the same answers with and without the digit pool" do
+        a = LibTom::Math::Bignum.new(3**2000)
+        with = (1..20).collect { |i| (a * (a + i)) % (a - i) }
+        LibTom::Math.digit_pool = false
+        begin
+            LibTom::Math.digit_pool?.should == false
+            without = (1..20).collect { |i| (a * (a + i)) % (a - i) }
+        ensure
+            LibTom::Math.digit_pool = true
+        end
+        without.should == with
+        LibTom::Math.digit_pool_stats.keys.sort_by { |k| k.to_s }.should == [:hits, :misses, :pooled_bytes]
+    end
+
 end
 
 describe LibTom::Math::Bignum, "conversions" do
@@ -78,6 +111,56 @@ describe LibTom::Math::Bignum, "conversions" do
         b.to_s(64).should == "rubyrules"
     end
 
+    it "should convert a big number to a string the way Ruby does" do
+        [ 3**20000 + 7 * 10**3000, -(10**4000), 2**9000 - 1 ].each do |x|
+            b = LibTom::Math::Bignum.new(x)
+            [ 2, 7, 10, 16, 36 ].each do |base|
+                b.to_s(base).should == x.to_s(base).upcase
+            end
+        end
+    end
+
+    it "should read a big number from a string the way Ruby does" do
+        [ 3**20000 + 7 * 10**3000, -(10**4000), 2**9000 - 1 ].each do |x|
+            [ 2, 7, 10, 16 ].each do |base|
+                LibTom::Math::Bignum.new(x.to_s(base), base).should == x
+            end
+            LibTom::Math::Bignum.new(x.to_s(36).upcase, 36).should == x
+        end
+        LibTom::Math::Bignum.new("#{10**3000}xyz", 10).should == 10**3000
+    end
+
+    it "should convert to and from every power of two base" do
+        [ 1, 2**4096, -(3**5000), 2**9000 - 1 ].each do |x|
+            b = LibTom::Math::Bignum.new(x)
+            [ 2, 4, 8, 16, 32, 64 ].each do |base|
+                s = b.to_s(base)
+                s.should == x.to_s(base).upcase if base <= 36
+                LibTom::Math::Bignum.new(s, base).should == b
+            end
+        end
+    end
+
+    it "should convert to and from binary strings" do
+        [ 0, 255, 2**64 + 5, 3**3000, -1, -128, -129, -(7**900) ].each do |x|
+            w = (x.abs.to_s(2).size + 8) / 8 * 8
+            hex = (x % 2**(8*w)).to_s(16).rjust(2*w, "0")
+            be = [hex].pack("H*")
+            b = LibTom::Math::Bignum.new(x)
+            b.to_bytes(:width => w, :signed => true).should == be
+            b.to_bytes(:width => w, :word => 4, :order => :little, :endian => :little, :signed => true).should == be.reverse
+            b.to_bytes(:width => w, :word => 8, :order => :little, :signed => true).should == be.scan(/.{8}/m).reverse.join
+            LibTom::Math::Bignum.from_bytes(be, :signed => true).should == x
+            LibTom::Math::Bignum.from_bytes(be.reverse, :word => 2, :order => :little, :endian => :little, :signed => true).should == x
+            LibTom::Math::Bignum.from_bytes(b.to_bytes(:signed => true, :endian => :native, :word => 4), :signed => true, :endian => :native, :word => 4).should == x
+            LibTom::Math::Bignum.from_bytes(b.abs.to_bytes).should == x.abs
+        end
+        LibTom::Math::Bignum.new(-128).to_bytes(:signed => true).should == "\x80".force_encoding("BINARY")
+        lambda { LibTom::Math::Bignum.new(-1).to_bytes }.should raise_error(RangeError)
+        lambda { LibTom::Math::Bignum.new(256).to_bytes(:width => 1) }.should raise_error(RangeError)
+        lambda { LibTom::Math::Bignum.from_bytes("abc", :word => 2) }.should raise_error(ArgumentError)
+    end
+
     it "should have Numeric as an ancestor" do
         @bn.class.ancestors.should include(Numeric)
     end
@@ -96,6 +179,14 @@ describe LibTom::Math::Bignum, "conversions" do
         c.should == 9876543210987654321
     end
 
+    it "should convert back to an Integer" do
+        [0, 42, -42, 9876543210987654321, -(7**5000)].each do |i|
+            c = LibTom::Math::Bignum.new(i).to_i
+            c.should == i
+            c.should be_kind_of(Integer)
+        end
+    end
+
     it "should convert a Float to Bignum correctly" do
         c = LibTom::Math::Bignum.new(42.42)
         c.should == 42
@@ -174,6 +265,18 @@ describe LibTom::Math::Bignum, "arithmetic operations" do
         c.abs.should == @a
     end
 
+    it "should leave the receiver alone when negating or taking the absolute value" do
+        c = -@a
+        c.should_not equal(@a)
+        @a.should == 1234567890987654321
+        d = c.abs
+        d.should_not equal(c)
+        c.should == -1234567890987654321
+        d.add!(10)
+        c.should == -1234567890987654321
+        @a.should == 1234567890987654321
+    end
+
     answers = {
         # test has param1, param2, [result of param1 op param2, result of param2 op param1]
         # klass => Array of tests
@@ -286,17 +389,160 @@ describe LibTom::Math::Bignum, "arithmetic operations" do
     end
     
     it "should perform divmod correctly - param neg " do
-        @a.divmod(-42).should == [-29394473594944150, -21]
+        @a.divmod(-42).should == [-29394473594944151, -21]
     end
     
     it "should perform divmod correctly - self neg " do
-        (-@a).divmod(42).should == [-29394473594944150, 21]
+        (-@a).divmod(42).should == [-29394473594944151, 21]
     end
     
     it "should perform divmod correctly - both neg " do
         (-@a).divmod(-42).should == [29394473594944150, -21]
     end
 
+    it "should perform divmod correctly - exact with a neg param" do
+        (@a * 3).divmod(-@a).should == [-3, 0]
+    end
+
+    it "should floor divmod the way Integer does for every kind of divisor" do
+        [ 7, -7, 3**90, -(3**90) ].each do |x|
+            [ 2, -2, 64, -64, 42, -42, 2**200, -(2**200), 3**50, -(3**50), LibTom::Math::Bignum.new(-(5**60)) ].each do |y|
+                q, m = LibTom::Math::Bignum.new(x).divmod(y)
+                [q, m].should == x.divmod(y.to_i)
+                (q * y + m).should == x
+            end
+        end
+    end
+
+    it "should perform modulo correctly - exact with a neg param" do
+        ((@a * 3) % -@a).should == 0
+    end
+
+    it "should perform exact division" do
+        (@a * 12345678901234567).divexact(12345678901234567).should == @a
+        (@a * @a).divexact(-@a).should == -@a
+        (@a * 64).divexact(64).should == @a
+    end
+
+    it "should throw ZeroDivisionError when divexact 0" do
+        lambda { @a.divexact(0) }.should raise_error(ZeroDivisionError)
+    end
+
+    it "should multiply, square and divide numbers big enough for Toom-Cook" do
+        x = (3**40000) + 12345
+        y = (7**20000) - 54321
+        a = LibTom::Math::Bignum.new(x)
+        b = LibTom::Math::Bignum.new(y)
+        (a * b).should == x * y
+        a.squared.should == x * x
+        (a / b).should == x / y
+        (a % b).should == x % y
+        (a * b).divexact(b).should == a
+    end
+
+    it "should divide numbers big enough for Burnikel-Ziegler" do
+        x = (3**400000) + 17
+        [(7**120000) + 1, (2**300000) - 1, (5**20000) * 3].each do |y|
+            a = LibTom::Math::Bignum.new(x)
+            b = LibTom::Math::Bignum.new(y)
+            (a / b).should == x / y
+            (a % b).should == x % y
+            (-a).remainder(b).should == (-x).remainder(y)
+            ((a * b + b - 1) / b).should == a
+        end
+    end
+
+    it "should multiply and square numbers big enough for Toom-4 and Toom-6.5" do
+        x = (3**150000) - 1
+        method = LibTom::Math.fft_multiplier
+        LibTom::Math.fft_multiplier = :none
+        begin
+            [(7**100000) + 12345, (5**100000) - 1, (2**220000) - 1].each do |y|
+                a = LibTom::Math::Bignum.new(x)
+                b = LibTom::Math::Bignum.new(y)
+                (a * b).should == x * y
+                (-a * b).should == -(x * y)
+                b.squared.should == y * y
+            end
+        ensure
+            LibTom::Math.fft_multiplier = method
+        end
+    end
+
+    it "should multiply numbers of very different lengths" do
+        x = (3**200000) + 1
+        [(7**9000) - 5, 2**3000 - 1, (11**27000) + 3, (13**29000) - 1, 5**30000].each do |y|
+            a = LibTom::Math::Bignum.new(x)
+            b = LibTom::Math::Bignum.new(y)
+            (a * b).should == x * y
+            (b * a).should == x * y
+            (-a * b).should == -(x * y)
+        end
+        y = (5**30000) - 1
+        [(11**27000) + 3, (13**29000) - 1].each do |x|
+            a = LibTom::Math::Bignum.new(x)
+            b = LibTom::Math::Bignum.new(y)
+            (a * -b).should == x * -y
+        end
+    end
+
+    it "should multiply and square numbers big enough for Schonhage-Strassen" do
+        x = (3**250000) - 1
+        y = (5**150000) + 7
+        a = LibTom::Math::Bignum.new(x)
+        b = LibTom::Math::Bignum.new(y)
+        method = LibTom::Math.fft_multiplier
+        LibTom::Math.fft_multiplier = :ssa
+        begin
+            (a * b).should == x * y
+            (a * -b).should == -(x * y)
+            a.squared.should == x * x
+            ((LibTom::Math::Bignum.new(9)**25)**20000).should == (9**25)**20000
+        ensure
+            LibTom::Math.fft_multiplier = method
+        end
+    end
+
+    it "should give the same products with every FFT multiplier" do
+        x = (7**150000) + 3
+        y = (2**400000) - 1
+        a = LibTom::Math::Bignum.new(x)
+        b = LibTom::Math::Bignum.new(y)
+        method = LibTom::Math.fft_multiplier
+        begin
+            [:ntt, :ssa, :none].each do |m|
+                LibTom::Math.fft_multiplier = m
+                LibTom::Math.fft_multiplier.should == m
+                (a * b).should == x * y
+                (-a * b).should == -(x * y)
+                b.squared.should == y * y
+            end
+        ensure
+            LibTom::Math.fft_multiplier = method
+        end
+        lambda { LibTom::Math.fft_multiplier = :fourier }.should raise_error(ArgumentError)
+    end
+
+    it "should give the same products with every comba kernel" do
+        x = (3**2500) + 5
+        y = (2**3000) - 1
+        a = LibTom::Math::Bignum.new(x)
+        b = LibTom::Math::Bignum.new(y)
+        kernel = LibTom::Math.comba_kernel
+        begin
+            [:ifma, :avx2, :scalar].drop_while { |k| k != kernel }.each do |k|
+                LibTom::Math.comba_kernel = k
+                LibTom::Math.comba_kernel.should == k
+                (a * b).should == x * y
+                (-a * b).should == -(x * y)
+                a.squared.should == x * x
+            end
+        ensure
+            LibTom::Math.comba_kernel = kernel
+        end
+        lambda { LibTom::Math.comba_kernel = :sse }.should raise_error(ArgumentError)
+    end
+
     it "should perform remainder correctly - all pos" do
         @a.remainder(42).should == 21
     end
@@ -322,6 +568,129 @@ describe LibTom::Math::Bignum, "arithmetic operations" do
     end
 end
 
+describe LibTom::Math::Bignum, "Fixnum operands" do
+    before(:each) do
+        @a = LibTom::Math::Bignum.new(-1234567890987654321)
+        @c = -1234567890987654321
+        @wide = 2**61 + 12345
+    end
+
+    [ 97, -97, 1, -1, 2**61 + 12345, -(2**61 + 12345) ].each do |n|
+        %w[ + - * / % remainder <=> == ].each do |op|
+            it "should #{op} #{n} correctly" do
+                expected = case op
+                           when "/" then (@c.abs / n.abs) * (((@c < 0) ^ (n < 0)) ? -1 : 1)
+                           else @c.send(op,n)
+                           end
+                @a.send(op,n).should == expected
+            end
+        end
+    end
+
+    it "should % into the sign of the divisor" do
+        (LibTom::Math::Bignum.new(-7) % 5).should == 3
+        (LibTom::Math::Bignum.new(7) % -5).should == -3
+        (LibTom::Math::Bignum.new(10) % -5).should == 0
+    end
+
+    it "should instantiate from a Fixnum wider than 32 bits" do
+        LibTom::Math::Bignum.new(@wide).should == @wide
+        LibTom::Math::Bignum.new(-@wide).should == -@wide
+    end
+
+    it "should throw ZeroDivisionError when % 0 (Integer)" do
+        lambda { @a % 0 }.should raise_error(ZeroDivisionError)
+    end
+
+    it "should divide long numbers by single digits" do
+        x = (3**5000) + 1
+        a = LibTom::Math::Bignum.new(x)
+        [ 3, 7, 10, 1000003, 2**59 + 1, 2**60 - 1, -(2**31 - 1) ].each do |n|
+            (a / n).should == (x.abs / n.abs) * (n < 0 ? -1 : 1)
+            (a % n).should == x % n
+            (-a).remainder(n).should == (-x).remainder(n)
+        end
+    end
+
+    it "should find the next prime of a long number" do
+        a = LibTom::Math::Bignum.new(10**300)
+        a.next_prime.should == 10**300 + 331
+    end
+end
+
+describe LibTom::Math::Bignum, "power of 2 and square operands" do
+    before(:each) do
+        @a = LibTom::Math::Bignum.new(-1234567890987654321)
+        @c = -1234567890987654321
+    end
+
+    [ 2**100, -(2**100), 2**61, -(2**61), 1024 ].each do |n|
+        it "should * #{n} correctly" do
+            (@a * LibTom::Math::Bignum.new(n)).should == @c * n
+            (LibTom::Math::Bignum.new(n) * @a).should == @c * n
+        end
+
+        it "should / and remainder #{n} correctly" do
+            (@a / LibTom::Math::Bignum.new(n)).should == (@c.abs / n.abs) * (((@c < 0) ^ (n < 0)) ? -1 : 1)
+            @a.remainder(LibTom::Math::Bignum.new(n)).should == @c.remainder(n)
+        end
+
+        it "should % #{n} correctly" do
+            (@a % LibTom::Math::Bignum.new(n)).should == @c % n
+        end
+    end
+
+    it "should square when multiplied by itself" do
+        (@a * @a).should == @c * @c
+    end
+end
+
+describe LibTom::Math::Bignum, "in place operations" do
+    before(:each) do
+        @a = LibTom::Math::Bignum.new(-1234567890987654321)
+        @c = -1234567890987654321
+    end
+
+    it "should return the receiver" do
+        @a.add!(1).should equal(@a)
+    end
+
+    it "should add! and sub! in place" do
+        @a.add!(2**70).should == @c + 2**70
+        @a.sub!(-42).should == @c + 2**70 + 42
+        @a.add!(@a).should == 2 * (@c + 2**70 + 42)
+    end
+
+    it "should mul! and sqr! in place" do
+        @a.mul!(3).should == @c * 3
+        @a.mul!(-(2**61)).should == @c * 3 * -(2**61)
+        @a.sqr!.should == (@c * 3 * 2**61)**2
+    end
+
+    it "should mod! in place" do
+        @a.mod!(1000).should == @c % 1000
+        LibTom::Math::Bignum.new(@c).mod!(-(2**61)).should == @c % -(2**61)
+        LibTom::Math::Bignum.new(@c).mod!(2**100 + 1).should == @c % (2**100 + 1)
+    end
+
+    it "should shl! and shr! in place" do
+        @a.abs.shl!(100).should == @c.abs << 100
+        @a.abs.shr!(20).should == @c.abs >> 20
+    end
+
+    it "should keep an accumulator in place" do
+        acc = LibTom::Math::Bignum.new(1)
+        m = 2**127 - 1
+        100.times { acc.mul!(@a).mod!(m) }
+        acc.should == (@c ** 100) % m
+    end
+
+    it "should not change a frozen Bignum" do
+        @a.freeze
+        lambda { @a.add!(1) }.should raise_error
+    end
+end
+
 describe LibTom::Math::Bignum, "utility operations" do
     before(:each) do
         @a = LibTom::Math::Bignum.new(1234567890987654321)
@@ -447,6 +816,17 @@ describe LibTom::Math::Bignum, "bitwise operations" do
     it "should return the number of bits in the internal representation" do
         @a.num_bits.should == 61
     end
+
+    it "should count its digits in any base without converting" do
+        [ 0, 1, -9, 10**500 - 1, -(10**500), 3**2000, 2**3000 ].each do |x|
+            b = LibTom::Math::Bignum.new(x)
+            [ 2, 3, 10, 16, 36 ].each do |base|
+                b.num_digits(base).should == x.abs.to_s(base).size
+            end
+        end
+        @a.num_digits.should == 19
+        lambda { @a.num_digits(65) }.should raise_error(ArgumentError)
+    end
 end
 
 describe LibTom::Math::Bignum, "Bonus methods" do 
@@ -503,6 +883,35 @@ describe LibTom::Math::Bignum, "Bonus methods" do
         @a.exponent_modulus(42,4321).should == ((@c ** 42) % 4321)
     end
 
+    it "should do d = (a ** b) mod c for a large odd c" do
+        m = (3**9000) + 2
+        x = (7**5000) + 1
+        LibTom::Math::Bignum.new(x).exponent_modulus(12345, m).should == x.pow(12345, m)
+    end
+
+    it "should do d = (a ** b) mod c for large values on several threads" do
+        m = 2**1279 - 1
+        threads = (1..4).map do |i|
+            Thread.new { (@a + i).exponent_modulus(m - 2, m) }
+        end
+        threads.each_with_index do |t,i|
+            ((t.value * (@a + i + 1)) % m).should == 1
+        end
+    end
+
+
+    it "should not be disturbed by other threads changing the operands in place" do
+        m = 2**1279 - 1
+        e = LibTom::Math::Bignum.new(m - 2)
+        answers = [ @a.exponent_modulus(m - 2, m), @a.exponent_modulus((m - 2) << 5000, m) ]
+        threads = (1..4).map { Thread.new { @a.exponent_modulus(e, m) } }
+        while threads.any? { |t| t.alive? }
+            e.shl!(5000)
+            e.shr!(5000)
+        end
+        threads.each { |t| answers.should include(t.value) }
+    end
+
 
     it "should do c = (1/a) mod b" do
         s = LibTom::Math::Bignum.new(4)
@@ -606,4 +1015,24 @@ describe LibTom::Math::Bignum, "Prime Number Methods" do
         a = LibTom::Math::Bignum.new(104729)
         lambda{ a.next_prime({ :trials => -1 }) }.should raise_error(ArgumentError)
     end
+
+    it "should detect a large prime" do
+        LibTom::Math::Bignum.new(2**1279 - 1).should be_is_prime
+        LibTom::Math::Bignum.new(2**1279 + 1).should_not be_is_prime
+    end
+
+    it "should find the next prime of a large number" do
+        a = LibTom::Math::Bignum.new(2**600)
+        b = a.next_prime
+        b.should > a
+        b.should be_is_prime
+        (a.next_prime(:congruency => true) % 4).should == 3
+    end
+
+    it "should let a long next_prime be killed" do
+        t = Thread.new { LibTom::Math::Bignum.new(2**4000).next_prime }
+        sleep 0.1
+        t.kill
+        t.join(5).should == t
+    end
 end
@@ -0,0 +1,29 @@
+require 'libtom/math'
+
+describe LibTom::Math::Divisor do
+    it "should divide the same way Bignum does" do
+        [ 7, -7, 2**64 + 1, -(3**80), (2**127) - 1 ].each do |y|
+            d = LibTom::Math::Divisor.new(y)
+            d.divisor.should == y
+            [ 0, 5, -5, 3**200, -(3**200), 2**1000 - 1 ].each do |x|
+                a = LibTom::Math::Bignum.new(x)
+                d.div(x).should == a / y
+                d.mod(x).should == a % y
+                d.divmod(a).should == a.divmod(y)
+            end
+        end
+    end
+
+    it "should divide huge numbers by a big divisor" do
+        x = (3**200000) + 17
+        y = (7**9000) + 1
+        d = LibTom::Math::Divisor.new(y)
+        d.div(x).should == x / y
+        d.mod(x).should == x % y
+        d.dup.mod(-x).should == (-x) % y
+    end
+
+    it "should raise an exception when set up with 0" do
+        lambda { LibTom::Math::Divisor.new(0) }.should raise_error(ZeroDivisionError)
+    end
+end